@@ -3,6 +3,8 @@
 #include "../helpers/classification_helpers.h"
 #include "../helpers/log.h"
 #include "../ml_algorithms/artificial_neural_network.h"
+#include "../ml_algorithms/quantized_artificial_neural_network.h"
+#include "../ml_algorithms/fixed_models.h"
 log_struct LOGGING_CONFIG = {};
 
 int main() {
@@ -16,7 +18,8 @@ int main() {
     ArtificialNeuralNetwork artificial_neural_network_stft = {};
     // Create an artificial neural network from csv files
     LOG(LOG_INFO) << "Creating an Artificial Neural Network from all csv files in the following dir " << ARTIFICIAL_NEURAL_NETWORK_LAYERS_FOLDER_PATH_STFT << " ...";
-    artificial_neural_network_stft.fill_from_csv(ARTIFICIAL_NEURAL_NETWORK_LAYERS_FOLDER_PATH_STFT);
+    load_model_from_csv(artificial_neural_network_stft, ARTIFICIAL_NEURAL_NETWORK_LAYERS_FOLDER_PATH_STFT);
+    LOG(LOG_INFO) << "Model arena: " << artificial_neural_network_stft.get_arena();
     LOG(LOG_DEBUG) << "artificial neural network (" << artificial_neural_network_stft.get_layers().size() << " layers):\n" << artificial_neural_network_stft;
 
     // Predict and test prediction results
@@ -24,6 +27,45 @@ int main() {
     auto prediction_accuracy_stft = predictions_report(predictions_stft);
     LOG(LOG_INFO) << "Model accuracy: "<< prediction_accuracy_stft;
     show_confusion_matrix(predictions_stft);
+    auto prediction_time_stft = benchmark_predictions(artificial_neural_network_stft, fvs_stft, 100);
+    LOG(LOG_INFO) << "Prediction time: " << prediction_time_stft << "µs";
+
+    // Fixed shape network generated by FIXED_MODEL_GENERATOR, the weights are in the object so it is allocated on the heap
+    auto fixed_artificial_neural_network_stft = std::make_unique<FixedArtificialNeuralNetworkSTFT>();
+    fixed_artificial_neural_network_stft->load(artificial_neural_network_stft);
+    auto fixed_predictions_stft = make_predictions(*fixed_artificial_neural_network_stft, fvs_stft);
+    LOG(LOG_INFO) << "Model accuracy (fixed shape): " << predictions_report(fixed_predictions_stft);
+    auto fixed_time_stft = benchmark_predictions(*fixed_artificial_neural_network_stft, fvs_stft, 100);
+    LOG(LOG_INFO) << "Prediction time: " << prediction_time_stft << "µs (runtime shape) versus " << fixed_time_stft << "µs (fixed shape), speed-up x" << prediction_time_stft / fixed_time_stft;
+
+    // Batch predictions and speed-up versus batch size on the train set
+    auto batch_predictions_stft = make_batch_predictions(artificial_neural_network_stft, fvs_stft);
+    LOG(LOG_INFO) << "Model accuracy (batch): " << predictions_report(batch_predictions_stft);
+    auto train_fvs_stft = get_features_vectors_from_csv(MUSIC_FEATURES_STFT_CSV_TRAIN_PATH, AuFileProcessingAlgorithm::STFT);
+    auto single_time_stft = benchmark_predictions(artificial_neural_network_stft, train_fvs_stft, 10);
+    for (std::size_t batch_size = 1; batch_size <= train_fvs_stft.size(); batch_size *= 4) {
+        auto batch_time_stft = benchmark_batch_predictions(artificial_neural_network_stft, train_fvs_stft, batch_size, 10);
+        LOG(LOG_INFO) << "Batch size " << batch_size << ": " << batch_time_stft << "µs per sample, speed-up x" << single_time_stft / batch_time_stft;
+    }
+    artificial_neural_network_stft.set_thread_pool(std::make_shared<ThreadPool>());
+    auto threaded_batch_time_stft = benchmark_batch_predictions(artificial_neural_network_stft, train_fvs_stft, train_fvs_stft.size(), 10);
+    LOG(LOG_INFO) << "Batch size " << train_fvs_stft.size() << " on " << std::thread::hardware_concurrency() << " threads: " << threaded_batch_time_stft << "µs per sample, speed-up x" << single_time_stft / threaded_batch_time_stft;
+
+    // Int8 quantization calibrated on the train set
+    std::vector<real_vector_t> calibration_fvs_stft;
+    std::transform(train_fvs_stft.cbegin(), train_fvs_stft.cend(), std::back_inserter(calibration_fvs_stft), [](const std::pair<std::string, real_vector_t> &pair) {
+        return pair.second;
+    });
+    QuantizedArtificialNeuralNetwork quantized_artificial_neural_network_stft = {};
+    for (QuantizationGranularity granularity: {QuantizationGranularity::PER_LAYER, QuantizationGranularity::PER_CHANNEL}) {
+        quantized_artificial_neural_network_stft.quantize(artificial_neural_network_stft, calibration_fvs_stft, granularity);
+        auto quantized_predictions_stft = make_predictions(quantized_artificial_neural_network_stft, fvs_stft);
+        auto quantized_accuracy_stft = predictions_report(quantized_predictions_stft);
+        LOG(LOG_INFO) << "Model accuracy (int8 " << (granularity == QuantizationGranularity::PER_LAYER ? "per layer" : "per channel") << "): " << quantized_accuracy_stft << " (delta " << quantized_accuracy_stft - prediction_accuracy_stft << ")";
+    }
+    auto quantized_time_stft = benchmark_predictions(quantized_artificial_neural_network_stft, fvs_stft, 100);
+    LOG(LOG_INFO) << "Footprint: " << artificial_neural_network_stft.get_memory_footprint() << "B (float) versus " << quantized_artificial_neural_network_stft.get_memory_footprint() << "B (int8), gain x" << (real_t) artificial_neural_network_stft.get_memory_footprint() / (real_t) quantized_artificial_neural_network_stft.get_memory_footprint();
+    LOG(LOG_INFO) << "Prediction time: " << prediction_time_stft << "µs (float) versus " << quantized_time_stft << "µs (int8), speed-up x" << prediction_time_stft / quantized_time_stft;
 
     LOG(LOG_INFO) << "------------ Testing Artificial Neural Network using MFCC algorithm ------------";
     // Get features from csv file
@@ -32,7 +74,8 @@ int main() {
     ArtificialNeuralNetwork artificial_neural_network_mfcc = {};
     // Create a tree from csv file
     LOG(LOG_INFO) << "Creating an Artificial Neural Network from all csv files in the following dir " << ARTIFICIAL_NEURAL_NETWORK_LAYERS_FOLDER_PATH_MFCC << " ...";
-    artificial_neural_network_mfcc.fill_from_csv(ARTIFICIAL_NEURAL_NETWORK_LAYERS_FOLDER_PATH_MFCC);
+    load_model_from_csv(artificial_neural_network_mfcc, ARTIFICIAL_NEURAL_NETWORK_LAYERS_FOLDER_PATH_MFCC);
+    LOG(LOG_INFO) << "Model arena: " << artificial_neural_network_mfcc.get_arena();
     LOG(LOG_DEBUG) << "artificial neural network (" << artificial_neural_network_mfcc.get_layers().size() << " layers):\n" << artificial_neural_network_mfcc;
 
     // Predict and test prediction results
@@ -40,6 +83,45 @@ int main() {
     auto prediction_accuracy_mfcc = predictions_report(predictions_mfcc);
     LOG(LOG_INFO) << "Model accuracy: "<< prediction_accuracy_mfcc;
     show_confusion_matrix(predictions_mfcc);
+    auto prediction_time_mfcc = benchmark_predictions(artificial_neural_network_mfcc, fvs_mfcc, 100);
+    LOG(LOG_INFO) << "Prediction time: " << prediction_time_mfcc << "µs";
+
+    // Fixed shape network generated by FIXED_MODEL_GENERATOR, the weights are in the object so it is allocated on the heap
+    auto fixed_artificial_neural_network_mfcc = std::make_unique<FixedArtificialNeuralNetworkMFCC>();
+    fixed_artificial_neural_network_mfcc->load(artificial_neural_network_mfcc);
+    auto fixed_predictions_mfcc = make_predictions(*fixed_artificial_neural_network_mfcc, fvs_mfcc);
+    LOG(LOG_INFO) << "Model accuracy (fixed shape): " << predictions_report(fixed_predictions_mfcc);
+    auto fixed_time_mfcc = benchmark_predictions(*fixed_artificial_neural_network_mfcc, fvs_mfcc, 100);
+    LOG(LOG_INFO) << "Prediction time: " << prediction_time_mfcc << "µs (runtime shape) versus " << fixed_time_mfcc << "µs (fixed shape), speed-up x" << prediction_time_mfcc / fixed_time_mfcc;
+
+    // Batch predictions and speed-up versus batch size on the train set
+    auto batch_predictions_mfcc = make_batch_predictions(artificial_neural_network_mfcc, fvs_mfcc);
+    LOG(LOG_INFO) << "Model accuracy (batch): " << predictions_report(batch_predictions_mfcc);
+    auto train_fvs_mfcc = get_features_vectors_from_csv(MUSIC_FEATURES_MFCC_CSV_TRAIN_PATH, AuFileProcessingAlgorithm::MFCC);
+    auto single_time_mfcc = benchmark_predictions(artificial_neural_network_mfcc, train_fvs_mfcc, 10);
+    for (std::size_t batch_size = 1; batch_size <= train_fvs_mfcc.size(); batch_size *= 4) {
+        auto batch_time_mfcc = benchmark_batch_predictions(artificial_neural_network_mfcc, train_fvs_mfcc, batch_size, 10);
+        LOG(LOG_INFO) << "Batch size " << batch_size << ": " << batch_time_mfcc << "µs per sample, speed-up x" << single_time_mfcc / batch_time_mfcc;
+    }
+    artificial_neural_network_mfcc.set_thread_pool(std::make_shared<ThreadPool>());
+    auto threaded_batch_time_mfcc = benchmark_batch_predictions(artificial_neural_network_mfcc, train_fvs_mfcc, train_fvs_mfcc.size(), 10);
+    LOG(LOG_INFO) << "Batch size " << train_fvs_mfcc.size() << " on " << std::thread::hardware_concurrency() << " threads: " << threaded_batch_time_mfcc << "µs per sample, speed-up x" << single_time_mfcc / threaded_batch_time_mfcc;
+
+    // Int8 quantization calibrated on the train set
+    std::vector<real_vector_t> calibration_fvs_mfcc;
+    std::transform(train_fvs_mfcc.cbegin(), train_fvs_mfcc.cend(), std::back_inserter(calibration_fvs_mfcc), [](const std::pair<std::string, real_vector_t> &pair) {
+        return pair.second;
+    });
+    QuantizedArtificialNeuralNetwork quantized_artificial_neural_network_mfcc = {};
+    for (QuantizationGranularity granularity: {QuantizationGranularity::PER_LAYER, QuantizationGranularity::PER_CHANNEL}) {
+        quantized_artificial_neural_network_mfcc.quantize(artificial_neural_network_mfcc, calibration_fvs_mfcc, granularity);
+        auto quantized_predictions_mfcc = make_predictions(quantized_artificial_neural_network_mfcc, fvs_mfcc);
+        auto quantized_accuracy_mfcc = predictions_report(quantized_predictions_mfcc);
+        LOG(LOG_INFO) << "Model accuracy (int8 " << (granularity == QuantizationGranularity::PER_LAYER ? "per layer" : "per channel") << "): " << quantized_accuracy_mfcc << " (delta " << quantized_accuracy_mfcc - prediction_accuracy_mfcc << ")";
+    }
+    auto quantized_time_mfcc = benchmark_predictions(quantized_artificial_neural_network_mfcc, fvs_mfcc, 100);
+    LOG(LOG_INFO) << "Footprint: " << artificial_neural_network_mfcc.get_memory_footprint() << "B (float) versus " << quantized_artificial_neural_network_mfcc.get_memory_footprint() << "B (int8), gain x" << (real_t) artificial_neural_network_mfcc.get_memory_footprint() / (real_t) quantized_artificial_neural_network_mfcc.get_memory_footprint();
+    LOG(LOG_INFO) << "Prediction time: " << prediction_time_mfcc << "µs (float) versus " << quantized_time_mfcc << "µs (int8), speed-up x" << prediction_time_mfcc / quantized_time_mfcc;
 
     return 0;
 }
@@ -18,7 +18,8 @@ int main() {
     DecisionTree decision_tree_model_stft = {};
     // Create a tree from csv file
     LOG(LOG_INFO) << "Creating a Decision Tree from the csv file " << DECISION_TREE_CSV_PATH_STFT << " ...";
-    decision_tree_model_stft.fill_from_csv(DECISION_TREE_CSV_PATH_STFT);
+    load_model_from_csv(decision_tree_model_stft, DECISION_TREE_CSV_PATH_STFT);
+    LOG(LOG_INFO) << "Model arena: " << decision_tree_model_stft.get_arena();
     LOG(LOG_DEBUG) << "decision tree (depth: " << decision_tree_model_stft.get_depth() << "): " << decision_tree_model_stft;
 
     // Predict and test prediction results
@@ -35,7 +36,8 @@ int main() {
     DecisionTree decision_tree_model_mfcc = {};
     // Create a tree from csv file
     LOG(LOG_INFO) << "Creating a Decision Tree from the csv file " << DECISION_TREE_CSV_PATH_MFCC << " ...";
-    decision_tree_model_mfcc.fill_from_csv(DECISION_TREE_CSV_PATH_MFCC);
+    load_model_from_csv(decision_tree_model_mfcc, DECISION_TREE_CSV_PATH_MFCC);
+    LOG(LOG_INFO) << "Model arena: " << decision_tree_model_mfcc.get_arena();
     LOG(LOG_DEBUG) << "decision tree (depth: " << decision_tree_model_mfcc.get_depth() << "): " << decision_tree_model_mfcc;
 
     // Predict and test prediction results
@@ -0,0 +1,105 @@
+#include "../helpers/file_helpers.h"
+#include "../helpers/classification_helpers.h"
+#include "../helpers/log.h"
+#include "../ml_algorithms/decision_tree.h"
+#include "../ml_algorithms/random_forest.h"
+#include "../ml_algorithms/one_vs_one_svm.h"
+#include "../ml_algorithms/artificial_neural_network.h"
+
+// The embedded models headers are generated by EMBEDDED_MODEL_GENERATOR for the models of EML_EMBEDDED_MODELS
+#ifdef EMBEDDED_CART
+#include "embedded_cart.h"
+#endif
+#ifdef EMBEDDED_RANDOM_FOREST
+#include "embedded_random_forest.h"
+#endif
+#ifdef EMBEDDED_SVM
+#include "embedded_svm.h"
+#endif
+#ifdef EMBEDDED_ANN
+#include "embedded_ann.h"
+#endif
+
+log_struct LOGGING_CONFIG = {};
+
+/**
+ * @brief           Predict the test set with an embedded model, check that it makes the same predictions as the model
+ *                  loaded from the training CSV files and compare their prediction times.
+ *
+ * @param[in]       model_name the name of the model in the logs
+ * @param[in]       embedded_model the model compiled in the binary
+ * @param[in]       csv_path the CSV file or folder of the same model
+ * @param[in]       fvs the test features vectors
+ * @returns         true if the embedded model makes the same predictions as the CSV one
+ */
+template<typename Model, typename EmbeddedModel>
+bool test_embedded_model(const std::string &model_name, const EmbeddedModel &embedded_model, const std::filesystem::path &csv_path, const std::vector<std::pair<std::string, real_vector_t>> &fvs) {
+    LOG(LOG_INFO) << "------------ Testing the embedded " << model_name << " model ------------";
+    LOG(LOG_INFO) << "Embedded tables: " << embedded_model.get_memory_footprint() << "B of read-only data, nothing to load";
+
+    // <true_label, predicted_label>, the features vectors size is checked once here
+    std::vector<std::pair<std::string, std::string>> predictions;
+    for (const std::pair<std::string, real_vector_t> &pair: fvs) {
+        if (pair.second.size() != EmbeddedModel::NUMBER_OF_FEATURES) {
+            LOG(LOG_ERROR) << "Error : the features vector size (" << pair.second.size() << ") is different from the embedded model one (" << EmbeddedModel::NUMBER_OF_FEATURES << ")";
+            throw std::invalid_argument("Feature vector size differ from embedded model one!");
+        }
+        const std::size_t class_id = embedded_model.predict_class_id(std::span<const real_t, EmbeddedModel::NUMBER_OF_FEATURES>(pair.second.data(), EmbeddedModel::NUMBER_OF_FEATURES));
+        predictions.emplace_back(pair.first, embedded_model.get_class_name(class_id));
+    }
+    LOG(LOG_INFO) << "Model accuracy: " << predictions_report(predictions);
+
+    real_t best_elapsed_time = std::numeric_limits<real_t>::max();
+    std::size_t class_ids_sum = 0;
+    for (std::size_t repetition = 0; repetition < 100; repetition++) {
+        auto start_time = std::chrono::high_resolution_clock::now();
+        for (const std::pair<std::string, real_vector_t> &pair: fvs) {
+            class_ids_sum += embedded_model.predict_class_id(std::span<const real_t, EmbeddedModel::NUMBER_OF_FEATURES>(pair.second.data(), EmbeddedModel::NUMBER_OF_FEATURES));
+        }
+        auto stop_time = std::chrono::high_resolution_clock::now();
+        best_elapsed_time = std::min(best_elapsed_time, (real_t) std::chrono::duration_cast<std::chrono::nanoseconds>(stop_time - start_time).count());
+    }
+    LOG(LOG_DEBUG) << "class ids checksum: " << class_ids_sum;
+    const real_t embedded_time = best_elapsed_time / 1000.0 / (real_t) fvs.size();
+
+    Model csv_model = {};
+    LOG(LOG_INFO) << "Creating the same model from " << csv_path << " ...";
+    load_model_from_csv(csv_model, csv_path);
+    const bool identical_predictions = make_predictions(csv_model, fvs) == predictions;
+    const real_t csv_time = benchmark_predictions(csv_model, fvs, 100);
+    LOG(LOG_INFO) << "Prediction time: " << csv_time << "µs (CSV model) versus " << embedded_time << "µs (embedded), " << (identical_predictions ? "identical predictions" : "PREDICTIONS DIFFER");
+    return identical_predictions;
+}
+
+int main() {
+    // Log config
+    LOGGING_CONFIG.level = LOG_INFO;
+
+    LOG(LOG_INFO) << "Getting features vectors from the csv files " << absolute(MUSIC_FEATURES_STFT_CSV_TEST_PATH) << " and " << absolute(MUSIC_FEATURES_MFCC_CSV_TEST_PATH) << " ...";
+    const auto fvs_stft = get_features_vectors_from_csv(MUSIC_FEATURES_STFT_CSV_TEST_PATH, AuFileProcessingAlgorithm::STFT);
+    const auto fvs_mfcc = get_features_vectors_from_csv(MUSIC_FEATURES_MFCC_CSV_TEST_PATH, AuFileProcessingAlgorithm::MFCC);
+
+    bool identical_predictions = true;
+#ifdef EMBEDDED_CART
+    identical_predictions &= test_embedded_model<DecisionTree>("CART STFT", EMBEDDED_CART_STFT, DECISION_TREE_CSV_PATH_STFT, fvs_stft);
+    identical_predictions &= test_embedded_model<DecisionTree>("CART MFCC", EMBEDDED_CART_MFCC, DECISION_TREE_CSV_PATH_MFCC, fvs_mfcc);
+#endif
+#ifdef EMBEDDED_RANDOM_FOREST
+    identical_predictions &= test_embedded_model<RandomForest>("random forest STFT", EMBEDDED_RANDOM_FOREST_STFT, RANDOM_FOREST_TREES_FOLDER_PATH_STFT, fvs_stft);
+    identical_predictions &= test_embedded_model<RandomForest>("random forest MFCC", EMBEDDED_RANDOM_FOREST_MFCC, RANDOM_FOREST_TREES_FOLDER_PATH_MFCC, fvs_mfcc);
+#endif
+#ifdef EMBEDDED_SVM
+    identical_predictions &= test_embedded_model<OneVsOneSVM>("one vs one SVM STFT", EMBEDDED_SVM_STFT, ONE_VS_ONE_SVM_CSV_PATH_STFT, fvs_stft);
+    identical_predictions &= test_embedded_model<OneVsOneSVM>("one vs one SVM MFCC", EMBEDDED_SVM_MFCC, ONE_VS_ONE_SVM_CSV_PATH_MFCC, fvs_mfcc);
+#endif
+#ifdef EMBEDDED_ANN
+    identical_predictions &= test_embedded_model<ArtificialNeuralNetwork>("neural network STFT", EMBEDDED_ANN_STFT, ARTIFICIAL_NEURAL_NETWORK_LAYERS_FOLDER_PATH_STFT, fvs_stft);
+    identical_predictions &= test_embedded_model<ArtificialNeuralNetwork>("neural network MFCC", EMBEDDED_ANN_MFCC, ARTIFICIAL_NEURAL_NETWORK_LAYERS_FOLDER_PATH_MFCC, fvs_mfcc);
+#endif
+
+    if (!identical_predictions) {
+        LOG(LOG_ERROR) << "Error : at least one embedded model does not make the same predictions as its CSV model";
+        return 1;
+    }
+    return 0;
+}
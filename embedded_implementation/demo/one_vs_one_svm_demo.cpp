@@ -3,9 +3,29 @@
 #include "../helpers/classification_helpers.h"
 #include "../helpers/log.h"
 #include "../ml_algorithms/one_vs_one_svm.h"
+#include "../ml_algorithms/kernel_one_vs_one_svm.h"
+#include "../ml_algorithms/fixed_models.h"
 
 log_struct LOGGING_CONFIG = {};
 
+void test_kernel_svm(const std::filesystem::path &kernel_svm_folder_path, const std::vector<std::pair<std::string, real_vector_t>> &fvs) {
+    if (!std::filesystem::exists(kernel_svm_folder_path)) {
+        LOG(LOG_WARNING) << "No kernel SVM model in " << kernel_svm_folder_path << ", export one with kernel_svm_to_csv from training/support_vector_machine/utils.py";
+        return;
+    }
+    KernelOneVsOneSVM kernel_svm_model = {};
+    LOG(LOG_INFO) << "Creating a one vs one kernel SVM model from the folder " << kernel_svm_folder_path << " ...";
+    load_model_from_csv(kernel_svm_model, kernel_svm_folder_path);
+    LOG(LOG_INFO) << kernel_svm_model;
+
+    auto predictions = make_predictions(kernel_svm_model, fvs);
+    LOG(LOG_INFO) << "Model accuracy (kernel): " << predictions_report(predictions);
+    show_confusion_matrix(predictions);
+    auto batch_predictions = make_batch_predictions(kernel_svm_model, fvs);
+    LOG(LOG_INFO) << "Model accuracy (kernel batch): " << predictions_report(batch_predictions);
+    LOG(LOG_INFO) << "Prediction time (kernel): " << benchmark_predictions(kernel_svm_model, fvs, 10) << "µs";
+}
+
 int main() {
     // Log config
     LOGGING_CONFIG.level = LOG_INFO;
@@ -17,7 +37,8 @@ int main() {
     OneVsOneSVM svm_model_stft = {};
     // Create a one vs one SVM model from csv file
     LOG(LOG_INFO) << "Creating a one vs one SVM model from the csv file " << ONE_VS_ONE_SVM_CSV_PATH_STFT << " ...";
-    svm_model_stft.fill_from_csv(ONE_VS_ONE_SVM_CSV_PATH_STFT);
+    load_model_from_csv(svm_model_stft, ONE_VS_ONE_SVM_CSV_PATH_STFT);
+    LOG(LOG_INFO) << "Model arena: " << svm_model_stft.get_arena();
     LOG(LOG_DEBUG) << "one vs one SVM: " << svm_model_stft;
 
     // Predict and test prediction results
@@ -26,6 +47,25 @@ int main() {
     LOG(LOG_INFO) << "Model accuracy: "<< prediction_accuracy_stft;
     show_confusion_matrix(predictions_stft);
 
+    // Compare the max wins voting with the decision DAG evaluation
+    auto max_wins_time_stft = benchmark_predictions(svm_model_stft, fvs_stft, 100);
+    svm_model_stft.set_evaluation_mode(SVMEvaluationMode::DDAG);
+    auto ddag_predictions_stft = make_predictions(svm_model_stft, fvs_stft);
+    auto ddag_time_stft = benchmark_predictions(svm_model_stft, fvs_stft, 100);
+    LOG(LOG_INFO) << "Model accuracy (DDAG): " << predictions_report(ddag_predictions_stft);
+    LOG(LOG_INFO) << "Prediction time: " << max_wins_time_stft << "µs (max wins) versus " << ddag_time_stft << "µs (DDAG), speed-up x" << max_wins_time_stft / ddag_time_stft;
+
+    // Fixed shape SVM generated by FIXED_MODEL_GENERATOR, same max wins vote without any runtime size
+    auto fixed_svm_model_stft = std::make_unique<FixedOneVsOneSVMSTFT>();
+    fixed_svm_model_stft->load(svm_model_stft);
+    auto fixed_predictions_stft = make_predictions(*fixed_svm_model_stft, fvs_stft);
+    LOG(LOG_INFO) << "Model accuracy (fixed shape): " << predictions_report(fixed_predictions_stft);
+    auto fixed_time_stft = benchmark_predictions(*fixed_svm_model_stft, fvs_stft, 100);
+    LOG(LOG_INFO) << "Prediction time: " << max_wins_time_stft << "µs (max wins) versus " << fixed_time_stft << "µs (fixed shape), speed-up x" << max_wins_time_stft / fixed_time_stft;
+
+
+    test_kernel_svm(KERNEL_SVM_FOLDER_PATH_STFT, fvs_stft);
+
 
     LOG(LOG_INFO) << "------------ Testing one vs one SVM model using MFCC algorithm ------------";
     // Get features from csv file
@@ -34,7 +74,8 @@ int main() {
     OneVsOneSVM svm_model_mfcc= {};
     // Create a one vs one SVM model from csv file
     LOG(LOG_INFO) << "Creating a one vs one SVM model from the csv file " << ONE_VS_ONE_SVM_CSV_PATH_MFCC << " ...";
-    svm_model_mfcc.fill_from_csv(ONE_VS_ONE_SVM_CSV_PATH_MFCC);
+    load_model_from_csv(svm_model_mfcc, ONE_VS_ONE_SVM_CSV_PATH_MFCC);
+    LOG(LOG_INFO) << "Model arena: " << svm_model_mfcc.get_arena();
     LOG(LOG_DEBUG) << "one vs one SVM: " << svm_model_mfcc;
 
     // Predict and test prediction results
@@ -43,5 +84,23 @@ int main() {
     LOG(LOG_INFO) << "Model accuracy: "<< prediction_accuracy_mfcc;
     show_confusion_matrix(predictions_mfcc);
 
+    // Compare the max wins voting with the decision DAG evaluation
+    auto max_wins_time_mfcc = benchmark_predictions(svm_model_mfcc, fvs_mfcc, 100);
+    svm_model_mfcc.set_evaluation_mode(SVMEvaluationMode::DDAG);
+    auto ddag_predictions_mfcc = make_predictions(svm_model_mfcc, fvs_mfcc);
+    auto ddag_time_mfcc = benchmark_predictions(svm_model_mfcc, fvs_mfcc, 100);
+    LOG(LOG_INFO) << "Model accuracy (DDAG): " << predictions_report(ddag_predictions_mfcc);
+    LOG(LOG_INFO) << "Prediction time: " << max_wins_time_mfcc << "µs (max wins) versus " << ddag_time_mfcc << "µs (DDAG), speed-up x" << max_wins_time_mfcc / ddag_time_mfcc;
+
+    // Fixed shape SVM generated by FIXED_MODEL_GENERATOR, same max wins vote without any runtime size
+    auto fixed_svm_model_mfcc = std::make_unique<FixedOneVsOneSVMMFCC>();
+    fixed_svm_model_mfcc->load(svm_model_mfcc);
+    auto fixed_predictions_mfcc = make_predictions(*fixed_svm_model_mfcc, fvs_mfcc);
+    LOG(LOG_INFO) << "Model accuracy (fixed shape): " << predictions_report(fixed_predictions_mfcc);
+    auto fixed_time_mfcc = benchmark_predictions(*fixed_svm_model_mfcc, fvs_mfcc, 100);
+    LOG(LOG_INFO) << "Prediction time: " << max_wins_time_mfcc << "µs (max wins) versus " << fixed_time_mfcc << "µs (fixed shape), speed-up x" << max_wins_time_mfcc / fixed_time_mfcc;
+
+    test_kernel_svm(KERNEL_SVM_FOLDER_PATH_MFCC, fvs_mfcc);
+
     return 0;
 }
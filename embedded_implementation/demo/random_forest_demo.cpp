@@ -4,6 +4,7 @@
 #include "../helpers/log.h"
 #include "../ml_algorithms/decision_tree.h"
 #include "../ml_algorithms/random_forest.h"
+#include "../ml_algorithms/quantized_random_forest.h"
 log_struct LOGGING_CONFIG = {};
 
 int main() {
@@ -15,9 +16,14 @@ int main() {
     LOG(LOG_INFO) << "Getting features vectors from the csv file " << absolute(MUSIC_FEATURES_STFT_CSV_TEST_PATH) << "...";
     auto fvs_stft = get_features_vectors_from_csv(MUSIC_FEATURES_STFT_CSV_TEST_PATH, AuFileProcessingAlgorithm::STFT);
     RandomForest random_forest_model_stft = {};
-    // Create a random forest from csv files
-    LOG(LOG_INFO) << "Creating a Random Forest from all csv files in the following dir " << RANDOM_FOREST_TREES_FOLDER_PATH_STFT << " ...";
-    random_forest_model_stft.fill_from_csv(RANDOM_FOREST_TREES_FOLDER_PATH_STFT);
+    // Create a random forest from csv files, the tree files are parsed in parallel
+    auto thread_pool = std::make_shared<ThreadPool>();
+    // Reference pool of the parallel predictions scaling
+    ThreadPool single_thread_pool(1);
+    random_forest_model_stft.set_thread_pool(thread_pool);
+    LOG(LOG_INFO) << "Creating a Random Forest from all csv files in the following dir " << RANDOM_FOREST_TREES_FOLDER_PATH_STFT << " on " << thread_pool->get_number_of_threads() << " threads ...";
+    load_model_from_csv(random_forest_model_stft, RANDOM_FOREST_TREES_FOLDER_PATH_STFT);
+    LOG(LOG_INFO) << "Model arena: " << random_forest_model_stft.get_arena();
     LOG(LOG_DEBUG) << "random forest (" << random_forest_model_stft.get_number_of_trees() << " trees): " << random_forest_model_stft;
 
     // Predict and test prediction results
@@ -26,15 +32,54 @@ int main() {
     LOG(LOG_INFO) << "Model accuracy: "<< prediction_accuracy_stft;
     show_confusion_matrix(predictions_stft);
 
+    // Predict again sharing the features vectors between the threads, the forest is const and each thread has its own context
+    auto parallel_predictions_stft = make_predictions(random_forest_model_stft, fvs_stft, thread_pool.get());
+    LOG(LOG_INFO) << "Model accuracy (parallel): " << predictions_report(parallel_predictions_stft) << ", " << (parallel_predictions_stft == predictions_stft ? "identical predictions" : "PREDICTIONS DIFFER");
+    const real_t single_thread_time_stft = benchmark_parallel_predictions(random_forest_model_stft, fvs_stft, single_thread_pool, 20);
+    const real_t parallel_time_stft = benchmark_parallel_predictions(random_forest_model_stft, fvs_stft, *thread_pool, 20);
+    LOG(LOG_INFO) << "Prediction time: " << single_thread_time_stft << "µs on 1 thread versus " << parallel_time_stft << "µs on " << thread_pool->get_number_of_threads() << " threads (speedup x" << single_thread_time_stft / parallel_time_stft << ")";
+
+    // Predict again using the tree-major batch layout
+    auto batch_predictions_stft = make_batch_predictions(random_forest_model_stft, fvs_stft);
+    LOG(LOG_INFO) << "Model accuracy (batch): "<< predictions_report(batch_predictions_stft);
+
+    // Quantize the forest thresholds and predict again using the compact nodes
+    QuantizedRandomForest quantized_random_forest_model_stft = {};
+    quantized_random_forest_model_stft.quantize(random_forest_model_stft);
+    LOG(LOG_INFO) << "Random forest footprint: " << random_forest_model_stft.get_memory_footprint() << "B, quantized random forest: " << quantized_random_forest_model_stft;
+    auto quantized_predictions_stft = make_batch_predictions(quantized_random_forest_model_stft, fvs_stft);
+    LOG(LOG_INFO) << "Model accuracy (quantized): "<< predictions_report(quantized_predictions_stft);
+
+    // Merge the identical subtrees of the quantized forest and predict again using the shared nodes
+    std::vector<real_vector_t> batch_stft;
+    std::transform(fvs_stft.cbegin(), fvs_stft.cend(), std::back_inserter(batch_stft), [](const std::pair<std::string, real_vector_t> &pair) { return pair.second; });
+    std::size_t working_set_stft = quantized_random_forest_model_stft.get_working_set(batch_stft);
+    quantized_random_forest_model_stft.compress();
+    LOG(LOG_INFO) << "Compressed random forest: " << quantized_random_forest_model_stft << ", nodes working set on the test set: " << working_set_stft << "B -> " << quantized_random_forest_model_stft.get_working_set(batch_stft) << "B";
+    auto compressed_predictions_stft = make_batch_predictions(quantized_random_forest_model_stft, fvs_stft);
+    LOG(LOG_INFO) << "Model accuracy (compressed): "<< predictions_report(compressed_predictions_stft);
+
+    // Predict again stopping once the majority is decided, with the most accurate trees on the train set first
+    random_forest_model_stft.sort_trees_by_accuracy(get_features_vectors_from_csv(MUSIC_FEATURES_STFT_CSV_TRAIN_PATH, AuFileProcessingAlgorithm::STFT));
+    random_forest_model_stft.set_early_termination(true);
+    auto early_termination_predictions_stft = make_predictions(random_forest_model_stft, fvs_stft);
+    RandomForestPredictionStats prediction_stats_stft = {};
+    for (const std::pair<std::string, real_vector_t> &pair: fvs_stft) {
+        random_forest_model_stft.predict_class_id(pair.second, prediction_stats_stft);
+    }
+    LOG(LOG_INFO) << "Model accuracy (early termination): " << predictions_report(early_termination_predictions_stft) << ", average number of evaluated trees: " << prediction_stats_stft.get_average_number_of_evaluated_trees() << "/" << random_forest_model_stft.get_number_of_trees();
+
 
     LOG(LOG_INFO) << "------------ Testing Decision Tree using MFCC algorithm ------------";
     // Get features from csv file
     LOG(LOG_INFO) << "Getting features vectors from the csv file " << absolute(MUSIC_FEATURES_MFCC_CSV_TEST_PATH) << " ...";
     auto fvs_mfcc = get_features_vectors_from_csv(MUSIC_FEATURES_MFCC_CSV_TEST_PATH, AuFileProcessingAlgorithm::MFCC);
     RandomForest random_forest_model_mfcc = {};
-    // Create a tree from csv file
-    LOG(LOG_INFO) << "Creating a Random Forest from all csv files in the following dir " << RANDOM_FOREST_TREES_FOLDER_PATH_MFCC << " ...";
-    random_forest_model_mfcc.fill_from_csv(RANDOM_FOREST_TREES_FOLDER_PATH_MFCC);
+    // Create a random forest from csv files, the tree files are parsed in parallel
+    random_forest_model_mfcc.set_thread_pool(thread_pool);
+    LOG(LOG_INFO) << "Creating a Random Forest from all csv files in the following dir " << RANDOM_FOREST_TREES_FOLDER_PATH_MFCC << " on " << thread_pool->get_number_of_threads() << " threads ...";
+    load_model_from_csv(random_forest_model_mfcc, RANDOM_FOREST_TREES_FOLDER_PATH_MFCC);
+    LOG(LOG_INFO) << "Model arena: " << random_forest_model_mfcc.get_arena();
     LOG(LOG_DEBUG) << "random forest (" << random_forest_model_mfcc.get_number_of_trees() << " trees): " << random_forest_model_mfcc;
 
     // Predict and test prediction results
@@ -43,5 +88,42 @@ int main() {
     LOG(LOG_INFO) << "Model accuracy: "<< prediction_accuracy_mfcc;
     show_confusion_matrix(predictions_mfcc);
 
+    // Predict again sharing the features vectors between the threads, the forest is const and each thread has its own context
+    auto parallel_predictions_mfcc = make_predictions(random_forest_model_mfcc, fvs_mfcc, thread_pool.get());
+    LOG(LOG_INFO) << "Model accuracy (parallel): " << predictions_report(parallel_predictions_mfcc) << ", " << (parallel_predictions_mfcc == predictions_mfcc ? "identical predictions" : "PREDICTIONS DIFFER");
+    const real_t single_thread_time_mfcc = benchmark_parallel_predictions(random_forest_model_mfcc, fvs_mfcc, single_thread_pool, 20);
+    const real_t parallel_time_mfcc = benchmark_parallel_predictions(random_forest_model_mfcc, fvs_mfcc, *thread_pool, 20);
+    LOG(LOG_INFO) << "Prediction time: " << single_thread_time_mfcc << "µs on 1 thread versus " << parallel_time_mfcc << "µs on " << thread_pool->get_number_of_threads() << " threads (speedup x" << single_thread_time_mfcc / parallel_time_mfcc << ")";
+
+    // Predict again using the tree-major batch layout
+    auto batch_predictions_mfcc = make_batch_predictions(random_forest_model_mfcc, fvs_mfcc);
+    LOG(LOG_INFO) << "Model accuracy (batch): "<< predictions_report(batch_predictions_mfcc);
+
+    // Quantize the forest thresholds and predict again using the compact nodes
+    QuantizedRandomForest quantized_random_forest_model_mfcc = {};
+    quantized_random_forest_model_mfcc.quantize(random_forest_model_mfcc);
+    LOG(LOG_INFO) << "Random forest footprint: " << random_forest_model_mfcc.get_memory_footprint() << "B, quantized random forest: " << quantized_random_forest_model_mfcc;
+    auto quantized_predictions_mfcc = make_batch_predictions(quantized_random_forest_model_mfcc, fvs_mfcc);
+    LOG(LOG_INFO) << "Model accuracy (quantized): "<< predictions_report(quantized_predictions_mfcc);
+
+    // Merge the identical subtrees of the quantized forest and predict again using the shared nodes
+    std::vector<real_vector_t> batch_mfcc;
+    std::transform(fvs_mfcc.cbegin(), fvs_mfcc.cend(), std::back_inserter(batch_mfcc), [](const std::pair<std::string, real_vector_t> &pair) { return pair.second; });
+    std::size_t working_set_mfcc = quantized_random_forest_model_mfcc.get_working_set(batch_mfcc);
+    quantized_random_forest_model_mfcc.compress();
+    LOG(LOG_INFO) << "Compressed random forest: " << quantized_random_forest_model_mfcc << ", nodes working set on the test set: " << working_set_mfcc << "B -> " << quantized_random_forest_model_mfcc.get_working_set(batch_mfcc) << "B";
+    auto compressed_predictions_mfcc = make_batch_predictions(quantized_random_forest_model_mfcc, fvs_mfcc);
+    LOG(LOG_INFO) << "Model accuracy (compressed): "<< predictions_report(compressed_predictions_mfcc);
+
+    // Predict again stopping once the majority is decided, with the most accurate trees on the train set first
+    random_forest_model_mfcc.sort_trees_by_accuracy(get_features_vectors_from_csv(MUSIC_FEATURES_MFCC_CSV_TRAIN_PATH, AuFileProcessingAlgorithm::MFCC));
+    random_forest_model_mfcc.set_early_termination(true);
+    auto early_termination_predictions_mfcc = make_predictions(random_forest_model_mfcc, fvs_mfcc);
+    RandomForestPredictionStats prediction_stats_mfcc = {};
+    for (const std::pair<std::string, real_vector_t> &pair: fvs_mfcc) {
+        random_forest_model_mfcc.predict_class_id(pair.second, prediction_stats_mfcc);
+    }
+    LOG(LOG_INFO) << "Model accuracy (early termination): " << predictions_report(early_termination_predictions_mfcc) << ", average number of evaluated trees: " << prediction_stats_mfcc.get_average_number_of_evaluated_trees() << "/" << random_forest_model_mfcc.get_number_of_trees();
+
     return 0;
 }
@@ -28,7 +28,8 @@ AuFileProcessor::AuFileProcessor(const std::filesystem::path &file_path) : file_
     this->channels = 0;
     this->features_average = {};
     this->features_standard_deviation = {};
-
+    this->required_features = {};
+    this->normalization_frame_stride = 1;
 }
 
 AuFileProcessor::AuFileProcessor(const std::filesystem::path &file_path, AuFileProcessingAlgorithm processing_algorithm) : file_path(file_path), processing_algorithm(processing_algorithm) {
@@ -50,6 +51,8 @@ AuFileProcessor::AuFileProcessor(const std::filesystem::path &file_path, AuFileP
     this->channels = 0;
     this->features_average = {};
     this->features_standard_deviation = {};
+    this->required_features = {};
+    this->normalization_frame_stride = 1;
 }
 
 const std::filesystem::path &AuFileProcessor::get_file_path() const {
@@ -104,6 +107,31 @@ const real_vector_t &AuFileProcessor::get_features_standard_deviation() const {
     return features_standard_deviation;
 }
 
+const std::vector<std::size_t> &AuFileProcessor::get_required_features() const {
+    return required_features;
+}
+
+std::size_t AuFileProcessor::get_normalization_frame_stride() const {
+    return normalization_frame_stride;
+}
+
+void AuFileProcessor::set_required_features(const std::vector<std::size_t> &required_features, std::size_t normalization_frame_stride) {
+    if (normalization_frame_stride == 0) {
+        LOG(LOG_ERROR) << "Error : the normalization frame stride must be at least 1";
+        throw std::invalid_argument("Bad required features!");
+    }
+    for (std::size_t feature_id: required_features) {
+        if (feature_id >= FFT_SIZE * 2) {
+            LOG(LOG_ERROR) << "Error : the required feature " << feature_id << " is not one of the " << FFT_SIZE * 2 << " STFT features";
+            throw std::invalid_argument("Bad required features!");
+        }
+    }
+    this->required_features = required_features;
+    std::sort(this->required_features.begin(), this->required_features.end());
+    this->required_features.erase(std::unique(this->required_features.begin(), this->required_features.end()), this->required_features.end());
+    this->normalization_frame_stride = normalization_frame_stride;
+}
+
 std::ostream &operator<<(std::ostream &os, const AuFileProcessor &au_file_processor) {
     char magic_str[5] = {
             (char) ((au_file_processor.magic_number & 0xFF000000) >> 24u),
@@ -218,13 +246,23 @@ std::string AuFileProcessor::get_csv_line_header(AuFileProcessingAlgorithm proce
 
 void AuFileProcessor::apply_processing_algorithm() {
     // Apply process algorithm
+    std::pair<real_t, real_t> normalization_statistics;
     switch (this->processing_algorithm) {
         case AuFileProcessingAlgorithm::STFT: {
-            apply_stft();
+            // A stride of 1 or too many bins for the Goertzel algorithm need the FFT of every frame, the full extraction is as
+            // fast and its normalization statistics are exact. At least 3 frames are needed to estimate them on 2 strided frames
+            const std::vector<std::size_t> bins = this->get_required_bins();
+            if (!bins.empty() && bins.size() <= AuFileProcessor::GOERTZEL_MAX_BINS && this->normalization_frame_stride > 1 && raw_data.size() / N >= 3) {
+                normalization_statistics = apply_lazy_stft(bins);
+            } else {
+                apply_stft();
+                normalization_statistics = get_normalization_statistics(this->features_average, this->features_standard_deviation);
+            }
             break;
         }
         case AuFileProcessingAlgorithm::MFCC: {
             apply_mfcc();
+            normalization_statistics = get_normalization_statistics(this->features_average, this->features_standard_deviation);
             break;
         }
         default: {
@@ -235,7 +273,7 @@ void AuFileProcessor::apply_processing_algorithm() {
     }
 
     // Normalize features
-    this->normalize_features();
+    this->normalize_features(normalization_statistics.first, normalization_statistics.second);
 }
 
 /* PRIVATE DEFINITION */
@@ -331,6 +369,95 @@ void AuFileProcessor::apply_stft() {
     std::transform(stdv.begin(), stdv.end(), std::back_inserter(this->features_standard_deviation), [size](real_t c) { return std::sqrt(c / (size - 1)); });
 }
 
+std::pair<real_t, real_t> AuFileProcessor::apply_lazy_stft(const std::vector<std::size_t> &bins) {
+    // Create hamming window
+    real_n_array_t h_window = hamming_window();
+    const real_vector_t coefficients = goertzel_coefficients(bins);
+
+    // A stride reaching the number of frames would leave a single frame to estimate the standard deviations
+    const std::size_t number_of_frames = raw_data.size() / N;
+    const std::size_t stride = std::min(this->normalization_frame_stride, number_of_frames - 1);
+
+    // Same running mean and variance as apply_stft, of the required bins on every frame and of all the bins on the strided frames
+    auto accumulate = [](real_t x1, real_t x2, real_t size, real_t &mean, real_t &stdv) {
+        real_t mean_prev = mean;
+        mean += (x1 - mean) / size;
+        stdv += (x1 - mean) * (x1 - mean_prev);
+        mean_prev = mean;
+        mean += (x2 - mean) / size;
+        stdv += (x2 - mean) * (x2 - mean_prev);
+    };
+    real_t size = 0;
+    real_vector_t mean(bins.size(), 0);
+    real_vector_t stdv(bins.size(), 0);
+    real_t estimation_size = 0;
+    real_fft_array_t estimation_mean = {};
+    real_fft_array_t estimation_stdv = {};
+    real_vector_t x1(bins.size(), 0);
+    real_vector_t x2(bins.size(), 0);
+
+    for (std::size_t k = 0; k < number_of_frames; k++) {
+        // The second frame overlaps the next block, zero-padded after the end of the raw data
+        const auto v2_end = raw_data.cbegin() + (long) std::min(k * N + N + N / 2, raw_data.size());
+        if (k % stride == 0) {
+            complex_n_array_t v1;
+            complex_n_array_t v2 = {};
+            std::copy(raw_data.cbegin() + k * N, raw_data.cbegin() + k * N + N, v1.begin());
+            std::copy(raw_data.cbegin() + k * N + N / 2, v2_end, v2.begin());
+            windowing(h_window, v1);
+            windowing(h_window, v2);
+            ite_dit_fft(v1);
+            ite_dit_fft(v2);
+
+            estimation_size++;
+            for (std::size_t iter = 0; iter < FFT_SIZE; iter++) {
+                accumulate(std::abs(v1.at(iter)), std::abs(v2.at(iter)), estimation_size, estimation_mean.at(iter), estimation_stdv.at(iter));
+            }
+            for (std::size_t bin_i = 0; bin_i < bins.size(); bin_i++) {
+                x1[bin_i] = std::abs(v1.at(bins[bin_i]));
+                x2[bin_i] = std::abs(v2.at(bins[bin_i]));
+            }
+        } else {
+            real_n_array_t f1;
+            real_n_array_t f2 = {};
+            std::copy(raw_data.cbegin() + k * N, raw_data.cbegin() + k * N + N, f1.begin());
+            std::copy(raw_data.cbegin() + k * N + N / 2, v2_end, f2.begin());
+            std::transform(f1.cbegin(), f1.cend(), h_window.cbegin(), f1.begin(), std::multiplies<>());
+            std::transform(f2.cbegin(), f2.cend(), h_window.cbegin(), f2.begin(), std::multiplies<>());
+            goertzel_magnitudes(f1, coefficients, x1.data());
+            goertzel_magnitudes(f2, coefficients, x2.data());
+        }
+
+        size++;
+        for (std::size_t bin_i = 0; bin_i < bins.size(); bin_i++) {
+            accumulate(x1[bin_i], x2[bin_i], size, mean[bin_i], stdv[bin_i]);
+        }
+    }
+
+    // The statistics are estimated on the strided frames, the required bins keep their values over all the frames
+    this->features_average.clear();
+    std::move(estimation_mean.cbegin(), estimation_mean.cend(), std::back_inserter(this->features_average));
+    this->features_standard_deviation.clear();
+    std::transform(estimation_stdv.begin(), estimation_stdv.end(), std::back_inserter(this->features_standard_deviation), [estimation_size](real_t c) { return std::sqrt(c / (estimation_size - 1)); });
+    const std::pair<real_t, real_t> normalization_statistics = get_normalization_statistics(this->features_average, this->features_standard_deviation);
+    for (std::size_t bin_i = 0; bin_i < bins.size(); bin_i++) {
+        this->features_average[bins[bin_i]] = mean[bin_i];
+        this->features_standard_deviation[bins[bin_i]] = std::sqrt(stdv[bin_i] / (size - 1));
+    }
+
+    return normalization_statistics;
+}
+
+std::vector<std::size_t> AuFileProcessor::get_required_bins() const {
+    std::vector<std::size_t> bins;
+    for (std::size_t feature_id: this->required_features) {
+        bins.push_back(feature_id % FFT_SIZE);
+    }
+    std::sort(bins.begin(), bins.end());
+    bins.erase(std::unique(bins.begin(), bins.end()), bins.end());
+    return bins;
+}
+
 void AuFileProcessor::apply_mfcc() {
     // Create bank of filter
     std::array<real_fft_array_t, MEL_N> filter_bank_t = mfcc_filters();
@@ -416,29 +543,33 @@ void AuFileProcessor::apply_mfcc() {
     std::transform(stdv.begin(), stdv.end(), std::back_inserter(this->features_standard_deviation), [size](real_t c) { return std::sqrt(c / (size - 1)); });
 }
 
-void AuFileProcessor::normalize_features() {
-    real_t features_size = (real_t) (this->features_average.size() + this->features_standard_deviation.size());
+std::pair<real_t, real_t> AuFileProcessor::get_normalization_statistics(const real_vector_t &features_average, const real_vector_t &features_standard_deviation) {
+    real_t features_size = (real_t) (features_average.size() + features_standard_deviation.size());
 
     // Compute features vector mean
     real_t sum = 0;
-    std::for_each(std::execution::seq, this->features_average.cbegin(), this->features_average.cend(), [&sum](real_t x) mutable {
+    std::for_each(std::execution::seq, features_average.cbegin(), features_average.cend(), [&sum](real_t x) mutable {
         sum += x;
     });
-    std::for_each(std::execution::seq, this->features_standard_deviation.cbegin(), this->features_standard_deviation.cend(), [&sum](real_t x) mutable {
+    std::for_each(std::execution::seq, features_standard_deviation.cbegin(), features_standard_deviation.cend(), [&sum](real_t x) mutable {
         sum += x;
     });
     real_t mean = sum / features_size;
 
     // Compute features vector standard deviation
     sum = 0;
-    std::for_each(std::execution::seq, this->features_average.cbegin(), this->features_average.cend(), [&mean, &sum](real_t x) mutable {
+    std::for_each(std::execution::seq, features_average.cbegin(), features_average.cend(), [&mean, &sum](real_t x) mutable {
         sum += std::pow(x - mean, 2);
     });
-    std::for_each(std::execution::seq, this->features_standard_deviation.cbegin(), this->features_standard_deviation.cend(), [&mean, &sum](real_t x) mutable {
+    std::for_each(std::execution::seq, features_standard_deviation.cbegin(), features_standard_deviation.cend(), [&mean, &sum](real_t x) mutable {
         sum += std::pow(x - mean, 2);
     });
     real_t stdev = std::sqrt(sum / features_size);
 
+    return {mean, stdev};
+}
+
+void AuFileProcessor::normalize_features(real_t mean, real_t stdev) {
     // Normalize features_average
     std::transform(std::execution::seq, features_average.cbegin(), features_average.cend(), features_average.begin(), [&mean, &stdev](real_t x) {
         return (x - mean) / stdev;
@@ -154,6 +154,34 @@ public:
      */
     const real_vector_t &get_features_standard_deviation() const;
 
+    /**
+     * @brief           Get the features the STFT extraction is restricted to.
+     *
+     * @returns         the required_features class variable value, empty when all the features are required.
+     */
+    const std::vector<std::size_t> &get_required_features() const;
+
+    /**
+     * @brief           Get the stride of the frames estimating the normalization statistics of a restricted STFT extraction.
+     *
+     * @returns         the normalization_frame_stride class variable value.
+     */
+    std::size_t get_normalization_frame_stride() const;
+
+    /**
+     * @brief           Restrict the STFT extraction to the features used by a model (see MachineLearningModel::get_used_features).
+     * @details         When the required features use at most GOERTZEL_MAX_BINS bins, these bins are computed on every frame with the Goertzel algorithm, so their values are the ones of the full extraction.
+     *                  The normalization uses the mean and standard deviation of all the features, they are estimated with the whole spectrum of one frame every normalization_frame_stride frames (at least 2 frames of the file). The features which are not required get these estimations.
+     *                  With more bins, the FFT of every frame is needed anyway and the extraction stays the full one, with exact normalization statistics. The same goes for a stride of 1.
+     *                  The MFCC coefficients each depend on the whole spectrum, the MFCC extraction ignores the restriction.
+     * @param[in]       required_features the ids of the required features (the BIN_AVG ids then the BIN_STDEV ids), empty to require all of them
+     * @param[in]       normalization_frame_stride the stride of the frames estimating the normalization statistics
+     *
+     * @trhow           <std::invalid_argument("Bad required features!")> Throw an exception if a feature id is not a STFT feature or the stride is 0
+     * @returns         void
+     */
+    void set_required_features(const std::vector<std::size_t> &required_features, std::size_t normalization_frame_stride);
+
     /**
      * @brief           Overload the << operator for the AuFileProcessor object.
      *
@@ -204,6 +232,11 @@ private:
      * Variable that store the .au file path.
      */
     std::filesystem::path file_path;
+    /**
+     * Constant that store the largest number of required bins computed with the Goertzel algorithm, with more the full extraction is used.
+     * The Goertzel filters of 8 bins run together in about 1/8 of the time of the FFT of a frame, they break even around 64 bins.
+     */
+    static constexpr std::size_t GOERTZEL_MAX_BINS = 48;
     /**
      * Constant that store the .au file default process algorithm (STFT)
      */
@@ -217,6 +250,14 @@ private:
      * This value is obtained through the parsing of the file name and is done the object Constructor.
      */
     std::string music_style;
+    /**
+     * Variable that store the ids of the features the STFT extraction is restricted to, sorted, empty when all the features are required.
+     */
+    std::vector<std::size_t> required_features;
+    /**
+     * Variable that store the stride of the frames estimating the normalization statistics of a restricted STFT extraction.
+     */
+    std::size_t normalization_frame_stride;
 
     /**
      * Variable that store the .au file magic number.
@@ -314,6 +355,24 @@ private:
      */
     void apply_stft();
 
+    /**
+     * @brief           Apply the stft restricted to the required features and estimate the normalization statistics.
+     * @details         The frames are the ones of apply_stft. The bins of the required features are accumulated on every frame and all the bins on one frame every normalization_frame_stride frames, whose whole spectrum is computed with the FFT.
+     *                  On the other frames, only the required bins are computed, with the Goertzel algorithm. A frame ending after the raw data is zero-padded.
+     *                  The stride is clamped so at least 2 frames estimate the statistics.
+     *
+     * @param[in]       bins the bins of the required features, at most GOERTZEL_MAX_BINS
+     * @returns         the estimated mean and standard deviation of all the features
+     */
+    std::pair<real_t, real_t> apply_lazy_stft(const std::vector<std::size_t> &bins);
+
+    /**
+     * @brief           Get the bins of the required features, the average and standard deviation features of a bin share it.
+     *
+     * @returns         the sorted bins of the required features
+     */
+    std::vector<std::size_t> get_required_bins() const;
+
     /**
      * @brief           Apply the mfcc to the raw data and save the average and standard deviation to their corresponding class variables.
      * @details         The mfcc, like the stft, extract from the raw data 2 list of data block, one with a step size of N and one with a step size of N/2.
@@ -327,12 +386,23 @@ private:
      */
     void apply_mfcc();
 
+    /**
+     * @brief           Compute the mean and standard deviation of all the values of the features average and standard deviation vectors.
+     *
+     * @param[in]       features_average the features average vector
+     * @param[in]       features_standard_deviation the features standard deviation vector
+     * @returns         the mean and the standard deviation
+     */
+    static std::pair<real_t, real_t> get_normalization_statistics(const real_vector_t &features_average, const real_vector_t &features_standard_deviation);
+
     /**
      * @brief           Normalize the features_average and features_standard_deviation vectors using the formula: normalized_vector = (vector - mean) / stdev
      *
+     * @param[in]       mean the mean of the features
+     * @param[in]       stdev the standard deviation of the features
      *  @returns        void
      */
-     void normalize_features();
+     void normalize_features(real_t mean, real_t stdev);
 };
 
 #endif //AU_FILE_PROCESSOR
@@ -0,0 +1,85 @@
+#ifndef CLASS_DICTIONARY_H
+#define CLASS_DICTIONARY_H
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include "log.h"
+
+/*
+ * ClassDictionary class definition
+ */
+// Bidirectional mapping between the class names of a model and the small integer class ids used by its inference
+class ClassDictionary {
+public:
+    // Upper bound of the number of classes, so votes can be counted in fixed size arrays
+    static constexpr std::size_t MAX_NUMBER_OF_CLASSES = 64;
+
+    ClassDictionary() = default;
+
+    explicit ClassDictionary(const std::vector<std::string> &class_names) {
+        for (const std::string &class_name: class_names) {
+            this->add_class(class_name);
+        }
+    }
+
+    std::size_t size() const {
+        return class_names.size();
+    }
+
+    bool empty() const {
+        return class_names.empty();
+    }
+
+    const std::vector<std::string> &get_class_names() const {
+        return class_names;
+    }
+
+    const std::string &get_class_name(std::size_t class_id) const {
+        return class_names.at(class_id);
+    }
+
+    bool contains(const std::string &class_name) const {
+        return std::find(class_names.cbegin(), class_names.cend(), class_name) != class_names.cend();
+    }
+
+    std::size_t get_class_id(const std::string &class_name) const {
+        auto class_it = std::find(class_names.cbegin(), class_names.cend(), class_name);
+        if (class_it == class_names.cend()) {
+            LOG(LOG_ERROR) << "Error : the class " << class_name << " is not in the class dictionary";
+            throw std::invalid_argument("Unknown class name!");
+        }
+        return std::distance(class_names.cbegin(), class_it);
+    }
+
+    // Return the id of the class, adding it at the end of the dictionary if it is not known yet
+    std::size_t add_class(const std::string &class_name) {
+        auto class_it = std::find(class_names.cbegin(), class_names.cend(), class_name);
+        if (class_it != class_names.cend()) {
+            return std::distance(class_names.cbegin(), class_it);
+        }
+        if (class_names.size() == MAX_NUMBER_OF_CLASSES) {
+            LOG(LOG_ERROR) << "Error : trying to add the class " << class_name << " but the class dictionary already has " << MAX_NUMBER_OF_CLASSES << " classes";
+            throw std::length_error("Too many classes!");
+        }
+        class_names.push_back(class_name);
+        return class_names.size() - 1;
+    }
+
+    void clear() {
+        class_names.clear();
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const ClassDictionary &class_dictionary) {
+        for (std::size_t class_id = 0; class_id < class_dictionary.size(); class_id++) {
+            os << (class_id == 0 ? "" : ", ") << class_id << ": " << class_dictionary.get_class_name(class_id);
+        }
+        return os;
+    }
+
+private:
+    std::vector<std::string> class_names;
+};
+
+#endif //CLASS_DICTIONARY_H
@@ -6,8 +6,32 @@
 #include <map>
 #include <execution>
 #include "../ml_algorithms/machine_learning_model.h"
+#include "../helpers/class_dictionary.h"
 #include "../helpers/log.h"
 #include "../helpers/print_helpers.h"
+#include "../helpers/thread_pool.h"
+
+// Number of features vectors predicted by one task of a parallel prediction, large enough to amortize the task dispatch
+static constexpr std::size_t PARALLEL_PREDICTIONS_CHUNK_SIZE = 64;
+
+// predicted_class_ids[i] = model.predict_class_id(feature_vectors[i].second), the chunks of features vectors are shared by
+// the threads of the pool when there is one, each thread predicting with its own inference context
+static inline void predict_class_id_chunks(const MachineLearningModel &model, const std::vector<std::pair<std::string, real_vector_t>> &feature_vectors, std::size_t *predicted_class_ids, ThreadPool *thread_pool) {
+    const std::size_t number_of_chunks = (feature_vectors.size() + PARALLEL_PREDICTIONS_CHUNK_SIZE - 1) / PARALLEL_PREDICTIONS_CHUNK_SIZE;
+    auto predict_chunk = [&model, &feature_vectors, predicted_class_ids](std::size_t chunk_i) {
+        const std::size_t last = std::min((chunk_i + 1) * PARALLEL_PREDICTIONS_CHUNK_SIZE, feature_vectors.size());
+        for (std::size_t i = chunk_i * PARALLEL_PREDICTIONS_CHUNK_SIZE; i < last; i++) {
+            predicted_class_ids[i] = model.predict_class_id(feature_vectors[i].second);
+        }
+    };
+    if (thread_pool == nullptr) {
+        for (std::size_t chunk_i = 0; chunk_i < number_of_chunks; chunk_i++) {
+            predict_chunk(chunk_i);
+        }
+    } else {
+        thread_pool->parallel_for(number_of_chunks, predict_chunk);
+    }
+}
 
 // <true_label, predicted_label>
 static inline real_t predictions_report(const std::vector<std::pair<std::string, std::string>> &predictions) {
@@ -21,41 +45,49 @@ static inline real_t predictions_report(const std::vector<std::pair<std::string,
     return (real_t) good_predictions / (real_t) predictions.size();
 }
 
-// <true_label, predicted_label>
-static inline void show_confusion_matrix(const std::vector<std::pair<std::string, std::string>> &predictions) {
-    std::map<std::string, std::map<std::string, int>> confusion_matrix;
-    std::size_t longest_unique_label_size = 0;
-    std::set<std::string> unique_labels;
+// <true_class_id, predicted_class_id>
+using class_id_predictions_t = std::vector<std::pair<std::size_t, std::size_t>>;
 
-    // Find unique labels
-    std::for_each(std::execution::seq, predictions.cbegin(), predictions.cend(), [&unique_labels, &longest_unique_label_size](const std::pair<std::string, std::string> &pair) mutable {
-        if (!unique_labels.contains(pair.first)) {
-            unique_labels.insert(pair.first);
-            longest_unique_label_size = pair.first.size() > longest_unique_label_size ? pair.first.size() : longest_unique_label_size;
-        }
-        if (!unique_labels.contains(pair.second)) {
-            unique_labels.insert(pair.second);
-            longest_unique_label_size = pair.second.size() > longest_unique_label_size ? pair.second.size() : longest_unique_label_size;
+// <true_class_id, predicted_class_id>
+static inline real_t predictions_report(const class_id_predictions_t &predictions) {
+    std::size_t good_predictions = 0;
+    for (const std::pair<std::size_t, std::size_t> &pair: predictions) {
+        if (pair.first == pair.second) {
+            good_predictions += 1;
         }
-    });
+    }
 
-    // Generate empty 2D hashmap
-    std::for_each(std::execution::seq, unique_labels.cbegin(), unique_labels.cend(), [&confusion_matrix, &unique_labels](const std::string &label) mutable {
-        confusion_matrix.insert(std::make_pair(label, std::map<std::string, int>{}));
+    return (real_t) good_predictions / (real_t) predictions.size();
+}
 
-        std::transform(unique_labels.cbegin(), unique_labels.cend(),
-                       std::inserter(confusion_matrix.at(label), confusion_matrix.at(label).end()),
-                       [](const std::string &unique_label) { return std::make_pair(unique_label, 0); }
-        );
-    });
+// <true_class_id, predicted_class_id>, the class ids index the class dictionary
+static inline void show_confusion_matrix(const ClassDictionary &class_dictionary, const class_id_predictions_t &predictions) {
+    const std::size_t number_of_classes = class_dictionary.size();
+    // Dense 2D array, confusion_matrix[true_class_id * number_of_classes + predicted_class_id]
+    std::vector<int> confusion_matrix(number_of_classes * number_of_classes, 0);
+    std::vector<bool> used_classes(number_of_classes, false);
+    for (const std::pair<std::size_t, std::size_t> &pair: predictions) {
+        confusion_matrix[pair.first * number_of_classes + pair.second] += 1;
+        used_classes[pair.first] = true;
+        used_classes[pair.second] = true;
+    }
 
-    // Fill the 2D hashmap
-    std::for_each(std::execution::seq, predictions.cbegin(), predictions.cend(), [&confusion_matrix](const std::pair<std::string, std::string> &pair) mutable {
-        confusion_matrix.at(pair.first).at(pair.second) += 1;
+    // Show the labels used by the predictions in alphabetical order
+    std::vector<std::size_t> labels;
+    std::size_t longest_unique_label_size = 0;
+    for (std::size_t class_id = 0; class_id < number_of_classes; class_id++) {
+        if (used_classes[class_id]) {
+            labels.push_back(class_id);
+            longest_unique_label_size = std::max(longest_unique_label_size, class_dictionary.get_class_name(class_id).size());
+        }
+    }
+    std::sort(labels.begin(), labels.end(), [&class_dictionary](std::size_t class_id_1, std::size_t class_id_2) {
+        return class_dictionary.get_class_name(class_id_1) < class_dictionary.get_class_name(class_id_2);
     });
 
     std::cout << (std::string(longest_unique_label_size + 5, ' ') + "\t ");
-    for (std::string label: unique_labels) {
+    for (std::size_t class_id: labels) {
+        const std::string &label = class_dictionary.get_class_name(class_id);
         try {
             std::cout << (char) toupper(label.at(0));
             std::cout << label.at(1);
@@ -64,45 +96,168 @@ static inline void show_confusion_matrix(const std::vector<std::pair<std::string
         std::cout << "\t";
     }
     std::cout << std::endl;
-    for (const auto &confusion_matrix_line: confusion_matrix) {
-        int space_len = (int) longest_unique_label_size - (int) confusion_matrix_line.first.size();
+    for (std::size_t true_class_id: labels) {
+        const std::string &label = class_dictionary.get_class_name(true_class_id);
+        int space_len = (int) longest_unique_label_size - (int) label.size();
         try {
-            std::cout << "(" << (char) toupper(confusion_matrix_line.first.at(0));
-            std::cout << confusion_matrix_line.first.at(1);
+            std::cout << "(" << (char) toupper(label.at(0));
+            std::cout << label.at(1);
         } catch (std::out_of_range &e) {
         }
-        std::cout << ") " << confusion_matrix_line.first << std::string(space_len, ' ') << "\t[";
-        std::size_t i = 0;
-        for (const auto &confusion_matrix_line_i: confusion_matrix_line.second) {
-            if (i >= confusion_matrix_line.second.size() - 1) {
-                std::cout << (std::to_string(confusion_matrix_line_i.second));
-            } else {
-                std::cout << (std::to_string(confusion_matrix_line_i.second) + "\t");
-            }
-            i++;
+        std::cout << ") " << label << std::string(space_len, ' ') << "\t[";
+        for (std::size_t i = 0; i < labels.size(); i++) {
+            std::cout << std::to_string(confusion_matrix[true_class_id * number_of_classes + labels[i]]) << (i + 1 < labels.size() ? "\t" : "");
         }
         std::cout << "]" << std::endl;
     }
-
 }
 
 // <true_label, predicted_label>
-static inline std::vector<std::pair<std::string, std::string>> make_predictions(MachineLearningModel &model, const std::vector<std::pair<std::string, real_vector_t>> &feature_vectors) {
-    std::vector<std::pair<std::string, std::string>> predictions;
+static inline void show_confusion_matrix(const std::vector<std::pair<std::string, std::string>> &predictions) {
+    ClassDictionary class_dictionary;
+    class_id_predictions_t class_id_predictions;
+    class_id_predictions.reserve(predictions.size());
+    for (const std::pair<std::string, std::string> &pair: predictions) {
+        class_id_predictions.emplace_back(class_dictionary.add_class(pair.first), class_dictionary.add_class(pair.second));
+    }
+    show_confusion_matrix(class_dictionary, class_id_predictions);
+}
+
+// Fill the model from its CSV file or folder and log the load time, returns the load time in ms
+static inline real_t load_model_from_csv(MachineLearningModel &model, const std::filesystem::path &csv_path) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    model.fill_from_csv(csv_path);
+    auto stop_time = std::chrono::high_resolution_clock::now();
+    real_t elapsed_time = (real_t) std::chrono::duration_cast<std::chrono::microseconds>(stop_time - start_time).count() / 1000.0;
+    LOG(LOG_INFO) << "Model loaded in " << elapsed_time << "ms";
+    return elapsed_time;
+}
+
+// <true_class_id, predicted_class_id>, the class ids index the class dictionary of the model, extended with the true labels unknown to the model
+// The predictions are shared by the threads of the pool when there is one
+static inline class_id_predictions_t make_class_id_predictions(const MachineLearningModel &model, const std::vector<std::pair<std::string, real_vector_t>> &feature_vectors, ClassDictionary &class_dictionary, ThreadPool *thread_pool = nullptr) {
+    class_dictionary = model.get_class_dictionary();
+    std::vector<std::size_t> predicted_class_ids(feature_vectors.size(), 0);
 
     // Predict for all feature vectors
     auto start_time = std::chrono::high_resolution_clock::now();
-    LOG(LOG_INFO) << "Making " << feature_vectors.size() << " prediction using the machine learning model...";
-    std::for_each(std::execution::seq, feature_vectors.cbegin(), feature_vectors.cend(), [&predictions, &model](const std::pair<std::string, real_vector_t> &pair)mutable {
-        std::string predicted_class = model.predict_class(pair.second);
-        LOG(LOG_DEBUG) << "\ttrue class: " << pair.first << ", predicted class: " << predicted_class;
-        predictions.emplace_back(pair.first, predicted_class);
-    });
+    LOG(LOG_INFO) << "Making " << feature_vectors.size() << " prediction using the machine learning model" << (thread_pool != nullptr ? " on " + std::to_string(thread_pool->get_number_of_threads()) + " threads" : "") << "...";
+    predict_class_id_chunks(model, feature_vectors, predicted_class_ids.data(), thread_pool);
     auto stop_time = std::chrono::high_resolution_clock::now();
     auto elapsed_time = std::chrono::duration_cast<std::chrono::milliseconds>(stop_time - start_time).count();
     LOG(LOG_INFO) << "Prediction done in " << elapsed_time / 1000 << "s and " << elapsed_time % 1000 << "ms";
 
+    // Translate the true labels outside of the timed loop
+    class_id_predictions_t predictions;
+    predictions.reserve(feature_vectors.size());
+    for (std::size_t i = 0; i < feature_vectors.size(); i++) {
+        predictions.emplace_back(class_dictionary.add_class(feature_vectors[i].first), predicted_class_ids[i]);
+        LOG(LOG_DEBUG) << "\ttrue class: " << feature_vectors[i].first << ", predicted class: " << class_dictionary.get_class_name(predictions[i].second);
+    }
+
     return predictions;
 }
 
+// <true_label, predicted_label>, the predictions are shared by the threads of the pool when there is one
+static inline std::vector<std::pair<std::string, std::string>> make_predictions(const MachineLearningModel &model, const std::vector<std::pair<std::string, real_vector_t>> &feature_vectors, ThreadPool *thread_pool = nullptr) {
+    ClassDictionary class_dictionary;
+    class_id_predictions_t class_id_predictions = make_class_id_predictions(model, feature_vectors, class_dictionary, thread_pool);
+
+    std::vector<std::pair<std::string, std::string>> predictions;
+    predictions.reserve(class_id_predictions.size());
+    for (const std::pair<std::size_t, std::size_t> &pair: class_id_predictions) {
+        predictions.emplace_back(class_dictionary.get_class_name(pair.first), class_dictionary.get_class_name(pair.second));
+    }
+
+    return predictions;
+}
+
+// <true_label, predicted_label>
+static inline std::vector<std::pair<std::string, std::string>> make_batch_predictions(const MachineLearningModel &model, const std::vector<std::pair<std::string, real_vector_t>> &feature_vectors) {
+    std::vector<std::pair<std::string, std::string>> predictions;
+    std::vector<real_vector_t> batch;
+    batch.reserve(feature_vectors.size());
+    std::transform(feature_vectors.cbegin(), feature_vectors.cend(), std::back_inserter(batch), [](const std::pair<std::string, real_vector_t> &pair) {
+        return pair.second;
+    });
+
+    // Predict all feature vectors in a single batch
+    auto start_time = std::chrono::high_resolution_clock::now();
+    LOG(LOG_INFO) << "Making " << feature_vectors.size() << " batch prediction using the machine learning model...";
+    std::vector<std::size_t> predicted_class_ids = model.predict_class_ids(batch);
+    auto stop_time = std::chrono::high_resolution_clock::now();
+    auto elapsed_time = std::chrono::duration_cast<std::chrono::milliseconds>(stop_time - start_time).count();
+    LOG(LOG_INFO) << "Batch prediction done in " << elapsed_time / 1000 << "s and " << elapsed_time % 1000 << "ms";
+
+    const ClassDictionary &class_dictionary = model.get_class_dictionary();
+    for (std::size_t i = 0; i < feature_vectors.size(); i++) {
+        const std::string &predicted_class = class_dictionary.get_class_name(predicted_class_ids[i]);
+        LOG(LOG_DEBUG) << "\ttrue class: " << feature_vectors[i].first << ", predicted class: " << predicted_class;
+        predictions.emplace_back(feature_vectors[i].first, predicted_class);
+    }
+
+    return predictions;
+}
+
+// Best average prediction time in µs per features vector over the repetitions, the best run filters out the scheduler noise
+static inline real_t benchmark_predictions(const MachineLearningModel &model, const std::vector<std::pair<std::string, real_vector_t>> &feature_vectors, std::size_t repetitions) {
+    real_t best_elapsed_time = std::numeric_limits<real_t>::max();
+    std::size_t class_ids_sum = 0;
+    for (std::size_t repetition = 0; repetition < repetitions; repetition++) {
+        auto start_time = std::chrono::high_resolution_clock::now();
+        for (const std::pair<std::string, real_vector_t> &pair: feature_vectors) {
+            class_ids_sum += model.predict_class_id(pair.second);
+        }
+        auto stop_time = std::chrono::high_resolution_clock::now();
+        best_elapsed_time = std::min(best_elapsed_time, (real_t) std::chrono::duration_cast<std::chrono::nanoseconds>(stop_time - start_time).count());
+    }
+    LOG(LOG_DEBUG) << "class ids checksum: " << class_ids_sum;
+
+    return best_elapsed_time / 1000.0 / (real_t) feature_vectors.size();
+}
+
+// Best average batch prediction time in µs per features vector over the repetitions, the features vectors are predicted by batches of batch_size
+static inline real_t benchmark_batch_predictions(const MachineLearningModel &model, const std::vector<std::pair<std::string, real_vector_t>> &feature_vectors, std::size_t batch_size, std::size_t repetitions) {
+    std::vector<std::vector<real_vector_t>> batches;
+    for (std::size_t first = 0; first < feature_vectors.size(); first += batch_size) {
+        std::vector<real_vector_t> batch;
+        for (std::size_t i = first; i < std::min(first + batch_size, feature_vectors.size()); i++) {
+            batch.push_back(feature_vectors[i].second);
+        }
+        batches.push_back(batch);
+    }
+
+    real_t best_elapsed_time = std::numeric_limits<real_t>::max();
+    std::size_t class_ids_sum = 0;
+    for (std::size_t repetition = 0; repetition < repetitions; repetition++) {
+        auto start_time = std::chrono::high_resolution_clock::now();
+        for (const std::vector<real_vector_t> &batch: batches) {
+            std::vector<std::size_t> class_ids = model.predict_class_ids(batch);
+            class_ids_sum += class_ids.front();
+        }
+        auto stop_time = std::chrono::high_resolution_clock::now();
+        best_elapsed_time = std::min(best_elapsed_time, (real_t) std::chrono::duration_cast<std::chrono::nanoseconds>(stop_time - start_time).count());
+    }
+    LOG(LOG_DEBUG) << "class ids checksum: " << class_ids_sum;
+
+    return best_elapsed_time / 1000.0 / (real_t) feature_vectors.size();
+}
+
+// Best average wall time in µs per features vector of the predictions shared by the threads of the pool over the repetitions
+static inline real_t benchmark_parallel_predictions(const MachineLearningModel &model, const std::vector<std::pair<std::string, real_vector_t>> &feature_vectors, ThreadPool &thread_pool, std::size_t repetitions) {
+    std::vector<std::size_t> predicted_class_ids(feature_vectors.size(), 0);
+    real_t best_elapsed_time = std::numeric_limits<real_t>::max();
+    std::size_t class_ids_sum = 0;
+    for (std::size_t repetition = 0; repetition < repetitions; repetition++) {
+        auto start_time = std::chrono::high_resolution_clock::now();
+        predict_class_id_chunks(model, feature_vectors, predicted_class_ids.data(), &thread_pool);
+        auto stop_time = std::chrono::high_resolution_clock::now();
+        best_elapsed_time = std::min(best_elapsed_time, (real_t) std::chrono::duration_cast<std::chrono::nanoseconds>(stop_time - start_time).count());
+        class_ids_sum += predicted_class_ids.front();
+    }
+    LOG(LOG_DEBUG) << "class ids checksum: " << class_ids_sum;
+
+    return best_elapsed_time / 1000.0 / (real_t) feature_vectors.size();
+}
+
 #endif //CLASSIFICATION_HELPERS_H
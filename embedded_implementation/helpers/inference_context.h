@@ -0,0 +1,69 @@
+#ifndef INFERENCE_CONTEXT_H
+#define INFERENCE_CONTEXT_H
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "simd.h"
+
+/*
+ * InferenceContext class definition
+ */
+// Scratch buffers of a prediction (zero-padded features, activations, decision values...), owned by the caller so a const
+// model can be shared by threads predicting concurrently, each with its own context. A context can be reused by any model,
+// the buffers grow to the largest size asked and keep the values of the last prediction, the models clear what they read
+class InferenceContext {
+public:
+    static constexpr std::size_t NUMBER_OF_REAL_BUFFERS = 3;
+    static constexpr std::size_t NUMBER_OF_INT8_BUFFERS = 2;
+
+    InferenceContext() = default;
+
+    // Aligned buffer buffer_i holding at least size reals
+    real_t *get_real_buffer(std::size_t buffer_i, std::size_t size) {
+        aligned_real_vector_t &buffer = this->real_buffers[buffer_i];
+        if (buffer.size() < size) {
+            buffer.resize(size, 0);
+        }
+        return buffer.data();
+    }
+
+    // Aligned buffer buffer_i holding at least size int8
+    std::int8_t *get_int8_buffer(std::size_t buffer_i, std::size_t size) {
+        aligned_int8_vector_t &buffer = this->int8_buffers[buffer_i];
+        if (buffer.size() < size) {
+            buffer.resize(size, 0);
+        }
+        return buffer.data();
+    }
+
+    // Buffer holding at least size quantized features bins (std::uint8_t or std::uint16_t)
+    template<typename bin_t>
+    bin_t *get_bin_buffer(std::size_t size) {
+        std::vector<bin_t> *buffer;
+        if constexpr (std::is_same_v<bin_t, std::uint8_t>) {
+            buffer = &this->narrow_bins_buffer;
+        } else {
+            buffer = &this->wide_bins_buffer;
+        }
+        if (buffer->size() < size) {
+            buffer->resize(size, 0);
+        }
+        return buffer->data();
+    }
+
+    // Context of the calling thread, used by the predictions made without an explicit context
+    static InferenceContext &get_thread_context() {
+        thread_local InferenceContext thread_context;
+        return thread_context;
+    }
+
+private:
+    std::array<aligned_real_vector_t, NUMBER_OF_REAL_BUFFERS> real_buffers;
+    std::array<aligned_int8_vector_t, NUMBER_OF_INT8_BUFFERS> int8_buffers;
+    std::vector<std::uint8_t> narrow_bins_buffer;
+    std::vector<std::uint16_t> wide_bins_buffer;
+};
+
+#endif //INFERENCE_CONTEXT_H
@@ -0,0 +1,168 @@
+#ifndef INFERENCE_PROTOCOL_H
+#define INFERENCE_PROTOCOL_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "globals.h"
+#include "log.h"
+
+/*
+ * Binary protocol of INFERENCE_DAEMON over a Unix domain socket
+ */
+// Each message is a fixed 16 bytes header followed by payload_size bytes of payload, in the byte order of the machine since
+// both ends run on it. A connection can pipeline any number of requests, the responses carry the request id of the client and
+// may come back in another order than the requests (the requests of different models are batched separately)
+
+/**
+ * @brief List of the request types
+ */
+enum class InferenceRequestType : std::uint8_t {
+    FEATURES_VECTOR = 0, /** Payload: the features vector, one double per feature */
+    AU_FILE_PATH = 1, /** Payload: the path of a .au file whose features are extracted by the daemon */
+    MODEL_INFO = 2 /** No payload, the response payload is "<model name> <STFT|MFCC> <number of features>" then one class name per line */
+};
+
+/**
+ * @brief List of the response status
+ */
+enum class InferenceStatus : std::uint16_t {
+    OK = 0, /** class_id is the predicted class id */
+    UNKNOWN_MODEL = 1, /** The model id is not one of the daemon models */
+    BAD_REQUEST = 2, /** Unknown request type or features vector size different from the model one */
+    EXTRACTION_FAILED = 3 /** The .au file could not be read or processed */
+};
+
+struct InferenceRequestHeader {
+    char magic[4];
+    std::uint32_t request_id;
+    // Index of the model in the daemon command line
+    std::uint8_t model_id;
+    std::uint8_t type;
+    std::uint16_t reserved;
+    std::uint32_t payload_size;
+};
+
+struct InferenceResponseHeader {
+    char magic[4];
+    std::uint32_t request_id;
+    std::uint16_t status;
+    std::uint16_t class_id;
+    std::uint32_t payload_size;
+};
+
+static_assert(sizeof(InferenceRequestHeader) == 16 && sizeof(InferenceResponseHeader) == 16, "The protocol headers must have no padding");
+
+constexpr char INFERENCE_REQUEST_MAGIC[4] = {'E', 'M', 'L', 'Q'};
+constexpr char INFERENCE_RESPONSE_MAGIC[4] = {'E', 'M', 'L', 'R'};
+// Larger payloads are protocol errors, the largest features vector (STFT) takes 8KB
+constexpr std::uint32_t INFERENCE_MAX_PAYLOAD_SIZE = 1 << 16;
+
+// Write all the bytes, retrying on the short writes, returns false if the peer is gone
+static inline bool write_fully(int file_descriptor, const void *data, std::size_t size) {
+    const char *bytes = static_cast<const char *>(data);
+    while (size > 0) {
+        ssize_t written = send(file_descriptor, bytes, size, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        bytes += written;
+        size -= (std::size_t) written;
+    }
+    return true;
+}
+
+// Read exactly size bytes, returns false on end of stream or error
+static inline bool read_fully(int file_descriptor, void *data, std::size_t size) {
+    char *bytes = static_cast<char *>(data);
+    while (size > 0) {
+        ssize_t read_size = read(file_descriptor, bytes, size);
+        if (read_size < 0 && errno == EINTR) {
+            continue;
+        }
+        if (read_size <= 0) {
+            return false;
+        }
+        bytes += read_size;
+        size -= (std::size_t) read_size;
+    }
+    return true;
+}
+
+// Header and payload gathered by a single sendmsg, the writers of a connection shared by several threads hold a lock around it
+static inline bool write_message(int file_descriptor, const void *header, std::size_t header_size, const void *payload, std::size_t payload_size) {
+    iovec buffers[2] = {{const_cast<void *>(header), header_size}, {const_cast<void *>(payload), payload_size}};
+    msghdr message = {};
+    message.msg_iov = buffers;
+    message.msg_iovlen = 2;
+    ssize_t written;
+    do {
+        written = sendmsg(file_descriptor, &message, MSG_NOSIGNAL);
+    } while (written < 0 && errno == EINTR);
+    if (written < 0) {
+        return false;
+    }
+
+    // Finish a short write
+    const auto written_size = (std::size_t) written;
+    if (written_size < header_size) {
+        return write_fully(file_descriptor, static_cast<const char *>(header) + written_size, header_size - written_size) && write_fully(file_descriptor, payload, payload_size);
+    }
+    return write_fully(file_descriptor, static_cast<const char *>(payload) + (written_size - header_size), payload_size - (written_size - header_size));
+}
+
+// Address of the socket, the path must fit in sun_path
+static inline sockaddr_un get_unix_socket_address(const std::string &socket_path) {
+    sockaddr_un address = {};
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        LOG(LOG_ERROR) << "Error : the socket path " << socket_path << " is longer than " << sizeof(address.sun_path) - 1 << " characters";
+        throw std::invalid_argument("Socket path too long!");
+    }
+    address.sun_family = AF_UNIX;
+    std::copy(socket_path.cbegin(), socket_path.cend(), address.sun_path);
+    return address;
+}
+
+/*
+ * LatencyRecorder class definition
+ */
+// Latencies in µs of the requests of a period, the percentiles are computed when the period is reported
+class LatencyRecorder {
+public:
+    void record(real_t latency) {
+        this->latencies.push_back(latency);
+    }
+
+    std::size_t size() const {
+        return this->latencies.size();
+    }
+
+    // Nearest-rank percentile, 0 without any latency, reorders the latencies
+    real_t get_percentile(real_t percentile) {
+        if (this->latencies.empty()) {
+            return 0;
+        }
+        const std::size_t rank = std::min(this->latencies.size() - 1, (std::size_t) (percentile / 100.0 * (real_t) this->latencies.size()));
+        std::nth_element(this->latencies.begin(), this->latencies.begin() + (long) rank, this->latencies.end());
+        return this->latencies[rank];
+    }
+
+    void clear() {
+        this->latencies.clear();
+    }
+
+private:
+    std::vector<real_t> latencies;
+};
+
+#endif //INFERENCE_PROTOCOL_H
@@ -0,0 +1,117 @@
+#ifndef MODEL_ARENA_H
+#define MODEL_ARENA_H
+
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <ostream>
+
+/*
+ * ModelArena class definition
+ */
+// Bump allocator holding the nodes, weights and coefficients of a model in a few big blocks instead of one heap object each.
+// Deallocation is a no-op, the blocks are given back to the heap at once when the arena is destroyed, so replacing the
+// content of a model keeps the memory of the old content until then. Allocations are serialized so the trees of a forest
+// can be parsed in parallel in the same arena
+class ModelArena : public std::pmr::memory_resource {
+public:
+    explicit ModelArena(std::size_t initial_block_size = 16 * 1024) : blocks_resource(), buffer_resource(initial_block_size, &blocks_resource) {}
+
+    ModelArena(const ModelArena &) = delete;
+
+    ModelArena &operator=(const ModelArena &) = delete;
+
+    // Bytes handed out to the containers of the model
+    std::size_t get_allocated_bytes() const {
+        std::unique_lock<std::mutex> lock(mutex);
+        return allocated_bytes;
+    }
+
+    // Bytes of the blocks taken from the heap, the real footprint of the arena
+    std::size_t get_reserved_bytes() const {
+        std::unique_lock<std::mutex> lock(mutex);
+        return blocks_resource.reserved_bytes;
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const ModelArena &model_arena) {
+        return os << model_arena.get_allocated_bytes() << "B allocated in " << model_arena.get_reserved_bytes() << "B of arena blocks";
+    }
+
+private:
+    // Heap resource counting the bytes of the blocks of the arena
+    class BlocksResource : public std::pmr::memory_resource {
+    public:
+        std::size_t reserved_bytes = 0;
+
+    private:
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+            reserved_bytes += bytes;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void *pointer, std::size_t bytes, std::size_t alignment) override {
+            reserved_bytes -= bytes;
+            std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    mutable std::mutex mutex;
+    BlocksResource blocks_resource;
+    std::pmr::monotonic_buffer_resource buffer_resource;
+    std::size_t allocated_bytes = 0;
+
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+        std::unique_lock<std::mutex> lock(mutex);
+        allocated_bytes += bytes;
+        return buffer_resource.allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *, std::size_t, std::size_t) override {
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+    }
+};
+
+/*
+ * ModelArenaReference class definition
+ */
+// Shared ownership of the arena of a model, declared before the containers allocating from it. A copied model gets a new
+// arena, an assigned model keeps its own arena since its containers keep their allocator, and a moved model shares the
+// arena with the model it was moved from, so the arena lives as long as any container allocating from it
+class ModelArenaReference {
+public:
+    ModelArenaReference() : arena(std::make_shared<ModelArena>()) {}
+
+    explicit ModelArenaReference(std::shared_ptr<ModelArena> arena) : arena(arena ? std::move(arena) : std::make_shared<ModelArena>()) {}
+
+    ModelArenaReference(const ModelArenaReference &) : ModelArenaReference() {}
+
+    ModelArenaReference(ModelArenaReference &&model_arena_reference) noexcept: arena(model_arena_reference.arena) {}
+
+    ModelArenaReference &operator=(const ModelArenaReference &) {
+        return *this;
+    }
+
+    ModelArenaReference &operator=(ModelArenaReference &&) noexcept {
+        return *this;
+    }
+
+    ModelArena *get() const {
+        return arena.get();
+    }
+
+    const std::shared_ptr<ModelArena> &share() const {
+        return arena;
+    }
+
+private:
+    std::shared_ptr<ModelArena> arena;
+};
+
+#endif //MODEL_ARENA_H
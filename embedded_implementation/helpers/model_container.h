@@ -0,0 +1,320 @@
+#ifndef MODEL_CONTAINER_H
+#define MODEL_CONTAINER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "globals.h"
+#include "class_dictionary.h"
+#include "log.h"
+
+/**
+ * @brief List of the model types stored in a model container
+ */
+enum class ModelType : std::uint32_t {
+    DECISION_TREE = 0, /** One TREE_NODES section */
+    RANDOM_FOREST = 1, /** One TREE_NODES section per tree */
+    ONE_VS_ONE_SVM = 2, /** SVM_CLASS_IDS, SVM_COEFFICIENTS and SVM_INTERCEPTS sections */
+    ARTIFICIAL_NEURAL_NETWORK = 3 /** LAYER_SHAPE, LAYER_WEIGHTS and LAYER_BIASES sections for each layer */
+};
+
+/**
+ * @brief List of the section types of a model container
+ */
+enum class ModelSectionType : std::uint32_t {
+    CLASS_NAMES = 0, /** The class names, each one followed by a null character */
+    TREE_NODES = 1, /** BinaryTreeNode records, the class ids index the CLASS_NAMES section */
+    SVM_CLASS_IDS = 2, /** The lower and upper class ids of each classifier (2 std::uint32_t per classifier) */
+    SVM_COEFFICIENTS = 3, /** Row-major classifiers x features real_t matrix */
+    SVM_INTERCEPTS = 4, /** One real_t per classifier */
+    LAYER_SHAPE = 5, /** BinaryLayerShape record */
+    LAYER_WEIGHTS = 6, /** Row-major neurons x inputs real_t matrix */
+    LAYER_BIASES = 7, /** One real_t per neuron */
+    // Sections evaluated in place from a shared model segment, see shared_models.h
+    FEATURES_VECTOR_SIZE = 8, /** One std::uint32_t, the number of features of the model */
+    FLAT_TREE_NODES = 9, /** FlatTreeNode records of all the trees one after the other, the class ids index the CLASS_NAMES section */
+    TREE_ROOTS_ID = 10, /** Index of the root node of each tree (one std::uint32_t per tree) */
+    PADDED_SVM_COEFFICIENTS = 11, /** Row-major classifiers x simd_padded_size(features) real_t matrix, zero-padded */
+    PADDED_LAYER_WEIGHTS = 12 /** Row-major neurons x simd_padded_size(inputs) real_t matrix, zero-padded */
+};
+
+/*
+ * Model container records definition
+ */
+// Tree node with its class name replaced by an id of the CLASS_NAMES section
+struct BinaryTreeNode {
+    std::uint64_t node_id;
+    real_t threshold;
+    std::int32_t feature_id;
+    std::int32_t left_children_id;
+    std::int32_t right_children_id;
+    std::uint32_t class_id;
+};
+
+struct BinaryLayerShape {
+    std::uint32_t input_size;
+    std::uint32_t output_size;
+    std::uint32_t activation_function;
+};
+
+// File header, followed by number_of_sections ModelContainerSection then by the sections data
+struct ModelContainerHeader {
+    char magic[4];
+    std::uint32_t version;
+    // Written as 0x01020304 to detect a file written with another endianness
+    std::uint32_t byte_order;
+    std::uint32_t model_type;
+    std::uint32_t number_of_sections;
+    std::uint32_t real_size;
+};
+
+struct ModelContainerSection {
+    std::uint32_t type;
+    std::uint32_t element_size;
+    std::uint64_t offset;
+    std::uint64_t count;
+};
+
+/* CONSTANTS */
+constexpr char MODEL_CONTAINER_MAGIC[4] = {'E', 'M', 'L', 'M'};
+constexpr std::uint32_t MODEL_CONTAINER_VERSION = 1;
+constexpr std::uint32_t MODEL_CONTAINER_BYTE_ORDER = 0x01020304;
+// Every section starts on a cache line so a mapped real_t matrix can be read with aligned SIMD loads
+constexpr std::size_t MODEL_CONTAINER_ALIGNMENT = 64;
+const std::string MODEL_CONTAINER_EXTENSION = ".eml";
+
+/*
+ * ModelContainerWriter class definition
+ */
+// Build the sections of a model in memory then write the container in one go
+class ModelContainerWriter {
+public:
+    explicit ModelContainerWriter(ModelType model_type) : model_type(model_type) {}
+
+    template<typename T>
+    void add_section(ModelSectionType type, const T *data, std::size_t count) {
+        ModelContainerSection section = {};
+        section.type = (std::uint32_t) type;
+        section.element_size = sizeof(T);
+        section.count = count;
+        this->sections.push_back(section);
+        const char *bytes = reinterpret_cast<const char *>(data);
+        this->sections_data.emplace_back(bytes, bytes + count * sizeof(T));
+    }
+
+    void add_class_dictionary(const ClassDictionary &class_dictionary) {
+        std::vector<char> class_names;
+        for (const std::string &class_name: class_dictionary.get_class_names()) {
+            class_names.insert(class_names.end(), class_name.cbegin(), class_name.cend());
+            class_names.push_back('\0');
+        }
+        this->add_section(ModelSectionType::CLASS_NAMES, class_names.data(), class_names.size());
+    }
+
+    void write(const std::filesystem::path &file_path) {
+        std::ofstream output_file(file_path, std::ios::binary);
+        if (!output_file.is_open()) {
+            LOG(LOG_ERROR) << "Error : file with path " + file_path.string() + "  cannot be created.";
+            throw std::filesystem::filesystem_error("Can't create file!", std::make_error_code(std::errc::no_such_file_or_directory));
+        }
+        this->write(output_file);
+        if (!output_file.good()) {
+            LOG(LOG_ERROR) << "Error : writing the model container " << file_path << " failed";
+            throw std::filesystem::filesystem_error("Can't write file!", std::make_error_code(std::errc::io_error));
+        }
+    }
+
+    // Write the container at the current position of the stream, the section offsets are relative to that position
+    void write(std::ostream &output_file) {
+        const std::streamoff container_start = output_file.tellp();
+        ModelContainerHeader header = {};
+        std::memcpy(header.magic, MODEL_CONTAINER_MAGIC, sizeof(header.magic));
+        header.version = MODEL_CONTAINER_VERSION;
+        header.byte_order = MODEL_CONTAINER_BYTE_ORDER;
+        header.model_type = (std::uint32_t) this->model_type;
+        header.number_of_sections = (std::uint32_t) this->sections.size();
+        header.real_size = sizeof(real_t);
+        std::uint64_t offset = aligned_offset(sizeof(ModelContainerHeader) + this->sections.size() * sizeof(ModelContainerSection));
+        for (ModelContainerSection &section: this->sections) {
+            section.offset = offset;
+            offset = aligned_offset(offset + section.count * section.element_size);
+        }
+
+        output_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        output_file.write(reinterpret_cast<const char *>(this->sections.data()), (std::streamsize) (this->sections.size() * sizeof(ModelContainerSection)));
+        for (std::size_t section_i = 0; section_i < this->sections.size(); section_i++) {
+            // Zero padding up to the section offset
+            std::vector<char> padding(this->sections[section_i].offset - (std::uint64_t) (output_file.tellp() - container_start), 0);
+            output_file.write(padding.data(), (std::streamsize) padding.size());
+            output_file.write(this->sections_data[section_i].data(), (std::streamsize) this->sections_data[section_i].size());
+        }
+    }
+
+private:
+    ModelType model_type;
+    std::vector<ModelContainerSection> sections;
+    std::vector<std::vector<char>> sections_data;
+
+    static std::uint64_t aligned_offset(std::uint64_t offset) {
+        return ((offset + MODEL_CONTAINER_ALIGNMENT - 1) / MODEL_CONTAINER_ALIGNMENT) * MODEL_CONTAINER_ALIGNMENT;
+    }
+};
+
+/*
+ * MappedModelContainer class definition
+ */
+// Read-only memory mapping of a model container, the sections are typed views on the mapped file so nothing is parsed
+// or copied until a model reads them, and only the pages actually read are loaded from the disk
+class MappedModelContainer {
+public:
+    explicit MappedModelContainer(const std::filesystem::path &file_path) {
+        int file_descriptor = open(file_path.c_str(), O_RDONLY);
+        if (file_descriptor < 0) {
+            LOG(LOG_ERROR) << "Error : file with path " + file_path.string() + "  not found.";
+            throw std::filesystem::filesystem_error("Can't open file!", std::make_error_code(std::errc::no_such_file_or_directory));
+        }
+        struct stat file_stat = {};
+        if (fstat(file_descriptor, &file_stat) != 0 || (std::size_t) file_stat.st_size < sizeof(ModelContainerHeader)) {
+            close(file_descriptor);
+            LOG(LOG_ERROR) << "Error : the file " << file_path << " is too small to be a model container";
+            throw std::invalid_argument("Not a model container!");
+        }
+        this->size = (std::size_t) file_stat.st_size;
+        void *mapping = mmap(nullptr, this->size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+        // The mapping keeps its own reference on the file
+        close(file_descriptor);
+        if (mapping == MAP_FAILED) {
+            LOG(LOG_ERROR) << "Error : the file " << file_path << " cannot be mapped";
+            throw std::filesystem::filesystem_error("Can't map file!", std::make_error_code(std::errc::io_error));
+        }
+        this->data = static_cast<const char *>(mapping);
+        this->owns_mapping = true;
+        this->read_section_table(file_path.string());
+    }
+
+    // View on a container already in memory (a model of a shared model segment), the memory must outlive the view
+    MappedModelContainer(std::span<const char> container, const std::string &container_name) {
+        if (container.size() < sizeof(ModelContainerHeader)) {
+            LOG(LOG_ERROR) << "Error : " << container_name << " is too small to be a model container";
+            throw std::invalid_argument("Not a model container!");
+        }
+        this->data = container.data();
+        this->size = container.size();
+        this->read_section_table(container_name);
+    }
+
+    ~MappedModelContainer() {
+        this->unmap();
+    }
+
+    MappedModelContainer(const MappedModelContainer &) = delete;
+
+    MappedModelContainer &operator=(const MappedModelContainer &) = delete;
+
+    ModelType get_model_type() const {
+        return (ModelType) this->header.model_type;
+    }
+
+    std::size_t get_number_of_sections(ModelSectionType type) const {
+        return std::count_if(this->sections.cbegin(), this->sections.cend(), [type](const ModelContainerSection &section) {
+            return section.type == (std::uint32_t) type;
+        });
+    }
+
+    // View on the occurrence-th section of the given type (sections of the same type keep their writing order)
+    template<typename T>
+    std::span<const T> get_section(ModelSectionType type, std::size_t occurrence = 0) const {
+        for (const ModelContainerSection &section: this->sections) {
+            if (section.type != (std::uint32_t) type) {
+                continue;
+            }
+            if (occurrence > 0) {
+                occurrence--;
+                continue;
+            }
+            if (section.element_size != sizeof(T)) {
+                LOG(LOG_ERROR) << "Error : the section " << section.type << " holds elements of " << section.element_size << " bytes but " << sizeof(T) << " bytes elements are read";
+                throw std::invalid_argument("Section element size mismatch!");
+            }
+            return std::span<const T>(reinterpret_cast<const T *>(this->data + section.offset), section.count);
+        }
+        LOG(LOG_ERROR) << "Error : the model container does not have the section " << (std::uint32_t) type;
+        throw std::invalid_argument("Missing model container section!");
+    }
+
+    ClassDictionary get_class_dictionary() const {
+        ClassDictionary class_dictionary;
+        std::span<const char> class_names = this->get_section<char>(ModelSectionType::CLASS_NAMES);
+        auto name_begin = class_names.begin();
+        while (name_begin != class_names.end()) {
+            auto name_end = std::find(name_begin, class_names.end(), '\0');
+            class_dictionary.add_class(std::string(name_begin, name_end));
+            name_begin = name_end == class_names.end() ? name_end : name_end + 1;
+        }
+        return class_dictionary;
+    }
+
+    // Check the model type before a model reads the sections
+    void expect_model_type(ModelType model_type) const {
+        if (this->get_model_type() != model_type) {
+            LOG(LOG_ERROR) << "Error : the model container holds a model of type " << this->header.model_type << " but a model of type " << (std::uint32_t) model_type << " is loaded";
+            throw std::invalid_argument("Model type mismatch!");
+        }
+    }
+
+private:
+    const char *data = nullptr;
+    std::size_t size = 0;
+    // False for a view on memory owned by someone else
+    bool owns_mapping = false;
+    ModelContainerHeader header = {};
+    std::vector<ModelContainerSection> sections;
+
+    // Validate the header and the section table before any section is read
+    void read_section_table(const std::string &container_name) {
+        std::memcpy(&this->header, this->data, sizeof(ModelContainerHeader));
+        if (std::memcmp(this->header.magic, MODEL_CONTAINER_MAGIC, sizeof(this->header.magic)) != 0 || this->header.byte_order != MODEL_CONTAINER_BYTE_ORDER) {
+            this->unmap();
+            LOG(LOG_ERROR) << "Error : " << container_name << " is not a model container or was written with another endianness";
+            throw std::invalid_argument("Not a model container!");
+        }
+        if (this->header.version != MODEL_CONTAINER_VERSION || this->header.real_size != sizeof(real_t)) {
+            this->unmap();
+            LOG(LOG_ERROR) << "Error : the model container " << container_name << " has the version " << this->header.version << " with " << this->header.real_size << " bytes reals, version " << MODEL_CONTAINER_VERSION << " with " << sizeof(real_t) << " bytes reals is expected";
+            throw std::invalid_argument("Unsupported model container version!");
+        }
+        const std::size_t table_end = sizeof(ModelContainerHeader) + (std::size_t) this->header.number_of_sections * sizeof(ModelContainerSection);
+        if (table_end > this->size) {
+            this->unmap();
+            LOG(LOG_ERROR) << "Error : the model container " << container_name << " is truncated";
+            throw std::invalid_argument("Truncated model container!");
+        }
+        this->sections.resize(this->header.number_of_sections);
+        std::memcpy(this->sections.data(), this->data + sizeof(ModelContainerHeader), this->sections.size() * sizeof(ModelContainerSection));
+        for (const ModelContainerSection &section: this->sections) {
+            if (section.offset % MODEL_CONTAINER_ALIGNMENT != 0 || section.offset > this->size || section.count > (this->size - section.offset) / std::max((std::uint32_t) 1, section.element_size)) {
+                this->unmap();
+                LOG(LOG_ERROR) << "Error : a section of the model container " << container_name << " is out of the container";
+                throw std::invalid_argument("Truncated model container!");
+            }
+        }
+    }
+
+    void unmap() {
+        if (this->owns_mapping && this->data != nullptr) {
+            munmap(const_cast<char *>(this->data), this->size);
+            this->data = nullptr;
+        }
+    }
+};
+
+#endif //MODEL_CONTAINER_H
@@ -0,0 +1,285 @@
+#ifndef MODEL_HOLDER_H
+#define MODEL_HOLDER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include "log.h"
+
+/*
+ * EpochDomain class definition
+ */
+// Epoch based reclamation shared by all the model holders. A reader announces the global epoch in its slot for the time of
+// its read section, a writer swapping a model advances the epoch then frees the old model once every slot is either idle or
+// announces the new epoch: those readers started after the swap and can only see the new model. Readers only do atomic
+// loads and stores, they never wait for a writer
+class EpochDomain {
+public:
+    static constexpr std::size_t MAX_READER_THREADS = 256;
+
+    // Pin the calling thread to the current epoch while alive, the sections of a thread can be nested
+    class ReadSection {
+    public:
+        ReadSection() {
+            ThreadSlot &thread_slot = get_thread_slot();
+            if (thread_slot.nesting++ == 0) {
+                thread_slot.slot->epoch.store(global_epoch.load());
+            }
+        }
+
+        ~ReadSection() {
+            ThreadSlot &thread_slot = get_thread_slot();
+            if (--thread_slot.nesting == 0) {
+                thread_slot.slot->epoch.store(IDLE_EPOCH);
+            }
+        }
+
+        ReadSection(const ReadSection &) = delete;
+
+        ReadSection &operator=(const ReadSection &) = delete;
+    };
+
+    // Start a new epoch, returns it
+    static std::uint64_t advance() {
+        return global_epoch.fetch_add(1) + 1;
+    }
+
+    // True if the calling thread is in a read section, a thread must not wait for the readers from inside one
+    static bool in_read_section() {
+        return get_local_thread_slot().nesting > 0;
+    }
+
+    // Wait until no reader is still in a section started before the epoch, the calling thread must not be in a read section
+    static void synchronize(std::uint64_t epoch) {
+        if (in_read_section()) {
+            LOG(LOG_ERROR) << "Error : a thread in a read section would wait for itself forever";
+            throw std::logic_error("Synchronize from a read section!");
+        }
+        while (true) {
+            bool quiescent = true;
+            for (const ReaderSlot &slot: slots) {
+                std::uint64_t slot_epoch = slot.epoch.load();
+                quiescent &= slot_epoch == IDLE_EPOCH || slot_epoch >= epoch;
+            }
+            if (quiescent) {
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+
+private:
+    static constexpr std::uint64_t IDLE_EPOCH = 0;
+
+    // One cache line per slot so the readers do not share their lines, the atomics are value-initialized (IDLE_EPOCH, not claimed)
+    struct alignas(64) ReaderSlot {
+        std::atomic<std::uint64_t> epoch;
+        std::atomic<bool> claimed;
+    };
+
+    // Slot claimed by a thread at its first read section and released when the thread exits
+    struct ThreadSlot {
+        ReaderSlot *slot = nullptr;
+        std::size_t nesting = 0;
+
+        ~ThreadSlot() {
+            if (this->slot != nullptr) {
+                this->slot->claimed.store(false);
+            }
+        }
+    };
+
+    static inline std::array<ReaderSlot, MAX_READER_THREADS> slots;
+    static inline std::atomic<std::uint64_t> global_epoch = 1;
+
+    // The slot is only claimed by get_thread_slot, a writer which never reads does not use one
+    static ThreadSlot &get_local_thread_slot() {
+        thread_local ThreadSlot thread_slot;
+        return thread_slot;
+    }
+
+    static ThreadSlot &get_thread_slot() {
+        ThreadSlot &thread_slot = get_local_thread_slot();
+        if (thread_slot.slot == nullptr) {
+            for (ReaderSlot &slot: slots) {
+                bool claimed = false;
+                if (slot.claimed.compare_exchange_strong(claimed, true)) {
+                    thread_slot.slot = &slot;
+                    break;
+                }
+            }
+            if (thread_slot.slot == nullptr) {
+                LOG(LOG_ERROR) << "Error : more than " << MAX_READER_THREADS << " threads are reading models at the same time";
+                throw std::runtime_error("Too many reader threads!");
+            }
+        }
+        return thread_slot;
+    }
+};
+
+/*
+ * ModelHolder class definition
+ */
+// Current version of a model loaded from a file or folder. get() is lock-free, a new version is built in the background when
+// the watched model path changes, then published by an atomic pointer swap, the old version is freed once its readers are done
+template<typename Model>
+class ModelHolder {
+public:
+    using model_loader_t = std::function<std::shared_ptr<Model>(const std::filesystem::path &)>;
+
+    // Read access to the model version current when the view was created, keep the view for the time of the predictions only.
+    // A view must not be held across a reload or the construction of a holder by the same thread (of any holder), the
+    // publication would wait for the view forever, it throws std::logic_error instead
+    class ModelView {
+    public:
+        explicit ModelView(const std::atomic<const Model *> &current) : model(current.load()) {}
+
+        const Model &operator*() const {
+            return *this->model;
+        }
+
+        const Model *operator->() const {
+            return this->model;
+        }
+
+    private:
+        // Built before the pointer is read
+        EpochDomain::ReadSection read_section;
+        const Model *model;
+    };
+
+    // Load the first version, a failing load throws like the loader
+    ModelHolder(std::filesystem::path model_path, model_loader_t model_loader) : model_path(std::move(model_path)), model_loader(std::move(model_loader)) {
+        this->publish(this->model_loader(this->model_path));
+    }
+
+    ~ModelHolder() {
+        this->stop_watching();
+        this->current.store(nullptr);
+    }
+
+    ModelHolder(const ModelHolder &) = delete;
+
+    ModelHolder &operator=(const ModelHolder &) = delete;
+
+    ModelView get() const {
+        return ModelView(this->current);
+    }
+
+    const std::filesystem::path &get_model_path() const {
+        return this->model_path;
+    }
+
+    std::size_t get_number_of_reloads() const {
+        return this->number_of_reloads.load();
+    }
+
+    // Load a new version and publish it, the current version stays if the load fails, returns true if published
+    bool reload() {
+        std::shared_ptr<Model> model;
+        try {
+            model = this->model_loader(this->model_path);
+        } catch (const std::exception &e) {
+            LOG(LOG_WARNING) << "Keeping the current model, " << this->model_path << " not loaded due to the following error : " << e.what();
+            return false;
+        }
+        this->publish(std::move(model));
+        this->number_of_reloads++;
+        return true;
+    }
+
+    // Reload the model in a background thread once the files of the model path stop changing for settle_delay
+    void start_watching(std::chrono::milliseconds settle_delay = std::chrono::milliseconds(500)) {
+        if (this->watcher.joinable()) {
+            return;
+        }
+        // A model file can be replaced by a rename, its folder is watched rather than the file itself
+        const bool model_folder = std::filesystem::is_directory(this->model_path);
+        const std::filesystem::path watched_path = model_folder ? this->model_path : (this->model_path.has_parent_path() ? this->model_path.parent_path() : std::filesystem::path("."));
+        int inotify_file_descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotify_file_descriptor < 0 || inotify_add_watch(inotify_file_descriptor, watched_path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE) < 0) {
+            LOG(LOG_ERROR) << "Error : can't watch " << watched_path << " : " << std::strerror(errno);
+            throw std::filesystem::filesystem_error("Can't watch the model path!", watched_path, std::make_error_code(std::errc::no_such_file_or_directory));
+        }
+        this->stopping = false;
+        this->watcher = std::thread([this, inotify_file_descriptor, model_folder, settle_delay]() {
+            this->watch(inotify_file_descriptor, model_folder, settle_delay);
+            close(inotify_file_descriptor);
+        });
+    }
+
+    void stop_watching() {
+        this->stopping = true;
+        if (this->watcher.joinable()) {
+            this->watcher.join();
+        }
+    }
+
+private:
+    const std::filesystem::path model_path;
+    const model_loader_t model_loader;
+    // Read by the readers without any lock
+    std::atomic<const Model *> current = nullptr;
+    // Owner of the current version, only used by the writers
+    std::shared_ptr<Model> current_owner;
+    std::mutex publish_mutex;
+    std::atomic<std::size_t> number_of_reloads = 0;
+    std::atomic<bool> stopping = false;
+    std::thread watcher;
+
+    // Swap the current version, then wait for the readers of the previous one before releasing it. Checked before the swap,
+    // the new version would be freed with a published pointer if the synchronization threw
+    void publish(std::shared_ptr<Model> model) {
+        if (EpochDomain::in_read_section()) {
+            LOG(LOG_ERROR) << "Error : the model " << this->model_path << " can't be published by a thread holding a model view";
+            throw std::logic_error("Model published from a model view!");
+        }
+        std::unique_lock<std::mutex> lock(this->publish_mutex);
+        this->current.store(model.get());
+        EpochDomain::synchronize(EpochDomain::advance());
+        this->current_owner = std::move(model);
+    }
+
+    void watch(int inotify_file_descriptor, bool model_folder, std::chrono::milliseconds settle_delay) {
+        alignas(inotify_event) char events[4096];
+        bool pending_change = false;
+        auto last_change_time = std::chrono::steady_clock::now();
+        while (!this->stopping) {
+            // The timeout bounds the delay to notice a stop request and to end the settle delay
+            pollfd poll_file_descriptor = {inotify_file_descriptor, POLLIN, 0};
+            if (poll(&poll_file_descriptor, 1, 100) > 0) {
+                ssize_t events_size;
+                while ((events_size = read(inotify_file_descriptor, events, sizeof(events))) > 0) {
+                    for (char *event_pointer = events; event_pointer < events + events_size; event_pointer += sizeof(inotify_event) + reinterpret_cast<inotify_event *>(event_pointer)->len) {
+                        const inotify_event *event = reinterpret_cast<inotify_event *>(event_pointer);
+                        if (model_folder || (event->len > 0 && this->model_path.filename() == event->name)) {
+                            pending_change = true;
+                            last_change_time = std::chrono::steady_clock::now();
+                        }
+                    }
+                }
+            }
+            if (pending_change && std::chrono::steady_clock::now() - last_change_time >= settle_delay) {
+                pending_change = false;
+                auto start_time = std::chrono::steady_clock::now();
+                if (this->reload()) {
+                    auto elapsed_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count();
+                    LOG(LOG_INFO) << "Model " << this->model_path << " reloaded and published in " << elapsed_time << "ms";
+                }
+            }
+        }
+    }
+};
+
+#endif //MODEL_HOLDER_H
@@ -4,10 +4,10 @@
 #include <iterator>
 #include "globals.h"
 
-template<typename T>
-std::ostream &operator<<(std::ostream &os, const std::vector<T> &v) {
+template<typename T, typename Allocator>
+std::ostream &operator<<(std::ostream &os, const std::vector<T, Allocator> &v) {
     os << "[";
-    for (typename std::vector<T>::const_iterator i = v.begin(); i != v.end(); ++i) {
+    for (typename std::vector<T, Allocator>::const_iterator i = v.begin(); i != v.end(); ++i) {
         if (i == v.end() - 1) {
             os << *i;
         } else {
@@ -0,0 +1,279 @@
+#ifndef SHARED_MODEL_SEGMENT_H
+#define SHARED_MODEL_SEGMENT_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "globals.h"
+#include "model_container.h"
+#include "log.h"
+
+/*
+ * Shared model segment layout
+ */
+// Read-only memory segment holding several model containers, prepared once by MODEL_SUPERVISOR and mapped by every worker
+// process, so all of them evaluate the same physical pages. Every reference of the segment is an offset, from the segment
+// start for the model entries and from the container start for the sections, so each process can map it at any address
+struct SharedSegmentHeader {
+    char magic[4];
+    std::uint32_t version;
+    // Written as 0x01020304 to detect a segment written with another endianness
+    std::uint32_t byte_order;
+    std::uint32_t number_of_models;
+    std::uint64_t size;
+};
+
+// Model container of the segment, found by the name of the model
+struct SharedSegmentEntry {
+    char name[48];
+    std::uint64_t offset;
+    std::uint64_t size;
+};
+
+/* CONSTANTS */
+constexpr char SHARED_SEGMENT_MAGIC[4] = {'E', 'M', 'L', 'S'};
+constexpr std::uint32_t SHARED_SEGMENT_VERSION = 1;
+// Every model container starts on a page so its sections keep the alignment of the container format
+constexpr std::size_t SHARED_SEGMENT_ALIGNMENT = 4096;
+// Environment variable giving the workers the path of the segment, /proc/self/fd/<fd> for the memfd inherited from the supervisor
+const std::string SHARED_SEGMENT_ENVIRONMENT_VARIABLE = "EML_MODEL_SEGMENT";
+
+/*
+ * SharedModelSegmentWriter class definition
+ */
+// Build the segment in memory then copy it in a sealed memfd, the seals forbid any later write, shrink or grow of the
+// segment, so the workers can map it without trusting each other
+class SharedModelSegmentWriter {
+public:
+    void add_model(const std::string &model_name, ModelContainerWriter &model_container) {
+        if (model_name.size() >= sizeof(SharedSegmentEntry::name)) {
+            LOG(LOG_ERROR) << "Error : the model name " << model_name << " is longer than " << sizeof(SharedSegmentEntry::name) - 1 << " characters";
+            throw std::invalid_argument("Model name too long!");
+        }
+        std::ostringstream container_stream;
+        model_container.write(container_stream);
+        this->model_names.push_back(model_name);
+        this->containers.push_back(container_stream.str());
+    }
+
+    // Create the memfd holding the segment, the file descriptor is inherited by the child processes
+    int create_memfd(const std::string &segment_name) const {
+        const std::string segment = this->get_segment();
+        int file_descriptor = memfd_create(segment_name.c_str(), MFD_ALLOW_SEALING);
+        if (file_descriptor < 0 || ftruncate(file_descriptor, (off_t) segment.size()) != 0) {
+            LOG(LOG_ERROR) << "Error : the shared model segment " << segment_name << " cannot be created : " << std::strerror(errno);
+            throw std::runtime_error("Can't create the shared model segment!");
+        }
+        std::size_t written_size = 0;
+        while (written_size < segment.size()) {
+            ssize_t written = pwrite(file_descriptor, segment.data() + written_size, segment.size() - written_size, (off_t) written_size);
+            if (written <= 0) {
+                close(file_descriptor);
+                LOG(LOG_ERROR) << "Error : writing the shared model segment " << segment_name << " failed : " << std::strerror(errno);
+                throw std::runtime_error("Can't write the shared model segment!");
+            }
+            written_size += (std::size_t) written;
+        }
+        if (fcntl(file_descriptor, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) != 0) {
+            close(file_descriptor);
+            LOG(LOG_ERROR) << "Error : the shared model segment " << segment_name << " cannot be sealed : " << std::strerror(errno);
+            throw std::runtime_error("Can't seal the shared model segment!");
+        }
+        return file_descriptor;
+    }
+
+    // Header, entries then the page aligned containers
+    std::string get_segment() const {
+        SharedSegmentHeader header = {};
+        std::memcpy(header.magic, SHARED_SEGMENT_MAGIC, sizeof(header.magic));
+        header.version = SHARED_SEGMENT_VERSION;
+        header.byte_order = MODEL_CONTAINER_BYTE_ORDER;
+        header.number_of_models = (std::uint32_t) this->containers.size();
+        std::vector<SharedSegmentEntry> entries(this->containers.size());
+        std::uint64_t offset = aligned_offset(sizeof(SharedSegmentHeader) + entries.size() * sizeof(SharedSegmentEntry));
+        for (std::size_t model_i = 0; model_i < this->containers.size(); model_i++) {
+            std::copy(this->model_names[model_i].cbegin(), this->model_names[model_i].cend(), entries[model_i].name);
+            entries[model_i].offset = offset;
+            entries[model_i].size = this->containers[model_i].size();
+            offset = aligned_offset(offset + entries[model_i].size);
+        }
+        header.size = offset;
+
+        std::string segment(offset, '\0');
+        std::memcpy(segment.data(), &header, sizeof(header));
+        std::memcpy(segment.data() + sizeof(header), entries.data(), entries.size() * sizeof(SharedSegmentEntry));
+        for (std::size_t model_i = 0; model_i < this->containers.size(); model_i++) {
+            std::copy(this->containers[model_i].cbegin(), this->containers[model_i].cend(), segment.begin() + (long) entries[model_i].offset);
+        }
+        return segment;
+    }
+
+private:
+    std::vector<std::string> model_names;
+    std::vector<std::string> containers;
+
+    static std::uint64_t aligned_offset(std::uint64_t offset) {
+        return ((offset + SHARED_SEGMENT_ALIGNMENT - 1) / SHARED_SEGMENT_ALIGNMENT) * SHARED_SEGMENT_ALIGNMENT;
+    }
+};
+
+/*
+ * SharedModelSegment class definition
+ */
+// Read-only shared mapping of a segment, the model containers are views on the mapping, nothing is copied
+class SharedModelSegment {
+public:
+    explicit SharedModelSegment(const std::filesystem::path &segment_path) {
+        int file_descriptor = open(segment_path.c_str(), O_RDONLY);
+        if (file_descriptor < 0) {
+            LOG(LOG_ERROR) << "Error : the shared model segment " << segment_path << " cannot be opened : " << std::strerror(errno);
+            throw std::filesystem::filesystem_error("Can't open the shared model segment!", std::make_error_code(std::errc::no_such_file_or_directory));
+        }
+        struct stat segment_stat = {};
+        if (fstat(file_descriptor, &segment_stat) != 0 || (std::size_t) segment_stat.st_size < sizeof(SharedSegmentHeader)) {
+            close(file_descriptor);
+            LOG(LOG_ERROR) << "Error : " << segment_path << " is too small to be a shared model segment";
+            throw std::invalid_argument("Not a shared model segment!");
+        }
+        this->size = (std::size_t) segment_stat.st_size;
+        void *mapping = mmap(nullptr, this->size, PROT_READ, MAP_SHARED, file_descriptor, 0);
+        close(file_descriptor);
+        if (mapping == MAP_FAILED) {
+            LOG(LOG_ERROR) << "Error : the shared model segment " << segment_path << " cannot be mapped : " << std::strerror(errno);
+            throw std::filesystem::filesystem_error("Can't map the shared model segment!", std::make_error_code(std::errc::io_error));
+        }
+        this->data = static_cast<const char *>(mapping);
+
+        SharedSegmentHeader header = {};
+        std::memcpy(&header, this->data, sizeof(header));
+        const std::size_t entries_end = sizeof(SharedSegmentHeader) + (std::size_t) header.number_of_models * sizeof(SharedSegmentEntry);
+        if (std::memcmp(header.magic, SHARED_SEGMENT_MAGIC, sizeof(header.magic)) != 0 || header.byte_order != MODEL_CONTAINER_BYTE_ORDER || header.version != SHARED_SEGMENT_VERSION ||
+            header.size != this->size || entries_end > this->size) {
+            munmap(const_cast<char *>(this->data), this->size);
+            LOG(LOG_ERROR) << "Error : " << segment_path << " is not a shared model segment of version " << SHARED_SEGMENT_VERSION << " written on this machine";
+            throw std::invalid_argument("Not a shared model segment!");
+        }
+        this->entries.resize(header.number_of_models);
+        std::memcpy(this->entries.data(), this->data + sizeof(SharedSegmentHeader), this->entries.size() * sizeof(SharedSegmentEntry));
+        for (SharedSegmentEntry &entry: this->entries) {
+            entry.name[sizeof(entry.name) - 1] = '\0';
+            if (entry.offset % SHARED_SEGMENT_ALIGNMENT != 0 || entry.offset > this->size || entry.size > this->size - entry.offset) {
+                munmap(const_cast<char *>(this->data), this->size);
+                LOG(LOG_ERROR) << "Error : the model " << entry.name << " of the shared model segment " << segment_path << " is out of the segment";
+                throw std::invalid_argument("Truncated shared model segment!");
+            }
+        }
+    }
+
+    // Segment of the supervisor, from the environment of the worker
+    static std::filesystem::path get_environment_segment_path() {
+        const char *segment_path = std::getenv(SHARED_SEGMENT_ENVIRONMENT_VARIABLE.c_str());
+        if (segment_path == nullptr) {
+            LOG(LOG_ERROR) << "Error : " << SHARED_SEGMENT_ENVIRONMENT_VARIABLE << " is not set, the worker must be started by MODEL_SUPERVISOR";
+            throw std::invalid_argument("No shared model segment!");
+        }
+        return segment_path;
+    }
+
+    ~SharedModelSegment() {
+        munmap(const_cast<char *>(this->data), this->size);
+    }
+
+    SharedModelSegment(const SharedModelSegment &) = delete;
+
+    SharedModelSegment &operator=(const SharedModelSegment &) = delete;
+
+    std::size_t get_size() const {
+        return this->size;
+    }
+
+    std::vector<std::string> get_model_names() const {
+        std::vector<std::string> model_names;
+        for (const SharedSegmentEntry &entry: this->entries) {
+            model_names.emplace_back(entry.name);
+        }
+        return model_names;
+    }
+
+    // Model container of the model, a view on the segment valid as long as the segment
+    std::span<const char> get_model_container(const std::string &model_name) const {
+        auto entry = std::find_if(this->entries.cbegin(), this->entries.cend(), [&model_name](const SharedSegmentEntry &segment_entry) {
+            return model_name == segment_entry.name;
+        });
+        if (entry == this->entries.cend()) {
+            LOG(LOG_ERROR) << "Error : the shared model segment does not hold the model " << model_name;
+            throw std::invalid_argument("Unknown shared model!");
+        }
+        return {this->data + entry->offset, entry->size};
+    }
+
+private:
+    const char *data = nullptr;
+    std::size_t size = 0;
+    std::vector<SharedSegmentEntry> entries;
+};
+
+/*
+ * Memory accounting
+ */
+// Resident memory of the mappings of a process from /proc/<pid>/smaps, in bytes. The proportional set size (PSS) splits each
+// shared page between the processes mapping it, so the PSS of the workers add up to the memory they really use together
+struct MappingsMemoryUsage {
+    std::size_t size = 0;
+    std::size_t rss = 0;
+    std::size_t pss = 0;
+    std::size_t shared_memory = 0;
+    std::size_t private_memory = 0;
+};
+
+/**
+ * @brief           Sum the memory usage of the mappings of a process.
+ *
+ * @param[in]       pid the process id
+ * @param[in]       mapping_name only the mappings whose path contains it are counted, all the mappings if empty
+ * @returns         the memory usage, all zeros if the process is gone
+ */
+static inline MappingsMemoryUsage get_mappings_memory_usage(pid_t pid, const std::string &mapping_name = "") {
+    MappingsMemoryUsage memory_usage;
+    std::ifstream smaps_file("/proc/" + std::to_string(pid) + "/smaps");
+    std::string line;
+    bool counted_mapping = false;
+    while (std::getline(smaps_file, line)) {
+        std::istringstream line_stream(line);
+        std::string field;
+        std::size_t value_kb = 0;
+        line_stream >> field;
+        // The fields are "<Name>: <value> kB", a mapping starts with its "<start>-<end> <perms> ..." line
+        if (field.empty() || field.back() != ':') {
+            counted_mapping = mapping_name.empty() || line.find(mapping_name) != std::string::npos;
+            continue;
+        }
+        if (!counted_mapping || !(line_stream >> value_kb)) {
+            continue;
+        }
+        if (field == "Size:") {
+            memory_usage.size += value_kb * 1024;
+        } else if (field == "Rss:") {
+            memory_usage.rss += value_kb * 1024;
+        } else if (field == "Pss:") {
+            memory_usage.pss += value_kb * 1024;
+        } else if (field == "Shared_Clean:" || field == "Shared_Dirty:") {
+            memory_usage.shared_memory += value_kb * 1024;
+        } else if (field == "Private_Clean:" || field == "Private_Dirty:") {
+            memory_usage.private_memory += value_kb * 1024;
+        }
+    }
+    return memory_usage;
+}
+
+#endif //SHARED_MODEL_SEGMENT_H
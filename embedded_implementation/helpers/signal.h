@@ -235,4 +235,42 @@ static inline void ite_dit_fft(complex_n_array_t &x) {
     }
 }
 
+/*
+ * Goertzel coefficients 2cos(2πk/N) of the given bins, for goertzel_magnitudes
+ */
+static inline real_vector_t goertzel_coefficients(const std::vector<std::size_t> &bins) {
+    real_vector_t coefficients;
+    for (std::size_t bin: bins) {
+        coefficients.push_back(2 * std::cos(2 * std::numbers::pi * (real_t) bin / N));
+    }
+    return coefficients;
+}
+
+/*
+ * Magnitudes of some bins of the DFT of the real frame x with the Goertzel algorithm, one second order filter of N
+ * multiply-adds per bin instead of a whole FFT, cheaper when only a few bins are needed
+ * The filters run by blocks of bins so the inner loop is vectorized across the bins
+ */
+static inline void goertzel_magnitudes(const real_n_array_t &x, const real_vector_t &coefficients, real_t *magnitudes) {
+    constexpr std::size_t block_size = 8;
+    for (std::size_t first = 0; first < coefficients.size(); first += block_size) {
+        const std::size_t count = std::min(block_size, coefficients.size() - first);
+        std::array<real_t, block_size> c = {};
+        std::array<real_t, block_size> s1 = {};
+        std::array<real_t, block_size> s2 = {};
+        std::copy(coefficients.cbegin() + (long) first, coefficients.cbegin() + (long) (first + count), c.begin());
+        for (real_t sample: x) {
+            for (std::size_t j = 0; j < block_size; j++) {
+                real_t s = sample + c[j] * s1[j] - s2[j];
+                s2[j] = s1[j];
+                s1[j] = s;
+            }
+        }
+        // |X_k|^2 = s1^2 + s2^2 - 2cos(2πk/N) s1 s2
+        for (std::size_t j = 0; j < count; j++) {
+            magnitudes[first + j] = std::sqrt(std::max(s1[j] * s1[j] + s2[j] * s2[j] - c[j] * s1[j] * s2[j], 0.0));
+        }
+    }
+}
+
 #endif //SIGNAL_H
@@ -0,0 +1,264 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <new>
+#include <vector>
+#include "globals.h"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/* CONSTANTS */
+// Alignment of the packed model buffers, a cache line so a SIMD load never crosses two lines
+constexpr std::size_t SIMD_ALIGNMENT = 64;
+// Number of real_t processed by one SIMD operation (2 doubles or 4 floats), the width of SSE2 and NEON registers
+constexpr std::size_t SIMD_LANES = 16 / sizeof(real_t);
+// Number of int8 processed by one step of simd_dot_product_int8, the int8 rows are zero-padded to a multiple of it
+constexpr std::size_t SIMD_INT8_LANES = 32;
+
+/* TYPES */
+// GCC/Clang vector extension, portable across x86 and ARM without intrinsics
+typedef real_t simd_real_t __attribute__((vector_size(SIMD_LANES * sizeof(real_t))));
+
+/*
+ * AlignedAllocator class definition
+ */
+template<typename T, std::size_t ALIGNMENT = SIMD_ALIGNMENT>
+class AlignedAllocator {
+public:
+    typedef T value_type;
+
+    template<typename U>
+    struct rebind {
+        typedef AlignedAllocator<U, ALIGNMENT> other;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, ALIGNMENT> &) noexcept {}
+
+    T *allocate(std::size_t n) {
+        // std::aligned_alloc needs a size multiple of the alignment
+        std::size_t size = ((n * sizeof(T) + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT;
+        void *pointer = std::aligned_alloc(ALIGNMENT, size == 0 ? ALIGNMENT : size);
+        if (pointer == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T *>(pointer);
+    }
+
+    void deallocate(T *pointer, std::size_t) noexcept {
+        std::free(pointer);
+    }
+
+    template<typename U>
+    bool operator==(const AlignedAllocator<U, ALIGNMENT> &) const noexcept {
+        return true;
+    }
+
+    template<typename U>
+    bool operator!=(const AlignedAllocator<U, ALIGNMENT> &) const noexcept {
+        return false;
+    }
+};
+
+typedef std::vector<real_t, AlignedAllocator<real_t>> aligned_real_vector_t;
+typedef std::vector<std::int8_t, AlignedAllocator<std::int8_t>> aligned_int8_vector_t;
+
+/* FUNCTIONS */
+// Size rounded up to a whole number of SIMD vectors, the padding of packed rows is filled with zeros
+static inline constexpr std::size_t simd_padded_size(std::size_t size) {
+    return ((size + SIMD_LANES - 1) / SIMD_LANES) * SIMD_LANES;
+}
+
+static inline std::size_t simd_padded_size_int8(std::size_t size) {
+    return ((size + SIMD_INT8_LANES - 1) / SIMD_INT8_LANES) * SIMD_INT8_LANES;
+}
+
+static inline simd_real_t simd_load(const real_t *pointer) {
+    simd_real_t v;
+    std::memcpy(&v, pointer, sizeof(simd_real_t));
+    return v;
+}
+
+static inline real_t simd_horizontal_sum(simd_real_t v) {
+    real_t sum = 0;
+    for (std::size_t lane = 0; lane < SIMD_LANES; lane++) {
+        sum += v[lane];
+    }
+    return sum;
+}
+
+// Dot product of two zero-padded vectors, four independent accumulators hide the latency of the additions
+static inline real_t simd_dot_product(const real_t *a, const real_t *b, std::size_t padded_size) {
+    simd_real_t sum_0 = {}, sum_1 = {}, sum_2 = {}, sum_3 = {};
+    std::size_t i = 0;
+    for (; i + 4 * SIMD_LANES <= padded_size; i += 4 * SIMD_LANES) {
+        sum_0 += simd_load(a + i) * simd_load(b + i);
+        sum_1 += simd_load(a + i + SIMD_LANES) * simd_load(b + i + SIMD_LANES);
+        sum_2 += simd_load(a + i + 2 * SIMD_LANES) * simd_load(b + i + 2 * SIMD_LANES);
+        sum_3 += simd_load(a + i + 3 * SIMD_LANES) * simd_load(b + i + 3 * SIMD_LANES);
+    }
+    for (; i < padded_size; i += SIMD_LANES) {
+        sum_0 += simd_load(a + i) * simd_load(b + i);
+    }
+    return simd_horizontal_sum((sum_0 + sum_1) + (sum_2 + sum_3));
+}
+
+// y = matrix * x + bias (bias can be null), with matrix a row-major rows x padded_cols array and x zero-padded up to padded_cols
+// Four rows are computed together so every load of x is shared by four dot products
+static inline void simd_gemv(const real_t *matrix, std::size_t rows, std::size_t padded_cols, const real_t *x, const real_t *bias, real_t *y) {
+    const std::size_t blocked_rows = rows - rows % 4;
+    std::size_t row = 0;
+    for (; row < blocked_rows; row += 4) {
+        const real_t *row_0 = matrix + row * padded_cols;
+        const real_t *row_1 = row_0 + padded_cols;
+        const real_t *row_2 = row_1 + padded_cols;
+        const real_t *row_3 = row_2 + padded_cols;
+        simd_real_t sum_0 = {}, sum_1 = {}, sum_2 = {}, sum_3 = {};
+        for (std::size_t col = 0; col < padded_cols; col += SIMD_LANES) {
+            simd_real_t x_v = simd_load(x + col);
+            sum_0 += simd_load(row_0 + col) * x_v;
+            sum_1 += simd_load(row_1 + col) * x_v;
+            sum_2 += simd_load(row_2 + col) * x_v;
+            sum_3 += simd_load(row_3 + col) * x_v;
+        }
+        y[row] = simd_horizontal_sum(sum_0) + (bias == nullptr ? 0 : bias[row]);
+        y[row + 1] = simd_horizontal_sum(sum_1) + (bias == nullptr ? 0 : bias[row + 1]);
+        y[row + 2] = simd_horizontal_sum(sum_2) + (bias == nullptr ? 0 : bias[row + 2]);
+        y[row + 3] = simd_horizontal_sum(sum_3) + (bias == nullptr ? 0 : bias[row + 3]);
+    }
+    for (; row < rows; row++) {
+        const real_t *row_i = matrix + row * padded_cols;
+        simd_real_t sum = {};
+        for (std::size_t col = 0; col < padded_cols; col += SIMD_LANES) {
+            sum += simd_load(row_i + col) * simd_load(x + col);
+        }
+        y[row] = simd_horizontal_sum(sum) + (bias == nullptr ? 0 : bias[row]);
+    }
+}
+
+// c[j * ldc + i] = dot(a row i, b row j), with a a m x padded_k and b a n x padded_k row-major zero-padded matrices
+// Cache blocking: the rows of a are walked by blocks small enough to stay in the L2 cache while every row of b is scored against them
+// Register blocking: 4 rows of a times 2 rows of b are computed together, each load feeds 2 or 4 multiply-adds
+static inline void simd_gemm_nt(const real_t *a, std::size_t m, const real_t *b, std::size_t n, std::size_t padded_k, real_t *c, std::size_t ldc) {
+    const std::size_t block_rows = std::max((std::size_t) 4, ((128 * KiB) / (padded_k * sizeof(real_t))) / 4 * 4);
+    for (std::size_t block_first = 0; block_first < m; block_first += block_rows) {
+        const std::size_t block_end = std::min(block_first + block_rows, m);
+        std::size_t j = 0;
+        for (; j + 2 <= n; j += 2) {
+            const real_t *b_0 = b + j * padded_k;
+            const real_t *b_1 = b_0 + padded_k;
+            real_t *c_0 = c + j * ldc;
+            real_t *c_1 = c_0 + ldc;
+            std::size_t i = block_first;
+            for (; i + 4 <= block_end; i += 4) {
+                const real_t *a_0 = a + i * padded_k;
+                const real_t *a_1 = a_0 + padded_k;
+                const real_t *a_2 = a_1 + padded_k;
+                const real_t *a_3 = a_2 + padded_k;
+                simd_real_t sum_00 = {}, sum_10 = {}, sum_20 = {}, sum_30 = {};
+                simd_real_t sum_01 = {}, sum_11 = {}, sum_21 = {}, sum_31 = {};
+                for (std::size_t k = 0; k < padded_k; k += SIMD_LANES) {
+                    simd_real_t b_0_v = simd_load(b_0 + k);
+                    simd_real_t b_1_v = simd_load(b_1 + k);
+                    simd_real_t a_v = simd_load(a_0 + k);
+                    sum_00 += a_v * b_0_v;
+                    sum_01 += a_v * b_1_v;
+                    a_v = simd_load(a_1 + k);
+                    sum_10 += a_v * b_0_v;
+                    sum_11 += a_v * b_1_v;
+                    a_v = simd_load(a_2 + k);
+                    sum_20 += a_v * b_0_v;
+                    sum_21 += a_v * b_1_v;
+                    a_v = simd_load(a_3 + k);
+                    sum_30 += a_v * b_0_v;
+                    sum_31 += a_v * b_1_v;
+                }
+                c_0[i] = simd_horizontal_sum(sum_00);
+                c_0[i + 1] = simd_horizontal_sum(sum_10);
+                c_0[i + 2] = simd_horizontal_sum(sum_20);
+                c_0[i + 3] = simd_horizontal_sum(sum_30);
+                c_1[i] = simd_horizontal_sum(sum_01);
+                c_1[i + 1] = simd_horizontal_sum(sum_11);
+                c_1[i + 2] = simd_horizontal_sum(sum_21);
+                c_1[i + 3] = simd_horizontal_sum(sum_31);
+            }
+            for (; i < block_end; i++) {
+                const real_t *a_i = a + i * padded_k;
+                simd_real_t sum_0 = {}, sum_1 = {};
+                for (std::size_t k = 0; k < padded_k; k += SIMD_LANES) {
+                    simd_real_t a_v = simd_load(a_i + k);
+                    sum_0 += a_v * simd_load(b_0 + k);
+                    sum_1 += a_v * simd_load(b_1 + k);
+                }
+                c_0[i] = simd_horizontal_sum(sum_0);
+                c_1[i] = simd_horizontal_sum(sum_1);
+            }
+        }
+        for (; j < n; j++) {
+            simd_gemv(a + block_first * padded_k, block_end - block_first, padded_k, b + j * padded_k, nullptr, c + j * ldc + block_first);
+        }
+    }
+}
+
+// Dot product of two zero-padded int8 vectors accumulated in int32, the products are widened to int16 and summed by pairs
+// (pmaddwd on x86, vpadal on ARM) so no intermediate sum can overflow for values in [-127, 127]
+static inline std::int32_t simd_dot_product_int8(const std::int8_t *a, const std::int8_t *b, std::size_t padded_size) {
+#if defined(__AVX2__)
+    __m256i sum = _mm256_setzero_si256();
+    for (std::size_t i = 0; i < padded_size; i += SIMD_INT8_LANES) {
+        __m256i a_lo = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i)));
+        __m256i a_hi = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i + 16)));
+        __m256i b_lo = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i)));
+        __m256i b_hi = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i + 16)));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(a_lo, b_lo));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(a_hi, b_hi));
+    }
+    __m128i sum_128 = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    sum_128 = _mm_add_epi32(sum_128, _mm_shuffle_epi32(sum_128, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum_128 = _mm_add_epi32(sum_128, _mm_shuffle_epi32(sum_128, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum_128);
+#elif defined(__SSE2__)
+    __m128i sum = _mm_setzero_si128();
+    for (std::size_t i = 0; i < padded_size; i += 16) {
+        __m128i a_v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+        __m128i b_v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+        // SSE2 has no sign extension, each byte is unpacked with itself then shifted right arithmetically
+        __m128i a_lo = _mm_srai_epi16(_mm_unpacklo_epi8(a_v, a_v), 8);
+        __m128i a_hi = _mm_srai_epi16(_mm_unpackhi_epi8(a_v, a_v), 8);
+        __m128i b_lo = _mm_srai_epi16(_mm_unpacklo_epi8(b_v, b_v), 8);
+        __m128i b_hi = _mm_srai_epi16(_mm_unpackhi_epi8(b_v, b_v), 8);
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(a_lo, b_lo));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(a_hi, b_hi));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    int32x4_t sum = vdupq_n_s32(0);
+    for (std::size_t i = 0; i < padded_size; i += 16) {
+        int8x16_t a_v = vld1q_s8(a + i);
+        int8x16_t b_v = vld1q_s8(b + i);
+        sum = vpadalq_s16(sum, vmull_s8(vget_low_s8(a_v), vget_low_s8(b_v)));
+        sum = vpadalq_s16(sum, vmull_s8(vget_high_s8(a_v), vget_high_s8(b_v)));
+    }
+    return vaddvq_s32(sum);
+#else
+    std::int32_t sum = 0;
+    for (std::size_t i = 0; i < padded_size; i++) {
+        sum += (std::int32_t) a[i] * (std::int32_t) b[i];
+    }
+    return sum;
+#endif
+}
+
+#endif //SIMD_H
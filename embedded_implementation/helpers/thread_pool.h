@@ -0,0 +1,131 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * ThreadPool class definition
+ */
+// Fixed set of worker threads running the iterations of parallel_for, the calling thread takes part in the work
+class ThreadPool {
+public:
+    explicit ThreadPool(std::size_t number_of_threads = std::thread::hardware_concurrency()) {
+        // The calling thread is one of the threads
+        for (std::size_t thread_i = 1; thread_i < std::max((std::size_t) 1, number_of_threads); thread_i++) {
+            workers.emplace_back([this]() { this->worker_loop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        work_available.notify_all();
+        for (std::thread &worker: workers) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    std::size_t get_number_of_threads() const {
+        return workers.size() + 1;
+    }
+
+    // Run task(i) for every i in [0, count) and wait for all of them, the first exception thrown by a task is rethrown
+    void parallel_for(std::size_t count, const std::function<void(std::size_t)> &task) {
+        if (workers.empty() || count <= 1) {
+            for (std::size_t i = 0; i < count; i++) {
+                task(i);
+            }
+            return;
+        }
+        std::unique_lock<std::mutex> call_lock(call_mutex);
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            current_task = &task;
+            task_count = count;
+            next_index = 0;
+            running_workers = workers.size();
+            task_exception = nullptr;
+            generation++;
+        }
+        work_available.notify_all();
+        this->run_tasks();
+        std::unique_lock<std::mutex> lock(mutex);
+        work_done.wait(lock, [this]() { return running_workers == 0; });
+        current_task = nullptr;
+        if (task_exception) {
+            std::rethrow_exception(task_exception);
+        }
+    }
+
+private:
+    std::vector<std::thread> workers;
+    // Serialize the parallel_for calls made from several threads
+    std::mutex call_mutex;
+    std::mutex mutex;
+    std::condition_variable work_available;
+    std::condition_variable work_done;
+    const std::function<void(std::size_t)> *current_task = nullptr;
+    std::size_t task_count = 0;
+    std::size_t next_index = 0;
+    std::size_t running_workers = 0;
+    std::size_t generation = 0;
+    std::exception_ptr task_exception = nullptr;
+    bool stopping = false;
+
+    // Take iterations until there is none left
+    void run_tasks() {
+        while (true) {
+            std::size_t index;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                if (next_index >= task_count) {
+                    return;
+                }
+                index = next_index++;
+            }
+            try {
+                (*current_task)(index);
+            } catch (...) {
+                std::unique_lock<std::mutex> lock(mutex);
+                if (!task_exception) {
+                    task_exception = std::current_exception();
+                }
+                next_index = task_count;
+            }
+        }
+    }
+
+    void worker_loop() {
+        std::size_t seen_generation = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                work_available.wait(lock, [this, &seen_generation]() { return stopping || generation != seen_generation; });
+                if (stopping) {
+                    return;
+                }
+                seen_generation = generation;
+            }
+            this->run_tasks();
+            std::unique_lock<std::mutex> lock(mutex);
+            running_workers--;
+            if (running_workers == 0) {
+                work_done.notify_one();
+            }
+        }
+    }
+};
+
+#endif //THREAD_POOL_H
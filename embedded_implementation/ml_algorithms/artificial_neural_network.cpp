@@ -5,6 +5,7 @@
 
 #include <utility>
 #include <execution>
+#include <iomanip>
 #include <iterator>
 
 /*
@@ -12,14 +13,20 @@
  */
 
 /* PUBLIC DEFINITION */
-Neuron::Neuron(real_t bias, real_vector_t weights) :
-        bias(bias), weights(std::move(weights)) {}
+Neuron::Neuron(real_t bias, std::span<const real_t> weights, const allocator_type &allocator) :
+        bias(bias), weights(weights.begin(), weights.end(), allocator) {}
+
+Neuron::Neuron(const Neuron &neuron, const allocator_type &allocator) :
+        bias(neuron.bias), weights(neuron.weights, allocator) {}
+
+Neuron::Neuron(Neuron &&neuron, const allocator_type &allocator) :
+        bias(neuron.bias), weights(std::move(neuron.weights), allocator) {}
 
 real_t Neuron::get_bias() const {
     return bias;
 }
 
-const real_vector_t &Neuron::get_weights() const {
+const std::pmr::vector<real_t> &Neuron::get_weights() const {
     return weights;
 }
 
@@ -49,25 +56,53 @@ real_t Neuron::compute_weighted_sum(real_vector_t &features_vector) {
  */
 
 /* PUBLIC DEFINITION */
-ArtificialNeuralNetwork::ArtificialNeuralNetwork() {
+ArtificialNeuralNetwork::ArtificialNeuralNetwork() : layers(this->arena.get()) {
     this->clear();
 }
 
-const std::map<std::size_t, std::vector<Neuron>> &ArtificialNeuralNetwork::get_layers() const {
+ArtificialNeuralNetwork::ArtificialNeuralNetwork(const ArtificialNeuralNetwork &artificial_neural_network) : ArtificialNeuralNetwork() {
+    *this = artificial_neural_network;
+}
+
+const std::pmr::map<std::size_t, std::pmr::vector<Neuron>> &ArtificialNeuralNetwork::get_layers() const {
     return layers;
 }
 
+const ModelArena &ArtificialNeuralNetwork::get_arena() const {
+    return *this->arena.get();
+}
+
 const std::map<std::size_t, ActivationFunction> &ArtificialNeuralNetwork::get_layers_activation_function() const {
     return layers_activation_function;
 }
 
+const std::vector<DenseLayer> &ArtificialNeuralNetwork::get_dense_layers() const {
+    return dense_layers;
+}
+
+std::size_t ArtificialNeuralNetwork::get_memory_footprint() const {
+    std::size_t footprint = sizeof(ArtificialNeuralNetwork);
+    for (const DenseLayer &dense_layer: this->dense_layers) {
+        footprint += sizeof(DenseLayer) + (dense_layer.weights.capacity() + dense_layer.biases.capacity()) * sizeof(real_t);
+    }
+    return footprint;
+}
+
+void ArtificialNeuralNetwork::set_thread_pool(std::shared_ptr<ThreadPool> thread_pool) {
+    this->thread_pool = std::move(thread_pool);
+}
+
 
 const std::vector<std::string> &ArtificialNeuralNetwork::get_classes() const {
-    return classes;
+    return class_dictionary.get_class_names();
+}
+
+const ClassDictionary &ArtificialNeuralNetwork::get_class_dictionary() const {
+    return class_dictionary;
 }
 
 std::ostream &operator<<(std::ostream &os, const ArtificialNeuralNetwork &artificial_neural_network) {
-    for (const std::pair<std::size_t, std::vector<Neuron>> layer: artificial_neural_network.get_layers()) {
+    for (const std::pair<const std::size_t, std::pmr::vector<Neuron>> &layer: artificial_neural_network.get_layers()) {
         os << "layer " << layer.first << " (" << layer.second.size() << ")";
         switch (artificial_neural_network.get_layers_activation_function().at(layer.first)) {
             case ActivationFunction::SIGMOID : {
@@ -96,137 +131,291 @@ std::ostream &operator<<(std::ostream &os, const ArtificialNeuralNetwork &artifi
 }
 
 void ArtificialNeuralNetwork::fill_from_csv(const std::filesystem::path &csv_folder_path) {
-    const char delimiter = ',';
     const std::string csv_extension = ".csv";
 
-
+    // The layer files are parsed concurrently on the thread pool, each task writes its own slot so the layer order stays the file order
     auto csv_files = alpha_files_listing(csv_folder_path.string(), csv_extension);
+    // The neurons are parsed straight into the arena, then moved in the layers without copy
+    std::vector<std::pmr::vector<Neuron>> csv_layers;
+    csv_layers.reserve(csv_files.size());
     for (std::size_t layer_i = 0; layer_i < csv_files.size(); layer_i++) {
+        csv_layers.emplace_back(this->arena.get());
+    }
+    std::vector<std::string> pred_classes = {};
+    auto layer_task = [&csv_files, &csv_layers, &pred_classes](std::size_t layer_i) {
         LOG(LOG_DEBUG) << "reading: " << layer_i << ", " << csv_files.at(layer_i);
-        std::string line = {};
-        std::string data = {};
-
-        std::ifstream input_file(csv_files.at(layer_i));
-        if (!input_file.is_open()) {
-            throw std::filesystem::filesystem_error("Can't open file!", std::make_error_code(std::errc::no_such_file_or_directory));
-        }
-
-        //TODO: check file extension and header
-        std::vector<Neuron> layer = {};
-        std::vector<std::string> pred_classes = {};
-        ActivationFunction layer_activation_function;
-        bool header_skipped = false;
-        while (std::getline(input_file, line)) {
-            if (!header_skipped) {
-                header_skipped = true;
-                continue;
-            } else {
-                std::stringstream ss(line);
-                size_t last = 0;
-                size_t next = 0;
-                // Get bias from line
-                next = line.find(delimiter, last);
-                real_t bias = std::stod(line.substr(last, next - last));
-                last = next + 1;
-                // Get the weigths from line
-                real_vector_t weigths;
-                while ((next = line.find(delimiter, last)) != std::string::npos) {
-                    weigths.push_back((real_t) std::stod(line.substr(last, next - last)));
-                    last = next + 1;
-                }
-                // If this is the output layer, the last value is the class names
-                if (layer_i + 1 == csv_files.size()) {
-                    std::string class_name = line.substr(last);
-                    // Remove double quote characters around the class name
-                    class_name.erase(remove(class_name.begin(), class_name.end(), '"'), class_name.end());
-                    pred_classes.push_back(class_name);
-                } else {
-                    weigths.push_back((real_t) std::stod(line.substr(last)));
-                }
-
-                Neuron neuron = {bias, weigths};
-                layer.push_back(neuron);
-            }
+        // If this is the output layer, the last value of each line is the class name
+        read_layer_csv(csv_files.at(layer_i), layer_i + 1 == csv_files.size(), csv_layers[layer_i], pred_classes);
+    };
+    if (this->thread_pool) {
+        this->thread_pool->parallel_for(csv_files.size(), layer_task);
+    } else {
+        for (std::size_t layer_i = 0; layer_i < csv_files.size(); layer_i++) {
+            layer_task(layer_i);
         }
+    }
+
+    for (std::size_t layer_i = 0; layer_i < csv_layers.size(); layer_i++) {
         // Use softmax only for last layer, else use Relu
-        if (layer_i + 1 == csv_files.size()) {
-            layer_activation_function = ActivationFunction::SOFTMAX;
-        } else {
-            layer_activation_function = ActivationFunction::RELU;
-        }
-        this->add_layer(layer_i, layer, layer_activation_function);
-        this->classes = pred_classes;
-    }
-}
-
-std::string ArtificialNeuralNetwork::predict_class(const real_vector_t &features_vector) {
-    real_vector_t last_activations = features_vector;
-    real_vector_t next_activations = features_vector;
-    std::for_each(std::execution::seq, this->layers.cbegin(), this->layers.cend(), [&last_activations, &next_activations, this](const std::pair<std::size_t, std::vector<Neuron>> &pair)mutable {
-        last_activations.clear();
-        std::move(next_activations.cbegin(), next_activations.cend(), std::back_inserter(last_activations));
-        next_activations.clear();
-        real_vector_t weighted_sum = {};
-        for (Neuron n: pair.second) {
-            weighted_sum.push_back(n.compute_weighted_sum(last_activations));
-        }
-        for (std::size_t neuron_i = 0; neuron_i < weighted_sum.size(); neuron_i++) {
-            switch (this->layers_activation_function.at(pair.first)) {
-                case ActivationFunction::SIGMOID :
-                case ActivationFunction::RELU : {
-                    next_activations.push_back(this->compute_layer_activation_function(pair.first, weighted_sum, neuron_i));
-                    break;
-                }
-                case ActivationFunction::SOFTMAX : {
-                    next_activations.push_back(this->compute_layer_activation_function(pair.first, weighted_sum, neuron_i));
-                    break;
-                }
-                default: {
-                    LOG(LOG_ERROR) << "Error : the activation function value usage is not defined in the project";
-                    throw std::domain_error("Unsupported activation function!");
-                    break;
-                }
+        const ActivationFunction layer_activation_function = layer_i + 1 == csv_layers.size() ? ActivationFunction::SOFTMAX : ActivationFunction::RELU;
+        this->layers.try_emplace(layer_i, std::move(csv_layers[layer_i]));
+        this->layers_activation_function.insert(std::make_pair(layer_i, layer_activation_function));
+    }
+    if (!csv_layers.empty()) {
+        this->class_dictionary = ClassDictionary(pred_classes);
+    }
+    // Pack once all the layers are known
+    this->pack_layers();
+}
+
+void ArtificialNeuralNetwork::write_to_csv(const std::filesystem::path &csv_folder_path) const {
+    for (const std::pair<const std::size_t, std::pmr::vector<Neuron>> &layer: this->layers) {
+        const std::filesystem::path csv_file_path = csv_folder_path / ("hidden_layer_" + std::to_string(layer.first + 1) + ".csv");
+        std::ofstream output_file(csv_file_path);
+        if (!output_file.is_open()) {
+            LOG(LOG_ERROR) << "Error : file with path " + csv_file_path.string() + "  cannot be created.";
+            throw std::filesystem::filesystem_error("Can't create file!", std::make_error_code(std::errc::no_such_file_or_directory));
+        }
+
+        // Keep every digit of the weights so the written network makes the same predictions
+        output_file << std::setprecision(std::numeric_limits<real_t>::max_digits10);
+        const std::size_t input_size = layer.second.empty() ? 0 : layer.second.front().get_weights().size();
+        output_file << "bias";
+        for (std::size_t weight_i = 0; weight_i < input_size; weight_i++) {
+            output_file << ",weight" << weight_i;
+        }
+        output_file << "\n";
+        // The output layer holds the class name of each neuron in its last column
+        const bool output_layer = layer.first == this->layers.rbegin()->first;
+        for (std::size_t neuron_i = 0; neuron_i < layer.second.size(); neuron_i++) {
+            const Neuron &neuron = layer.second[neuron_i];
+            output_file << neuron.get_bias();
+            for (real_t weight: neuron.get_weights()) {
+                output_file << "," << weight;
+            }
+            if (output_layer) {
+                output_file << ",\"" << this->class_dictionary.get_class_name(neuron_i) << "\"";
             }
+            output_file << "\n";
+        }
+    }
+}
 
+void ArtificialNeuralNetwork::fill_from_binary(const std::filesystem::path &binary_file_path) {
+    MappedModelContainer model_container(binary_file_path);
+    model_container.expect_model_type(ModelType::ARTIFICIAL_NEURAL_NETWORK);
+    const ClassDictionary class_dictionary = model_container.get_class_dictionary();
+    const std::size_t number_of_layers = model_container.get_number_of_sections(ModelSectionType::LAYER_SHAPE);
+    std::size_t previous_output_size = 0;
+    for (std::size_t layer_i = 0; layer_i < number_of_layers; layer_i++) {
+        std::span<const BinaryLayerShape> layer_shapes = model_container.get_section<BinaryLayerShape>(ModelSectionType::LAYER_SHAPE, layer_i);
+        if (layer_shapes.empty()) {
+            LOG(LOG_ERROR) << "Error : the layer " << layer_i << " of the model container " << binary_file_path << " has an empty shape section";
+            throw std::invalid_argument("Invalid layer shape section!");
         }
-    });
+        const BinaryLayerShape layer_shape = layer_shapes.front();
+        std::span<const real_t> weights = model_container.get_section<real_t>(ModelSectionType::LAYER_WEIGHTS, layer_i);
+        std::span<const real_t> biases = model_container.get_section<real_t>(ModelSectionType::LAYER_BIASES, layer_i);
+        if (layer_i > 0 && layer_shape.input_size != previous_output_size) {
+            LOG(LOG_ERROR) << "Error : the layer " << layer_i << " of the model container " << binary_file_path << " takes " << layer_shape.input_size << " inputs but the previous layer has " << previous_output_size << " neurons";
+            throw std::invalid_argument("Unchained layers!");
+        }
+        if (weights.size() != (std::size_t) layer_shape.output_size * layer_shape.input_size || biases.size() != layer_shape.output_size) {
+            LOG(LOG_ERROR) << "Error : the layer " << layer_i << " of the model container " << binary_file_path << " is " << layer_shape.input_size << " -> " << layer_shape.output_size << " but holds " << weights.size() << " weights and " << biases.size() << " biases";
+            throw std::invalid_argument("Layer sections sizes mismatch!");
+        }
+
+        // The weights are copied from the mapped file straight into the arena
+        std::pmr::vector<Neuron> layer(this->arena.get());
+        layer.reserve(layer_shape.output_size);
+        for (std::size_t neuron_i = 0; neuron_i < layer_shape.output_size; neuron_i++) {
+            layer.emplace_back(biases[neuron_i], weights.subspan(neuron_i * layer_shape.input_size, layer_shape.input_size));
+        }
+        this->add_layer(layer_i, std::move(layer), (ActivationFunction) layer_shape.activation_function);
+        previous_output_size = layer_shape.output_size;
+    }
+    if (number_of_layers == 0 || previous_output_size != class_dictionary.size()) {
+        LOG(LOG_ERROR) << "Error : the neural network of the model container " << binary_file_path << " has " << number_of_layers << " layers ending with " << previous_output_size << " neurons for " << class_dictionary.size() << " classes";
+        throw std::invalid_argument("Invalid model container!");
+    }
+    this->class_dictionary = class_dictionary;
+}
+
+void ArtificialNeuralNetwork::write_to_binary(const std::filesystem::path &binary_file_path) const {
+    ModelContainerWriter model_container(ModelType::ARTIFICIAL_NEURAL_NETWORK);
+    model_container.add_class_dictionary(this->class_dictionary);
+    for (const std::pair<const std::size_t, std::pmr::vector<Neuron>> &layer: this->layers) {
+        BinaryLayerShape layer_shape = {};
+        layer_shape.input_size = layer.second.empty() ? 0 : (std::uint32_t) layer.second.front().get_weights().size();
+        layer_shape.output_size = (std::uint32_t) layer.second.size();
+        layer_shape.activation_function = (std::uint32_t) this->layers_activation_function.at(layer.first);
+        // Row-major unpadded matrix, the SIMD padding depends on the target so it is added by pack_layers when loading
+        real_vector_t weights;
+        real_vector_t biases;
+        for (const Neuron &neuron: layer.second) {
+            weights.insert(weights.end(), neuron.get_weights().cbegin(), neuron.get_weights().cend());
+            biases.push_back(neuron.get_bias());
+        }
+        model_container.add_section(ModelSectionType::LAYER_SHAPE, &layer_shape, 1);
+        model_container.add_section(ModelSectionType::LAYER_WEIGHTS, weights.data(), weights.size());
+        model_container.add_section(ModelSectionType::LAYER_BIASES, biases.data(), biases.size());
+    }
+    model_container.write(binary_file_path);
+}
+
+void ArtificialNeuralNetwork::prune_weights(real_t sparsity, const std::vector<real_vector_t> &calibration_features_vectors) {
+    if (sparsity < 0 || sparsity >= 1) {
+        LOG(LOG_ERROR) << "Error : the sparsity (" << sparsity << ") must be in [0, 1)";
+        throw std::invalid_argument("Sparsity out of range!");
+    }
 
+    // Mean absolute value of each input of each layer over the calibration set, 1 without calibration
+    std::vector<real_vector_t> layers_mean_input;
+    for (const DenseLayer &dense_layer: this->dense_layers) {
+        layers_mean_input.emplace_back(dense_layer.input_size, calibration_features_vectors.empty() ? 1 : 0);
+    }
+    InferenceContext context;
+    for (const real_vector_t &features_vector: calibration_features_vectors) {
+        if (features_vector.size() != this->dense_layers.front().input_size) {
+            LOG(LOG_ERROR) << "Error : the calibration feature vector size (" << features_vector.size() << ") is different from the input layer size (" << this->dense_layers.front().input_size << ")";
+            throw std::invalid_argument("Feature vector size differ from input layer size!");
+        }
+        std::array<real_t *, 2> activations_buffers = {context.get_real_buffer(0, this->activations_buffer_size), context.get_real_buffer(1, this->activations_buffer_size)};
+        std::copy(features_vector.cbegin(), features_vector.cend(), activations_buffers[0]);
+        std::fill(activations_buffers[0] + features_vector.size(), activations_buffers[0] + this->activations_buffer_size, 0);
+        std::size_t buffer_i = 0;
+        for (std::size_t layer_i = 0; layer_i < this->dense_layers.size(); layer_i++) {
+            const real_t *input = activations_buffers[buffer_i];
+            for (std::size_t input_i = 0; input_i < this->dense_layers[layer_i].input_size; input_i++) {
+                layers_mean_input[layer_i][input_i] += std::abs(input[input_i]) / (real_t) calibration_features_vectors.size();
+            }
+            compute_dense_layer(this->dense_layers[layer_i], input, activations_buffers[1 - buffer_i]);
+            buffer_i = 1 - buffer_i;
+        }
+    }
+
+    std::size_t layer_i = 0;
+    for (std::pair<const std::size_t, std::pmr::vector<Neuron>> &layer: this->layers) {
+        const real_vector_t &mean_input = layers_mean_input[layer_i++];
+        // The output layer holds few weights but each of them drives a class score directly
+        if (layer.first == this->layers.rbegin()->first) {
+            continue;
+        }
+        std::vector<real_vector_t> weights;
+        std::vector<std::pair<std::size_t, std::size_t>> weight_positions;
+        for (std::size_t neuron_i = 0; neuron_i < layer.second.size(); neuron_i++) {
+            weights.emplace_back(layer.second[neuron_i].get_weights().cbegin(), layer.second[neuron_i].get_weights().cend());
+            for (std::size_t weight_i = 0; weight_i < weights.back().size(); weight_i++) {
+                weight_positions.emplace_back(neuron_i, weight_i);
+            }
+        }
+        const std::size_t number_of_pruned_weights = (std::size_t) (sparsity * (real_t) weight_positions.size());
+        if (number_of_pruned_weights == 0) {
+            continue;
+        }
+        // Only the smallest weights need to be found, not sorted
+        std::nth_element(weight_positions.begin(), weight_positions.begin() + (long) (number_of_pruned_weights - 1), weight_positions.end(),
+                         [&weights, &mean_input](const std::pair<std::size_t, std::size_t> &a, const std::pair<std::size_t, std::size_t> &b) {
+                             return std::abs(weights[a.first][a.second]) * mean_input[a.second] < std::abs(weights[b.first][b.second]) * mean_input[b.second];
+                         });
+        for (std::size_t position_i = 0; position_i < number_of_pruned_weights; position_i++) {
+            weights[weight_positions[position_i].first][weight_positions[position_i].second] = 0;
+        }
+        for (std::size_t neuron_i = 0; neuron_i < layer.second.size(); neuron_i++) {
+            layer.second[neuron_i] = Neuron(layer.second[neuron_i].get_bias(), weights[neuron_i]);
+        }
+    }
+    this->pack_layers();
+}
+
+std::size_t ArtificialNeuralNetwork::predict_class_id(const real_vector_t &features_vector) const {
+    return this->predict_class_id(features_vector, InferenceContext::get_thread_context());
+}
+
+std::size_t ArtificialNeuralNetwork::predict_class_id(const real_vector_t &features_vector, InferenceContext &context) const {
     // Get the prediction result with the most choice
-    auto pr = std::max_element(std::execution::seq, next_activations.begin(), next_activations.end());
+    const real_t *output = this->compute_output(features_vector, context);
+    auto pr = std::max_element(std::execution::seq, output, output + this->dense_layers.back().output_size);
 
-    return this->classes.at(std::distance(next_activations.begin(), pr));
+    return std::distance(output, pr);
 }
 
-/* PRIVATE DEFINITION */
-void ArtificialNeuralNetwork::add_layer(std::size_t layer_id, const std::vector<Neuron> &neurons, ActivationFunction activation_function) {
-    this->layers.insert(std::make_pair(layer_id, neurons));
-    this->layers_activation_function.insert(std::make_pair(layer_id, activation_function));
+std::size_t ArtificialNeuralNetwork::predict_class_id_with_confidence(const real_vector_t &features_vector, real_t &confidence) const {
+    const real_t *output = this->compute_output(features_vector, InferenceContext::get_thread_context());
+    const DenseLayer &output_layer = this->dense_layers.back();
+    auto pr = std::max_element(std::execution::seq, output, output + output_layer.output_size);
+
+    // An output layer without softmax gets one for the confidence only, the prediction stays the largest output
+    if (output_layer.activation_function == ActivationFunction::SOFTMAX) {
+        confidence = *pr;
+    } else {
+        real_t exponentials_sum = 0;
+        for (std::size_t output_i = 0; output_i < output_layer.output_size; output_i++) {
+            exponentials_sum += std::exp(output[output_i] - *pr);
+        }
+        confidence = 1 / exponentials_sum;
+    }
+
+    return std::distance(output, pr);
 }
 
-void ArtificialNeuralNetwork::remove_layer(std::size_t layer_id) {
-    this->layers.erase(layer_id);
-    this->layers_activation_function.erase(layer_id);
+std::vector<std::size_t> ArtificialNeuralNetwork::predict_class_ids(const std::vector<real_vector_t> &features_vectors) const {
+    if (this->dense_layers.empty()) {
+        LOG(LOG_ERROR) << "Error : trying to make prediction but the neural network does not have any layer";
+        throw std::invalid_argument("Neural network does not have any layer!");
+    }
+    std::vector<std::size_t> predicted_class_ids(features_vectors.size(), 0);
+    const std::size_t number_of_tiles = (features_vectors.size() + BATCH_TILE_SIZE - 1) / BATCH_TILE_SIZE;
+    auto tile_task = [this, &features_vectors, &predicted_class_ids](std::size_t tile_i) {
+        const std::size_t first = tile_i * BATCH_TILE_SIZE;
+        this->predict_class_ids_tile(features_vectors, first, std::min(BATCH_TILE_SIZE, features_vectors.size() - first), predicted_class_ids.data() + first);
+    };
+    if (this->thread_pool) {
+        this->thread_pool->parallel_for(number_of_tiles, tile_task);
+    } else {
+        for (std::size_t tile_i = 0; tile_i < number_of_tiles; tile_i++) {
+            tile_task(tile_i);
+        }
+    }
+    return predicted_class_ids;
 }
 
-void ArtificialNeuralNetwork::clear() {
-    this->layers.clear();
-    this->layers_activation_function.clear();
+void ArtificialNeuralNetwork::compute_dense_layer(const DenseLayer &dense_layer, const real_t *input, real_t *output) {
+    simd_gemv(dense_layer.weights.data(), dense_layer.output_size, dense_layer.padded_input_size, input, dense_layer.biases.data(), output);
+    apply_activation_function(dense_layer, output);
 }
 
-real_t ArtificialNeuralNetwork::compute_layer_activation_function(std::size_t layer_ind, real_vector_t &weighted_sums, std::size_t weighted_sum_ind) {
-    switch (this->layers_activation_function.at(layer_ind)) {
+void ArtificialNeuralNetwork::apply_activation_function(const DenseLayer &dense_layer, real_t *output) {
+    apply_activation_function(dense_layer.activation_function, dense_layer.output_size, output);
+    // Clear the padding so the next layer can run on whole SIMD vectors
+    std::fill(output + dense_layer.output_size, output + simd_padded_size(dense_layer.output_size), 0);
+}
+
+void ArtificialNeuralNetwork::apply_activation_function(ActivationFunction activation_function, std::size_t output_size, real_t *output) {
+    switch (activation_function) {
         case ActivationFunction::SIGMOID : {
-            return 1.0 / (1.0 + std::exp(-weighted_sums.at(weighted_sum_ind)));
+            for (std::size_t neuron_i = 0; neuron_i < output_size; neuron_i++) {
+                output[neuron_i] = 1.0 / (1.0 + std::exp(-output[neuron_i]));
+            }
             break;
         }
         case ActivationFunction::RELU : {
-            return std::max((real_t) 0, weighted_sums.at(weighted_sum_ind));
+            for (std::size_t neuron_i = 0; neuron_i < output_size; neuron_i++) {
+                output[neuron_i] = std::max((real_t) 0, output[neuron_i]);
+            }
             break;
         }
         case ActivationFunction::SOFTMAX : {
-            return std::exp(weighted_sums.at(weighted_sum_ind)) / std::transform_reduce(std::execution::seq, weighted_sums.cbegin(), weighted_sums.cend(), 0.0, std::plus<>(), [](real_t r)mutable {
-                return std::exp(r);
-            });
+            // The exponential sum is computed once for the whole layer, shifted by the max weighted sum to avoid overflows
+            real_t max_weighted_sum = *std::max_element(output, output + output_size);
+            real_t exp_sum = 0;
+            for (std::size_t neuron_i = 0; neuron_i < output_size; neuron_i++) {
+                output[neuron_i] = std::exp(output[neuron_i] - max_weighted_sum);
+                exp_sum += output[neuron_i];
+            }
+            for (std::size_t neuron_i = 0; neuron_i < output_size; neuron_i++) {
+                output[neuron_i] /= exp_sum;
+            }
             break;
         }
         default: {
@@ -235,5 +424,165 @@ real_t ArtificialNeuralNetwork::compute_layer_activation_function(std::size_t la
             break;
         }
     }
-    return 0;
+}
+
+/* PRIVATE DEFINITION */
+void ArtificialNeuralNetwork::add_layer(std::size_t layer_id, std::pmr::vector<Neuron> &&neurons, ActivationFunction activation_function) {
+    this->layers.try_emplace(layer_id, std::move(neurons));
+    this->layers_activation_function.insert(std::make_pair(layer_id, activation_function));
+    this->pack_layers();
+}
+
+void ArtificialNeuralNetwork::remove_layer(std::size_t layer_id) {
+    this->layers.erase(layer_id);
+    this->layers_activation_function.erase(layer_id);
+    this->pack_layers();
+}
+
+void ArtificialNeuralNetwork::clear() {
+    this->layers.clear();
+    this->layers_activation_function.clear();
+    this->class_dictionary.clear();
+    this->pack_layers();
+}
+
+void ArtificialNeuralNetwork::read_layer_csv(const std::filesystem::path &csv_file_path, bool output_layer, std::pmr::vector<Neuron> &neurons, std::vector<std::string> &class_names) {
+    const char delimiter = ',';
+    std::string line = {};
+
+    std::ifstream input_file(csv_file_path);
+    if (!input_file.is_open()) {
+        LOG(LOG_ERROR) << "Error : file with path " + csv_file_path.string() + "  not found.";
+        throw std::filesystem::filesystem_error("Can't open file!", std::make_error_code(std::errc::no_such_file_or_directory));
+    }
+
+    //TODO: check file extension and header
+    bool header_skipped = false;
+    while (std::getline(input_file, line)) {
+        if (!header_skipped) {
+            header_skipped = true;
+            continue;
+        } else {
+            size_t last = 0;
+            size_t next = 0;
+            // Get bias from line
+            next = line.find(delimiter, last);
+            real_t bias = std::stod(line.substr(last, next - last));
+            last = next + 1;
+            // Get the weigths from line
+            real_vector_t weigths;
+            while ((next = line.find(delimiter, last)) != std::string::npos) {
+                weigths.push_back((real_t) std::stod(line.substr(last, next - last)));
+                last = next + 1;
+            }
+            // If this is the output layer, the last value is the class names
+            if (output_layer) {
+                std::string class_name = line.substr(last);
+                // Remove double quote characters around the class name
+                class_name.erase(remove(class_name.begin(), class_name.end(), '"'), class_name.end());
+                class_names.push_back(class_name);
+            } else {
+                weigths.push_back((real_t) std::stod(line.substr(last)));
+            }
+
+            neurons.emplace_back(bias, weigths);
+        }
+    }
+}
+
+void ArtificialNeuralNetwork::pack_layers() {
+    this->dense_layers.clear();
+    std::size_t buffer_size = 0;
+    for (const std::pair<const std::size_t, std::pmr::vector<Neuron>> &layer: this->layers) {
+        DenseLayer dense_layer = {};
+        dense_layer.input_size = layer.second.empty() ? 0 : layer.second.front().get_weights().size();
+        dense_layer.padded_input_size = simd_padded_size(dense_layer.input_size);
+        dense_layer.output_size = layer.second.size();
+        dense_layer.activation_function = this->layers_activation_function.at(layer.first);
+        dense_layer.weights.assign(dense_layer.output_size * dense_layer.padded_input_size, 0);
+        dense_layer.biases.assign(dense_layer.output_size, 0);
+        for (std::size_t neuron_i = 0; neuron_i < layer.second.size(); neuron_i++) {
+            const Neuron &neuron = layer.second[neuron_i];
+            if (neuron.get_weights().size() != dense_layer.input_size) {
+                LOG(LOG_ERROR) << "Error : the neuron " << neuron_i << " of the layer " << layer.first << " has " << neuron.get_weights().size() << " weights but the first one has " << dense_layer.input_size;
+                throw std::invalid_argument("Neuron weights sizes differ!");
+            }
+            std::copy(neuron.get_weights().cbegin(), neuron.get_weights().cend(), dense_layer.weights.begin() + (long) (neuron_i * dense_layer.padded_input_size));
+            dense_layer.biases[neuron_i] = neuron.get_bias();
+        }
+        if (!this->dense_layers.empty() && this->dense_layers.back().output_size != dense_layer.input_size) {
+            LOG(LOG_ERROR) << "Error : the layer " << layer.first << " takes " << dense_layer.input_size << " inputs but the previous layer has " << this->dense_layers.back().output_size << " neurons";
+            throw std::invalid_argument("Layer sizes mismatch!");
+        }
+        buffer_size = std::max({buffer_size, dense_layer.padded_input_size, simd_padded_size(dense_layer.output_size)});
+        this->dense_layers.push_back(std::move(dense_layer));
+    }
+    this->activations_buffer_size = buffer_size;
+}
+
+const real_t *ArtificialNeuralNetwork::compute_output(const real_vector_t &features_vector, InferenceContext &context) const {
+    if (this->dense_layers.empty()) {
+        LOG(LOG_ERROR) << "Error : trying to make prediction but the neural network does not have any layer";
+        throw std::invalid_argument("Neural network does not have any layer!");
+    }
+    const DenseLayer &input_layer = this->dense_layers.front();
+    if (features_vector.size() != input_layer.input_size) {
+        LOG(LOG_ERROR) << "Error : trying to make prediction but the feature vector size (" << features_vector.size() << ") is different from the input layer size (" << input_layer.input_size << ")";
+        throw std::invalid_argument("Feature vector size differ from input layer size!");
+    }
+
+    // The padding of the input is cleared since a wider layer or another model may have written there during the previous prediction
+    std::array<real_t *, 2> activations_buffers = {context.get_real_buffer(0, this->activations_buffer_size), context.get_real_buffer(1, this->activations_buffer_size)};
+    std::copy(features_vector.cbegin(), features_vector.cend(), activations_buffers[0]);
+    std::fill(activations_buffers[0] + input_layer.input_size, activations_buffers[0] + input_layer.padded_input_size, 0);
+    std::size_t buffer_i = 0;
+    for (const DenseLayer &dense_layer: this->dense_layers) {
+        compute_dense_layer(dense_layer, activations_buffers[buffer_i], activations_buffers[1 - buffer_i]);
+        buffer_i = 1 - buffer_i;
+    }
+
+    return activations_buffers[buffer_i];
+}
+
+void ArtificialNeuralNetwork::predict_class_ids_tile(const std::vector<real_vector_t> &features_vectors, std::size_t first, std::size_t count, std::size_t *class_ids) const {
+    // Each tile has its own ping-pong buffers so the tiles can run on several threads
+    std::size_t row_size = 0;
+    for (const DenseLayer &dense_layer: this->dense_layers) {
+        row_size = std::max({row_size, dense_layer.padded_input_size, simd_padded_size(dense_layer.output_size)});
+    }
+    std::array<aligned_real_vector_t, 2> tile_buffers = {aligned_real_vector_t(count * row_size, 0), aligned_real_vector_t(count * row_size, 0)};
+
+    // Pack the samples of the tile as rows of padded_input_size values
+    const DenseLayer &input_layer = this->dense_layers.front();
+    for (std::size_t i = 0; i < count; i++) {
+        const real_vector_t &features_vector = features_vectors[first + i];
+        if (features_vector.size() != input_layer.input_size) {
+            LOG(LOG_ERROR) << "Error : trying to make prediction but the feature vector size (" << features_vector.size() << ") is different from the input layer size (" << input_layer.input_size << ")";
+            throw std::invalid_argument("Feature vector size differ from input layer size!");
+        }
+        std::copy(features_vector.cbegin(), features_vector.cend(), tile_buffers[0].begin() + (long) (i * input_layer.padded_input_size));
+    }
+
+    std::size_t buffer_i = 0;
+    for (const DenseLayer &dense_layer: this->dense_layers) {
+        const std::size_t padded_output_size = simd_padded_size(dense_layer.output_size);
+        real_t *output = tile_buffers[1 - buffer_i].data();
+        simd_gemm_nt(dense_layer.weights.data(), dense_layer.output_size, tile_buffers[buffer_i].data(), count, dense_layer.padded_input_size, output, padded_output_size);
+        for (std::size_t i = 0; i < count; i++) {
+            real_t *output_row = output + i * padded_output_size;
+            for (std::size_t neuron_i = 0; neuron_i < dense_layer.output_size; neuron_i++) {
+                output_row[neuron_i] += dense_layer.biases[neuron_i];
+            }
+            apply_activation_function(dense_layer, output_row);
+        }
+        buffer_i = 1 - buffer_i;
+    }
+
+    // Get the prediction result with the most choice for each sample
+    const std::size_t output_size = this->dense_layers.back().output_size;
+    const std::size_t padded_output_size = simd_padded_size(output_size);
+    for (std::size_t i = 0; i < count; i++) {
+        const real_t *output_row = tile_buffers[buffer_i].data() + i * padded_output_size;
+        class_ids[i] = std::distance(output_row, std::max_element(output_row, output_row + output_size));
+    }
 }
@@ -3,7 +3,14 @@
 
 #include "globals.h"
 #include "machine_learning_model.h"
+#include "../helpers/model_arena.h"
+#include "../helpers/model_container.h"
+#include "../helpers/simd.h"
+#include "../helpers/thread_pool.h"
 #include <map>
+#include <memory>
+#include <memory_resource>
+#include <span>
 
 /**
  * @brief List of activation functions
@@ -17,13 +24,26 @@ enum class ActivationFunction {
 /*
  * Neuron class definition
  */
+// Allocator-aware, a neuron stored in the layers of a network allocates its weights in the arena of the network
 class Neuron {
 public:
-    Neuron(real_t bias, real_vector_t weights);
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+
+    Neuron(real_t bias, std::span<const real_t> weights, const allocator_type &allocator = {});
+
+    Neuron(const Neuron &neuron, const allocator_type &allocator = {});
+
+    Neuron(Neuron &&neuron) = default;
+
+    Neuron(Neuron &&neuron, const allocator_type &allocator);
+
+    Neuron &operator=(const Neuron &neuron) = default;
+
+    Neuron &operator=(Neuron &&neuron) = default;
 
     real_t get_bias() const;
 
-    const real_vector_t &get_weights() const;
+    const std::pmr::vector<real_t> &get_weights() const;
 
     friend std::ostream &operator<<(std::ostream &os, const Neuron &neuron);
 
@@ -31,7 +51,20 @@ public:
 
 private:
     real_t bias;
-    real_vector_t weights;
+    std::pmr::vector<real_t> weights;
+};
+
+/*
+ * DenseLayer struct definition
+ */
+// Weights of all the neurons of a layer packed in one aligned row-major output_size x padded_input_size matrix
+struct DenseLayer {
+    std::size_t input_size = 0;
+    std::size_t padded_input_size = 0;
+    std::size_t output_size = 0;
+    aligned_real_vector_t weights;
+    aligned_real_vector_t biases;
+    ActivationFunction activation_function = ActivationFunction::RELU;
 };
 
 /*
@@ -41,30 +74,103 @@ class ArtificialNeuralNetwork : public MachineLearningModel {
 public:
     ArtificialNeuralNetwork();
 
-    const std::map<std::size_t, std::vector<Neuron>> &get_layers() const;
+    // The copy allocates its neurons in a new arena
+    ArtificialNeuralNetwork(const ArtificialNeuralNetwork &artificial_neural_network);
+
+    ArtificialNeuralNetwork(ArtificialNeuralNetwork &&artificial_neural_network) = default;
+
+    ArtificialNeuralNetwork &operator=(const ArtificialNeuralNetwork &artificial_neural_network) = default;
+
+    ArtificialNeuralNetwork &operator=(ArtificialNeuralNetwork &&artificial_neural_network) = default;
+
+    const std::pmr::map<std::size_t, std::pmr::vector<Neuron>> &get_layers() const;
+
+    // Arena of the neurons and their weights
+    const ModelArena &get_arena() const;
 
     const std::map<std::size_t, ActivationFunction> &get_layers_activation_function() const;
 
+    const std::vector<DenseLayer> &get_dense_layers() const;
+
+    // Bytes used by the inference engine (dense layers), the activation buffers belong to the inference contexts
+    std::size_t get_memory_footprint() const;
+
+    // Thread pool running the layer files parsing of fill_from_csv and the batch tiles of predict_class_ids in parallel, null to run them on the calling thread
+    void set_thread_pool(std::shared_ptr<ThreadPool> thread_pool);
+
     const std::vector<std::string> &get_classes() const;
 
+    // Output layer class names, in the order of the output neurons
+    const ClassDictionary &get_class_dictionary() const override;
+
     friend std::ostream &operator<<(std::ostream &os, const ArtificialNeuralNetwork &artificial_neural_network);
 
     void fill_from_csv(const std::filesystem::path &csv_file_path) override;
 
-    std::string predict_class(const real_vector_t &features_vector) override;
+    // Write one hidden_layer_<id + 1>.csv file per layer in the folder, in the format read by fill_from_csv
+    void write_to_csv(const std::filesystem::path &csv_folder_path) const;
+
+    // Read all the layers from one binary model container written by write_to_binary, the weights are copied from the mapped file without parsing
+    void fill_from_binary(const std::filesystem::path &binary_file_path);
+
+    // LAYER_SHAPE, LAYER_WEIGHTS and LAYER_BIASES sections for each layer, in the order of the layer ids
+    void write_to_binary(const std::filesystem::path &binary_file_path) const;
+
+    // Magnitude pruning: set to zero the given fraction of the weights of each hidden layer, the smallest in absolute value first
+    // With calibration features vectors, the weights are ranked by |weight| * mean |input| so the inputs with a small range do not lose all their weights
+    void prune_weights(real_t sparsity, const std::vector<real_vector_t> &calibration_features_vectors = {});
+
+    std::size_t predict_class_id(const real_vector_t &features_vector) const override;
+
+    // Same prediction with the activations in the ping-pong buffers 0 and 1 of the context
+    std::size_t predict_class_id(const real_vector_t &features_vector, InferenceContext &context) const;
+
+    // The confidence is the largest softmax output, the probability of the predicted class
+    std::size_t predict_class_id_with_confidence(const real_vector_t &features_vector, real_t &confidence) const override;
+
+    // Batch forward pass, each layer runs as a GEMM on tiles of BATCH_TILE_SIZE samples so its weights are loaded once per tile
+    std::vector<std::size_t> predict_class_ids(const std::vector<real_vector_t> &features_vectors) const override;
+
+    // output = activation(weights * input + biases), input and output are zero-padded up to a whole number of SIMD vectors
+    static void compute_dense_layer(const DenseLayer &dense_layer, const real_t *input, real_t *output);
+
+    // Apply the activation function of the layer on the weighted sums in place and clear the padding
+    static void apply_activation_function(const DenseLayer &dense_layer, real_t *output);
+
+    // Apply the activation function on the output_size weighted sums in place
+    static void apply_activation_function(ActivationFunction activation_function, std::size_t output_size, real_t *output);
+
+    static constexpr std::size_t BATCH_TILE_SIZE = 64;
 
 private:
-    std::map<std::size_t, std::vector<Neuron>> layers;
+    // Declared first so the arena outlives the neurons allocated from it
+    ModelArenaReference arena;
+    std::pmr::map<std::size_t, std::pmr::vector<Neuron>> layers;
     std::map<std::size_t, ActivationFunction> layers_activation_function;
-    std::vector<std::string> classes;
+    ClassDictionary class_dictionary;
+    // Inference engine, the layers packed in the order of their ids
+    std::vector<DenseLayer> dense_layers;
+    // Size of the ping-pong activation buffers, a layer reads one and writes the other so a forward pass allocates nothing
+    std::size_t activations_buffer_size;
+    std::shared_ptr<ThreadPool> thread_pool;
 
-    void add_layer(std::size_t layer_id, const std::vector<Neuron> &neurons, ActivationFunction activation_function);
+    void add_layer(std::size_t layer_id, std::pmr::vector<Neuron> &&neurons, ActivationFunction activation_function);
 
     void remove_layer(std::size_t layer_id);
 
     void clear();
 
-    real_t compute_layer_activation_function(std::size_t layer_ind, real_vector_t &weighted_sums, std::size_t weighted_sum_ind);
+    // Parse the neurons of one layer file, the output layer file also holds the class name of each neuron
+    static void read_layer_csv(const std::filesystem::path &csv_file_path, bool output_layer, std::pmr::vector<Neuron> &neurons, std::vector<std::string> &class_names);
+
+    // Rebuild the dense layers and the activation buffers size from the neurons of the layers
+    void pack_layers();
+
+    // Forward pass of one features vector in the ping-pong buffers of the context, returns the output layer activations
+    const real_t *compute_output(const real_vector_t &features_vector, InferenceContext &context) const;
+
+    // Forward pass of features_vectors[first, first + count) writing the predicted class ids in class_ids
+    void predict_class_ids_tile(const std::vector<real_vector_t> &features_vectors, std::size_t first, std::size_t count, std::size_t *class_ids) const;
 
 };
 
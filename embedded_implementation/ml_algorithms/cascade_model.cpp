@@ -0,0 +1,139 @@
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <set>
+#include <sstream>
+#include "cascade_model.h"
+
+/* PUBLIC DEFINITION */
+CascadeModel::CascadeModel() : stages(), class_dictionary() {}
+
+const std::vector<CascadeStage> &CascadeModel::get_stages() const {
+    return this->stages;
+}
+
+void CascadeModel::add_stage(const std::string &name, std::shared_ptr<const MachineLearningModel> model, real_t confidence_threshold) {
+    if (!model || model->get_class_dictionary().empty()) {
+        LOG(LOG_ERROR) << "Error : the cascade stage " << name << " does not have any model or any class";
+        throw std::invalid_argument("Empty cascade stage model!");
+    }
+
+    // Map the class ids of the model to the cascade ones, the models do not share the same class order
+    CascadeStage stage = {name, std::move(model), confidence_threshold, {}};
+    const ClassDictionary &model_class_dictionary = stage.model->get_class_dictionary();
+    for (std::size_t class_id = 0; class_id < model_class_dictionary.size(); class_id++) {
+        stage.class_ids.push_back(this->class_dictionary.add_class(model_class_dictionary.get_class_name(class_id)));
+    }
+    this->stages.push_back(std::move(stage));
+}
+
+void CascadeModel::set_confidence_threshold(std::size_t stage_id, real_t confidence_threshold) {
+    if (stage_id >= this->stages.size()) {
+        LOG(LOG_ERROR) << "Error : the cascade stage " << stage_id << " does not exist, the cascade has " << this->stages.size() << " stages";
+        throw std::out_of_range("Cascade stage does not exist!");
+    }
+    this->stages[stage_id].confidence_threshold = confidence_threshold;
+}
+
+void CascadeModel::fill_from_csv(const std::filesystem::path &csv_file_path) {
+    std::ifstream input_file(csv_file_path);
+    if (!input_file.is_open()) {
+        LOG(LOG_ERROR) << "Error : file with path " + csv_file_path.string() + "  not found.";
+        throw std::filesystem::filesystem_error("Can't open file!", std::make_error_code(std::errc::no_such_file_or_directory));
+    }
+
+    // One stage_id,model,confidence_threshold line per stage after the header
+    std::string line = {};
+    std::getline(input_file, line);
+    std::size_t number_of_lines = 0;
+    while (std::getline(input_file, line)) {
+        std::stringstream ss(line);
+        std::string stage_id;
+        std::string name;
+        std::string confidence_threshold;
+        std::getline(ss, stage_id, ',');
+        std::getline(ss, name, ',');
+        std::getline(ss, confidence_threshold, ',');
+        const std::size_t stage_i = std::stoul(stage_id);
+        if (stage_i >= this->stages.size() || this->stages[stage_i].name != name) {
+            LOG(LOG_ERROR) << "Error : the cascade stage " << stage_i << " of " << csv_file_path << " is " << name << " but the cascade does not have it at this place";
+            throw std::invalid_argument("Cascade stages differ from the csv file!");
+        }
+        this->stages[stage_i].confidence_threshold = (real_t) std::stod(confidence_threshold);
+        number_of_lines += 1;
+    }
+    if (number_of_lines != this->stages.size()) {
+        LOG(LOG_ERROR) << "Error : " << csv_file_path << " has " << number_of_lines << " stages but the cascade has " << this->stages.size();
+        throw std::invalid_argument("Cascade stages differ from the csv file!");
+    }
+}
+
+void CascadeModel::write_to_csv(const std::filesystem::path &csv_file_path) const {
+    std::ofstream output_file(csv_file_path);
+    if (!output_file.is_open()) {
+        LOG(LOG_ERROR) << "Error : file with path " + csv_file_path.string() + "  cannot be created.";
+        throw std::filesystem::filesystem_error("Can't create file!", std::make_error_code(std::errc::no_such_file_or_directory));
+    }
+
+    output_file << std::setprecision(std::numeric_limits<real_t>::max_digits10);
+    output_file << "stage_id,model,confidence_threshold\n";
+    for (std::size_t stage_i = 0; stage_i < this->stages.size(); stage_i++) {
+        output_file << stage_i << "," << this->stages[stage_i].name << "," << this->stages[stage_i].confidence_threshold << "\n";
+    }
+}
+
+const ClassDictionary &CascadeModel::get_class_dictionary() const {
+    return this->class_dictionary;
+}
+
+std::vector<std::size_t> CascadeModel::get_used_features() const {
+    std::set<std::size_t> used_features;
+    for (const CascadeStage &stage: this->stages) {
+        const std::vector<std::size_t> stage_used_features = stage.model->get_used_features();
+        if (stage_used_features.empty()) {
+            return {};
+        }
+        used_features.insert(stage_used_features.cbegin(), stage_used_features.cend());
+    }
+    return {used_features.cbegin(), used_features.cend()};
+}
+
+std::size_t CascadeModel::predict_class_id(const real_vector_t &features_vector) const {
+    real_t confidence = 0;
+    std::size_t stage_id = 0;
+    return this->predict_class_id(features_vector, confidence, stage_id);
+}
+
+std::size_t CascadeModel::predict_class_id(const real_vector_t &features_vector, CascadePredictionStats &prediction_stats) const {
+    real_t confidence = 0;
+    std::size_t stage_id = 0;
+    const std::size_t class_id = this->predict_class_id(features_vector, confidence, stage_id);
+    prediction_stats.number_of_stage_decisions.resize(std::max(prediction_stats.number_of_stage_decisions.size(), this->stages.size()), 0);
+    prediction_stats.number_of_predictions += 1;
+    prediction_stats.number_of_stage_decisions[stage_id] += 1;
+    prediction_stats.last_stage_id = stage_id;
+    return class_id;
+}
+
+std::size_t CascadeModel::predict_class_id_with_confidence(const real_vector_t &features_vector, real_t &confidence) const {
+    std::size_t stage_id = 0;
+    return this->predict_class_id(features_vector, confidence, stage_id);
+}
+
+/* PRIVATE DEFINITION */
+std::size_t CascadeModel::predict_class_id(const real_vector_t &features_vector, real_t &confidence, std::size_t &stage_id) const {
+    if (this->stages.empty()) {
+        LOG(LOG_ERROR) << "Error : trying to make prediction but the cascade does not have any stage";
+        throw std::invalid_argument("Cascade does not have any stage!");
+    }
+
+    for (stage_id = 0; stage_id + 1 < this->stages.size(); stage_id++) {
+        const CascadeStage &stage = this->stages[stage_id];
+        const std::size_t model_class_id = stage.model->predict_class_id_with_confidence(features_vector, confidence);
+        if (confidence >= stage.confidence_threshold) {
+            return stage.class_ids[model_class_id];
+        }
+    }
+    const CascadeStage &last_stage = this->stages.back();
+    return last_stage.class_ids[last_stage.model->predict_class_id_with_confidence(features_vector, confidence)];
+}
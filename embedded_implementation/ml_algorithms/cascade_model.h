@@ -0,0 +1,87 @@
+#ifndef CASCADE_MODEL_H
+#define CASCADE_MODEL_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "machine_learning_model.h"
+#include "globals.h"
+#include "../helpers/log.h"
+
+/*
+ * CascadeStage struct definition
+ */
+// A model of the cascade, its prediction is escalated to the next stage when its confidence is below the threshold
+struct CascadeStage {
+    std::string name;
+    std::shared_ptr<const MachineLearningModel> model;
+    real_t confidence_threshold;
+    // Cascade class id of each class id of the model
+    std::vector<std::size_t> class_ids;
+};
+
+/*
+ * CascadePredictionStats struct definition
+ */
+// Stage deciding each prediction of CascadeModel::predict_class_id, kept by the caller so the cascade stays const
+struct CascadePredictionStats {
+    std::size_t number_of_predictions = 0;
+    // Number of predictions decided by each stage
+    std::vector<std::size_t> number_of_stage_decisions;
+    std::size_t last_stage_id = 0;
+
+    // Fraction of the predictions which reached the given stage
+    real_t get_stage_rate(std::size_t stage_id) const {
+        std::size_t reached_predictions = 0;
+        for (std::size_t stage_i = stage_id; stage_i < number_of_stage_decisions.size(); stage_i++) {
+            reached_predictions += number_of_stage_decisions[stage_i];
+        }
+        return number_of_predictions == 0 ? 0 : (real_t) reached_predictions / (real_t) number_of_predictions;
+    }
+};
+
+/*
+ * CascadeModel class definition
+ */
+// Models ordered from the cheapest to the most expensive, each sample is predicted by the first stage confident enough
+// (see MachineLearningModel::predict_class_id_with_confidence), the last stage always decides. The stage models are
+// shared and stay const, so the cascade is as reentrant as its stages
+class CascadeModel : public MachineLearningModel {
+public:
+    CascadeModel();
+
+    const std::vector<CascadeStage> &get_stages() const;
+
+    // The threshold of the last stage is kept but never used
+    void add_stage(const std::string &name, std::shared_ptr<const MachineLearningModel> model, real_t confidence_threshold);
+
+    void set_confidence_threshold(std::size_t stage_id, real_t confidence_threshold);
+
+    // Read the calibrated confidence thresholds written by write_to_csv, the stages must already be added in the same order
+    void fill_from_csv(const std::filesystem::path &csv_file_path) override;
+
+    void write_to_csv(const std::filesystem::path &csv_file_path) const;
+
+    // Class names of all the stages, in the order the stages introduce them
+    const ClassDictionary &get_class_dictionary() const override;
+
+    // Features used by any stage, empty as soon as one stage may use all of them
+    std::vector<std::size_t> get_used_features() const override;
+
+    std::size_t predict_class_id(const real_vector_t &features_vector) const override;
+
+    // Same prediction, the deciding stage is added to the prediction stats
+    std::size_t predict_class_id(const real_vector_t &features_vector, CascadePredictionStats &prediction_stats) const;
+
+    // The confidence is the one of the deciding stage
+    std::size_t predict_class_id_with_confidence(const real_vector_t &features_vector, real_t &confidence) const override;
+
+private:
+    std::vector<CascadeStage> stages;
+    ClassDictionary class_dictionary;
+
+    // Run the stages until one is confident enough, returns the cascade class id
+    std::size_t predict_class_id(const real_vector_t &features_vector, real_t &confidence, std::size_t &stage_id) const;
+};
+
+#endif //CASCADE_MODEL_H
@@ -3,6 +3,9 @@
 #include <utility>
 #include <functional>
 #include <fstream>
+#include <iomanip>
+#include <limits>
+#include <set>
 #include "../helpers/log.h"
 
 /*
@@ -52,34 +55,31 @@ bool TreeNode::as_children() const {
  */
 
 /* PUBLIC DEFINITION */
-DecisionTree::DecisionTree() {
-    this->tree.clear();
+DecisionTree::DecisionTree() : DecisionTree(nullptr) {
+}
+
+DecisionTree::DecisionTree(std::shared_ptr<ModelArena> arena) : arena(std::move(arena)), tree(this->arena.get()) {
     this->depth = 0;
     this->number_of_nodes = 0;
-    this->depth_up_to_date = true;
     this->max_feature_id = 0;
+    this->flat_tree.clear();
+    this->class_dictionary.clear();
 }
 
-const std::map<std::size_t, TreeNode> &DecisionTree::get_tree() const {
+DecisionTree::DecisionTree(const DecisionTree &decision_tree) : DecisionTree() {
+    *this = decision_tree;
+}
+
+const std::pmr::map<std::size_t, TreeNode> &DecisionTree::get_tree() const {
     return this->tree;
 }
 
-size_t DecisionTree::get_depth() {
-    if (this->depth_up_to_date) {
-        return this->depth;
-    } else {
-        this->depth = this->compute_depth();
-        this->depth_up_to_date = true;
-        return this->depth;
-    }
+const ModelArena &DecisionTree::get_arena() const {
+    return *this->arena.get();
 }
 
 size_t DecisionTree::get_depth() const {
-    if (this->depth_up_to_date) {
-        return this->depth;
-    } else {
-        return compute_depth();
-    }
+    return this->depth;
 }
 
 std::size_t DecisionTree::get_number_of_nodes() const {
@@ -94,6 +94,23 @@ TreeNode DecisionTree::get_node(std::size_t node_id) const {
     return this->tree.at(node_id);
 }
 
+std::size_t DecisionTree::get_memory_footprint() const {
+    std::size_t footprint = sizeof(DecisionTree);
+    for (const std::pair<const unsigned long, TreeNode> &tree_node: this->tree) {
+        // A map node, allocated in the arena, holds its value next to the red-black tree color and 3 links
+        footprint += sizeof(tree_node) + 4 * sizeof(void *);
+        // Class names longer than the small string buffer are allocated apart
+        const std::string &class_name = tree_node.second.get_class_name();
+        const char *class_name_object = reinterpret_cast<const char *>(&class_name);
+        if (class_name.data() < class_name_object || class_name.data() >= class_name_object + sizeof(std::string)) {
+            footprint += class_name.capacity() + 1;
+        }
+    }
+    footprint += this->flat_tree.capacity() * sizeof(FlatTreeNode);
+    footprint += this->class_dictionary.get_class_names().capacity() * sizeof(std::string);
+    return footprint;
+}
+
 std::ostream &operator<<(std::ostream &os, const DecisionTree &decision_tree) {
     for (const std::pair<const unsigned long, TreeNode> &tree: decision_tree.get_tree()) {
         os << "\n- node[" << tree.first << "]: " << tree.second;
@@ -102,20 +119,8 @@ std::ostream &operator<<(std::ostream &os, const DecisionTree &decision_tree) {
 }
 
 void DecisionTree::insert_node(std::size_t node_id, const TreeNode &node) {
-    if (this->tree.count(node_id) == 1) {
-        if (node_id == 0) {
-            LOG(LOG_ERROR) << "Error : trying to insert a node with id=0 but the tree already as a root node";
-            throw std::invalid_argument("Tree already have a root node!");
-        } else {
-            LOG(LOG_ERROR) << "Error : trying to insert a node with id=" + std::to_string(node_id) + " but the tree already as a node with this id";
-            throw std::invalid_argument("Tree already have a node with id " + std::to_string(node_id) + "!");
-        }
-    }
-    this->tree.insert(std::make_pair(node_id, node));
-    this->max_feature_id = std::max(node.get_feature_id(), this->max_feature_id);
-
-    this->depth_up_to_date = false;
-    this->number_of_nodes += 1;
+    this->add_node(node_id, node);
+    this->update_flat_tree();
 }
 
 void DecisionTree::remove_node(std::size_t node_id) {
@@ -129,18 +134,18 @@ void DecisionTree::remove_node(std::size_t node_id) {
 
     }
     this->tree.erase(node_id);
-
-    this->depth_up_to_date = false;
     this->number_of_nodes -= 1;
+    this->update_flat_tree();
 }
 
 void DecisionTree::clear() {
     this->tree.clear();
 
     this->depth = 0;
-    this->depth_up_to_date = true;
     this->number_of_nodes = 0;
     this->max_feature_id = 0;
+    this->flat_tree.clear();
+    this->class_dictionary.clear();
 }
 
 void DecisionTree::fill_from_csv(const std::filesystem::path &csv_file_path) {
@@ -190,56 +195,226 @@ void DecisionTree::fill_from_csv(const std::filesystem::path &csv_file_path) {
             // Remove double quote characters around the class name
             class_name.erase(remove(class_name.begin(), class_name.end(), '"'), class_name.end());
             TreeNode new_tree = {class_name, threshold, feature_id, left_children_id, right_children_id};
-            this->insert_node(node_id, new_tree);
+            this->add_node(node_id, new_tree);
         }
     }
 
-    this->depth_up_to_date = false;
+    this->update_flat_tree();
+}
+
+void DecisionTree::write_to_csv(const std::filesystem::path &csv_file_path) const {
+    std::ofstream output_file(csv_file_path);
+    if (!output_file.is_open()) {
+        LOG(LOG_ERROR) << "Error : file with path " + csv_file_path.string() + "  cannot be created.";
+        throw std::filesystem::filesystem_error("Can't create file!", std::make_error_code(std::errc::no_such_file_or_directory));
+    }
+
+    // Keep every digit of the thresholds so the written tree makes the same predictions
+    output_file << std::setprecision(std::numeric_limits<real_t>::max_digits10);
+    output_file << "node_id,threshold,feature_id,left_children_id,right_children_id,class\n";
+    for (const auto &[node_id, node]: this->tree) {
+        output_file << node_id << "," << node.get_threshold() << "," << node.get_feature_id() << "," << node.get_left_children_id() << "," << node.get_right_children_id() << ",\"" << node.get_class_name() << "\"\n";
+    }
+}
+
+void DecisionTree::fill_from_binary(const std::filesystem::path &binary_file_path) {
+    MappedModelContainer model_container(binary_file_path);
+    model_container.expect_model_type(ModelType::DECISION_TREE);
+    this->fill_from_binary_nodes(model_container.get_section<BinaryTreeNode>(ModelSectionType::TREE_NODES), model_container.get_class_dictionary());
 }
 
-std::string DecisionTree::predict_class(const real_vector_t &features_vector) {
+void DecisionTree::write_to_binary(const std::filesystem::path &binary_file_path) const {
+    ClassDictionary class_names;
+    const std::vector<BinaryTreeNode> binary_nodes = this->get_binary_nodes(class_names);
+    ModelContainerWriter model_container(ModelType::DECISION_TREE);
+    model_container.add_class_dictionary(class_names);
+    model_container.add_section(ModelSectionType::TREE_NODES, binary_nodes.data(), binary_nodes.size());
+    model_container.write(binary_file_path);
+}
+
+std::vector<BinaryTreeNode> DecisionTree::get_binary_nodes(ClassDictionary &class_names) const {
+    std::vector<BinaryTreeNode> binary_nodes;
+    binary_nodes.reserve(this->tree.size());
+    for (const auto &[node_id, node]: this->tree) {
+        BinaryTreeNode binary_node = {};
+        binary_node.node_id = node_id;
+        binary_node.threshold = node.get_threshold();
+        binary_node.feature_id = node.get_feature_id();
+        binary_node.left_children_id = node.get_left_children_id();
+        binary_node.right_children_id = node.get_right_children_id();
+        binary_node.class_id = (std::uint32_t) class_names.add_class(node.get_class_name());
+        binary_nodes.push_back(binary_node);
+    }
+    return binary_nodes;
+}
+
+void DecisionTree::fill_from_binary_nodes(std::span<const BinaryTreeNode> binary_nodes, const ClassDictionary &class_names) {
+    for (const BinaryTreeNode &binary_node: binary_nodes) {
+        if (binary_node.class_id >= class_names.size()) {
+            LOG(LOG_ERROR) << "Error : the node " << binary_node.node_id << " has the class id " << binary_node.class_id << " but the model container only has " << class_names.size() << " classes";
+            throw std::invalid_argument("Unknown class id!");
+        }
+        TreeNode new_tree = {class_names.get_class_name(binary_node.class_id), binary_node.threshold, binary_node.feature_id, binary_node.left_children_id, binary_node.right_children_id};
+        this->add_node(binary_node.node_id, new_tree);
+    }
+    this->update_flat_tree();
+}
+
+const ClassDictionary &DecisionTree::get_class_dictionary() const {
+    return this->class_dictionary;
+}
+
+const std::vector<FlatTreeNode> &DecisionTree::get_flat_tree() const {
+    return this->flat_tree;
+}
+
+std::vector<std::size_t> DecisionTree::get_used_features() const {
+    std::set<std::size_t> used_features;
+    for (const auto &[node_id, node]: this->tree) {
+        if (node.as_children()) {
+            used_features.insert((std::size_t) node.get_feature_id());
+        }
+    }
+    return {used_features.cbegin(), used_features.cend()};
+}
+
+std::size_t DecisionTree::predict_class_id(const real_vector_t &features_vector) const {
+    if (this->tree.count(0) == 0) {
+        LOG(LOG_ERROR) << "Error : trying to make prediction but the tree does not have a root node";
+        throw std::invalid_argument("Tree does not have a root node!");
+    }
     // Verify that the tree does not contain a feature id bigger than the feature vector size
-    if ((int) features_vector.size() < this->max_feature_id) {
-        LOG(LOG_ERROR) << "Error : trying to make prediction but the tree contain a feature id bigger than the feature vector size (" << features_vector.size() << " < " << this->max_feature_id << ")";
+    if ((int) features_vector.size() <= this->max_feature_id) {
+        LOG(LOG_ERROR) << "Error : trying to make prediction but the tree contain a feature id bigger than the feature vector size (" << features_vector.size() << " <= " << this->max_feature_id << ")";
         throw std::invalid_argument("Feature vector too small!");
     }
 
-    // Current node point to root node
-    TreeNode *current_node = &this->tree.at(0);
+    // Set current node to the left or right node if the features vector feature at the given id is bellow the current node threshold, a leaf is the only node looping on itself
+    std::uint32_t current_node_id = 0;
+    std::uint32_t next_node_id = 0;
+    do {
+        current_node_id = next_node_id;
+        const FlatTreeNode &node = this->flat_tree[current_node_id];
+        next_node_id = node.children_id[!(features_vector[node.feature_id] <= node.threshold)];
+    } while (next_node_id != current_node_id);
 
-    while (current_node->as_children() && current_node->get_feature_id() >= 0) {
-        // Set current node to the left or right node if the features vector feature at the given id is bellow the current node threshold
-        if (features_vector.at(current_node->get_feature_id()) <= current_node->get_threshold()) {
-            current_node = &this->tree.at(current_node->get_left_children_id());
-        } else {
-            current_node = &this->tree.at(current_node->get_right_children_id());
+    return this->flat_tree[current_node_id].class_id;
+}
+
+std::vector<std::size_t> DecisionTree::predict_class_ids(const std::vector<real_vector_t> &features_vectors) const {
+    std::vector<std::uint32_t> class_ids(features_vectors.size());
+    this->predict_class_ids(features_vectors, 0, features_vectors.size(), class_ids.data());
+    return {class_ids.cbegin(), class_ids.cend()};
+}
+
+void DecisionTree::predict_class_ids(const std::vector<real_vector_t> &features_vectors, std::size_t first, std::size_t count, std::uint32_t *class_ids) const {
+    if (this->tree.count(0) == 0) {
+        LOG(LOG_ERROR) << "Error : trying to make prediction but the tree does not have a root node";
+        throw std::invalid_argument("Tree does not have a root node!");
+    }
+    // Verify once that the tree does not contain a feature id bigger than the feature vectors size, the traversal itself is unchecked
+    for (std::size_t i = first; i < first + count; i++) {
+        if ((int) features_vectors.at(i).size() <= this->max_feature_id) {
+            LOG(LOG_ERROR) << "Error : trying to make prediction but the tree contain a feature id bigger than the feature vector size (" << features_vectors.at(i).size() << " <= " << this->max_feature_id << ")";
+            throw std::invalid_argument("Feature vector too small!");
         }
     }
 
-    return current_node->get_class_name();
+    // Leaves loop on themselves, so depth - 1 steps bring every sample to its leaf
+    const std::size_t steps = this->depth - 1;
+    const FlatTreeNode *nodes = this->flat_tree.data();
+
+    for (std::size_t group_first = first; group_first < first + count; group_first += INTERLEAVED_SAMPLES) {
+        const std::size_t group_size = std::min(INTERLEAVED_SAMPLES, first + count - group_first);
+        std::uint32_t current_nodes[INTERLEAVED_SAMPLES] = {};
+        const real_t *features[INTERLEAVED_SAMPLES] = {};
+        for (std::size_t i = 0; i < group_size; i++) {
+            features[i] = features_vectors[group_first + i].data();
+        }
+
+        // Each step moves all the samples of the group one level down, their node loads are independent and overlap
+        for (std::size_t step = 0; step < steps; step++) {
+            for (std::size_t i = 0; i < group_size; i++) {
+                const FlatTreeNode &node = nodes[current_nodes[i]];
+                current_nodes[i] = node.children_id[!(features[i][node.feature_id] <= node.threshold)];
+            }
+        }
+
+        for (std::size_t i = 0; i < group_size; i++) {
+            class_ids[group_first - first + i] = nodes[current_nodes[i]].class_id;
+        }
+    }
 }
 
 /* PRIVATE DEFINITION */
+void DecisionTree::add_node(std::size_t node_id, const TreeNode &node) {
+    if (this->tree.count(node_id) == 1) {
+        if (node_id == 0) {
+            LOG(LOG_ERROR) << "Error : trying to insert a node with id=0 but the tree already as a root node";
+            throw std::invalid_argument("Tree already have a root node!");
+        } else {
+            LOG(LOG_ERROR) << "Error : trying to insert a node with id=" + std::to_string(node_id) + " but the tree already as a node with this id";
+            throw std::invalid_argument("Tree already have a node with id " + std::to_string(node_id) + "!");
+        }
+    }
+    this->tree.insert(std::make_pair(node_id, node));
+    this->max_feature_id = std::max(node.get_feature_id(), this->max_feature_id);
+    this->number_of_nodes += 1;
+}
+
 std::size_t DecisionTree::compute_depth() const {
-    // function <return_type(parameter_types)> function_name
+    // function <return_type(parameter_types)> function_name, the children not inserted yet count as empty subtrees
     std::function<int(TreeNode)> compute_tree_depth = [this, &compute_tree_depth](const TreeNode &node) {
-        int lh = (node.get_left_children_id() == -1) ? 0 : compute_tree_depth(this->tree.at(node.get_left_children_id()));
-        int rh = (node.get_right_children_id() == -1) ? 0 : compute_tree_depth(this->tree.at(node.get_right_children_id()));
+        int lh = (this->tree.count(node.get_left_children_id()) == 0) ? 0 : compute_tree_depth(this->tree.at(node.get_left_children_id()));
+        int rh = (this->tree.count(node.get_right_children_id()) == 0) ? 0 : compute_tree_depth(this->tree.at(node.get_right_children_id()));
         return (std::size_t) std::max(lh, rh) + 1;
     };
     //TODO: parallelize the depth computation
-    if (this->tree.empty()) {
+    if (this->tree.count(0) == 0) {
         return 0;
     } else {
         return compute_tree_depth(this->tree.at(0));
     }
 }
 
+void DecisionTree::update_flat_tree() {
+    this->depth = this->compute_depth();
+    this->flat_tree.clear();
+    this->class_dictionary.clear();
 
+    // A node is a split once both its children are inserted, else it is a leaf predicting its own class
+    auto is_split = [this](const TreeNode &node) {
+        return node.as_children() && node.get_feature_id() >= 0 && this->tree.count(node.get_left_children_id()) == 1 && this->tree.count(node.get_right_children_id()) == 1;
+    };
 
+    // Leaves class names are sorted so the class ids follow the alphabetical order
+    std::set<std::string> leaves_classes;
+    for (const auto &[node_id, node]: this->tree) {
+        if (!is_split(node)) {
+            leaves_classes.insert(node.get_class_name());
+        }
+    }
+    this->class_dictionary = ClassDictionary(std::vector<std::string>(leaves_classes.cbegin(), leaves_classes.cend()));
 
+    // Flat index of each node id (the map is sorted so the root node stays at index 0)
+    std::map<std::size_t, std::uint32_t> flat_ids;
+    for (const auto &[node_id, node]: this->tree) {
+        flat_ids.insert(std::make_pair(node_id, (std::uint32_t) flat_ids.size()));
+    }
 
-
-
-
-
+    this->flat_tree.reserve(this->tree.size());
+    for (const auto &[node_id, node]: this->tree) {
+        FlatTreeNode flat_node = {};
+        if (is_split(node)) {
+            flat_node.threshold = node.get_threshold();
+            flat_node.feature_id = node.get_feature_id();
+            flat_node.children_id[0] = flat_ids.at(node.get_left_children_id());
+            flat_node.children_id[1] = flat_ids.at(node.get_right_children_id());
+        } else {
+            flat_node.class_id = this->class_dictionary.get_class_id(node.get_class_name());
+            flat_node.children_id[0] = flat_ids.at(node_id);
+            flat_node.children_id[1] = flat_ids.at(node_id);
+        }
+        this->flat_tree.push_back(flat_node);
+    }
+}
@@ -1,11 +1,17 @@
 #ifndef DECISION_TREE_H
 #define DECISION_TREE_H
 
+#include <cstdint>
 #include <filesystem>
 #include <map>
+#include <memory>
+#include <span>
 #include <string>
+#include <vector>
 #include "machine_learning_model.h"
 #include "globals.h"
+#include "../helpers/model_arena.h"
+#include "../helpers/model_container.h"
 
 /*
  * TreeNode class definition
@@ -37,6 +43,18 @@ private:
 
 };
 
+/*
+ * FlatTreeNode struct definition
+ */
+// Node of the flattened tree used by the batch predictions
+// A leaf has both children pointing to itself so every traversal can run for a fixed number of steps
+struct FlatTreeNode {
+    real_t threshold;
+    std::uint32_t feature_id;
+    std::uint32_t children_id[2]; // [0] -> left (feature <= threshold), [1] -> right
+    std::uint32_t class_id;
+};
+
 /*
  * DecisionTree class definition
  */
@@ -46,11 +64,23 @@ class DecisionTree : public MachineLearningModel {
 public:
     DecisionTree();
 
-    const std::map<std::size_t, TreeNode> &get_tree() const;
+    // The nodes are allocated in the given arena, shared with the other trees of a forest
+    explicit DecisionTree(std::shared_ptr<ModelArena> arena);
 
-    std::size_t get_depth() const;
+    // The copy allocates its nodes in a new arena
+    DecisionTree(const DecisionTree &decision_tree);
+
+    DecisionTree(DecisionTree &&decision_tree) = default;
 
-    std::size_t get_depth();
+    DecisionTree &operator=(const DecisionTree &decision_tree) = default;
+
+    DecisionTree &operator=(DecisionTree &&decision_tree) = default;
+
+    const std::pmr::map<std::size_t, TreeNode> &get_tree() const;
+
+    const ModelArena &get_arena() const;
+
+    std::size_t get_depth() const;
 
     std::size_t get_number_of_nodes() const;
 
@@ -58,8 +88,12 @@ public:
 
     TreeNode get_node(std::size_t node_id) const;
 
+    // Estimation of the heap and object bytes used by the tree
+    std::size_t get_memory_footprint() const;
+
     friend std::ostream &operator<<(std::ostream &os, const DecisionTree &decision_tree);
 
+    // Each edit rebuilds the flattened tree, a node whose children are not inserted yet predicts its own class
     void insert_node(std::size_t node_id, const TreeNode &node);
 
     void remove_node(std::size_t node_id);
@@ -68,16 +102,56 @@ public:
 
     void fill_from_csv(const std::filesystem::path &csv_file_path) override;
 
-    std::string predict_class(const real_vector_t &features_vector) override;
+    // Write the tree using the same csv format as the one read by fill_from_csv
+    void write_to_csv(const std::filesystem::path &csv_file_path) const;
+
+    // Read the tree from a binary model container written by write_to_binary, the nodes are copied from the mapped file without parsing
+    void fill_from_binary(const std::filesystem::path &binary_file_path);
+
+    void write_to_binary(const std::filesystem::path &binary_file_path) const;
+
+    // Node records of the tree, the class names are replaced by their id in class_names (unknown ones are added)
+    std::vector<BinaryTreeNode> get_binary_nodes(ClassDictionary &class_names) const;
+
+    void fill_from_binary_nodes(std::span<const BinaryTreeNode> binary_nodes, const ClassDictionary &class_names);
+
+    // Leaves class names, sorted in alphabetical order
+    const ClassDictionary &get_class_dictionary() const override;
+
+    // Flattened nodes used by the predictions, the root node first and the leaf class ids indexing get_class_dictionary()
+    const std::vector<FlatTreeNode> &get_flat_tree() const;
+
+    // Features tested by the inner nodes
+    std::vector<std::size_t> get_used_features() const override;
+
+    std::size_t predict_class_id(const real_vector_t &features_vector) const override;
+
+    std::vector<std::size_t> predict_class_ids(const std::vector<real_vector_t> &features_vectors) const override;
+
+    // Write in class_ids the leaf class id of features_vectors[first] to features_vectors[first + count - 1]
+    void predict_class_ids(const std::vector<real_vector_t> &features_vectors, std::size_t first, std::size_t count, std::uint32_t *class_ids) const;
+
+    // Number of samples walking down the tree together to hide the memory latency of each other
+    static constexpr std::size_t INTERLEAVED_SAMPLES = 8;
 
 private:
-    std::map<std::size_t, TreeNode> tree;
+    // Declared first so the arena outlives the nodes allocated from it
+    ModelArenaReference arena;
+    std::pmr::map<std::size_t, TreeNode> tree;
     std::size_t depth;
     std::size_t number_of_nodes;
     int max_feature_id;
-    bool depth_up_to_date;
+    // Derived from the nodes after every edit so the predictions only read them
+    std::vector<FlatTreeNode> flat_tree;
+    ClassDictionary class_dictionary;
+
+    // Insert a node without rebuilding the flattened tree, the loaders rebuild it once all their nodes are inserted
+    void add_node(std::size_t node_id, const TreeNode &node);
 
     std::size_t compute_depth() const;
+
+    // Rebuild the depth, the class dictionary and the flattened tree from the nodes
+    void update_flat_tree();
 };
 
 #endif //DECISION_TREE_H
@@ -0,0 +1,329 @@
+#include "decision_tree_trainer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include "../helpers/log.h"
+
+// Impurity of a node weighted by its number of samples, n.I(node), so the impurity of a split is the sum of its children
+// ones. It only depends on the node size and on the sum over the classes of count_term(class count), which a split
+// search updates class by class when samples move from a children to the other
+static real_t count_term(std::uint32_t count, SplitCriterion criterion, const real_vector_t &count_log_counts) {
+    // Gini: sum(c²), entropy: sum(c.ln(c))
+    return criterion == SplitCriterion::GINI ? (real_t) count * (real_t) count : count_log_counts[count];
+}
+
+static real_t weighted_impurity(std::size_t node_size, real_t count_terms_sum, SplitCriterion criterion, const real_vector_t &count_log_counts) {
+    if (criterion == SplitCriterion::GINI) {
+        // n.(1 - sum((c/n)²)) = n - sum(c²)/n
+        return (real_t) node_size - count_terms_sum / (real_t) node_size;
+    } else {
+        // -n.sum(c/n.log2(c/n)) = (n.ln(n) - sum(c.ln(c))) / ln(2)
+        return (count_log_counts[node_size] - count_terms_sum) / std::log(2.0);
+    }
+}
+
+/*
+ * DecisionTreeTrainer class definition
+ */
+
+/* PUBLIC DEFINITION */
+DecisionTreeTrainer::DecisionTreeTrainer(const std::vector<std::pair<std::string, real_vector_t>> &training_set, std::size_t number_of_bins, ThreadPool *thread_pool) : thread_pool(thread_pool) {
+    if (training_set.empty()) {
+        LOG(LOG_ERROR) << "Error : trying to train a decision tree on an empty training set";
+        throw std::invalid_argument("Empty training set!");
+    }
+    if (number_of_bins < 2 || number_of_bins > MAX_NUMBER_OF_BINS) {
+        LOG(LOG_ERROR) << "Error : the number of bins must be between 2 and " << MAX_NUMBER_OF_BINS << " (" << number_of_bins << ")";
+        throw std::invalid_argument("Bad number of bins!");
+    }
+    this->number_of_samples = training_set.size();
+    this->number_of_features = training_set.front().second.size();
+    for (const std::pair<std::string, real_vector_t> &sample: training_set) {
+        if (sample.second.size() != this->number_of_features) {
+            LOG(LOG_ERROR) << "Error : the features vectors of the training set do not have the same size (" << sample.second.size() << " != " << this->number_of_features << ")";
+            throw std::invalid_argument("Features vectors of different sizes!");
+        }
+    }
+
+    // Class ids follow the alphabetical order, like the class names of sklearn
+    std::set<std::string> class_names;
+    for (const std::pair<std::string, real_vector_t> &sample: training_set) {
+        class_names.insert(sample.first);
+    }
+    this->class_dictionary = ClassDictionary(std::vector<std::string>(class_names.cbegin(), class_names.cend()));
+    this->count_log_counts.resize(this->number_of_samples + 1, 0);
+    for (std::size_t count = 1; count <= this->number_of_samples; count++) {
+        this->count_log_counts[count] = (real_t) count * std::log((real_t) count);
+    }
+    this->sample_class_ids.reserve(this->number_of_samples);
+    for (const std::pair<std::string, real_vector_t> &sample: training_set) {
+        this->sample_class_ids.push_back((std::uint32_t) this->class_dictionary.get_class_id(sample.first));
+    }
+
+    // The features are binned independently of each other
+    this->bins.resize(this->number_of_features * this->number_of_samples);
+    this->bin_thresholds.resize(this->number_of_features);
+    auto bin_feature_task = [this, &training_set, number_of_bins](std::size_t feature_id) {
+        this->bin_feature(training_set, feature_id, number_of_bins);
+    };
+    if (this->thread_pool == nullptr) {
+        for (std::size_t feature_id = 0; feature_id < this->number_of_features; feature_id++) {
+            bin_feature_task(feature_id);
+        }
+    } else {
+        this->thread_pool->parallel_for(this->number_of_features, bin_feature_task);
+    }
+}
+
+std::size_t DecisionTreeTrainer::get_number_of_samples() const {
+    return this->number_of_samples;
+}
+
+std::size_t DecisionTreeTrainer::get_number_of_features() const {
+    return this->number_of_features;
+}
+
+const ClassDictionary &DecisionTreeTrainer::get_class_dictionary() const {
+    return this->class_dictionary;
+}
+
+DecisionTree DecisionTreeTrainer::train(const DecisionTreeTrainingParameters &parameters) const {
+    std::vector<std::size_t> sample_ids(this->number_of_samples);
+    for (std::size_t sample_id = 0; sample_id < this->number_of_samples; sample_id++) {
+        sample_ids[sample_id] = sample_id;
+    }
+    return this->train(parameters, std::move(sample_ids));
+}
+
+DecisionTree DecisionTreeTrainer::train(const DecisionTreeTrainingParameters &parameters, std::vector<std::size_t> sample_ids) const {
+    if (sample_ids.empty()) {
+        LOG(LOG_ERROR) << "Error : trying to train a decision tree without any training sample";
+        throw std::invalid_argument("Empty training set!");
+    }
+    for (std::size_t sample_id: sample_ids) {
+        if (sample_id >= this->number_of_samples) {
+            LOG(LOG_ERROR) << "Error : the training sample id " << sample_id << " is out of the training set (" << this->number_of_samples << " samples)";
+            throw std::out_of_range("Unknown training sample!");
+        }
+    }
+
+    // Node of the tree still to create, its samples are sample_ids[first, last)
+    struct PendingNode {
+        std::size_t first;
+        std::size_t last;
+        std::size_t depth;
+        long parent_node_id;
+        bool is_right_children;
+    };
+
+    // The nodes are created in depth first order, left children first, so the node ids follow the sklearn ones
+    const std::size_t number_of_classes = this->class_dictionary.size();
+    const std::size_t number_of_chunks = (this->number_of_features + FEATURES_CHUNK_SIZE - 1) / FEATURES_CHUNK_SIZE;
+    std::vector<BinaryTreeNode> nodes;
+    std::vector<PendingNode> pending_nodes = {{0, sample_ids.size(), 0, -1, false}};
+    std::vector<std::uint32_t> class_counts(number_of_classes);
+    std::vector<Split> chunk_splits(number_of_chunks);
+    while (!pending_nodes.empty()) {
+        const PendingNode pending_node = pending_nodes.back();
+        pending_nodes.pop_back();
+        const std::size_t node_size = pending_node.last - pending_node.first;
+        const std::size_t *node_sample_ids = sample_ids.data() + pending_node.first;
+
+        // A node predicts its majority class, the first one in case of tie
+        std::fill(class_counts.begin(), class_counts.end(), 0);
+        for (std::size_t i = 0; i < node_size; i++) {
+            class_counts[this->sample_class_ids[node_sample_ids[i]]] += 1;
+        }
+        const auto class_id = (std::size_t) std::distance(class_counts.cbegin(), std::max_element(class_counts.cbegin(), class_counts.cend()));
+
+        // Leaves are written like the sklearn ones: no feature, no threshold and no children
+        BinaryTreeNode node = {};
+        node.node_id = nodes.size();
+        node.threshold = -2;
+        node.feature_id = -2;
+        node.left_children_id = -1;
+        node.right_children_id = -1;
+        node.class_id = (std::uint32_t) class_id;
+        if (pending_node.parent_node_id >= 0) {
+            if (pending_node.is_right_children) {
+                nodes[pending_node.parent_node_id].right_children_id = (std::int32_t) node.node_id;
+            } else {
+                nodes[pending_node.parent_node_id].left_children_id = (std::int32_t) node.node_id;
+            }
+        }
+
+        const bool can_split = class_counts[class_id] < node_size && node_size >= parameters.min_samples_split && node_size >= 2 * parameters.min_samples_leaf && (parameters.max_depth == 0 || pending_node.depth < parameters.max_depth);
+        Split best_split = {};
+        if (can_split) {
+            auto find_chunk_split = [this, &parameters, node_sample_ids, node_size, &chunk_splits](std::size_t chunk_i) {
+                chunk_splits[chunk_i] = this->find_best_split(parameters, node_sample_ids, node_size, chunk_i * FEATURES_CHUNK_SIZE, std::min((chunk_i + 1) * FEATURES_CHUNK_SIZE, this->number_of_features));
+            };
+            if (this->thread_pool == nullptr) {
+                for (std::size_t chunk_i = 0; chunk_i < number_of_chunks; chunk_i++) {
+                    find_chunk_split(chunk_i);
+                }
+            } else {
+                this->thread_pool->parallel_for(number_of_chunks, find_chunk_split);
+            }
+            // Chunks are reduced in feature order so ties always go to the smallest feature id
+            for (const Split &chunk_split: chunk_splits) {
+                if (chunk_split.feature_id >= 0 && (best_split.feature_id < 0 || chunk_split.children_impurity < best_split.children_impurity)) {
+                    best_split = chunk_split;
+                }
+            }
+        }
+
+        if (best_split.feature_id >= 0) {
+            node.threshold = this->bin_thresholds[best_split.feature_id][best_split.bin];
+            node.feature_id = best_split.feature_id;
+            // Samples whose bin is at most the split bin go to the left children, i.e. feature <= threshold
+            const std::uint8_t *feature_bins = this->bins.data() + (std::size_t) best_split.feature_id * this->number_of_samples;
+            auto middle = std::stable_partition(sample_ids.begin() + (long) pending_node.first, sample_ids.begin() + (long) pending_node.last, [feature_bins, &best_split](std::size_t sample_id) {
+                return feature_bins[sample_id] <= best_split.bin;
+            });
+            const auto middle_i = (std::size_t) std::distance(sample_ids.begin(), middle);
+            pending_nodes.push_back({middle_i, pending_node.last, pending_node.depth + 1, (long) node.node_id, true});
+            pending_nodes.push_back({pending_node.first, middle_i, pending_node.depth + 1, (long) node.node_id, false});
+        }
+        nodes.push_back(node);
+    }
+
+    // All the nodes are known, the flattened tree is built once
+    DecisionTree decision_tree;
+    decision_tree.fill_from_binary_nodes(nodes, this->class_dictionary);
+    return decision_tree;
+}
+
+/* PRIVATE DEFINITION */
+void DecisionTreeTrainer::bin_feature(const std::vector<std::pair<std::string, real_vector_t>> &training_set, std::size_t feature_id, std::size_t number_of_bins) {
+    real_vector_t sorted_values(this->number_of_samples);
+    for (std::size_t sample_id = 0; sample_id < this->number_of_samples; sample_id++) {
+        sorted_values[sample_id] = training_set[sample_id].second[feature_id];
+    }
+    std::sort(sorted_values.begin(), sorted_values.end());
+    real_vector_t distinct_values;
+    std::unique_copy(sorted_values.cbegin(), sorted_values.cend(), std::back_inserter(distinct_values));
+
+    // Largest training value of each bin, one bin per distinct value when there are few of them, else quantiles
+    real_vector_t bin_upper_values;
+    if (distinct_values.size() <= number_of_bins) {
+        bin_upper_values = distinct_values;
+    } else {
+        for (std::size_t bin = 1; bin <= number_of_bins; bin++) {
+            const real_t upper_value = sorted_values[bin * this->number_of_samples / number_of_bins - 1];
+            // Values repeated over several quantiles stay in a single bin
+            if (bin_upper_values.empty() || upper_value > bin_upper_values.back()) {
+                bin_upper_values.push_back(upper_value);
+            }
+        }
+    }
+
+    // The threshold after a bin is halfway to the next training value, like sklearn (unless rounding reaches the next value)
+    real_vector_t &thresholds = this->bin_thresholds[feature_id];
+    thresholds.clear();
+    for (std::size_t bin = 0; bin + 1 < bin_upper_values.size(); bin++) {
+        const real_t next_value = *std::upper_bound(distinct_values.cbegin(), distinct_values.cend(), bin_upper_values[bin]);
+        real_t threshold = (bin_upper_values[bin] + next_value) / 2;
+        if (threshold == next_value) {
+            threshold = bin_upper_values[bin];
+        }
+        thresholds.push_back(threshold);
+    }
+
+    std::uint8_t *feature_bins = this->bins.data() + feature_id * this->number_of_samples;
+    for (std::size_t sample_id = 0; sample_id < this->number_of_samples; sample_id++) {
+        const real_t value = training_set[sample_id].second[feature_id];
+        feature_bins[sample_id] = (std::uint8_t) std::distance(bin_upper_values.cbegin(), std::lower_bound(bin_upper_values.cbegin(), bin_upper_values.cend(), value));
+    }
+}
+
+DecisionTreeTrainer::Split DecisionTreeTrainer::find_best_split(const DecisionTreeTrainingParameters &parameters, const std::size_t *node_sample_ids, std::size_t node_size, std::size_t first_feature_id, std::size_t last_feature_id) const {
+    const std::size_t number_of_classes = this->class_dictionary.size();
+    std::vector<std::uint32_t> node_class_counts(number_of_classes, 0);
+    for (std::size_t i = 0; i < node_size; i++) {
+        node_class_counts[this->sample_class_ids[node_sample_ids[i]]] += 1;
+    }
+    // A split must decrease the impurity of the node, the tolerance absorbs the rounding of equivalent splits
+    real_t node_count_terms_sum = 0;
+    for (std::uint32_t class_count: node_class_counts) {
+        node_count_terms_sum += count_term(class_count, parameters.criterion, this->count_log_counts);
+    }
+    const real_t node_impurity = weighted_impurity(node_size, node_count_terms_sum, parameters.criterion, this->count_log_counts);
+    const real_t impurity_tolerance = 1e-9 * (real_t) node_size;
+
+    // Class ids of the node samples sorted by bin (counting sort), only the bins holding samples are visited and cleared
+    // so small nodes do not pay for all the bins
+    std::vector<std::uint32_t> bin_sizes(MAX_NUMBER_OF_BINS, 0);
+    std::vector<std::uint32_t> bin_ends(MAX_NUMBER_OF_BINS, 0);
+    std::vector<std::uint8_t> used_bins;
+    used_bins.reserve(MAX_NUMBER_OF_BINS);
+    std::vector<std::uint32_t> sorted_class_ids(node_size);
+    std::vector<std::uint32_t> left_class_counts(number_of_classes);
+    std::vector<std::uint32_t> right_class_counts(number_of_classes);
+
+    Split best_split = {};
+    for (std::size_t feature_id = first_feature_id; feature_id < last_feature_id; feature_id++) {
+        const std::uint8_t *feature_bins = this->bins.data() + feature_id * this->number_of_samples;
+        used_bins.clear();
+        for (std::size_t i = 0; i < node_size; i++) {
+            const std::uint8_t bin = feature_bins[node_sample_ids[i]];
+            if (bin_sizes[bin]++ == 0) {
+                used_bins.push_back(bin);
+            }
+        }
+        // Large nodes use most of the bins, reading them in order is cheaper than sorting them
+        if (used_bins.size() * 8 > MAX_NUMBER_OF_BINS) {
+            used_bins.clear();
+            for (std::size_t bin = 0; bin < MAX_NUMBER_OF_BINS; bin++) {
+                if (bin_sizes[bin] > 0) {
+                    used_bins.push_back((std::uint8_t) bin);
+                }
+            }
+        } else {
+            std::sort(used_bins.begin(), used_bins.end());
+        }
+        std::uint32_t bin_first = 0;
+        for (std::uint8_t bin: used_bins) {
+            bin_ends[bin] = bin_first;
+            bin_first += bin_sizes[bin];
+        }
+        for (std::size_t i = 0; i < node_size; i++) {
+            sorted_class_ids[bin_ends[feature_bins[node_sample_ids[i]]]++] = this->sample_class_ids[node_sample_ids[i]];
+        }
+
+        // Move the samples bin by bin from the right children to the left one, a split is possible after each bin
+        std::fill(left_class_counts.begin(), left_class_counts.end(), 0);
+        std::copy(node_class_counts.cbegin(), node_class_counts.cend(), right_class_counts.begin());
+        real_t left_count_terms_sum = 0;
+        real_t right_count_terms_sum = node_count_terms_sum;
+        std::size_t left_size = 0;
+        for (std::size_t used_bin_i = 0; used_bin_i + 1 < used_bins.size(); used_bin_i++) {
+            const std::uint8_t bin = used_bins[used_bin_i];
+            for (; left_size < bin_ends[bin]; left_size++) {
+                const std::uint32_t class_id = sorted_class_ids[left_size];
+                left_count_terms_sum += count_term(left_class_counts[class_id] + 1, parameters.criterion, this->count_log_counts) - count_term(left_class_counts[class_id], parameters.criterion, this->count_log_counts);
+                right_count_terms_sum += count_term(right_class_counts[class_id] - 1, parameters.criterion, this->count_log_counts) - count_term(right_class_counts[class_id], parameters.criterion, this->count_log_counts);
+                left_class_counts[class_id] += 1;
+                right_class_counts[class_id] -= 1;
+            }
+            if (left_size < parameters.min_samples_leaf) {
+                continue;
+            }
+            if (node_size - left_size < parameters.min_samples_leaf) {
+                break;
+            }
+            const real_t children_impurity = weighted_impurity(left_size, left_count_terms_sum, parameters.criterion, this->count_log_counts) + weighted_impurity(node_size - left_size, right_count_terms_sum, parameters.criterion, this->count_log_counts);
+            if (children_impurity < node_impurity - impurity_tolerance && (best_split.feature_id < 0 || children_impurity < best_split.children_impurity)) {
+                best_split.feature_id = (int) feature_id;
+                best_split.bin = bin;
+                best_split.children_impurity = children_impurity;
+            }
+        }
+
+        for (std::uint8_t bin: used_bins) {
+            bin_sizes[bin] = 0;
+        }
+    }
+    return best_split;
+}
@@ -0,0 +1,88 @@
+#ifndef DECISION_TREE_TRAINER_H
+#define DECISION_TREE_TRAINER_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "decision_tree.h"
+#include "globals.h"
+#include "../helpers/class_dictionary.h"
+#include "../helpers/thread_pool.h"
+
+/** @brief impurity measures used to choose the splits */
+enum class SplitCriterion : std::size_t {
+    GINI = 0, /** Gini impurity, 1 - sum(p²) */
+    ENTROPY = 1 /** Shannon entropy, -sum(p.log2(p)) */
+};
+
+/*
+ * DecisionTreeTrainingParameters struct definition
+ */
+// Same meaning as the parameters of the sklearn DecisionTreeClassifier used by the training notebooks
+struct DecisionTreeTrainingParameters {
+    SplitCriterion criterion = SplitCriterion::GINI;
+    // 0 -> the nodes are split until their leaves are pure
+    std::size_t max_depth = 0;
+    std::size_t min_samples_split = 2;
+    std::size_t min_samples_leaf = 1;
+};
+
+/*
+ * DecisionTreeTrainer class definition
+ */
+// CART trainer working on pre-binned features: each feature of the training set is replaced once by the index of its
+// quantile bin, so the best split of a node is found from per bin class counts instead of sorting the node samples.
+// The features are searched in parallel on the thread pool, the chosen split does not depend on the number of threads
+class DecisionTreeTrainer {
+public:
+    // Bin indices are stored on one byte
+    static constexpr std::size_t MAX_NUMBER_OF_BINS = 256;
+
+    // Number of features searched by one task of the thread pool, large enough to amortize the task dispatch
+    static constexpr std::size_t FEATURES_CHUNK_SIZE = 16;
+
+    // Bin every feature of the training set, a feature with at most number_of_bins distinct values keeps one bin per
+    // value (exact splits like sklearn). The thread pool, if any, is used by the binning and by every training
+    explicit DecisionTreeTrainer(const std::vector<std::pair<std::string, real_vector_t>> &training_set, std::size_t number_of_bins = MAX_NUMBER_OF_BINS, ThreadPool *thread_pool = nullptr);
+
+    std::size_t get_number_of_samples() const;
+
+    std::size_t get_number_of_features() const;
+
+    // Class names of the training set, sorted in alphabetical order
+    const ClassDictionary &get_class_dictionary() const;
+
+    // Grow a tree on all the training samples
+    DecisionTree train(const DecisionTreeTrainingParameters &parameters) const;
+
+    // Grow a tree on the given training samples only (e.g. the folds of a cross validation)
+    DecisionTree train(const DecisionTreeTrainingParameters &parameters, std::vector<std::size_t> sample_ids) const;
+
+private:
+    // Best split of a node for a range of features, feature_id = -1 if no split decreases the impurity
+    struct Split {
+        int feature_id = -1;
+        std::size_t bin = 0;
+        real_t children_impurity = 0;
+    };
+
+    std::size_t number_of_samples;
+    std::size_t number_of_features;
+    ClassDictionary class_dictionary;
+    std::vector<std::uint32_t> sample_class_ids;
+    // c.ln(c) for every class count c of a node, used by the entropy
+    real_vector_t count_log_counts;
+    // Bin of each sample for each feature, feature major: bins[feature_id * number_of_samples + sample_id]
+    std::vector<std::uint8_t> bins;
+    // Threshold separating the bin b from the bin b+1 of each feature, halfway between their training values
+    std::vector<real_vector_t> bin_thresholds;
+    ThreadPool *thread_pool;
+
+    void bin_feature(const std::vector<std::pair<std::string, real_vector_t>> &training_set, std::size_t feature_id, std::size_t number_of_bins);
+
+    // Best split of the node samples over the features [first_feature_id, last_feature_id)
+    Split find_best_split(const DecisionTreeTrainingParameters &parameters, const std::size_t *node_sample_ids, std::size_t node_size, std::size_t first_feature_id, std::size_t last_feature_id) const;
+};
+
+#endif //DECISION_TREE_TRAINER_H
@@ -0,0 +1,251 @@
+#ifndef EMBEDDED_MODELS_H
+#define EMBEDDED_MODELS_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include "decision_tree.h"
+#include "artificial_neural_network.h"
+#include "globals.h"
+#include "../helpers/simd.h"
+
+/*
+ * EmbeddedDecisionTree class definition
+ */
+// Decision tree evaluated from constexpr tables generated by EMBEDDED_MODEL_GENERATOR, the flattened nodes of DecisionTree
+// with the root node first. The tables are compiled in the read-only data of the binary, nothing is parsed or allocated
+template<std::size_t NumberOfFeatures, std::size_t NumberOfClasses>
+class EmbeddedDecisionTree {
+public:
+    static constexpr std::size_t NUMBER_OF_FEATURES = NumberOfFeatures;
+    static constexpr std::size_t NUMBER_OF_CLASSES = NumberOfClasses;
+
+    constexpr EmbeddedDecisionTree(std::span<const FlatTreeNode> nodes, std::span<const std::string_view, NumberOfClasses> class_names) : nodes(nodes), class_names(class_names) {}
+
+    // Every child, feature and class id of the tables is in range, checked by a static_assert in the generated header
+    constexpr bool is_valid() const {
+        return !this->nodes.empty() && std::all_of(this->nodes.begin(), this->nodes.end(), [this](const FlatTreeNode &node) {
+            return node.feature_id < NUMBER_OF_FEATURES && node.children_id[0] < this->nodes.size() && node.children_id[1] < this->nodes.size() && node.class_id < NUMBER_OF_CLASSES;
+        });
+    }
+
+    // Bytes of the tables in the read-only data of the binary
+    constexpr std::size_t get_memory_footprint() const {
+        return this->nodes.size_bytes() + this->class_names.size_bytes();
+    }
+
+    constexpr std::string_view get_class_name(std::size_t class_id) const {
+        return this->class_names[class_id];
+    }
+
+    // A leaf is the only node looping on itself
+    std::size_t predict_class_id(std::span<const real_t, NUMBER_OF_FEATURES> features_vector) const {
+        std::uint32_t current_node_id = 0;
+        std::uint32_t next_node_id = 0;
+        do {
+            current_node_id = next_node_id;
+            const FlatTreeNode &node = this->nodes[current_node_id];
+            next_node_id = node.children_id[!(features_vector[node.feature_id] <= node.threshold)];
+        } while (next_node_id != current_node_id);
+        return this->nodes[current_node_id].class_id;
+    }
+
+private:
+    std::span<const FlatTreeNode> nodes;
+    std::span<const std::string_view, NumberOfClasses> class_names;
+};
+
+/*
+ * EmbeddedRandomForest class definition
+ */
+// Random forest evaluated from constexpr tables, the flattened nodes of all the trees one after the other and the index of
+// the root node of each tree. The leaf class ids are already forest class ids, so each tree votes without any remapping
+template<std::size_t NumberOfFeatures, std::size_t NumberOfClasses, std::size_t NumberOfTrees>
+class EmbeddedRandomForest {
+    static_assert(NumberOfClasses >= 1 && NumberOfClasses <= ClassDictionary::MAX_NUMBER_OF_CLASSES, "Unsupported number of classes");
+
+public:
+    static constexpr std::size_t NUMBER_OF_FEATURES = NumberOfFeatures;
+    static constexpr std::size_t NUMBER_OF_CLASSES = NumberOfClasses;
+    static constexpr std::size_t NUMBER_OF_TREES = NumberOfTrees;
+
+    constexpr EmbeddedRandomForest(std::span<const FlatTreeNode> nodes, std::span<const std::uint32_t, NumberOfTrees> roots_id, std::span<const std::string_view, NumberOfClasses> class_names) : nodes(nodes), roots_id(roots_id), class_names(class_names) {}
+
+    // Every root, child, feature and class id of the tables is in range, checked by a static_assert in the generated header
+    constexpr bool is_valid() const {
+        return std::all_of(this->roots_id.begin(), this->roots_id.end(), [this](std::uint32_t root_id) {
+            return root_id < this->nodes.size();
+        }) && std::all_of(this->nodes.begin(), this->nodes.end(), [this](const FlatTreeNode &node) {
+            return node.feature_id < NUMBER_OF_FEATURES && node.children_id[0] < this->nodes.size() && node.children_id[1] < this->nodes.size() && node.class_id < NUMBER_OF_CLASSES;
+        });
+    }
+
+    // Bytes of the tables in the read-only data of the binary
+    constexpr std::size_t get_memory_footprint() const {
+        return this->nodes.size_bytes() + this->roots_id.size_bytes() + this->class_names.size_bytes();
+    }
+
+    constexpr std::string_view get_class_name(std::size_t class_id) const {
+        return this->class_names[class_id];
+    }
+
+    // Ties go to the first class in alphabetical order, as RandomForest
+    std::size_t predict_class_id(std::span<const real_t, NUMBER_OF_FEATURES> features_vector) const {
+        std::array<std::size_t, NUMBER_OF_CLASSES> votes = {};
+        for (std::uint32_t root_id: this->roots_id) {
+            std::uint32_t current_node_id = root_id;
+            std::uint32_t next_node_id = root_id;
+            do {
+                current_node_id = next_node_id;
+                const FlatTreeNode &node = this->nodes[current_node_id];
+                next_node_id = node.children_id[!(features_vector[node.feature_id] <= node.threshold)];
+            } while (next_node_id != current_node_id);
+            votes[this->nodes[current_node_id].class_id] += 1;
+        }
+        return std::distance(votes.cbegin(), std::max_element(votes.cbegin(), votes.cend()));
+    }
+
+private:
+    std::span<const FlatTreeNode> nodes;
+    std::span<const std::uint32_t, NumberOfTrees> roots_id;
+    std::span<const std::string_view, NumberOfClasses> class_names;
+};
+
+/*
+ * EmbeddedOneVsOneSVM class definition
+ */
+// One vs one linear SVM evaluated from constexpr tables, the zero-padded coefficients of FixedOneVsOneSVM and the two class
+// ids of each classifier, the first one winning the vote on a positive decision value
+template<std::size_t NumberOfFeatures, std::size_t NumberOfClasses>
+class EmbeddedOneVsOneSVM {
+    static_assert(NumberOfClasses >= 2 && NumberOfClasses <= ClassDictionary::MAX_NUMBER_OF_CLASSES, "Unsupported number of classes");
+
+public:
+    static constexpr std::size_t NUMBER_OF_FEATURES = NumberOfFeatures;
+    static constexpr std::size_t NUMBER_OF_CLASSES = NumberOfClasses;
+    static constexpr std::size_t NUMBER_OF_CLASSIFIERS = NumberOfClasses * (NumberOfClasses - 1) / 2;
+    static constexpr std::size_t PADDED_NUMBER_OF_FEATURES = simd_padded_size(NumberOfFeatures);
+
+    constexpr EmbeddedOneVsOneSVM(std::span<const real_t, NUMBER_OF_CLASSIFIERS * PADDED_NUMBER_OF_FEATURES> coefficients, std::span<const real_t, NUMBER_OF_CLASSIFIERS> intercepts,
+                                  std::span<const std::uint32_t, NUMBER_OF_CLASSIFIERS * 2> classifiers_class_ids, std::span<const std::string_view, NumberOfClasses> class_names)
+            : coefficients(coefficients), intercepts(intercepts), classifiers_class_ids(classifiers_class_ids), class_names(class_names) {}
+
+    // Every class id of the tables is in range, checked by a static_assert in the generated header
+    constexpr bool is_valid() const {
+        return std::all_of(this->classifiers_class_ids.begin(), this->classifiers_class_ids.end(), [](std::uint32_t class_id) {
+            return class_id < NUMBER_OF_CLASSES;
+        });
+    }
+
+    // Bytes of the tables in the read-only data of the binary
+    constexpr std::size_t get_memory_footprint() const {
+        return this->coefficients.size_bytes() + this->intercepts.size_bytes() + this->classifiers_class_ids.size_bytes() + this->class_names.size_bytes();
+    }
+
+    constexpr std::string_view get_class_name(std::size_t class_id) const {
+        return this->class_names[class_id];
+    }
+
+    // Ties go to the first class in alphabetical order, as OneVsOneSVM
+    std::size_t predict_class_id(std::span<const real_t, NUMBER_OF_FEATURES> features_vector) const {
+        std::array<real_t, PADDED_NUMBER_OF_FEATURES> features = {};
+        std::copy(features_vector.begin(), features_vector.end(), features.begin());
+        std::array<real_t, NUMBER_OF_CLASSIFIERS> decision_values;
+        simd_gemv(this->coefficients.data(), NUMBER_OF_CLASSIFIERS, PADDED_NUMBER_OF_FEATURES, features.data(), this->intercepts.data(), decision_values.data());
+
+        std::array<std::size_t, NUMBER_OF_CLASSES> votes = {};
+        for (std::size_t classifier_i = 0; classifier_i < NUMBER_OF_CLASSIFIERS; classifier_i++) {
+            votes[this->classifiers_class_ids[classifier_i * 2 + (decision_values[classifier_i] > 0 ? 0 : 1)]] += 1;
+        }
+        return std::distance(votes.cbegin(), std::max_element(votes.cbegin(), votes.cend()));
+    }
+
+private:
+    // Row-major NUMBER_OF_CLASSIFIERS x PADDED_NUMBER_OF_FEATURES matrix
+    std::span<const real_t, NUMBER_OF_CLASSIFIERS * PADDED_NUMBER_OF_FEATURES> coefficients;
+    std::span<const real_t, NUMBER_OF_CLASSIFIERS> intercepts;
+    std::span<const std::uint32_t, NUMBER_OF_CLASSIFIERS * 2> classifiers_class_ids;
+    std::span<const std::string_view, NumberOfClasses> class_names;
+};
+
+/*
+ * EmbeddedDenseLayer struct definition
+ */
+// Dense layer of an EmbeddedArtificialNeuralNetwork, the row-major output_size x simd_padded_size(input_size) zero-padded
+// weights of DenseLayer
+struct EmbeddedDenseLayer {
+    std::size_t input_size;
+    std::size_t output_size;
+    std::span<const real_t> weights;
+    std::span<const real_t> biases;
+    ActivationFunction activation_function;
+};
+
+/*
+ * EmbeddedArtificialNeuralNetwork class definition
+ */
+// Neural network evaluated from constexpr tables, with compile-time layer sizes (input size, hidden layers sizes..., number
+// of classes) as FixedArtificialNeuralNetwork. The forward pass swaps two stack buffers sized for the widest layer
+template<std::size_t... LayerSizes>
+class EmbeddedArtificialNeuralNetwork {
+    static_assert(sizeof...(LayerSizes) >= 2, "A neural network needs at least an input size and an output layer");
+
+public:
+    static constexpr std::array<std::size_t, sizeof...(LayerSizes)> LAYER_SIZES = {LayerSizes...};
+    static constexpr std::size_t NUMBER_OF_LAYERS = sizeof...(LayerSizes) - 1;
+    static constexpr std::size_t INPUT_SIZE = LAYER_SIZES.front();
+    static constexpr std::size_t OUTPUT_SIZE = LAYER_SIZES.back();
+    static constexpr std::size_t NUMBER_OF_FEATURES = INPUT_SIZE;
+    static constexpr std::size_t MAX_PADDED_LAYER_SIZE = simd_padded_size(*std::max_element(LAYER_SIZES.begin(), LAYER_SIZES.end()));
+
+    constexpr EmbeddedArtificialNeuralNetwork(const std::array<EmbeddedDenseLayer, NUMBER_OF_LAYERS> &layers, std::span<const std::string_view, OUTPUT_SIZE> class_names) : layers(layers), class_names(class_names) {}
+
+    // The layers have the template sizes and their tables the matching sizes, checked by a static_assert in the generated header
+    constexpr bool is_valid() const {
+        for (std::size_t layer_i = 0; layer_i < NUMBER_OF_LAYERS; layer_i++) {
+            const EmbeddedDenseLayer &layer = this->layers[layer_i];
+            if (layer.input_size != LAYER_SIZES[layer_i] || layer.output_size != LAYER_SIZES[layer_i + 1] ||
+                layer.weights.size() != layer.output_size * simd_padded_size(layer.input_size) || layer.biases.size() != layer.output_size) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Bytes of the tables in the read-only data of the binary
+    constexpr std::size_t get_memory_footprint() const {
+        std::size_t memory_footprint = sizeof(this->layers) + this->class_names.size_bytes();
+        for (const EmbeddedDenseLayer &layer: this->layers) {
+            memory_footprint += layer.weights.size_bytes() + layer.biases.size_bytes();
+        }
+        return memory_footprint;
+    }
+
+    constexpr std::string_view get_class_name(std::size_t class_id) const {
+        return this->class_names[class_id];
+    }
+
+    std::size_t predict_class_id(std::span<const real_t, INPUT_SIZE> features_vector) const {
+        alignas(SIMD_ALIGNMENT) std::array<real_t, MAX_PADDED_LAYER_SIZE> first_buffer = {};
+        alignas(SIMD_ALIGNMENT) std::array<real_t, MAX_PADDED_LAYER_SIZE> second_buffer = {};
+        std::copy(features_vector.begin(), features_vector.end(), first_buffer.begin());
+        real_t *input = first_buffer.data();
+        real_t *output = second_buffer.data();
+        for (const EmbeddedDenseLayer &layer: this->layers) {
+            simd_gemv(layer.weights.data(), layer.output_size, simd_padded_size(layer.input_size), input, layer.biases.data(), output);
+            ArtificialNeuralNetwork::apply_activation_function(layer.activation_function, layer.output_size, output);
+            // The padding of the next input must be zeros, the buffer may hold the output of a wider layer
+            std::fill(output + layer.output_size, output + MAX_PADDED_LAYER_SIZE, 0);
+            std::swap(input, output);
+        }
+        return std::distance(input, std::max_element(input, input + OUTPUT_SIZE));
+    }
+
+private:
+    std::array<EmbeddedDenseLayer, NUMBER_OF_LAYERS> layers;
+    std::span<const std::string_view, OUTPUT_SIZE> class_names;
+};
+
+#endif //EMBEDDED_MODELS_H
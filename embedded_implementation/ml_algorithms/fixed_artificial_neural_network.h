@@ -0,0 +1,135 @@
+#ifndef FIXED_ARTIFICIAL_NEURAL_NETWORK_H
+#define FIXED_ARTIFICIAL_NEURAL_NETWORK_H
+
+#include <algorithm>
+#include <array>
+#include <span>
+#include <tuple>
+#include <utility>
+#include "artificial_neural_network.h"
+#include "machine_learning_model.h"
+#include "globals.h"
+#include "../helpers/log.h"
+
+/*
+ * FixedDenseLayer struct definition
+ */
+// Dense layer with compile-time sizes, the packed weights and the SIMD matrix-vector product of DenseLayer with constant
+// trip counts so the compiler fully unrolls the loops, input and output arrays are zero-padded to a whole number of SIMD vectors
+template<std::size_t InputSize, std::size_t OutputSize>
+struct FixedDenseLayer {
+    static constexpr std::size_t PADDED_INPUT_SIZE = simd_padded_size(InputSize);
+    static constexpr std::size_t PADDED_OUTPUT_SIZE = simd_padded_size(OutputSize);
+
+    // Row-major OutputSize x PADDED_INPUT_SIZE matrix
+    alignas(SIMD_ALIGNMENT) std::array<real_t, OutputSize * PADDED_INPUT_SIZE> weights = {};
+    alignas(SIMD_ALIGNMENT) std::array<real_t, OutputSize> biases = {};
+    ActivationFunction activation_function = ActivationFunction::RELU;
+
+    void load(const DenseLayer &dense_layer) {
+        if (dense_layer.input_size != InputSize || dense_layer.output_size != OutputSize) {
+            LOG(LOG_ERROR) << "Error : trying to load a " << dense_layer.input_size << " -> " << dense_layer.output_size << " layer in a fixed " << InputSize << " -> " << OutputSize << " layer";
+            throw std::invalid_argument("Layer sizes mismatch!");
+        }
+        for (std::size_t neuron_i = 0; neuron_i < OutputSize; neuron_i++) {
+            std::copy(dense_layer.weights.cbegin() + (long) (neuron_i * dense_layer.padded_input_size), dense_layer.weights.cbegin() + (long) (neuron_i * dense_layer.padded_input_size + InputSize), this->weights.begin() + (long) (neuron_i * PADDED_INPUT_SIZE));
+        }
+        std::copy(dense_layer.biases.cbegin(), dense_layer.biases.cend(), this->biases.begin());
+        this->activation_function = dense_layer.activation_function;
+    }
+
+    void compute(const std::array<real_t, PADDED_INPUT_SIZE> &input, std::array<real_t, PADDED_OUTPUT_SIZE> &output) const {
+        simd_gemv(this->weights.data(), OutputSize, PADDED_INPUT_SIZE, input.data(), this->biases.data(), output.data());
+        ArtificialNeuralNetwork::apply_activation_function(this->activation_function, OutputSize, output.data());
+        std::fill(output.begin() + OutputSize, output.end(), 0);
+    }
+};
+
+/*
+ * FixedArtificialNeuralNetwork class definition
+ */
+// Neural network with compile-time layer sizes (input size, hidden layers sizes..., number of classes), for instance
+// FixedArtificialNeuralNetwork<42, 28, 10>, the weights are loaded from an ArtificialNeuralNetwork of the same shape and
+// the forward pass keeps its activations on the stack. The weights live in the object, allocate big networks on the heap
+template<std::size_t... LayerSizes>
+class FixedArtificialNeuralNetwork : public MachineLearningModel {
+    static_assert(sizeof...(LayerSizes) >= 2, "A neural network needs at least an input size and an output layer");
+
+public:
+    static constexpr std::array<std::size_t, sizeof...(LayerSizes)> LAYER_SIZES = {LayerSizes...};
+    static constexpr std::size_t NUMBER_OF_LAYERS = sizeof...(LayerSizes) - 1;
+    static constexpr std::size_t INPUT_SIZE = LAYER_SIZES.front();
+    static constexpr std::size_t OUTPUT_SIZE = LAYER_SIZES.back();
+
+    FixedArtificialNeuralNetwork() = default;
+
+    // Copy the dense layers of the network, its shape must be the template one
+    void load(const ArtificialNeuralNetwork &artificial_neural_network) {
+        const std::vector<DenseLayer> &dense_layers = artificial_neural_network.get_dense_layers();
+        if (dense_layers.size() != NUMBER_OF_LAYERS) {
+            LOG(LOG_ERROR) << "Error : trying to load a neural network with " << dense_layers.size() << " layers in a fixed neural network with " << NUMBER_OF_LAYERS << " layers";
+            throw std::invalid_argument("Number of layers mismatch!");
+        }
+        this->load_layers(dense_layers, std::make_index_sequence<NUMBER_OF_LAYERS>());
+        this->class_dictionary = ClassDictionary(artificial_neural_network.get_classes());
+    }
+
+    std::size_t get_memory_footprint() const {
+        return sizeof(FixedArtificialNeuralNetwork);
+    }
+
+    void fill_from_csv(const std::filesystem::path &csv_folder_path) override {
+        ArtificialNeuralNetwork artificial_neural_network = {};
+        artificial_neural_network.fill_from_csv(csv_folder_path);
+        this->load(artificial_neural_network);
+    }
+
+    const ClassDictionary &get_class_dictionary() const override {
+        return class_dictionary;
+    }
+
+    // The size is checked once here, the fixed size overload runs without any check
+    std::size_t predict_class_id(const real_vector_t &features_vector) const override {
+        if (features_vector.size() != INPUT_SIZE) {
+            LOG(LOG_ERROR) << "Error : trying to make prediction but the feature vector size (" << features_vector.size() << ") is different from the input layer size (" << INPUT_SIZE << ")";
+            throw std::invalid_argument("Feature vector size differ from input layer size!");
+        }
+        return this->predict_class_id(std::span<const real_t, INPUT_SIZE>(features_vector.data(), INPUT_SIZE));
+    }
+
+    std::size_t predict_class_id(std::span<const real_t, INPUT_SIZE> features_vector) const {
+        std::array<real_t, simd_padded_size(INPUT_SIZE)> input;
+        std::copy(features_vector.begin(), features_vector.end(), input.begin());
+        std::fill(input.begin() + INPUT_SIZE, input.end(), 0);
+        std::array<real_t, simd_padded_size(OUTPUT_SIZE)> output;
+        this->forward<0>(input, output);
+        return std::distance(output.cbegin(), std::max_element(output.cbegin(), output.cbegin() + OUTPUT_SIZE));
+    }
+
+private:
+    // One FixedDenseLayer<LAYER_SIZES[i], LAYER_SIZES[i + 1]> per layer
+    template<std::size_t... LayerIndexes>
+    static auto make_layers(std::index_sequence<LayerIndexes...>) -> std::tuple<FixedDenseLayer<LAYER_SIZES[LayerIndexes], LAYER_SIZES[LayerIndexes + 1]>...>;
+
+    decltype(make_layers(std::make_index_sequence<NUMBER_OF_LAYERS>())) layers;
+    ClassDictionary class_dictionary;
+
+    template<std::size_t... LayerIndexes>
+    void load_layers(const std::vector<DenseLayer> &dense_layers, std::index_sequence<LayerIndexes...>) {
+        (std::get<LayerIndexes>(this->layers).load(dense_layers[LayerIndexes]), ...);
+    }
+
+    // Run the layers from LayerIndex to the output one, each hidden activation array lives in the stack frame of its layer
+    template<std::size_t LayerIndex>
+    void forward(const std::array<real_t, simd_padded_size(LAYER_SIZES[LayerIndex])> &input, std::array<real_t, simd_padded_size(OUTPUT_SIZE)> &output) const {
+        if constexpr (LayerIndex + 1 == NUMBER_OF_LAYERS) {
+            std::get<LayerIndex>(this->layers).compute(input, output);
+        } else {
+            std::array<real_t, simd_padded_size(LAYER_SIZES[LayerIndex + 1])> hidden;
+            std::get<LayerIndex>(this->layers).compute(input, hidden);
+            this->forward<LayerIndex + 1>(hidden, output);
+        }
+    }
+};
+
+#endif //FIXED_ARTIFICIAL_NEURAL_NETWORK_H
@@ -0,0 +1,20 @@
+// Generated by FIXED_MODEL_GENERATOR from the training CSV files, do not edit
+#ifndef FIXED_MODELS_H
+#define FIXED_MODELS_H
+
+#include "fixed_artificial_neural_network.h"
+#include "fixed_one_vs_one_svm.h"
+
+// artificial_neural_network_stft: 2 layers
+typedef FixedArtificialNeuralNetwork<512, 170, 10> FixedArtificialNeuralNetworkSTFT;
+
+// artificial_neural_network_mfcc: 2 layers
+typedef FixedArtificialNeuralNetwork<42, 28, 10> FixedArtificialNeuralNetworkMFCC;
+
+// support_vector_machine_stft.csv: 45 classifiers
+typedef FixedOneVsOneSVM<512, 10> FixedOneVsOneSVMSTFT;
+
+// support_vector_machine_mfcc.csv: 45 classifiers
+typedef FixedOneVsOneSVM<42, 10> FixedOneVsOneSVMMFCC;
+
+#endif //FIXED_MODELS_H
@@ -0,0 +1,96 @@
+#ifndef FIXED_ONE_VS_ONE_SVM_H
+#define FIXED_ONE_VS_ONE_SVM_H
+
+#include <algorithm>
+#include <array>
+#include <span>
+#include "one_vs_one_svm.h"
+#include "machine_learning_model.h"
+#include "globals.h"
+#include "../helpers/log.h"
+
+/*
+ * FixedOneVsOneSVM class definition
+ */
+// One vs one linear SVM with compile-time sizes, for instance FixedOneVsOneSVM<42, 10>, loaded from a OneVsOneSVM of the
+// same shape. The decision values come from the SIMD matrix-vector product of OneVsOneSVM with constant trip counts so the
+// compiler fully unrolls it, the prediction uses the max wins vote of OneVsOneSVM
+template<std::size_t NumberOfFeatures, std::size_t NumberOfClasses>
+class FixedOneVsOneSVM : public MachineLearningModel {
+    static_assert(NumberOfClasses >= 2 && NumberOfClasses <= ClassDictionary::MAX_NUMBER_OF_CLASSES, "Unsupported number of classes");
+
+public:
+    static constexpr std::size_t NUMBER_OF_FEATURES = NumberOfFeatures;
+    static constexpr std::size_t NUMBER_OF_CLASSES = NumberOfClasses;
+    static constexpr std::size_t NUMBER_OF_CLASSIFIERS = NumberOfClasses * (NumberOfClasses - 1) / 2;
+    static constexpr std::size_t PADDED_NUMBER_OF_FEATURES = simd_padded_size(NumberOfFeatures);
+
+    FixedOneVsOneSVM() = default;
+
+    // Copy the classifiers of the SVM, its shape must be the template one
+    void load(OneVsOneSVM &one_vs_one_svm) {
+        const std::pmr::vector<LinearClassifier> &classifiers = one_vs_one_svm.get_classifiers();
+        this->class_dictionary = one_vs_one_svm.get_class_dictionary();
+        if (this->class_dictionary.size() != NUMBER_OF_CLASSES || classifiers.size() != NUMBER_OF_CLASSIFIERS) {
+            LOG(LOG_ERROR) << "Error : trying to load a SVM with " << this->class_dictionary.size() << " classes and " << classifiers.size() << " classifiers in a fixed SVM with " << NUMBER_OF_CLASSES << " classes and " << NUMBER_OF_CLASSIFIERS << " classifiers";
+            throw std::invalid_argument("SVM shape mismatch!");
+        }
+        for (std::size_t classifier_i = 0; classifier_i < NUMBER_OF_CLASSIFIERS; classifier_i++) {
+            const LinearClassifier &linear_classifier = classifiers[classifier_i];
+            if (linear_classifier.get_coef_matrix().size() != NUMBER_OF_FEATURES) {
+                LOG(LOG_ERROR) << "Error : the classifier " << classifier_i << " has " << linear_classifier.get_coef_matrix().size() << " coefficients but the fixed SVM takes " << NUMBER_OF_FEATURES << " features";
+                throw std::invalid_argument("SVM shape mismatch!");
+            }
+            std::copy(linear_classifier.get_coef_matrix().cbegin(), linear_classifier.get_coef_matrix().cend(), this->coefficients.begin() + (long) (classifier_i * PADDED_NUMBER_OF_FEATURES));
+            this->intercepts[classifier_i] = linear_classifier.get_intercept();
+            this->classifiers_class_ids[classifier_i] = {this->class_dictionary.get_class_id(linear_classifier.get_lower_class()),
+                                                         this->class_dictionary.get_class_id(linear_classifier.get_upper_class())};
+        }
+    }
+
+    std::size_t get_memory_footprint() const {
+        return sizeof(FixedOneVsOneSVM);
+    }
+
+    void fill_from_csv(const std::filesystem::path &csv_file_path) override {
+        OneVsOneSVM one_vs_one_svm = {};
+        one_vs_one_svm.fill_from_csv(csv_file_path);
+        this->load(one_vs_one_svm);
+    }
+
+    const ClassDictionary &get_class_dictionary() const override {
+        return class_dictionary;
+    }
+
+    // The size is checked once here, the fixed size overload runs without any check
+    std::size_t predict_class_id(const real_vector_t &features_vector) const override {
+        if (features_vector.size() != NUMBER_OF_FEATURES) {
+            LOG(LOG_ERROR) << "Error : trying to make prediction but the feature vector size (" << features_vector.size() << ") is different from the coefficient matrix size (" << NUMBER_OF_FEATURES << ")";
+            throw std::invalid_argument("Feature vector size differ from coefficient matrix size!");
+        }
+        return this->predict_class_id(std::span<const real_t, NUMBER_OF_FEATURES>(features_vector.data(), NUMBER_OF_FEATURES));
+    }
+
+    std::size_t predict_class_id(std::span<const real_t, NUMBER_OF_FEATURES> features_vector) const {
+        std::array<real_t, PADDED_NUMBER_OF_FEATURES> features = {};
+        std::copy(features_vector.begin(), features_vector.end(), features.begin());
+        std::array<real_t, NUMBER_OF_CLASSIFIERS> decision_values;
+        simd_gemv(this->coefficients.data(), NUMBER_OF_CLASSIFIERS, PADDED_NUMBER_OF_FEATURES, features.data(), this->intercepts.data(), decision_values.data());
+
+        // Ties go to the first class in alphabetical order
+        std::array<std::size_t, NUMBER_OF_CLASSES> votes = {};
+        for (std::size_t classifier_i = 0; classifier_i < NUMBER_OF_CLASSIFIERS; classifier_i++) {
+            votes[decision_values[classifier_i] > 0 ? this->classifiers_class_ids[classifier_i].first : this->classifiers_class_ids[classifier_i].second] += 1;
+        }
+        return std::distance(votes.cbegin(), std::max_element(votes.cbegin(), votes.cend()));
+    }
+
+private:
+    // Row-major NUMBER_OF_CLASSIFIERS x PADDED_NUMBER_OF_FEATURES matrix
+    alignas(SIMD_ALIGNMENT) std::array<real_t, NUMBER_OF_CLASSIFIERS * PADDED_NUMBER_OF_FEATURES> coefficients = {};
+    alignas(SIMD_ALIGNMENT) std::array<real_t, NUMBER_OF_CLASSIFIERS> intercepts = {};
+    std::array<std::pair<std::size_t, std::size_t>, NUMBER_OF_CLASSIFIERS> classifiers_class_ids = {};
+    ClassDictionary class_dictionary;
+};
+
+#endif //FIXED_ONE_VS_ONE_SVM_H
@@ -0,0 +1,370 @@
+#include "kernel_one_vs_one_svm.h"
+#include <fstream>
+#include <set>
+#include <array>
+#include <cmath>
+#include <execution>
+
+/*
+ * KernelOneVsOneSVM class definition
+ */
+
+/* PUBLIC DEFINITION */
+KernelOneVsOneSVM::KernelOneVsOneSVM() {
+    this->clear();
+}
+
+KernelFunction KernelOneVsOneSVM::get_kernel_function() const {
+    return kernel_function;
+}
+
+real_t KernelOneVsOneSVM::get_gamma() const {
+    return gamma;
+}
+
+real_t KernelOneVsOneSVM::get_coef0() const {
+    return coef0;
+}
+
+real_t KernelOneVsOneSVM::get_degree() const {
+    return degree;
+}
+
+std::size_t KernelOneVsOneSVM::get_number_of_support_vectors() const {
+    return number_of_support_vectors;
+}
+
+std::size_t KernelOneVsOneSVM::get_number_of_features() const {
+    return number_of_features;
+}
+
+std::size_t KernelOneVsOneSVM::get_number_of_classifiers() const {
+    return classifiers_class_ids.size();
+}
+
+std::ostream &operator<<(std::ostream &os, const KernelOneVsOneSVM &kernel_one_vs_one_svm) {
+    os << "One Vs One kernel SVM (kernel ";
+    switch (kernel_one_vs_one_svm.get_kernel_function()) {
+        case KernelFunction::LINEAR : {
+            os << "LINEAR";
+            break;
+        }
+        case KernelFunction::POLYNOMIAL : {
+            os << "POLYNOMIAL";
+            break;
+        }
+        case KernelFunction::RBF : {
+            os << "RBF";
+            break;
+        }
+        case KernelFunction::SIGMOID : {
+            os << "SIGMOID";
+            break;
+        }
+        default: {
+            os << "UNKNOWN";
+            break;
+        }
+    }
+    return os << ", gamma: " << kernel_one_vs_one_svm.get_gamma() << ", coef0: " << kernel_one_vs_one_svm.get_coef0() << ", degree: " << kernel_one_vs_one_svm.get_degree()
+              << ", support vectors: " << kernel_one_vs_one_svm.get_number_of_support_vectors() << ", features: " << kernel_one_vs_one_svm.get_number_of_features()
+              << ", classifiers: " << kernel_one_vs_one_svm.get_number_of_classifiers() << ")";
+}
+
+void KernelOneVsOneSVM::clear() {
+    this->kernel_function = KernelFunction::RBF;
+    this->gamma = 1;
+    this->coef0 = 0;
+    this->degree = 3;
+    this->class_dictionary.clear();
+    this->classifiers_class_ids.clear();
+    this->number_of_features = 0;
+    this->padded_number_of_features = 0;
+    this->number_of_support_vectors = 0;
+    this->padded_number_of_support_vectors = 0;
+    this->support_vectors.clear();
+    this->support_vectors_squared_norm.clear();
+    this->dual_coefficients.clear();
+    this->intercepts.clear();
+}
+
+void KernelOneVsOneSVM::fill_from_csv(const std::filesystem::path &csv_folder_path) {
+    this->clear();
+    this->read_kernel_csv(csv_folder_path / KERNEL_CSV);
+    this->read_support_vectors_csv(csv_folder_path / SUPPORT_VECTORS_CSV);
+    this->read_dual_coefficients_csv(csv_folder_path / DUAL_COEFFICIENTS_CSV);
+}
+
+const ClassDictionary &KernelOneVsOneSVM::get_class_dictionary() const {
+    return class_dictionary;
+}
+
+std::size_t KernelOneVsOneSVM::predict_class_id(const real_vector_t &features_vector) const {
+    return this->predict_class_id(features_vector, InferenceContext::get_thread_context());
+}
+
+std::size_t KernelOneVsOneSVM::predict_class_id(const real_vector_t &features_vector, InferenceContext &context) const {
+    if (this->class_dictionary.empty()) {
+        LOG(LOG_ERROR) << "Error : trying to make prediction but the SVM does not have any classifier";
+        throw std::invalid_argument("SVM does not have any classifier!");
+    }
+    if (features_vector.size() != this->number_of_features) {
+        LOG(LOG_ERROR) << "Error : trying to make prediction but the feature vector size (" << features_vector.size() << ") is different from the support vectors size (" << this->number_of_features << ")";
+        throw std::invalid_argument("Feature vector size differ from support vectors size!");
+    }
+
+    // The padding of the context buffers may hold the values of another model, it is cleared before being read
+    real_t *features = context.get_real_buffer(0, this->padded_number_of_features);
+    real_t *kernel_values = context.get_real_buffer(1, this->padded_number_of_support_vectors);
+    real_t *decision_values = context.get_real_buffer(2, this->classifiers_class_ids.size());
+    std::copy(features_vector.cbegin(), features_vector.cend(), features);
+    std::fill(features + this->number_of_features, features + this->padded_number_of_features, 0);
+    std::fill(kernel_values + this->number_of_support_vectors, kernel_values + this->padded_number_of_support_vectors, 0);
+
+    // Compute the kernel values once, all classifiers share them
+    real_t features_squared_norm = simd_dot_product(features, features, this->padded_number_of_features);
+    simd_gemv(this->support_vectors.data(), this->number_of_support_vectors, this->padded_number_of_features, features, nullptr, kernel_values);
+    this->apply_kernel_function(features_squared_norm, kernel_values);
+    simd_gemv(this->dual_coefficients.data(), this->classifiers_class_ids.size(), this->padded_number_of_support_vectors, kernel_values, this->intercepts.data(), decision_values);
+
+    return this->vote(decision_values);
+}
+
+std::vector<std::size_t> KernelOneVsOneSVM::predict_class_ids(const std::vector<real_vector_t> &features_vectors) const {
+    if (this->class_dictionary.empty()) {
+        LOG(LOG_ERROR) << "Error : trying to make prediction but the SVM does not have any classifier";
+        throw std::invalid_argument("SVM does not have any classifier!");
+    }
+    std::vector<std::size_t> predicted_class_ids;
+    predicted_class_ids.reserve(features_vectors.size());
+    aligned_real_vector_t features_block(BATCH_BLOCK_SIZE * this->padded_number_of_features, 0);
+    aligned_real_vector_t kernel_values_block(BATCH_BLOCK_SIZE * this->padded_number_of_support_vectors, 0);
+    aligned_real_vector_t decision_values(this->classifiers_class_ids.size(), 0);
+
+    for (std::size_t block_first = 0; block_first < features_vectors.size(); block_first += BATCH_BLOCK_SIZE) {
+        const std::size_t block_size = std::min(BATCH_BLOCK_SIZE, features_vectors.size() - block_first);
+        for (std::size_t i = 0; i < block_size; i++) {
+            const real_vector_t &features_vector = features_vectors[block_first + i];
+            if (features_vector.size() != this->number_of_features) {
+                LOG(LOG_ERROR) << "Error : trying to make prediction but the feature vector size (" << features_vector.size() << ") is different from the support vectors size (" << this->number_of_features << ")";
+                throw std::invalid_argument("Feature vector size differ from support vectors size!");
+            }
+            std::copy(features_vector.cbegin(), features_vector.cend(), features_block.begin() + (long) (i * this->padded_number_of_features));
+        }
+
+        // Dot products of the whole block against the support vectors, each block of support vectors is loaded once per block of samples
+        simd_gemm_nt(this->support_vectors.data(), this->number_of_support_vectors, features_block.data(), block_size, this->padded_number_of_features, kernel_values_block.data(), this->padded_number_of_support_vectors);
+        for (std::size_t i = 0; i < block_size; i++) {
+            const real_t *features = features_block.data() + i * this->padded_number_of_features;
+            real_t *kernel_values = kernel_values_block.data() + i * this->padded_number_of_support_vectors;
+            this->apply_kernel_function(simd_dot_product(features, features, this->padded_number_of_features), kernel_values);
+            simd_gemv(this->dual_coefficients.data(), this->classifiers_class_ids.size(), this->padded_number_of_support_vectors, kernel_values, this->intercepts.data(), decision_values.data());
+            predicted_class_ids.push_back(this->vote(decision_values.data()));
+        }
+    }
+    return predicted_class_ids;
+}
+
+/* PRIVATE DEFINITION */
+void KernelOneVsOneSVM::read_kernel_csv(const std::filesystem::path &csv_file_path) {
+    const char delimiter = ',';
+    std::string line = {};
+
+    std::ifstream input_file(csv_file_path);
+    if (!input_file.is_open()) {
+        LOG(LOG_ERROR) << "Error : file with path " + csv_file_path.string() + "  not found.";
+        throw std::filesystem::filesystem_error("Can't open file!", std::make_error_code(std::errc::no_such_file_or_directory));
+    }
+
+    // Skip the header and read the single kernel line
+    std::getline(input_file, line);
+    if (!std::getline(input_file, line)) {
+        LOG(LOG_ERROR) << "Error : the kernel file " << csv_file_path << " does not have any kernel line";
+        throw std::invalid_argument("Missing kernel line!");
+    }
+    size_t last = 0;
+    size_t next = line.find(delimiter, last);
+    std::string kernel_name = line.substr(last, next - last);
+    // Remove double quote characters around the kernel name
+    kernel_name.erase(remove(kernel_name.begin(), kernel_name.end(), '"'), kernel_name.end());
+    last = next + 1;
+    next = line.find(delimiter, last);
+    this->gamma = (real_t) std::stod(line.substr(last, next - last));
+    last = next + 1;
+    next = line.find(delimiter, last);
+    this->coef0 = (real_t) std::stod(line.substr(last, next - last));
+    last = next + 1;
+    this->degree = (real_t) std::stod(line.substr(last));
+
+    if (kernel_name == "linear") {
+        this->kernel_function = KernelFunction::LINEAR;
+    } else if (kernel_name == "poly") {
+        this->kernel_function = KernelFunction::POLYNOMIAL;
+    } else if (kernel_name == "rbf") {
+        this->kernel_function = KernelFunction::RBF;
+    } else if (kernel_name == "sigmoid") {
+        this->kernel_function = KernelFunction::SIGMOID;
+    } else {
+        LOG(LOG_ERROR) << "Error : the kernel " << kernel_name << " is not supported (linear, poly, rbf or sigmoid)";
+        throw std::domain_error("Unsupported kernel function!");
+    }
+}
+
+void KernelOneVsOneSVM::read_support_vectors_csv(const std::filesystem::path &csv_file_path) {
+    const char delimiter = ',';
+    std::string line = {};
+
+    std::ifstream input_file(csv_file_path);
+    if (!input_file.is_open()) {
+        LOG(LOG_ERROR) << "Error : file with path " + csv_file_path.string() + "  not found.";
+        throw std::filesystem::filesystem_error("Can't open file!", std::make_error_code(std::errc::no_such_file_or_directory));
+    }
+
+    std::vector<real_vector_t> rows;
+    bool header_skipped = false;
+    while (std::getline(input_file, line)) {
+        if (!header_skipped) {
+            header_skipped = true;
+            continue;
+        }
+        size_t last = 0;
+        size_t next = 0;
+        real_vector_t support_vector;
+        while ((next = line.find(delimiter, last)) != std::string::npos) {
+            support_vector.push_back((real_t) std::stod(line.substr(last, next - last)));
+            last = next + 1;
+        }
+        support_vector.push_back((real_t) std::stod(line.substr(last)));
+        if (!rows.empty() && support_vector.size() != rows.front().size()) {
+            LOG(LOG_ERROR) << "Error : the support vector " << rows.size() << " has " << support_vector.size() << " features but the first one has " << rows.front().size();
+            throw std::invalid_argument("Support vectors sizes differ!");
+        }
+        rows.push_back(support_vector);
+    }
+
+    // Pack the support vectors, each row padded with zeros up to a whole number of SIMD vectors
+    this->number_of_support_vectors = rows.size();
+    this->padded_number_of_support_vectors = simd_padded_size(this->number_of_support_vectors);
+    this->number_of_features = rows.empty() ? 0 : rows.front().size();
+    this->padded_number_of_features = simd_padded_size(this->number_of_features);
+    this->support_vectors.assign(this->number_of_support_vectors * this->padded_number_of_features, 0);
+    this->support_vectors_squared_norm.assign(this->number_of_support_vectors, 0);
+    for (std::size_t support_vector_i = 0; support_vector_i < rows.size(); support_vector_i++) {
+        real_t *support_vector = this->support_vectors.data() + support_vector_i * this->padded_number_of_features;
+        std::copy(rows[support_vector_i].cbegin(), rows[support_vector_i].cend(), support_vector);
+        this->support_vectors_squared_norm[support_vector_i] = simd_dot_product(support_vector, support_vector, this->padded_number_of_features);
+    }
+}
+
+void KernelOneVsOneSVM::read_dual_coefficients_csv(const std::filesystem::path &csv_file_path) {
+    const char delimiter = ',';
+    std::string line = {};
+
+    std::ifstream input_file(csv_file_path);
+    if (!input_file.is_open()) {
+        LOG(LOG_ERROR) << "Error : file with path " + csv_file_path.string() + "  not found.";
+        throw std::filesystem::filesystem_error("Can't open file!", std::make_error_code(std::errc::no_such_file_or_directory));
+    }
+
+    std::vector<std::pair<std::string, std::string>> classifiers_classes;
+    std::vector<real_t> classifiers_intercept;
+    std::vector<real_vector_t> classifiers_coefficients;
+    bool header_skipped = false;
+    while (std::getline(input_file, line)) {
+        if (!header_skipped) {
+            header_skipped = true;
+            continue;
+        }
+        size_t last = 0;
+        size_t next = 0;
+        // Get the classes of the pair, removing the double quote characters around the class names
+        next = line.find(delimiter, last);
+        std::string positive_class = line.substr(last, next - last);
+        positive_class.erase(remove(positive_class.begin(), positive_class.end(), '"'), positive_class.end());
+        last = next + 1;
+        next = line.find(delimiter, last);
+        std::string negative_class = line.substr(last, next - last);
+        negative_class.erase(remove(negative_class.begin(), negative_class.end(), '"'), negative_class.end());
+        last = next + 1;
+        // Get the intercept and the dual coefficients
+        next = line.find(delimiter, last);
+        real_t intercept = (real_t) std::stod(line.substr(last, next - last));
+        last = next + 1;
+        real_vector_t coefficients;
+        while ((next = line.find(delimiter, last)) != std::string::npos) {
+            coefficients.push_back((real_t) std::stod(line.substr(last, next - last)));
+            last = next + 1;
+        }
+        coefficients.push_back((real_t) std::stod(line.substr(last)));
+        if (coefficients.size() != this->number_of_support_vectors) {
+            LOG(LOG_ERROR) << "Error : the classifier " << positive_class << "/" << negative_class << " has " << coefficients.size() << " dual coefficients but there are " << this->number_of_support_vectors << " support vectors";
+            throw std::invalid_argument("Dual coefficients size differ from the number of support vectors!");
+        }
+        classifiers_classes.emplace_back(positive_class, negative_class);
+        classifiers_intercept.push_back(intercept);
+        classifiers_coefficients.push_back(coefficients);
+    }
+
+    // Sorted class dictionary so ties go to the first class in alphabetical order like OneVsOneSVM
+    std::set<std::string> svm_classes;
+    for (const std::pair<std::string, std::string> &classes: classifiers_classes) {
+        svm_classes.insert(classes.first);
+        svm_classes.insert(classes.second);
+    }
+    this->class_dictionary = ClassDictionary(std::vector<std::string>(svm_classes.cbegin(), svm_classes.cend()));
+    for (const std::pair<std::string, std::string> &classes: classifiers_classes) {
+        this->classifiers_class_ids.emplace_back(this->class_dictionary.get_class_id(classes.first), this->class_dictionary.get_class_id(classes.second));
+    }
+
+    // Pack the dual coefficients, the padding columns stay at zero so the padding of the kernel values has no effect
+    this->dual_coefficients.assign(classifiers_coefficients.size() * this->padded_number_of_support_vectors, 0);
+    this->intercepts.assign(classifiers_intercept.cbegin(), classifiers_intercept.cend());
+    for (std::size_t classifier_i = 0; classifier_i < classifiers_coefficients.size(); classifier_i++) {
+        std::copy(classifiers_coefficients[classifier_i].cbegin(), classifiers_coefficients[classifier_i].cend(), this->dual_coefficients.begin() + (long) (classifier_i * this->padded_number_of_support_vectors));
+    }
+}
+
+void KernelOneVsOneSVM::apply_kernel_function(real_t features_squared_norm, real_t *kernel_values) const {
+    switch (this->kernel_function) {
+        case KernelFunction::LINEAR : {
+            break;
+        }
+        case KernelFunction::POLYNOMIAL : {
+            for (std::size_t i = 0; i < this->number_of_support_vectors; i++) {
+                kernel_values[i] = std::pow(this->gamma * kernel_values[i] + this->coef0, this->degree);
+            }
+            break;
+        }
+        case KernelFunction::RBF : {
+            // ||x - sv||^2 = ||x||^2 + ||sv||^2 - 2 <x, sv>, with the support vectors norms cached at load time
+            for (std::size_t i = 0; i < this->number_of_support_vectors; i++) {
+                real_t squared_distance = std::max((real_t) 0, features_squared_norm + this->support_vectors_squared_norm[i] - 2 * kernel_values[i]);
+                kernel_values[i] = std::exp(-this->gamma * squared_distance);
+            }
+            break;
+        }
+        case KernelFunction::SIGMOID : {
+            for (std::size_t i = 0; i < this->number_of_support_vectors; i++) {
+                kernel_values[i] = std::tanh(this->gamma * kernel_values[i] + this->coef0);
+            }
+            break;
+        }
+        default: {
+            LOG(LOG_ERROR) << "Error : the kernel function value usage is not defined in the project";
+            throw std::domain_error("Unsupported kernel function!");
+            break;
+        }
+    }
+}
+
+std::size_t KernelOneVsOneSVM::vote(const real_t *decision_values) const {
+    std::array<std::size_t, ClassDictionary::MAX_NUMBER_OF_CLASSES> votes = {};
+    for (std::size_t classifier_i = 0; classifier_i < this->classifiers_class_ids.size(); classifier_i++) {
+        const std::pair<std::size_t, std::size_t> &class_ids = this->classifiers_class_ids[classifier_i];
+        votes[decision_values[classifier_i] > 0 ? class_ids.first : class_ids.second] += 1;
+    }
+
+    // Get the prediction result with the most choice, ties go to the first class in alphabetical order
+    auto pr = std::max_element(std::execution::seq, votes.cbegin(), votes.cbegin() + (long) this->class_dictionary.size());
+    return std::distance(votes.cbegin(), pr);
+}
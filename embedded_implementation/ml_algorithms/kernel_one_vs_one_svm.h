@@ -0,0 +1,98 @@
+#ifndef KERNEL_ONE_VS_ONE_SVM_H
+#define KERNEL_ONE_VS_ONE_SVM_H
+
+#include "machine_learning_model.h"
+#include "globals.h"
+#include "../helpers/log.h"
+#include "../helpers/simd.h"
+
+/**
+ * @brief List of kernel functions
+ */
+enum class KernelFunction {
+    LINEAR = 0, /** The linear kernel k(x, sv) = <x, sv> */
+    POLYNOMIAL = 1, /** The polynomial kernel k(x, sv) = (gamma * <x, sv> + coef0)^degree */
+    RBF = 2, /** The gaussian kernel k(x, sv) = exp(-gamma * ||x - sv||^2) */
+    SIGMOID = 3 /** The sigmoid kernel k(x, sv) = tanh(gamma * <x, sv> + coef0) */
+};
+
+/*
+ * KernelOneVsOneSVM class definition
+ */
+// One vs one SVM with a non linear kernel, loaded from a folder holding:
+//  - kernel.csv: kernel,gamma,coef0,degree
+//  - support_vectors.csv: one support vector per line
+//  - dual_coefficients.csv: positive_class,negative_class,intercept then one dual coefficient per support vector (0 if the
+//    support vector is not used by the pair), the decision value is sum(coeff * k(x, sv)) + intercept, positive_class wins if > 0
+class KernelOneVsOneSVM : public MachineLearningModel {
+public:
+    KernelOneVsOneSVM();
+
+    KernelFunction get_kernel_function() const;
+
+    real_t get_gamma() const;
+
+    real_t get_coef0() const;
+
+    real_t get_degree() const;
+
+    std::size_t get_number_of_support_vectors() const;
+
+    std::size_t get_number_of_features() const;
+
+    std::size_t get_number_of_classifiers() const;
+
+    friend std::ostream &operator<<(std::ostream &os, const KernelOneVsOneSVM &kernel_one_vs_one_svm);
+
+    void clear();
+
+    void fill_from_csv(const std::filesystem::path &csv_folder_path) override;
+
+    // SVM class names, sorted in alphabetical order
+    const ClassDictionary &get_class_dictionary() const override;
+
+    std::size_t predict_class_id(const real_vector_t &features_vector) const override;
+
+    // Same prediction with the features, kernel values and decision values in the buffers 0, 1 and 2 of the context
+    std::size_t predict_class_id(const real_vector_t &features_vector, InferenceContext &context) const;
+
+    std::vector<std::size_t> predict_class_ids(const std::vector<real_vector_t> &features_vectors) const override;
+
+    static inline const std::string KERNEL_CSV = "kernel.csv";
+    static inline const std::string SUPPORT_VECTORS_CSV = "support_vectors.csv";
+    static inline const std::string DUAL_COEFFICIENTS_CSV = "dual_coefficients.csv";
+    // Number of samples whose kernel values are computed together by the batch prediction
+    static constexpr std::size_t BATCH_BLOCK_SIZE = 32;
+
+private:
+    KernelFunction kernel_function;
+    real_t gamma;
+    real_t coef0;
+    real_t degree;
+    ClassDictionary class_dictionary;
+    // Class ids of the positive and negative classes of each classifier
+    std::vector<std::pair<std::size_t, std::size_t>> classifiers_class_ids;
+    std::size_t number_of_features;
+    std::size_t padded_number_of_features;
+    std::size_t number_of_support_vectors;
+    std::size_t padded_number_of_support_vectors;
+    // Aligned row-major support_vectors x padded_number_of_features matrix and the squared norm of each support vector
+    aligned_real_vector_t support_vectors;
+    aligned_real_vector_t support_vectors_squared_norm;
+    // Aligned row-major classifiers x padded_number_of_support_vectors matrix, shared kernel values feed all classifiers
+    aligned_real_vector_t dual_coefficients;
+    aligned_real_vector_t intercepts;
+
+    void read_kernel_csv(const std::filesystem::path &csv_file_path);
+
+    void read_support_vectors_csv(const std::filesystem::path &csv_file_path);
+
+    void read_dual_coefficients_csv(const std::filesystem::path &csv_file_path);
+
+    // Turn the dot products <x, sv> into kernel values in place
+    void apply_kernel_function(real_t features_squared_norm, real_t *kernel_values) const;
+
+    std::size_t vote(const real_t *decision_values) const;
+};
+
+#endif //KERNEL_ONE_VS_ONE_SVM_H
@@ -2,14 +2,64 @@
 #define MACHINE_LEARNING_MODEL_H
 
 #include <string>
+#include <vector>
 #include <filesystem>
 #include "globals.h"
+#include "../helpers/class_dictionary.h"
+#include "../helpers/inference_context.h"
 
+// The inference is const and reentrant: once filled, a model can be shared by threads predicting concurrently, the models
+// needing scratch buffers take them from a caller-owned InferenceContext (the one of the calling thread by default)
 class MachineLearningModel {
 public:
+    virtual ~MachineLearningModel() = default;
+
     virtual void fill_from_csv(const std::filesystem::path &csv_folder_path) = 0;
 
-    virtual std::string predict_class(const real_vector_t &features_vector) = 0;
+    // Class names of the model, indexed by the class ids returned by predict_class_id
+    virtual const ClassDictionary &get_class_dictionary() const = 0;
+
+    virtual std::size_t predict_class_id(const real_vector_t &features_vector) const = 0;
+
+    // Prediction with a confidence in [0, 1] comparable between the samples of a model, used to gate a CascadeModel.
+    // The models without any confidence measure are always fully confident
+    virtual std::size_t predict_class_id_with_confidence(const real_vector_t &features_vector, real_t &confidence) const {
+        confidence = 1;
+        return this->predict_class_id(features_vector);
+    }
+
+    // Ids of the features the predictions depend on, sorted, empty when they may depend on all of them (see
+    // AuFileProcessor::set_required_features)
+    virtual std::vector<std::size_t> get_used_features() const {
+        return {};
+    }
+
+    // Class names only appear at the API edge, the inference itself works on class ids
+    virtual std::string predict_class(const real_vector_t &features_vector) const {
+        std::size_t class_id = this->predict_class_id(features_vector);
+        return this->get_class_dictionary().get_class_name(class_id);
+    }
+
+    // Default batch prediction, models with a faster batch layout override it
+    virtual std::vector<std::size_t> predict_class_ids(const std::vector<real_vector_t> &features_vectors) const {
+        std::vector<std::size_t> predicted_class_ids;
+        predicted_class_ids.reserve(features_vectors.size());
+        for (const real_vector_t &features_vector: features_vectors) {
+            predicted_class_ids.push_back(this->predict_class_id(features_vector));
+        }
+        return predicted_class_ids;
+    }
+
+    virtual std::vector<std::string> predict_classes(const std::vector<real_vector_t> &features_vectors) const {
+        std::vector<std::size_t> predicted_class_ids = this->predict_class_ids(features_vectors);
+        const ClassDictionary &class_dictionary = this->get_class_dictionary();
+        std::vector<std::string> predicted_classes;
+        predicted_classes.reserve(predicted_class_ids.size());
+        for (std::size_t class_id: predicted_class_ids) {
+            predicted_classes.push_back(class_dictionary.get_class_name(class_id));
+        }
+        return predicted_classes;
+    }
 };
 
 #endif //MACHINE_LEARNING_MODEL_H
@@ -2,7 +2,8 @@
 #include <fstream>
 #include <utility>
 #include <execution>
-#include <map>
+#include <set>
+#include <array>
 #include "../helpers/print_helpers.h"
 
 /*
@@ -10,8 +11,16 @@
  */
 
 /* PUBLIC DEFINITION */
-LinearClassifier::LinearClassifier(std::string lower_class, std::string upper_class, real_t intercept, real_vector_t coef_matrix) :
-        lower_class(std::move(lower_class)), upper_class(std::move(upper_class)), intercept(intercept), coeff_matrix(std::move(coef_matrix)) {
+LinearClassifier::LinearClassifier(std::string lower_class, std::string upper_class, real_t intercept, std::span<const real_t> coef_matrix, const allocator_type &allocator) :
+        lower_class(std::move(lower_class)), upper_class(std::move(upper_class)), intercept(intercept), coeff_matrix(coef_matrix.begin(), coef_matrix.end(), allocator) {
+}
+
+LinearClassifier::LinearClassifier(const LinearClassifier &linear_classifier, const allocator_type &allocator) :
+        lower_class(linear_classifier.lower_class), upper_class(linear_classifier.upper_class), intercept(linear_classifier.intercept), coeff_matrix(linear_classifier.coeff_matrix, allocator) {
+}
+
+LinearClassifier::LinearClassifier(LinearClassifier &&linear_classifier, const allocator_type &allocator) :
+        lower_class(std::move(linear_classifier.lower_class)), upper_class(std::move(linear_classifier.upper_class)), intercept(linear_classifier.intercept), coeff_matrix(std::move(linear_classifier.coeff_matrix), allocator) {
 }
 
 const std::string &LinearClassifier::get_lower_class() const {
@@ -26,7 +35,7 @@ real_t LinearClassifier::get_intercept() const {
     return intercept;
 }
 
-const real_vector_t &LinearClassifier::get_coef_matrix() const {
+const std::pmr::vector<real_t> &LinearClassifier::get_coef_matrix() const {
     return coeff_matrix;
 }
 
@@ -41,7 +50,7 @@ std::ostream &operator<<(std::ostream &os, const LinearClassifier &linear_classi
     return os << "y >= Ax+b -> class id is " << linear_classifier.get_upper_class() << " else class id is" << linear_classifier.get_lower_class() << " with A=" << matrix_a << " and b=" << std::to_string(linear_classifier.get_intercept());
 }
 
-std::string LinearClassifier::predict(const real_vector_t &features_vector) {
+real_t LinearClassifier::compute_decision_value(const real_vector_t &features_vector) const {
     LOG(LOG_DEBUG) << "fv: " << features_vector;
     LOG(LOG_DEBUG) << "intercept: " << intercept << ", coeff_matrix: " << this->coeff_matrix;
     if (features_vector.size() != this->coeff_matrix.size()) {
@@ -57,7 +66,11 @@ std::string LinearClassifier::predict(const real_vector_t &features_vector) {
     result += this->intercept;
 
     LOG(LOG_DEBUG) << this->upper_class << " (" << result << ") " << this->lower_class;
-    return (result > 0 ? this->lower_class : this->upper_class);
+    return result;
+}
+
+std::string LinearClassifier::predict(const real_vector_t &features_vector) const {
+    return (this->compute_decision_value(features_vector) > 0 ? this->lower_class : this->upper_class);
 }
 
 /* PRIVATE DEFINITION */
@@ -68,19 +81,37 @@ std::string LinearClassifier::predict(const real_vector_t &features_vector) {
  */
 
 /* PUBLIC DEFINITION */
-OneVsOneSVM::OneVsOneSVM() {
-    this->classifiers.clear();
+OneVsOneSVM::OneVsOneSVM() : classifiers(this->arena.get()) {
     this->number_of_class = 0;
+    this->number_of_features = 0;
+    this->padded_number_of_features = 0;
+    this->evaluation_mode = SVMEvaluationMode::MAX_WINS;
 }
 
-const std::vector<LinearClassifier> &OneVsOneSVM::get_classifiers() const {
+OneVsOneSVM::OneVsOneSVM(const OneVsOneSVM &one_vs_one_svm) : OneVsOneSVM() {
+    *this = one_vs_one_svm;
+}
+
+const std::pmr::vector<LinearClassifier> &OneVsOneSVM::get_classifiers() const {
     return classifiers;
 }
 
+const ModelArena &OneVsOneSVM::get_arena() const {
+    return *this->arena.get();
+}
+
 size_t OneVsOneSVM::get_number_of_class() const {
     return number_of_class;
 }
 
+SVMEvaluationMode OneVsOneSVM::get_evaluation_mode() const {
+    return evaluation_mode;
+}
+
+void OneVsOneSVM::set_evaluation_mode(SVMEvaluationMode evaluation_mode) {
+    this->evaluation_mode = evaluation_mode;
+}
+
 std::ostream &operator<<(std::ostream &os, const OneVsOneSVM &one_vs_one_svm) {
     // A for_each is not used here because the size of the final string can be really long
     os << "One Vs One Linear SVM classifiers:" << std::endl;
@@ -94,14 +125,22 @@ std::ostream &operator<<(std::ostream &os, const OneVsOneSVM &one_vs_one_svm) {
 
 void OneVsOneSVM::push_classifier(const LinearClassifier &linear_classifier) {
     this->classifiers.push_back(linear_classifier);
+    this->pack_classifiers();
+}
+
+void OneVsOneSVM::push_classifier(LinearClassifier &&linear_classifier) {
+    this->classifiers.push_back(std::move(linear_classifier));
+    this->pack_classifiers();
 }
 
 void OneVsOneSVM::pop_classifier() {
     this->classifiers.pop_back();
+    this->pack_classifiers();
 }
 
 void OneVsOneSVM::clear() {
     this->classifiers.clear();
+    this->pack_classifiers();
 }
 
 void OneVsOneSVM::fill_from_csv(const std::filesystem::path &csv_file_path) {
@@ -150,33 +189,210 @@ void OneVsOneSVM::fill_from_csv(const std::filesystem::path &csv_file_path) {
             }
             coeff_matrix.push_back((real_t) std::stod(line.substr(last)));
 
-            LinearClassifier new_linear_classifier = {positive_class, negative_class, intercept, coeff_matrix};
-            this->push_classifier(new_linear_classifier);
+            this->classifiers.emplace_back(positive_class, negative_class, intercept, coeff_matrix);
         }
     }
+    this->pack_classifiers();
 }
 
-std::string OneVsOneSVM::predict_class(const real_vector_t &features_vector) {
-    std::map<std::string, std::size_t> pred_results;
-    using pred_results_pair_t = decltype(pred_results)::value_type;
+void OneVsOneSVM::fill_from_binary(const std::filesystem::path &binary_file_path) {
+    MappedModelContainer model_container(binary_file_path);
+    model_container.expect_model_type(ModelType::ONE_VS_ONE_SVM);
+    const ClassDictionary class_names = model_container.get_class_dictionary();
+    std::span<const std::uint32_t> classifiers_class_ids = model_container.get_section<std::uint32_t>(ModelSectionType::SVM_CLASS_IDS);
+    std::span<const real_t> coefficients = model_container.get_section<real_t>(ModelSectionType::SVM_COEFFICIENTS);
+    std::span<const real_t> intercepts = model_container.get_section<real_t>(ModelSectionType::SVM_INTERCEPTS);
+    const std::size_t number_of_classifiers = intercepts.size();
+    if (classifiers_class_ids.size() != 2 * number_of_classifiers || (number_of_classifiers != 0 && coefficients.size() % number_of_classifiers != 0)) {
+        LOG(LOG_ERROR) << "Error : the model container " << binary_file_path << " holds " << intercepts.size() << " intercepts, " << classifiers_class_ids.size() << " class ids and " << coefficients.size() << " coefficients";
+        throw std::invalid_argument("SVM sections sizes mismatch!");
+    }
+    const std::size_t features = number_of_classifiers == 0 ? 0 : coefficients.size() / number_of_classifiers;
 
-    // Get results for each linear classifier
-    std::for_each(std::execution::seq, this->classifiers.begin(), this->classifiers.end(), [&pred_results, &features_vector](LinearClassifier &linear_classifier) mutable {
-        std::string pred_result = linear_classifier.predict(features_vector);
-        if (pred_results.count(pred_result) == 0) {
-            pred_results.insert(std::make_pair(pred_result, 1));
-        } else {
-            pred_results.at(pred_result) += 1;
+    // The coefficients are copied from the mapped file straight into the arena
+    for (std::size_t classifier_i = 0; classifier_i < number_of_classifiers; classifier_i++) {
+        this->classifiers.emplace_back(class_names.get_class_name(classifiers_class_ids[2 * classifier_i]), class_names.get_class_name(classifiers_class_ids[2 * classifier_i + 1]), intercepts[classifier_i],
+                                       coefficients.subspan(classifier_i * features, features));
+    }
+    this->pack_classifiers();
+}
+
+void OneVsOneSVM::write_to_binary(const std::filesystem::path &binary_file_path) const {
+    ClassDictionary class_names;
+    std::vector<std::uint32_t> classifiers_class_ids;
+    real_vector_t coefficients;
+    real_vector_t intercepts;
+    const std::size_t features = this->classifiers.empty() ? 0 : this->classifiers.front().get_coef_matrix().size();
+    for (const LinearClassifier &linear_classifier: this->classifiers) {
+        if (linear_classifier.get_coef_matrix().size() != features) {
+            LOG(LOG_ERROR) << "Error : a classifier has " << linear_classifier.get_coef_matrix().size() << " coefficients but the first one has " << features;
+            throw std::invalid_argument("Coefficient matrix sizes differ!");
         }
-    });
+        classifiers_class_ids.push_back((std::uint32_t) class_names.add_class(linear_classifier.get_lower_class()));
+        classifiers_class_ids.push_back((std::uint32_t) class_names.add_class(linear_classifier.get_upper_class()));
+        coefficients.insert(coefficients.end(), linear_classifier.get_coef_matrix().cbegin(), linear_classifier.get_coef_matrix().cend());
+        intercepts.push_back(linear_classifier.get_intercept());
+    }
+    ModelContainerWriter model_container(ModelType::ONE_VS_ONE_SVM);
+    model_container.add_class_dictionary(class_names);
+    model_container.add_section(ModelSectionType::SVM_CLASS_IDS, classifiers_class_ids.data(), classifiers_class_ids.size());
+    model_container.add_section(ModelSectionType::SVM_COEFFICIENTS, coefficients.data(), coefficients.size());
+    model_container.add_section(ModelSectionType::SVM_INTERCEPTS, intercepts.data(), intercepts.size());
+    model_container.write(binary_file_path);
+}
+
+const ClassDictionary &OneVsOneSVM::get_class_dictionary() const {
+    return this->class_dictionary;
+}
+
+void OneVsOneSVM::compute_decision_values(const real_vector_t &features_vector, real_t *decision_values, InferenceContext &context) const {
+    const real_t *features = this->pad_features_vector(features_vector, context);
+    simd_gemv(this->coefficients.data(), this->classifiers.size(), this->padded_number_of_features, features, this->intercepts.data(), decision_values);
+}
 
-    // Get the prediction result with the most choice
-    auto pr = std::max_element(std::execution::seq, pred_results.cbegin(), pred_results.cend(),
-                               [](const pred_results_pair_t &p1, const pred_results_pair_t &p2) {
-                                   return p1.second < p2.second;
-                               });
+std::size_t OneVsOneSVM::predict_class_id(const real_vector_t &features_vector) const {
+    return this->predict_class_id(features_vector, InferenceContext::get_thread_context());
+}
 
-    return pr->first;
+std::size_t OneVsOneSVM::predict_class_id(const real_vector_t &features_vector, InferenceContext &context) const {
+    if (this->class_dictionary.empty()) {
+        LOG(LOG_ERROR) << "Error : trying to make prediction but the SVM does not have any classifier";
+        throw std::invalid_argument("SVM does not have any classifier!");
+    }
+
+    switch (this->evaluation_mode) {
+        case SVMEvaluationMode::MAX_WINS : {
+            return this->predict_class_id_max_wins(features_vector, context);
+        }
+        case SVMEvaluationMode::DDAG : {
+            return this->predict_class_id_ddag(features_vector, context);
+        }
+        default: {
+            LOG(LOG_ERROR) << "Error : the SVM evaluation mode value usage is not defined in the project";
+            throw std::domain_error("Unsupported SVM evaluation mode!");
+            break;
+        }
+    }
+    return 0;
+}
+
+std::size_t OneVsOneSVM::predict_class_id_with_confidence(const real_vector_t &features_vector, real_t &confidence) const {
+    if (this->class_dictionary.empty()) {
+        LOG(LOG_ERROR) << "Error : trying to make prediction but the SVM does not have any classifier";
+        throw std::invalid_argument("SVM does not have any classifier!");
+    }
+    std::array<std::size_t, ClassDictionary::MAX_NUMBER_OF_CLASSES> votes = {};
+    const std::size_t class_id = this->compute_votes(features_vector, votes, InferenceContext::get_thread_context());
+
+    // A tie has no spread
+    std::size_t runner_up_votes = 0;
+    for (std::size_t other_class_id = 0; other_class_id < this->number_of_class; other_class_id++) {
+        if (other_class_id != class_id) {
+            runner_up_votes = std::max(runner_up_votes, votes[other_class_id]);
+        }
+    }
+    confidence = this->number_of_class > 1 ? (real_t) (votes[class_id] - runner_up_votes) / (real_t) (this->number_of_class - 1) : 1;
+
+    return class_id;
 }
 
 /* PRIVATE DEFINITION */
+void OneVsOneSVM::pack_classifiers() {
+    // Sorted set of all classifier classes
+    std::set<std::string> svm_classes;
+    for (const LinearClassifier &linear_classifier: this->classifiers) {
+        svm_classes.insert(linear_classifier.get_lower_class());
+        svm_classes.insert(linear_classifier.get_upper_class());
+    }
+    this->class_dictionary = ClassDictionary(std::vector<std::string>(svm_classes.cbegin(), svm_classes.cend()));
+    this->number_of_class = this->class_dictionary.size();
+
+    this->classifiers_class_ids.clear();
+    for (const LinearClassifier &linear_classifier: this->classifiers) {
+        this->classifiers_class_ids.emplace_back(this->class_dictionary.get_class_id(linear_classifier.get_lower_class()),
+                                                 this->class_dictionary.get_class_id(linear_classifier.get_upper_class()));
+    }
+
+    // Pack the coefficients row by row, each row padded with zeros up to a whole number of SIMD vectors
+    this->number_of_features = this->classifiers.empty() ? 0 : this->classifiers.front().get_coef_matrix().size();
+    this->padded_number_of_features = simd_padded_size(this->number_of_features);
+    this->coefficients.assign(this->classifiers.size() * this->padded_number_of_features, 0);
+    this->intercepts.assign(this->classifiers.size(), 0);
+    for (std::size_t classifier_i = 0; classifier_i < this->classifiers.size(); classifier_i++) {
+        const std::pmr::vector<real_t> &coef_matrix = this->classifiers[classifier_i].get_coef_matrix();
+        if (coef_matrix.size() != this->number_of_features) {
+            LOG(LOG_ERROR) << "Error : the classifier " << classifier_i << " has " << coef_matrix.size() << " coefficients but the first one has " << this->number_of_features;
+            throw std::invalid_argument("Classifiers coefficient matrix sizes differ!");
+        }
+        std::copy(coef_matrix.cbegin(), coef_matrix.cend(), this->coefficients.begin() + (long) (classifier_i * this->padded_number_of_features));
+        this->intercepts[classifier_i] = this->classifiers[classifier_i].get_intercept();
+    }
+
+    // Classifier of each class pair for the DDAG walk
+    this->pairs_classifier_id.assign(this->number_of_class * this->number_of_class, -1);
+    for (std::size_t classifier_i = 0; classifier_i < this->classifiers_class_ids.size(); classifier_i++) {
+        const std::pair<std::size_t, std::size_t> &class_ids = this->classifiers_class_ids[classifier_i];
+        this->pairs_classifier_id[class_ids.first * this->number_of_class + class_ids.second] = (long) classifier_i;
+        this->pairs_classifier_id[class_ids.second * this->number_of_class + class_ids.first] = (long) classifier_i;
+    }
+}
+
+const real_t *OneVsOneSVM::pad_features_vector(const real_vector_t &features_vector, InferenceContext &context) const {
+    if (features_vector.size() != this->number_of_features) {
+        LOG(LOG_ERROR) << "Error : trying to make prediction but the feature vector size (" << features_vector.size() << ") is different from the coefficient matrix size (" << this->number_of_features << ")";
+        throw std::invalid_argument("Feature vector size differ from coefficient matrix size!");
+    }
+
+    // The padding is cleared on each call since the context may come from a model with more features
+    real_t *features = context.get_real_buffer(0, this->padded_number_of_features);
+    std::copy(features_vector.cbegin(), features_vector.cend(), features);
+    std::fill(features + this->number_of_features, features + this->padded_number_of_features, 0);
+    return features;
+}
+
+std::size_t OneVsOneSVM::compute_votes(const real_vector_t &features_vector, std::span<std::size_t, ClassDictionary::MAX_NUMBER_OF_CLASSES> votes, InferenceContext &context) const {
+    const std::size_t number_of_classes = this->class_dictionary.size();
+    real_t *decision_values = context.get_real_buffer(1, this->classifiers.size());
+    this->compute_decision_values(features_vector, decision_values, context);
+
+    // Vote over the precomputed class pairs of the classifiers
+    std::fill(votes.begin(), votes.end(), 0);
+    for (std::size_t classifier_i = 0; classifier_i < this->classifiers_class_ids.size(); classifier_i++) {
+        const std::pair<std::size_t, std::size_t> &class_ids = this->classifiers_class_ids[classifier_i];
+        votes[decision_values[classifier_i] > 0 ? class_ids.first : class_ids.second] += 1;
+    }
+
+    // Get the prediction result with the most choice, ties go to the first class in alphabetical order
+    auto pr = std::max_element(std::execution::seq, votes.begin(), votes.begin() + (long) number_of_classes);
+
+    return std::distance(votes.begin(), pr);
+}
+
+std::size_t OneVsOneSVM::predict_class_id_max_wins(const real_vector_t &features_vector, InferenceContext &context) const {
+    std::array<std::size_t, ClassDictionary::MAX_NUMBER_OF_CLASSES> votes = {};
+    return this->compute_votes(features_vector, votes, context);
+}
+
+std::size_t OneVsOneSVM::predict_class_id_ddag(const real_vector_t &features_vector, InferenceContext &context) const {
+    const real_t *features = this->pad_features_vector(features_vector, context);
+
+    // The remaining classes are always the range [first_class_id, last_class_id], each test eliminates one of its ends
+    std::size_t first_class_id = 0;
+    std::size_t last_class_id = this->number_of_class - 1;
+    while (first_class_id < last_class_id) {
+        long classifier_id = this->pairs_classifier_id[first_class_id * this->number_of_class + last_class_id];
+        if (classifier_id < 0) {
+            LOG(LOG_ERROR) << "Error : trying to make a DDAG prediction but there is no classifier for the classes " << this->class_dictionary.get_class_name(first_class_id) << " and " << this->class_dictionary.get_class_name(last_class_id);
+            throw std::invalid_argument("Missing classifier for a class pair!");
+        }
+        real_t decision_value = simd_dot_product(this->coefficients.data() + classifier_id * (long) this->padded_number_of_features, features, this->padded_number_of_features) + this->intercepts[classifier_id];
+        std::size_t winner_class_id = decision_value > 0 ? this->classifiers_class_ids[classifier_id].first : this->classifiers_class_ids[classifier_id].second;
+        if (winner_class_id == first_class_id) {
+            last_class_id--;
+        } else {
+            first_class_id++;
+        }
+    }
+
+    return first_class_id;
+}
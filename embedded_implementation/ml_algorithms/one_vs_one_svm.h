@@ -2,17 +2,42 @@
 #ifndef ONE_VS_ONE_SVM_H
 #define ONE_VS_ONE_SVM_H
 
+#include <memory_resource>
+#include <span>
 #include "machine_learning_model.h"
 #include "globals.h"
 #include "../helpers/log.h"
+#include "../helpers/model_arena.h"
+#include "../helpers/model_container.h"
+#include "../helpers/simd.h"
+
+/**
+ * @brief List of one vs one SVM evaluation modes
+ */
+enum class SVMEvaluationMode {
+    MAX_WINS = 0, /** Evaluate the K(K-1)/2 classifiers and vote, the class with the most wins is predicted */
+    DDAG = 1 /** Decision DAG, evaluate K-1 classifiers each eliminating the losing class of the first and last remaining classes */
+};
 
 /*
  * LinearClassifier class definition
  */
-
+// Allocator-aware, a classifier stored in a SVM allocates its coefficients in the arena of the SVM
 class LinearClassifier {
 public:
-    LinearClassifier(std::string lower_class, std::string upper_class, real_t intercept, real_vector_t coef_matrix);
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+
+    LinearClassifier(std::string lower_class, std::string upper_class, real_t intercept, std::span<const real_t> coef_matrix, const allocator_type &allocator = {});
+
+    LinearClassifier(const LinearClassifier &linear_classifier, const allocator_type &allocator = {});
+
+    LinearClassifier(LinearClassifier &&linear_classifier) = default;
+
+    LinearClassifier(LinearClassifier &&linear_classifier, const allocator_type &allocator);
+
+    LinearClassifier &operator=(const LinearClassifier &linear_classifier) = default;
+
+    LinearClassifier &operator=(LinearClassifier &&linear_classifier) = default;
 
     const std::string &get_lower_class() const;
 
@@ -20,17 +45,20 @@ public:
 
     real_t get_intercept() const;
 
-    const real_vector_t &get_coef_matrix() const;
+    const std::pmr::vector<real_t> &get_coef_matrix() const;
 
     friend std::ostream &operator<<(std::ostream &os, const LinearClassifier &linear_classifier);
 
-    std::string predict(const real_vector_t &features_vector);
+    // Signed distance to the hyperplane, the lower class wins when it is positive
+    real_t compute_decision_value(const real_vector_t &features_vector) const;
+
+    std::string predict(const real_vector_t &features_vector) const;
 
 private:
     std::string lower_class;
     std::string upper_class;
     real_t intercept;
-    real_vector_t coeff_matrix;
+    std::pmr::vector<real_t> coeff_matrix;
 };
 
 /*
@@ -41,26 +69,88 @@ class OneVsOneSVM : public MachineLearningModel {
 public:
     OneVsOneSVM();
 
-    const std::vector<LinearClassifier> &get_classifiers() const;
+    // The copy allocates its classifiers in a new arena
+    OneVsOneSVM(const OneVsOneSVM &one_vs_one_svm);
+
+    OneVsOneSVM(OneVsOneSVM &&one_vs_one_svm) = default;
+
+    OneVsOneSVM &operator=(const OneVsOneSVM &one_vs_one_svm) = default;
+
+    OneVsOneSVM &operator=(OneVsOneSVM &&one_vs_one_svm) = default;
+
+    const std::pmr::vector<LinearClassifier> &get_classifiers() const;
+
+    // Arena of the classifiers and their coefficients
+    const ModelArena &get_arena() const;
 
     size_t get_number_of_class() const;
 
+    SVMEvaluationMode get_evaluation_mode() const;
+
+    void set_evaluation_mode(SVMEvaluationMode evaluation_mode);
+
     friend std::ostream &operator<<(std::ostream &os, const OneVsOneSVM &one_vs_one_svm);
 
+    // The copy of the classifier allocates its coefficients in the arena of the SVM
     void push_classifier(const LinearClassifier& linear_classifier);
 
+    void push_classifier(LinearClassifier &&linear_classifier);
+
     void pop_classifier();
 
     void clear();
 
     void fill_from_csv(const std::filesystem::path &csv_file_path) override;
 
-    std::string predict_class(const real_vector_t &features_vector) override;
+    // Read the classifiers from a binary model container written by write_to_binary, the coefficients are copied from the mapped file without parsing
+    void fill_from_binary(const std::filesystem::path &binary_file_path);
+
+    void write_to_binary(const std::filesystem::path &binary_file_path) const;
+
+    // SVM class names, sorted in alphabetical order
+    const ClassDictionary &get_class_dictionary() const override;
+
+    // Compute the decision values of all classifiers with one matrix-vector product on the packed coefficients
+    void compute_decision_values(const real_vector_t &features_vector, real_t *decision_values, InferenceContext &context = InferenceContext::get_thread_context()) const;
+
+    std::size_t predict_class_id(const real_vector_t &features_vector) const override;
+
+    // Same prediction with the zero-padded features and the decision values in the buffers of the context
+    std::size_t predict_class_id(const real_vector_t &features_vector, InferenceContext &context) const;
 
+    // The confidence is the vote spread, the wins of the leader minus the wins of the runner-up over the number of classes
+    // minus one. The votes need all the classifiers, so the prediction is the MAX_WINS one whatever the evaluation mode
+    std::size_t predict_class_id_with_confidence(const real_vector_t &features_vector, real_t &confidence) const override;
 
 private:
-    std::vector<LinearClassifier> classifiers;
+    // Declared first so the arena outlives the classifiers allocated from it
+    ModelArenaReference arena;
+    std::pmr::vector<LinearClassifier> classifiers;
     std::size_t number_of_class;
+    ClassDictionary class_dictionary;
+    // Class ids of the lower and upper classes of each classifier
+    std::vector<std::pair<std::size_t, std::size_t>> classifiers_class_ids;
+    // Coefficients of all classifiers packed in one aligned row-major classifiers x padded_number_of_features matrix,
+    // repacked after every change of the classifiers
+    aligned_real_vector_t coefficients;
+    aligned_real_vector_t intercepts;
+    std::size_t number_of_features;
+    std::size_t padded_number_of_features;
+    // pairs_classifier_id[lower_class_id * number_of_class + upper_class_id] is the classifier of the pair or -1, both orders are filled
+    std::vector<long> pairs_classifier_id;
+    SVMEvaluationMode evaluation_mode;
+
+    void pack_classifiers();
+
+    // Copy the features vector in the first buffer of the context, zero-padded up to padded_number_of_features
+    const real_t *pad_features_vector(const real_vector_t &features_vector, InferenceContext &context) const;
+
+    // Count the wins of each class over all the classifiers, returns the class with the most wins
+    std::size_t compute_votes(const real_vector_t &features_vector, std::span<std::size_t, ClassDictionary::MAX_NUMBER_OF_CLASSES> votes, InferenceContext &context) const;
+
+    std::size_t predict_class_id_max_wins(const real_vector_t &features_vector, InferenceContext &context) const;
+
+    std::size_t predict_class_id_ddag(const real_vector_t &features_vector, InferenceContext &context) const;
 
 };
 
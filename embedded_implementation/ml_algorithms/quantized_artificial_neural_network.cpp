@@ -0,0 +1,229 @@
+#include "quantized_artificial_neural_network.h"
+#include <cmath>
+#include <execution>
+#include "../helpers/file_helpers.h"
+#include "../helpers/log.h"
+
+/*
+ * QuantizedArtificialNeuralNetwork class definition
+ */
+
+/* PUBLIC DEFINITION */
+QuantizedArtificialNeuralNetwork::QuantizedArtificialNeuralNetwork() {
+    this->clear();
+}
+
+const std::vector<QuantizedDenseLayer> &QuantizedArtificialNeuralNetwork::get_layers() const {
+    return layers;
+}
+
+std::size_t QuantizedArtificialNeuralNetwork::get_memory_footprint() const {
+    std::size_t footprint = sizeof(QuantizedArtificialNeuralNetwork);
+    for (const QuantizedDenseLayer &layer: this->layers) {
+        footprint += sizeof(QuantizedDenseLayer) + layer.weights.capacity() * sizeof(std::int8_t);
+        footprint += (layer.weights_scale.capacity() + layer.biases.capacity() + layer.input_inverse_scales.capacity()) * sizeof(real_t);
+    }
+    return footprint;
+}
+
+std::ostream &operator<<(std::ostream &os, const QuantizedArtificialNeuralNetwork &quantized_artificial_neural_network) {
+    for (std::size_t layer_i = 0; layer_i < quantized_artificial_neural_network.get_layers().size(); layer_i++) {
+        const QuantizedDenseLayer &layer = quantized_artificial_neural_network.get_layers()[layer_i];
+        os << "layer " << layer_i << " (" << layer.input_size << " -> " << layer.output_size << ")\n";
+    }
+    return os << "footprint: " << quantized_artificial_neural_network.get_memory_footprint() << "B";
+}
+
+void QuantizedArtificialNeuralNetwork::quantize(const ArtificialNeuralNetwork &artificial_neural_network, const std::vector<real_vector_t> &calibration_features_vectors, QuantizationGranularity granularity) {
+    this->clear();
+    const std::vector<DenseLayer> &dense_layers = artificial_neural_network.get_dense_layers();
+    if (dense_layers.empty() || calibration_features_vectors.empty()) {
+        LOG(LOG_ERROR) << "Error : trying to quantize a neural network with " << dense_layers.size() << " layers on " << calibration_features_vectors.size() << " calibration features vectors";
+        throw std::invalid_argument("Nothing to quantize or calibrate on!");
+    }
+    this->class_dictionary = ClassDictionary(artificial_neural_network.get_classes());
+
+    // Calibration: largest absolute value of each input of each layer over the calibration set, with the float engine
+    std::vector<real_vector_t> layers_max_input;
+    for (const DenseLayer &dense_layer: dense_layers) {
+        layers_max_input.emplace_back(dense_layer.input_size, 0);
+    }
+    std::size_t buffer_size = 0;
+    for (const DenseLayer &dense_layer: dense_layers) {
+        buffer_size = std::max({buffer_size, dense_layer.padded_input_size, simd_padded_size(dense_layer.output_size)});
+    }
+    std::array<aligned_real_vector_t, 2> float_buffers = {aligned_real_vector_t(buffer_size, 0), aligned_real_vector_t(buffer_size, 0)};
+    for (const real_vector_t &features_vector: calibration_features_vectors) {
+        if (features_vector.size() != dense_layers.front().input_size) {
+            LOG(LOG_ERROR) << "Error : the calibration feature vector size (" << features_vector.size() << ") is different from the input layer size (" << dense_layers.front().input_size << ")";
+            throw std::invalid_argument("Feature vector size differ from input layer size!");
+        }
+        std::fill(float_buffers[0].begin(), float_buffers[0].end(), 0);
+        std::copy(features_vector.cbegin(), features_vector.cend(), float_buffers[0].begin());
+        std::size_t buffer_i = 0;
+        for (std::size_t layer_i = 0; layer_i < dense_layers.size(); layer_i++) {
+            const real_t *input = float_buffers[buffer_i].data();
+            for (std::size_t input_i = 0; input_i < dense_layers[layer_i].input_size; input_i++) {
+                layers_max_input[layer_i][input_i] = std::max(layers_max_input[layer_i][input_i], std::abs(input[input_i]));
+            }
+            ArtificialNeuralNetwork::compute_dense_layer(dense_layers[layer_i], input, float_buffers[1 - buffer_i].data());
+            buffer_i = 1 - buffer_i;
+        }
+    }
+
+    // Symmetric quantization of the weights scaled by the input scales, per layer or per output neuron
+    std::size_t int8_buffer_size = 0;
+    for (std::size_t layer_i = 0; layer_i < dense_layers.size(); layer_i++) {
+        const DenseLayer &dense_layer = dense_layers[layer_i];
+        QuantizedDenseLayer layer = {};
+        layer.input_size = dense_layer.input_size;
+        layer.padded_input_size = simd_padded_size_int8(dense_layer.input_size);
+        layer.output_size = dense_layer.output_size;
+        layer.activation_function = dense_layer.activation_function;
+        layer.biases.assign(dense_layer.biases.cbegin(), dense_layer.biases.cend());
+        real_vector_t input_scales(layer.input_size, 1);
+        layer.input_inverse_scales.assign(layer.input_size, 1);
+        for (std::size_t input_i = 0; input_i < layer.input_size; input_i++) {
+            // An input always at zero keeps a unit scale, its int8 value is zero anyway
+            if (layers_max_input[layer_i][input_i] > 0) {
+                input_scales[input_i] = layers_max_input[layer_i][input_i] / INT8_MAX_VALUE;
+                layer.input_inverse_scales[input_i] = 1.0 / input_scales[input_i];
+            }
+        }
+        real_vector_t scaled_weights(layer.output_size * layer.input_size, 0);
+        for (std::size_t neuron_i = 0; neuron_i < layer.output_size; neuron_i++) {
+            for (std::size_t input_i = 0; input_i < layer.input_size; input_i++) {
+                scaled_weights[neuron_i * layer.input_size + input_i] = dense_layer.weights[neuron_i * dense_layer.padded_input_size + input_i] * input_scales[input_i];
+            }
+        }
+        real_t layer_max_weight = 0;
+        for (real_t scaled_weight: scaled_weights) {
+            layer_max_weight = std::max(layer_max_weight, std::abs(scaled_weight));
+        }
+        layer.weights.assign(layer.output_size * layer.padded_input_size, 0);
+        layer.weights_scale.assign(layer.output_size, 0);
+        real_vector_t weights_inverse_scale(layer.input_size, 0);
+        for (std::size_t neuron_i = 0; neuron_i < layer.output_size; neuron_i++) {
+            const real_t *neuron_weights = scaled_weights.data() + neuron_i * layer.input_size;
+            real_t max_weight = layer_max_weight;
+            if (granularity == QuantizationGranularity::PER_CHANNEL) {
+                max_weight = 0;
+                for (std::size_t input_i = 0; input_i < layer.input_size; input_i++) {
+                    max_weight = std::max(max_weight, std::abs(neuron_weights[input_i]));
+                }
+            }
+            layer.weights_scale[neuron_i] = max_weight > 0 ? max_weight / INT8_MAX_VALUE : 1;
+            std::fill(weights_inverse_scale.begin(), weights_inverse_scale.end(), 1.0 / layer.weights_scale[neuron_i]);
+            quantize_activations(neuron_weights, layer.input_size, weights_inverse_scale.data(), layer.weights.data() + neuron_i * layer.padded_input_size);
+        }
+        int8_buffer_size = std::max({int8_buffer_size, layer.padded_input_size, simd_padded_size_int8(layer.output_size)});
+        this->layers.push_back(std::move(layer));
+    }
+    this->activations_buffer_size = int8_buffer_size;
+    this->weighted_sums_buffer_size = buffer_size;
+}
+
+void QuantizedArtificialNeuralNetwork::clear() {
+    this->layers.clear();
+    this->class_dictionary.clear();
+    this->activations_buffer_size = 0;
+    this->weighted_sums_buffer_size = 0;
+}
+
+void QuantizedArtificialNeuralNetwork::fill_from_csv(const std::filesystem::path &csv_folder_path) {
+    ArtificialNeuralNetwork artificial_neural_network = {};
+    artificial_neural_network.fill_from_csv(csv_folder_path);
+
+    // The calibration set is the train set of the features the network was trained on
+    std::vector<std::pair<std::string, real_vector_t>> train_features_vectors;
+    if (csv_folder_path.filename() == ARTIFICIAL_NEURAL_NETWORK_LAYERS_FOLDER_STFT) {
+        train_features_vectors = get_features_vectors_from_csv(MUSIC_FEATURES_STFT_CSV_TRAIN_PATH, AuFileProcessingAlgorithm::STFT);
+    } else if (csv_folder_path.filename() == ARTIFICIAL_NEURAL_NETWORK_LAYERS_FOLDER_MFCC) {
+        train_features_vectors = get_features_vectors_from_csv(MUSIC_FEATURES_MFCC_CSV_TRAIN_PATH, AuFileProcessingAlgorithm::MFCC);
+    } else {
+        LOG(LOG_ERROR) << "Error : no calibration set is known for the neural network folder " << csv_folder_path << ", use quantize with your own calibration features vectors";
+        throw std::invalid_argument("Unknown calibration set!");
+    }
+    std::vector<real_vector_t> calibration_features_vectors;
+    calibration_features_vectors.reserve(train_features_vectors.size());
+    for (const std::pair<std::string, real_vector_t> &train_features_vector: train_features_vectors) {
+        calibration_features_vectors.push_back(train_features_vector.second);
+    }
+    this->quantize(artificial_neural_network, calibration_features_vectors, QuantizationGranularity::PER_CHANNEL);
+}
+
+const ClassDictionary &QuantizedArtificialNeuralNetwork::get_class_dictionary() const {
+    return class_dictionary;
+}
+
+std::size_t QuantizedArtificialNeuralNetwork::predict_class_id(const real_vector_t &features_vector) const {
+    return this->predict_class_id(features_vector, InferenceContext::get_thread_context());
+}
+
+std::size_t QuantizedArtificialNeuralNetwork::predict_class_id(const real_vector_t &features_vector, InferenceContext &context) const {
+    if (this->layers.empty()) {
+        LOG(LOG_ERROR) << "Error : trying to make prediction but the neural network does not have any layer";
+        throw std::invalid_argument("Neural network does not have any layer!");
+    }
+    const QuantizedDenseLayer &input_layer = this->layers.front();
+    if (features_vector.size() != input_layer.input_size) {
+        LOG(LOG_ERROR) << "Error : trying to make prediction but the feature vector size (" << features_vector.size() << ") is different from the input layer size (" << input_layer.input_size << ")";
+        throw std::invalid_argument("Feature vector size differ from input layer size!");
+    }
+
+    std::array<std::int8_t *, 2> activations_buffers = {context.get_int8_buffer(0, this->activations_buffer_size), context.get_int8_buffer(1, this->activations_buffer_size)};
+    std::int8_t *input = activations_buffers[0];
+    quantize_activations(features_vector.data(), input_layer.input_size, input_layer.input_inverse_scales.data(), input);
+    std::fill(input + input_layer.input_size, input + input_layer.padded_input_size, 0);
+    std::size_t buffer_i = 0;
+    real_t *weighted_sums = context.get_real_buffer(0, this->weighted_sums_buffer_size);
+    for (std::size_t layer_i = 0; layer_i < this->layers.size(); layer_i++) {
+        const QuantizedDenseLayer &layer = this->layers[layer_i];
+        const std::int8_t *layer_input = activations_buffers[buffer_i];
+        for (std::size_t neuron_i = 0; neuron_i < layer.output_size; neuron_i++) {
+            std::int32_t accumulator = simd_dot_product_int8(layer.weights.data() + neuron_i * layer.padded_input_size, layer_input, layer.padded_input_size);
+            weighted_sums[neuron_i] = (real_t) accumulator * layer.weights_scale[neuron_i] + layer.biases[neuron_i];
+        }
+        // The softmax of the output layer does not change the most probable class, the weighted sums are compared directly
+        if (layer_i + 1 == this->layers.size()) {
+            break;
+        }
+        switch (layer.activation_function) {
+            case ActivationFunction::SIGMOID : {
+                for (std::size_t neuron_i = 0; neuron_i < layer.output_size; neuron_i++) {
+                    weighted_sums[neuron_i] = 1.0 / (1.0 + std::exp(-weighted_sums[neuron_i]));
+                }
+                break;
+            }
+            case ActivationFunction::RELU : {
+                for (std::size_t neuron_i = 0; neuron_i < layer.output_size; neuron_i++) {
+                    weighted_sums[neuron_i] = std::max((real_t) 0, weighted_sums[neuron_i]);
+                }
+                break;
+            }
+            default: {
+                LOG(LOG_ERROR) << "Error : the activation function value usage is not supported by the hidden layers of a quantized neural network";
+                throw std::domain_error("Unsupported activation function!");
+                break;
+            }
+        }
+        // Requantize with the input scales of the next layer
+        const QuantizedDenseLayer &next_layer = this->layers[layer_i + 1];
+        std::int8_t *output = activations_buffers[1 - buffer_i];
+        quantize_activations(weighted_sums, layer.output_size, next_layer.input_inverse_scales.data(), output);
+        std::fill(output + layer.output_size, output + next_layer.padded_input_size, 0);
+        buffer_i = 1 - buffer_i;
+    }
+
+    // Get the prediction result with the most choice
+    auto pr = std::max_element(std::execution::seq, weighted_sums, weighted_sums + this->layers.back().output_size);
+    return std::distance(weighted_sums, pr);
+}
+
+/* PRIVATE DEFINITION */
+void QuantizedArtificialNeuralNetwork::quantize_activations(const real_t *activations, std::size_t size, const real_t *inverse_scales, std::int8_t *quantized_activations) {
+    for (std::size_t i = 0; i < size; i++) {
+        real_t quantized_activation = std::nearbyint(activations[i] * inverse_scales[i]);
+        quantized_activations[i] = (std::int8_t) std::clamp(quantized_activation, (real_t) -INT8_MAX_VALUE, (real_t) INT8_MAX_VALUE);
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef QUANTIZED_ARTIFICIAL_NEURAL_NETWORK_H
+#define QUANTIZED_ARTIFICIAL_NEURAL_NETWORK_H
+
+#include <cstdint>
+#include <vector>
+#include "artificial_neural_network.h"
+#include "machine_learning_model.h"
+#include "globals.h"
+#include "../helpers/simd.h"
+
+/**
+ * @brief List of weight quantization granularities
+ */
+enum class QuantizationGranularity {
+    PER_LAYER = 0, /** One weight scale for the whole layer */
+    PER_CHANNEL = 1 /** One weight scale per output neuron */
+};
+
+/*
+ * QuantizedDenseLayer struct definition
+ */
+// Layer with int8 weights and inputs, real input i = input_scales[i] * int8 input i
+// The input scales are folded into the weights, weights_scale[o] * int8 weight (o, i) = real weight (o, i) * input_scales[i]
+struct QuantizedDenseLayer {
+    std::size_t input_size = 0;
+    std::size_t padded_input_size = 0;
+    std::size_t output_size = 0;
+    // Row-major output_size x padded_input_size matrix
+    aligned_int8_vector_t weights;
+    real_vector_t weights_scale;
+    real_vector_t biases;
+    // Inverse of the input scales, applied when the previous layer requantizes its activations
+    real_vector_t input_inverse_scales;
+    ActivationFunction activation_function = ActivationFunction::RELU;
+};
+
+/*
+ * QuantizedArtificialNeuralNetwork class definition
+ */
+// Post-training symmetric int8 quantization of an ArtificialNeuralNetwork, the layers compute int8 x int8 -> int32 dot products
+// and the weighted sums are requantized to int8 with the calibrated input scales of the next layer
+class QuantizedArtificialNeuralNetwork : public MachineLearningModel {
+public:
+    QuantizedArtificialNeuralNetwork();
+
+    const std::vector<QuantizedDenseLayer> &get_layers() const;
+
+    std::size_t get_memory_footprint() const;
+
+    friend std::ostream &operator<<(std::ostream &os, const QuantizedArtificialNeuralNetwork &quantized_artificial_neural_network);
+
+    // Calibrate one scale per input of each layer on the largest activation seen on the calibration features vectors, then quantize the weights
+    void quantize(const ArtificialNeuralNetwork &artificial_neural_network, const std::vector<real_vector_t> &calibration_features_vectors, QuantizationGranularity granularity);
+
+    void clear();
+
+    // Load the float network and calibrate it on the train features vectors of the same folder type (STFT or MFCC)
+    void fill_from_csv(const std::filesystem::path &csv_folder_path) override;
+
+    const ClassDictionary &get_class_dictionary() const override;
+
+    std::size_t predict_class_id(const real_vector_t &features_vector) const override;
+
+    // Same prediction with the int8 activations in the int8 buffers 0 and 1 of the context and the weighted sums in its real buffer 0
+    std::size_t predict_class_id(const real_vector_t &features_vector, InferenceContext &context) const;
+
+    static constexpr std::int8_t INT8_MAX_VALUE = 127;
+
+private:
+    std::vector<QuantizedDenseLayer> layers;
+    ClassDictionary class_dictionary;
+    // Sizes of the ping-pong int8 activation buffers and of the real weighted sums buffer of the current layer
+    std::size_t activations_buffer_size;
+    std::size_t weighted_sums_buffer_size;
+
+    // Round to the nearest int8 step of the scales, saturated to [-127, 127]
+    static void quantize_activations(const real_t *activations, std::size_t size, const real_t *inverse_scales, std::int8_t *quantized_activations);
+};
+
+#endif //QUANTIZED_ARTIFICIAL_NEURAL_NETWORK_H
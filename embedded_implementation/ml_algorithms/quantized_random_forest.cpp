@@ -0,0 +1,333 @@
+#include "quantized_random_forest.h"
+
+#include <set>
+#include <array>
+#include <queue>
+#include <functional>
+#include <unordered_map>
+#include <execution>
+#include "../helpers/log.h"
+
+/*
+ * QuantizedRandomForest class definition
+ */
+
+/* PUBLIC DEFINITION */
+QuantizedRandomForest::QuantizedRandomForest() {
+    this->clear();
+}
+
+const std::vector<CompactTreeNode> &QuantizedRandomForest::get_nodes() const {
+    return nodes;
+}
+
+const ClassDictionary &QuantizedRandomForest::get_class_dictionary() const {
+    return class_dictionary;
+}
+
+std::size_t QuantizedRandomForest::get_number_of_trees() const {
+    return this->trees_root_id.size();
+}
+
+std::size_t QuantizedRandomForest::get_number_of_features() const {
+    return number_of_features;
+}
+
+std::size_t QuantizedRandomForest::get_bin_size() const {
+    return bin_size;
+}
+
+std::size_t QuantizedRandomForest::get_memory_footprint() const {
+    std::size_t footprint = sizeof(QuantizedRandomForest);
+    footprint += this->nodes.capacity() * sizeof(CompactTreeNode);
+    footprint += this->trees_root_id.capacity() * sizeof(std::uint32_t);
+    footprint += this->trees_steps.capacity() * sizeof(std::uint32_t);
+    footprint += this->thresholds.capacity() * sizeof(real_t);
+    footprint += this->features_thresholds_offset.capacity() * sizeof(std::uint32_t);
+    for (const std::string &class_name: this->class_dictionary.get_class_names()) {
+        footprint += sizeof(std::string) + class_name.capacity() + 1;
+    }
+    return footprint;
+}
+
+std::ostream &operator<<(std::ostream &os, const QuantizedRandomForest &quantized_random_forest) {
+    return os << "(trees: " << quantized_random_forest.get_number_of_trees() << ", nodes: " << quantized_random_forest.get_nodes().size() << ", features: " << quantized_random_forest.get_number_of_features() << ", bin size: " << quantized_random_forest.get_bin_size() << "B, footprint: " << quantized_random_forest.get_memory_footprint() << "B)";
+}
+
+void QuantizedRandomForest::quantize(const RandomForest &random_forest) {
+    this->clear();
+    // The class dictionary holds at most MAX_NUMBER_OF_CLASSES classes so every class id fits in the feature_id of a leaf
+    this->class_dictionary = random_forest.get_class_dictionary();
+
+    // Collect the distinct split thresholds of each feature across all trees
+    int max_feature_id = 0;
+    for (const DecisionTree &tree: random_forest.get_trees()) {
+        max_feature_id = std::max(max_feature_id, tree.get_max_feature_id());
+    }
+    this->number_of_features = max_feature_id + 1;
+    if (this->number_of_features > UINT16_MAX) {
+        LOG(LOG_ERROR) << "Error : trying to quantize a forest using " << this->number_of_features << " features but a compact node can only store " << UINT16_MAX << " feature ids";
+        throw std::invalid_argument("Too many features to quantize!");
+    }
+    std::vector<std::set<real_t>> features_thresholds(this->number_of_features);
+    for (const DecisionTree &tree: random_forest.get_trees()) {
+        for (const auto &[node_id, node]: tree.get_tree()) {
+            if (node.as_children() && node.get_feature_id() >= 0) {
+                features_thresholds[node.get_feature_id()].insert(node.get_threshold());
+            }
+        }
+    }
+    this->features_thresholds_offset.push_back(0);
+    for (std::size_t feature_id = 0; feature_id < this->number_of_features; feature_id++) {
+        if (features_thresholds[feature_id].size() >= LEAF_THRESHOLD_BIN) {
+            LOG(LOG_ERROR) << "Error : trying to quantize the feature " << feature_id << " with " << features_thresholds[feature_id].size() << " distinct thresholds but a bin id is stored on 16 bits";
+            throw std::invalid_argument("Too many thresholds to quantize!");
+        }
+        std::copy(features_thresholds[feature_id].cbegin(), features_thresholds[feature_id].cend(), std::back_inserter(this->thresholds));
+        this->features_thresholds_offset.push_back(this->thresholds.size());
+        // A feature with N thresholds has N + 1 bins, from 0 to N
+        if (features_thresholds[feature_id].size() > UINT8_MAX) {
+            this->bin_size = sizeof(std::uint16_t);
+        }
+    }
+
+    // Lay out each tree breadth first so the two children of a node are next to each other
+    for (const DecisionTree &tree: random_forest.get_trees()) {
+        if (tree.get_tree().count(0) == 0) {
+            LOG(LOG_ERROR) << "Error : trying to quantize a tree that does not have a root node";
+            throw std::invalid_argument("Tree does not have a root node!");
+        }
+        std::uint32_t root_id = this->nodes.size();
+        this->nodes.push_back({});
+        this->trees_root_id.push_back(root_id);
+        this->trees_steps.push_back(tree.get_depth() - 1);
+
+        // <tree node id, compact node id>
+        std::queue<std::pair<std::size_t, std::uint32_t>> nodes_to_place;
+        nodes_to_place.emplace(0, root_id);
+        while (!nodes_to_place.empty()) {
+            auto [node_id, compact_node_id] = nodes_to_place.front();
+            nodes_to_place.pop();
+            const TreeNode &node = tree.get_tree().at(node_id);
+
+            if (node.as_children() && node.get_feature_id() >= 0) {
+                const real_t *feature_thresholds_begin = this->thresholds.data() + this->features_thresholds_offset[node.get_feature_id()];
+                const real_t *feature_thresholds_end = this->thresholds.data() + this->features_thresholds_offset[node.get_feature_id() + 1];
+                std::uint32_t children_id = this->nodes.size();
+                this->nodes.resize(this->nodes.size() + 2);
+                this->nodes[compact_node_id] = {(std::uint16_t) node.get_feature_id(),
+                                                (std::uint16_t) std::distance(feature_thresholds_begin, std::lower_bound(feature_thresholds_begin, feature_thresholds_end, node.get_threshold())),
+                                                children_id};
+                nodes_to_place.emplace(node.get_left_children_id(), children_id);
+                nodes_to_place.emplace(node.get_right_children_id(), children_id + 1);
+            } else {
+                this->nodes[compact_node_id] = {(std::uint16_t) this->class_dictionary.get_class_id(node.get_class_name()), LEAF_THRESHOLD_BIN, compact_node_id};
+            }
+        }
+    }
+    this->nodes.shrink_to_fit();
+}
+
+void QuantizedRandomForest::compress() {
+    // A node is identified by its 8 bytes, and a pair of sibling nodes by its 16 bytes
+    auto node_key = [](const CompactTreeNode &node) {
+        return ((std::uint64_t) node.feature_id << 48) | ((std::uint64_t) node.threshold_bin << 32) | node.children_id;
+    };
+    auto pair_hash = [](const std::pair<std::uint64_t, std::uint64_t> &p) {
+        return std::hash<std::uint64_t>()(p.first) ^ (std::hash<std::uint64_t>()(p.second) * 0x9e3779b97f4a7c15ULL);
+    };
+    std::unordered_map<std::pair<std::uint64_t, std::uint64_t>, std::uint32_t, decltype(pair_hash)> pairs_id(0, pair_hash);
+    std::vector<std::uint32_t> leaves_pair_id(this->class_dictionary.size(), UINT32_MAX);
+    std::vector<CompactTreeNode> shared_nodes;
+
+    // Id of the first node of the shared pair (left, right), created the first time it is seen
+    auto get_pair_id = [&pairs_id, &shared_nodes, &node_key](const CompactTreeNode &left, const CompactTreeNode &right) {
+        auto [pair_it, inserted] = pairs_id.try_emplace(std::make_pair(node_key(left), node_key(right)), (std::uint32_t) shared_nodes.size());
+        if (inserted) {
+            shared_nodes.push_back(left);
+            shared_nodes.push_back(right);
+        }
+        return pair_it->second;
+    };
+
+    // Hash the subtrees bottom-up, a node is rewritten once its children point to their shared pair
+    std::function<CompactTreeNode(std::uint32_t)> share_subtree = [this, &leaves_pair_id, &shared_nodes, &get_pair_id, &share_subtree](std::uint32_t node_id) {
+        const CompactTreeNode node = this->nodes[node_id];
+        if (node.threshold_bin == LEAF_THRESHOLD_BIN) {
+            // All the leaves of a class share a pair made of two copies of the leaf, so a leaf still loops on itself
+            if (leaves_pair_id[node.feature_id] == UINT32_MAX) {
+                leaves_pair_id[node.feature_id] = shared_nodes.size();
+                CompactTreeNode leaf = {node.feature_id, LEAF_THRESHOLD_BIN, (std::uint32_t) shared_nodes.size()};
+                shared_nodes.push_back(leaf);
+                shared_nodes.push_back(leaf);
+            }
+            return shared_nodes[leaves_pair_id[node.feature_id]];
+        }
+        CompactTreeNode left = share_subtree(node.children_id);
+        CompactTreeNode right = share_subtree(node.children_id + 1);
+        return CompactTreeNode{node.feature_id, node.threshold_bin, get_pair_id(left, right)};
+    };
+
+    // A root is stored as a pair of two copies of itself so identical trees are shared too
+    for (std::uint32_t &root_id: this->trees_root_id) {
+        CompactTreeNode root = share_subtree(root_id);
+        root_id = get_pair_id(root, root);
+    }
+
+    LOG(LOG_DEBUG) << "forest compressed from " << this->nodes.size() << " to " << shared_nodes.size() << " nodes";
+    this->nodes = std::move(shared_nodes);
+    this->nodes.shrink_to_fit();
+}
+
+std::size_t QuantizedRandomForest::get_working_set(const std::vector<real_vector_t> &features_vectors) const {
+    const std::size_t bins_per_sample = this->get_bins_per_sample();
+    std::vector<std::uint16_t> bins(bins_per_sample, 0);
+    std::set<std::size_t> touched_cache_lines;
+    const std::uintptr_t nodes_address = reinterpret_cast<std::uintptr_t>(this->nodes.data());
+
+    for (const real_vector_t &features_vector: features_vectors) {
+        this->quantize_features(features_vector, bins.data());
+        for (std::size_t tree_i = 0; tree_i < this->trees_root_id.size(); tree_i++) {
+            std::uint32_t current_node_id = this->trees_root_id[tree_i];
+            for (std::uint32_t step = 0; step <= this->trees_steps[tree_i]; step++) {
+                touched_cache_lines.insert((nodes_address + current_node_id * sizeof(CompactTreeNode)) / CACHE_LINE_SIZE);
+                const CompactTreeNode node = this->nodes[current_node_id];
+                current_node_id = node.children_id + (bins[node.feature_id] > node.threshold_bin);
+            }
+        }
+    }
+
+    return touched_cache_lines.size() * CACHE_LINE_SIZE;
+}
+
+void QuantizedRandomForest::clear() {
+    this->nodes.clear();
+    this->trees_root_id.clear();
+    this->trees_steps.clear();
+    this->thresholds.clear();
+    this->features_thresholds_offset.clear();
+    this->class_dictionary.clear();
+    this->number_of_features = 0;
+    this->bin_size = sizeof(std::uint8_t);
+}
+
+void QuantizedRandomForest::fill_from_csv(const std::filesystem::path &csv_folder_path) {
+    RandomForest random_forest = {};
+    random_forest.fill_from_csv(csv_folder_path);
+    this->quantize(random_forest);
+}
+
+std::size_t QuantizedRandomForest::predict_class_id(const real_vector_t &features_vector) const {
+    return this->predict_class_id(features_vector, InferenceContext::get_thread_context());
+}
+
+std::size_t QuantizedRandomForest::predict_class_id(const real_vector_t &features_vector, InferenceContext &context) const {
+    std::array<std::size_t, ClassDictionary::MAX_NUMBER_OF_CLASSES> votes = {};
+    if (this->bin_size == sizeof(std::uint8_t)) {
+        this->compute_votes_block(&features_vector, 1, context.get_bin_buffer<std::uint8_t>(this->get_bins_per_sample()), votes.data());
+    } else {
+        this->compute_votes_block(&features_vector, 1, context.get_bin_buffer<std::uint16_t>(this->get_bins_per_sample()), votes.data());
+    }
+
+    // Get the prediction result with the most choice, ties go to the first class in alphabetical order like RandomForest
+    auto pr = std::max_element(std::execution::seq, votes.cbegin(), votes.cbegin() + (long) this->class_dictionary.size());
+    return std::distance(votes.cbegin(), pr);
+}
+
+std::vector<std::size_t> QuantizedRandomForest::predict_class_ids(const std::vector<real_vector_t> &features_vectors) const {
+    std::vector<std::size_t> votes = this->compute_votes(features_vectors);
+    const std::size_t number_of_classes = this->class_dictionary.size();
+
+    std::vector<std::size_t> predicted_class_ids;
+    predicted_class_ids.reserve(features_vectors.size());
+    for (std::size_t sample_i = 0; sample_i < features_vectors.size(); sample_i++) {
+        auto sample_votes = votes.cbegin() + (long) (sample_i * number_of_classes);
+        auto pr = std::max_element(sample_votes, sample_votes + (long) number_of_classes);
+        predicted_class_ids.push_back(std::distance(sample_votes, pr));
+    }
+    return predicted_class_ids;
+}
+
+std::vector<std::size_t> QuantizedRandomForest::compute_votes(const std::vector<real_vector_t> &features_vectors) const {
+    const std::size_t number_of_classes = this->class_dictionary.size();
+    std::vector<std::size_t> votes(features_vectors.size() * number_of_classes, 0);
+    const bool narrow_bins = this->bin_size == sizeof(std::uint8_t);
+    std::vector<std::uint8_t> narrow_bins_block(narrow_bins ? BATCH_BLOCK_SIZE * this->get_bins_per_sample() : 0, 0);
+    std::vector<std::uint16_t> wide_bins_block(narrow_bins ? 0 : BATCH_BLOCK_SIZE * this->get_bins_per_sample(), 0);
+
+    for (std::size_t block_first = 0; block_first < features_vectors.size(); block_first += BATCH_BLOCK_SIZE) {
+        const std::size_t block_size = std::min(BATCH_BLOCK_SIZE, features_vectors.size() - block_first);
+        if (narrow_bins) {
+            this->compute_votes_block(features_vectors.data() + block_first, block_size, narrow_bins_block.data(), votes.data() + block_first * number_of_classes);
+        } else {
+            this->compute_votes_block(features_vectors.data() + block_first, block_size, wide_bins_block.data(), votes.data() + block_first * number_of_classes);
+        }
+    }
+
+    return votes;
+}
+
+/* PRIVATE DEFINITION */
+std::size_t QuantizedRandomForest::get_bins_per_sample() const {
+    return std::max(this->number_of_features, this->class_dictionary.size());
+}
+
+template<typename bin_t>
+void QuantizedRandomForest::quantize_features(const real_vector_t &features_vector, bin_t *bins) const {
+    if (features_vector.size() < this->number_of_features) {
+        LOG(LOG_ERROR) << "Error : trying to make prediction but the forest contain a feature id bigger than the feature vector size (" << features_vector.size() << " < " << this->number_of_features << ")";
+        throw std::invalid_argument("Feature vector too small!");
+    }
+
+    // The bin of a value is the number of thresholds strictly below it, so value <= threshold[k] <=> bin <= k
+    for (std::size_t feature_id = 0; feature_id < this->number_of_features; feature_id++) {
+        const real_t *feature_thresholds_begin = this->thresholds.data() + this->features_thresholds_offset[feature_id];
+        const real_t *feature_thresholds_end = this->thresholds.data() + this->features_thresholds_offset[feature_id + 1];
+        bins[feature_id] = (bin_t) std::distance(feature_thresholds_begin, std::lower_bound(feature_thresholds_begin, feature_thresholds_end, features_vector[feature_id]));
+    }
+}
+
+template<typename bin_t>
+void QuantizedRandomForest::compute_votes_block(const real_vector_t *features_vectors, std::size_t count, bin_t *bins, std::size_t *votes) const {
+    if (this->trees_root_id.empty()) {
+        LOG(LOG_ERROR) << "Error : trying to make prediction but the forest does not have any tree";
+        throw std::invalid_argument("Forest does not have any tree!");
+    }
+    const std::size_t number_of_classes = this->class_dictionary.size();
+    const std::size_t bins_per_sample = this->get_bins_per_sample();
+
+    // Convert the features vectors into bin ids once for all the trees, the bins read by the leaves past the features are zeros
+    for (std::size_t i = 0; i < count; i++) {
+        bin_t *sample_bins = bins + i * bins_per_sample;
+        std::fill(sample_bins + this->number_of_features, sample_bins + bins_per_sample, 0);
+        this->quantize_features(features_vectors[i], sample_bins);
+    }
+
+    const CompactTreeNode *compact_nodes = this->nodes.data();
+    for (std::size_t tree_i = 0; tree_i < this->trees_root_id.size(); tree_i++) {
+        const std::uint32_t root_id = this->trees_root_id[tree_i];
+        const std::uint32_t steps = this->trees_steps[tree_i];
+
+        for (std::size_t group_first = 0; group_first < count; group_first += INTERLEAVED_SAMPLES) {
+            const std::size_t group_size = std::min(INTERLEAVED_SAMPLES, count - group_first);
+            std::uint32_t current_nodes[INTERLEAVED_SAMPLES];
+            const bin_t *samples_bins[INTERLEAVED_SAMPLES];
+            for (std::size_t i = 0; i < group_size; i++) {
+                current_nodes[i] = root_id;
+                samples_bins[i] = bins + (group_first + i) * bins_per_sample;
+            }
+
+            // Integer compares only, leaves loop on themselves until the last step
+            for (std::uint32_t step = 0; step < steps; step++) {
+                for (std::size_t i = 0; i < group_size; i++) {
+                    const CompactTreeNode node = compact_nodes[current_nodes[i]];
+                    current_nodes[i] = node.children_id + (samples_bins[i][node.feature_id] > node.threshold_bin);
+                }
+            }
+
+            for (std::size_t i = 0; i < group_size; i++) {
+                votes[(group_first + i) * number_of_classes + compact_nodes[current_nodes[i]].feature_id] += 1;
+            }
+        }
+    }
+}
@@ -0,0 +1,99 @@
+#ifndef QUANTIZED_RANDOM_FOREST_H
+#define QUANTIZED_RANDOM_FOREST_H
+
+#include <cstdint>
+#include <vector>
+#include "random_forest.h"
+#include "machine_learning_model.h"
+#include "globals.h"
+#include "../helpers/inference_context.h"
+
+/*
+ * CompactTreeNode struct definition
+ */
+// 8 bytes node of a quantized tree, the two children of a node are stored next to each other
+// A leaf has threshold_bin = LEAF_THRESHOLD_BIN (no bin is bigger so it always goes to children_id), feature_id = its class id
+// and children_id = a node holding the same leaf, its own id in a tree or the shared leaf pair of its class in a compressed forest
+struct CompactTreeNode {
+    std::uint16_t feature_id;
+    std::uint16_t threshold_bin; // go to the left child (children_id) when bin <= threshold_bin, else to the right child (children_id + 1)
+    std::uint32_t children_id;
+};
+static_assert(sizeof(CompactTreeNode) == 8, "A compact tree node must fit in 8 bytes");
+
+/*
+ * QuantizedRandomForest class definition
+ */
+class QuantizedRandomForest : public MachineLearningModel {
+public:
+    QuantizedRandomForest();
+
+    const std::vector<CompactTreeNode> &get_nodes() const;
+
+    const ClassDictionary &get_class_dictionary() const override;
+
+    std::size_t get_number_of_trees() const;
+
+    std::size_t get_number_of_features() const;
+
+    // Size in bytes of a feature bin id (1 if every feature has less than 256 thresholds, else 2)
+    std::size_t get_bin_size() const;
+
+    std::size_t get_memory_footprint() const;
+
+    friend std::ostream &operator<<(std::ostream &os, const QuantizedRandomForest &quantized_random_forest);
+
+    // Replace the thresholds of every tree by the bin ids of the per-feature sorted distinct thresholds
+    void quantize(const RandomForest &random_forest);
+
+    // Merge the identical subtrees of all trees into a shared DAG, the evaluation runs unchanged on the shared nodes
+    void compress();
+
+    // Number of distinct bytes (counted by cache lines) of nodes read to predict the features vectors
+    std::size_t get_working_set(const std::vector<real_vector_t> &features_vectors) const;
+
+    void clear();
+
+    void fill_from_csv(const std::filesystem::path &csv_folder_path) override;
+
+    std::size_t predict_class_id(const real_vector_t &features_vector) const override;
+
+    // Same prediction with the bins of the features in the bin buffer of the context
+    std::size_t predict_class_id(const real_vector_t &features_vector, InferenceContext &context) const;
+
+    std::vector<std::size_t> predict_class_ids(const std::vector<real_vector_t> &features_vectors) const override;
+
+    // Dense samples x classes array with votes[sample_i * number_of_classes + class_id] the number of trees voting class_id for sample_i
+    std::vector<std::size_t> compute_votes(const std::vector<real_vector_t> &features_vectors) const;
+
+    static constexpr std::uint16_t LEAF_THRESHOLD_BIN = UINT16_MAX;
+    static constexpr std::size_t CACHE_LINE_SIZE = 64;
+    // Number of samples scored by one tree before moving on to the next tree
+    static constexpr std::size_t BATCH_BLOCK_SIZE = 64;
+    // Number of samples walking down a tree together to hide the memory latency of each other
+    static constexpr std::size_t INTERLEAVED_SAMPLES = 8;
+
+private:
+    std::vector<CompactTreeNode> nodes;
+    std::vector<std::uint32_t> trees_root_id;
+    // Number of steps needed to reach any leaf of the tree (depth - 1)
+    std::vector<std::uint32_t> trees_steps;
+    // Sorted distinct thresholds of all features, the ones of feature f are in [features_thresholds_offset[f], features_thresholds_offset[f + 1])
+    std::vector<real_t> thresholds;
+    std::vector<std::uint32_t> features_thresholds_offset;
+    ClassDictionary class_dictionary;
+    std::size_t number_of_features;
+    std::size_t bin_size;
+
+    template<typename bin_t>
+    void quantize_features(const real_vector_t &features_vector, bin_t *bins) const;
+
+    // Number of bins of a sample in a bins buffer, a leaf reads the bin at the index of its class id
+    std::size_t get_bins_per_sample() const;
+
+    // The bins buffer holds at least count * get_bins_per_sample() bins
+    template<typename bin_t>
+    void compute_votes_block(const real_vector_t *features_vectors, std::size_t count, bin_t *bins, std::size_t *votes) const;
+};
+
+#endif //QUANTIZED_RANDOM_FOREST_H
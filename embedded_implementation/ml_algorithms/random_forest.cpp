@@ -1,6 +1,8 @@
 
 #include <vector>
 #include <map>
+#include <set>
+#include <array>
 #include <execution>
 #include "random_forest.h"
 
@@ -12,6 +14,31 @@
 /* PUBLIC DEFINITION */
 RandomForest::RandomForest() {
     trees = {};
+    class_dictionary = {};
+    trees_class_ids = {};
+    early_termination = false;
+}
+
+RandomForest::RandomForest(const RandomForest &random_forest) : RandomForest() {
+    *this = random_forest;
+}
+
+RandomForest &RandomForest::operator=(const RandomForest &random_forest) {
+    if (this != &random_forest) {
+        // Copy the trees one by one so their nodes go in the arena of this forest
+        this->trees.clear();
+        this->trees.reserve(random_forest.trees.size());
+        for (const DecisionTree &tree: random_forest.trees) {
+            DecisionTree tree_copy(this->arena.share());
+            tree_copy = tree;
+            this->trees.push_back(std::move(tree_copy));
+        }
+        this->class_dictionary = random_forest.class_dictionary;
+        this->trees_class_ids = random_forest.trees_class_ids;
+        this->early_termination = random_forest.early_termination;
+        this->thread_pool = random_forest.thread_pool;
+    }
+    return *this;
 }
 
 const std::vector<DecisionTree> &RandomForest::get_trees() const {
@@ -22,6 +49,37 @@ unsigned long RandomForest::get_number_of_trees() const {
     return this->trees.size();
 }
 
+const ModelArena &RandomForest::get_arena() const {
+    return *this->arena.get();
+}
+
+bool RandomForest::get_early_termination() const {
+    return early_termination;
+}
+
+void RandomForest::set_early_termination(bool early_termination) {
+    this->early_termination = early_termination;
+}
+
+void RandomForest::set_thread_pool(std::shared_ptr<ThreadPool> thread_pool) {
+    this->thread_pool = std::move(thread_pool);
+}
+
+std::size_t RandomForest::get_memory_footprint() const {
+    std::size_t footprint = sizeof(RandomForest);
+    for (const DecisionTree &tree: this->trees) {
+        footprint += tree.get_memory_footprint();
+    }
+    footprint += (this->trees.capacity() - this->trees.size()) * sizeof(DecisionTree);
+    for (const std::string &class_name: this->class_dictionary.get_class_names()) {
+        footprint += sizeof(std::string) + class_name.capacity() + 1;
+    }
+    for (const std::vector<std::size_t> &tree_class_ids: this->trees_class_ids) {
+        footprint += sizeof(tree_class_ids) + tree_class_ids.capacity() * sizeof(std::size_t);
+    }
+    return footprint;
+}
+
 std::ostream &operator<<(std::ostream &os, const RandomForest &random_forest) {
     for (const DecisionTree &tree: random_forest.get_trees()) {
         os << "\n - tree[depth: " << tree.get_depth() << ", number_of_nodes: " << tree.get_number_of_nodes() << "]";
@@ -30,47 +88,243 @@ std::ostream &operator<<(std::ostream &os, const RandomForest &random_forest) {
 }
 
 void RandomForest::push_tree(const DecisionTree &tree) {
-    this->trees.push_back(tree);
+    DecisionTree tree_copy(this->arena.share());
+    tree_copy = tree;
+    this->trees.push_back(std::move(tree_copy));
+    this->compute_classes();
+}
+
+void RandomForest::push_tree(DecisionTree &&tree) {
+    this->trees.push_back(std::move(tree));
+    this->compute_classes();
 }
 
 void RandomForest::pop_tree() {
     this->trees.pop_back();
+    this->compute_classes();
 }
 
 void RandomForest::clear() {
     this->trees.clear();
+    this->class_dictionary.clear();
+    this->trees_class_ids.clear();
+}
+
+void RandomForest::sort_trees_by_accuracy(const std::vector<std::pair<std::string, real_vector_t>> &validation_features_vectors) {
+    if (validation_features_vectors.empty()) {
+        LOG(LOG_ERROR) << "Error : trying to sort the trees by accuracy on an empty validation set";
+        throw std::invalid_argument("Empty validation set!");
+    }
+    // <tree accuracy, tree>
+    std::vector<std::pair<real_t, DecisionTree>> scored_trees;
+    for (DecisionTree &tree: this->trees) {
+        std::size_t good_predictions = 0;
+        for (const auto &[true_class, features_vector]: validation_features_vectors) {
+            if (tree.get_class_dictionary().get_class_name(tree.predict_class_id(features_vector)) == true_class) {
+                good_predictions += 1;
+            }
+        }
+        scored_trees.emplace_back((real_t) good_predictions / (real_t) validation_features_vectors.size(), std::move(tree));
+    }
+    std::stable_sort(scored_trees.begin(), scored_trees.end(), [](const std::pair<real_t, DecisionTree> &t1, const std::pair<real_t, DecisionTree> &t2) {
+        return t1.first > t2.first;
+    });
+
+    this->trees.clear();
+    for (auto &scored_tree: scored_trees) {
+        LOG(LOG_DEBUG) << "tree accuracy: " << scored_tree.first;
+        this->trees.push_back(std::move(scored_tree.second));
+    }
+    this->compute_classes();
 }
 
 void RandomForest::fill_from_csv(const std::filesystem::path &csv_folder_path) {
+    // The tree files are parsed concurrently on the thread pool, each task fills its own slot so the trees keep the file order
     auto csv_files = alpha_files_listing(csv_folder_path.string());
-    for (const auto &csv_file_path: csv_files) {
-        DecisionTree new_tree = {};
-        new_tree.fill_from_csv(csv_file_path);
-        this->push_tree(new_tree);
+    std::vector<DecisionTree> csv_trees;
+    csv_trees.reserve(csv_files.size());
+    for (std::size_t tree_i = 0; tree_i < csv_files.size(); tree_i++) {
+        csv_trees.emplace_back(this->arena.share());
+    }
+    auto tree_task = [&csv_files, &csv_trees](std::size_t tree_i) {
+        csv_trees[tree_i].fill_from_csv(csv_files[tree_i]);
+    };
+    if (this->thread_pool) {
+        this->thread_pool->parallel_for(csv_files.size(), tree_task);
+    } else {
+        for (std::size_t tree_i = 0; tree_i < csv_files.size(); tree_i++) {
+            tree_task(tree_i);
+        }
+    }
+
+    this->trees.reserve(this->trees.size() + csv_trees.size());
+    std::move(csv_trees.begin(), csv_trees.end(), std::back_inserter(this->trees));
+    this->compute_classes();
+}
+
+void RandomForest::fill_from_binary(const std::filesystem::path &binary_file_path) {
+    MappedModelContainer model_container(binary_file_path);
+    model_container.expect_model_type(ModelType::RANDOM_FOREST);
+    const ClassDictionary class_names = model_container.get_class_dictionary();
+    const std::size_t number_of_trees = model_container.get_number_of_sections(ModelSectionType::TREE_NODES);
+    this->trees.reserve(this->trees.size() + number_of_trees);
+    for (std::size_t tree_i = 0; tree_i < number_of_trees; tree_i++) {
+        DecisionTree new_tree(this->arena.share());
+        new_tree.fill_from_binary_nodes(model_container.get_section<BinaryTreeNode>(ModelSectionType::TREE_NODES, tree_i), class_names);
+        this->trees.push_back(std::move(new_tree));
+    }
+    this->compute_classes();
+}
+
+void RandomForest::write_to_binary(const std::filesystem::path &binary_file_path) const {
+    ClassDictionary class_names;
+    std::vector<std::vector<BinaryTreeNode>> trees_binary_nodes;
+    for (const DecisionTree &tree: this->trees) {
+        trees_binary_nodes.push_back(tree.get_binary_nodes(class_names));
+    }
+    ModelContainerWriter model_container(ModelType::RANDOM_FOREST);
+    model_container.add_class_dictionary(class_names);
+    for (const std::vector<BinaryTreeNode> &binary_nodes: trees_binary_nodes) {
+        model_container.add_section(ModelSectionType::TREE_NODES, binary_nodes.data(), binary_nodes.size());
+    }
+    model_container.write(binary_file_path);
+}
+
+std::vector<std::size_t> RandomForest::get_used_features() const {
+    std::set<std::size_t> used_features;
+    for (const DecisionTree &tree: this->trees) {
+        const std::vector<std::size_t> tree_used_features = tree.get_used_features();
+        used_features.insert(tree_used_features.cbegin(), tree_used_features.cend());
     }
+    return {used_features.cbegin(), used_features.cend()};
+}
+
+std::size_t RandomForest::predict_class_id(const real_vector_t &features_vector) const {
+    RandomForestPredictionStats prediction_stats = {};
+    return this->predict_class_id(features_vector, prediction_stats);
 }
 
-std::string RandomForest::predict_class(const real_vector_t &features_vector) {
-    std::map<std::string, std::size_t> pred_results;
-    using pred_results_pair_t = decltype(pred_results)::value_type;
+std::size_t RandomForest::predict_class_id(const real_vector_t &features_vector, RandomForestPredictionStats &prediction_stats) const {
+    const std::size_t number_of_classes = this->class_dictionary.size();
+    std::array<std::size_t, ClassDictionary::MAX_NUMBER_OF_CLASSES> votes = {};
 
     // Get results for each tree
-    std::for_each(std::execution::seq, this->trees.begin(), this->trees.end(), [&pred_results, &features_vector](DecisionTree &tree) mutable {
-        std::string pred_result = tree.predict_class(features_vector);
-        if (pred_results.count(pred_result) == 0) {
-            pred_results.insert(std::make_pair(pred_result, 1));
-        } else {
-            pred_results.at(pred_result) += 1;
+    std::size_t evaluated_trees = 0;
+    for (std::size_t tree_i = 0; tree_i < this->trees.size(); tree_i++) {
+        votes[this->trees_class_ids[tree_i][this->trees[tree_i].predict_class_id(features_vector)]] += 1;
+        evaluated_trees += 1;
+
+        if (this->early_termination) {
+            // The leader keeps its place if no other class can catch up, even with all the remaining trees
+            std::size_t leader_votes = 0;
+            std::size_t runner_up_votes = 0;
+            for (std::size_t class_id = 0; class_id < number_of_classes; class_id++) {
+                std::size_t class_votes = votes[class_id];
+                if (class_votes > leader_votes) {
+                    runner_up_votes = leader_votes;
+                    leader_votes = class_votes;
+                } else if (class_votes > runner_up_votes) {
+                    runner_up_votes = class_votes;
+                }
+            }
+            if (leader_votes - runner_up_votes > this->trees.size() - evaluated_trees) {
+                break;
+            }
         }
-    });
+    }
+    prediction_stats.number_of_predictions += 1;
+    prediction_stats.number_of_evaluated_trees += evaluated_trees;
+    prediction_stats.last_number_of_evaluated_trees = evaluated_trees;
 
-    // Get the prediction result with the most choice
-    auto pr = std::max_element(std::execution::seq, pred_results.cbegin(), pred_results.cend(),
-                               [](const pred_results_pair_t &p1, const pred_results_pair_t &p2) {
-                                   return p1.second < p2.second;
-                               });
+    // Get the prediction result with the most choice, ties go to the first class in alphabetical order
+    if (number_of_classes == 0) {
+        LOG(LOG_ERROR) << "Error : trying to make prediction but the forest does not have any class";
+        throw std::invalid_argument("Forest does not have any class!");
+    }
+    auto pr = std::max_element(std::execution::seq, votes.cbegin(), votes.cbegin() + (long) number_of_classes);
 
-    return pr->first;
+    return std::distance(votes.cbegin(), pr);
+}
+
+std::size_t RandomForest::predict_class_id_with_confidence(const real_vector_t &features_vector, real_t &confidence) const {
+    const std::size_t number_of_classes = this->class_dictionary.size();
+    if (number_of_classes == 0) {
+        LOG(LOG_ERROR) << "Error : trying to make prediction but the forest does not have any class";
+        throw std::invalid_argument("Forest does not have any class!");
+    }
+    std::array<std::size_t, ClassDictionary::MAX_NUMBER_OF_CLASSES> votes = {};
+    for (std::size_t tree_i = 0; tree_i < this->trees.size(); tree_i++) {
+        votes[this->trees_class_ids[tree_i][this->trees[tree_i].predict_class_id(features_vector)]] += 1;
+    }
+
+    // Ties go to the first class in alphabetical order like predict_class_id, a tie has no margin
+    auto pr = std::max_element(std::execution::seq, votes.cbegin(), votes.cbegin() + (long) number_of_classes);
+    std::size_t runner_up_votes = 0;
+    for (auto class_votes = votes.cbegin(); class_votes != votes.cbegin() + (long) number_of_classes; class_votes++) {
+        if (class_votes != pr) {
+            runner_up_votes = std::max(runner_up_votes, *class_votes);
+        }
+    }
+    confidence = (real_t) (*pr - runner_up_votes) / (real_t) this->trees.size();
+
+    return std::distance(votes.cbegin(), pr);
+}
+
+std::vector<std::size_t> RandomForest::predict_class_ids(const std::vector<real_vector_t> &features_vectors) const {
+    std::vector<std::size_t> votes = this->compute_votes(features_vectors);
+    const std::size_t number_of_classes = this->class_dictionary.size();
+
+    // Get the prediction result with the most choice, ties go to the first class in alphabetical order like predict_class_id
+    std::vector<std::size_t> predicted_class_ids;
+    predicted_class_ids.reserve(features_vectors.size());
+    for (std::size_t sample_i = 0; sample_i < features_vectors.size(); sample_i++) {
+        auto sample_votes = votes.cbegin() + (long) (sample_i * number_of_classes);
+        auto pr = std::max_element(sample_votes, sample_votes + (long) number_of_classes);
+        predicted_class_ids.push_back(std::distance(sample_votes, pr));
+    }
+    return predicted_class_ids;
+}
+
+const ClassDictionary &RandomForest::get_class_dictionary() const {
+    return this->class_dictionary;
+}
+
+std::vector<std::size_t> RandomForest::compute_votes(const std::vector<real_vector_t> &features_vectors) const {
+    const std::size_t number_of_classes = this->class_dictionary.size();
+    std::vector<std::size_t> votes(features_vectors.size() * number_of_classes, 0);
+    std::vector<std::uint32_t> leaves_class_ids(BATCH_BLOCK_SIZE);
+
+    // Tree-major order: a tree scores a whole block of samples while its nodes are hot in cache
+    for (std::size_t block_first = 0; block_first < features_vectors.size(); block_first += BATCH_BLOCK_SIZE) {
+        const std::size_t block_size = std::min(BATCH_BLOCK_SIZE, features_vectors.size() - block_first);
+        for (std::size_t tree_i = 0; tree_i < this->trees.size(); tree_i++) {
+            const std::vector<std::size_t> &tree_class_ids = this->trees_class_ids[tree_i];
+            this->trees[tree_i].predict_class_ids(features_vectors, block_first, block_size, leaves_class_ids.data());
+            for (std::size_t i = 0; i < block_size; i++) {
+                votes[(block_first + i) * number_of_classes + tree_class_ids[leaves_class_ids[i]]] += 1;
+            }
+        }
+    }
+
+    return votes;
 }
 
 /* PRIVATE DEFINITION */
+void RandomForest::compute_classes() {
+    // Forest class names are sorted so the class ids follow the alphabetical order
+    std::set<std::string> forest_classes;
+    for (const DecisionTree &tree: this->trees) {
+        const std::vector<std::string> &tree_classes = tree.get_class_dictionary().get_class_names();
+        forest_classes.insert(tree_classes.cbegin(), tree_classes.cend());
+    }
+    this->class_dictionary = ClassDictionary(std::vector<std::string>(forest_classes.cbegin(), forest_classes.cend()));
+
+    this->trees_class_ids.clear();
+    for (const DecisionTree &tree: this->trees) {
+        std::vector<std::size_t> tree_class_ids;
+        for (const std::string &class_name: tree.get_class_dictionary().get_class_names()) {
+            tree_class_ids.push_back(this->class_dictionary.get_class_id(class_name));
+        }
+        this->trees_class_ids.push_back(tree_class_ids);
+    }
+}
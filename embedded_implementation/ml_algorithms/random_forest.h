@@ -1,11 +1,27 @@
 #ifndef RANDOM_FOREST_H
 #define RANDOM_FOREST_H
 
+#include <memory>
 #include <vector>
 #include "decision_tree.h"
 #include "machine_learning_model.h"
 #include "../helpers/log.h"
 #include "../helpers/file_helpers.h"
+#include "../helpers/thread_pool.h"
+
+/*
+ * RandomForestPredictionStats struct definition
+ */
+// Number of trees evaluated by RandomForest::predict_class_id, kept by the caller so the forest stays const
+struct RandomForestPredictionStats {
+    std::size_t number_of_predictions = 0;
+    std::size_t number_of_evaluated_trees = 0;
+    std::size_t last_number_of_evaluated_trees = 0;
+
+    real_t get_average_number_of_evaluated_trees() const {
+        return number_of_predictions == 0 ? 0 : (real_t) number_of_evaluated_trees / (real_t) number_of_predictions;
+    }
+};
 
 /*
  * RandomForest class definition
@@ -15,25 +31,90 @@ public:
 
     RandomForest();
 
+    // The copy allocates the nodes of its trees in a new arena
+    RandomForest(const RandomForest &random_forest);
+
+    RandomForest(RandomForest &&random_forest) = default;
+
+    RandomForest &operator=(const RandomForest &random_forest);
+
+    RandomForest &operator=(RandomForest &&random_forest) = default;
+
     const std::vector<DecisionTree> &get_trees() const;
 
     size_t get_number_of_trees() const;
 
+    // Arena of the nodes of the trees loaded or copied in the forest
+    const ModelArena &get_arena() const;
+
+    // Estimation of the heap and object bytes used by the forest
+    std::size_t get_memory_footprint() const;
+
+    bool get_early_termination() const;
+
+    // Stop evaluating trees in predict_class_id once the remaining trees cannot change the leader, the result stays identical
+    void set_early_termination(bool early_termination);
+
+    // Thread pool parsing the tree files of fill_from_csv in parallel, null to parse them on the calling thread
+    void set_thread_pool(std::shared_ptr<ThreadPool> thread_pool);
+
     friend std::ostream &operator<<(std::ostream &os, const RandomForest &random_forest);
 
+    // The copy of the tree allocates its nodes in the arena of the forest
     void push_tree(const DecisionTree& tree);
 
+    void push_tree(DecisionTree &&tree);
+
     void pop_tree();
 
     void clear();
 
+    // Order the trees from the most to the least accurate on the validation set, so early termination settles sooner, the
+    // validation set must not be empty
+    void sort_trees_by_accuracy(const std::vector<std::pair<std::string, real_vector_t>> &validation_features_vectors);
+
     void fill_from_csv(const std::filesystem::path &csv_folder_path) override;
 
-    std::string predict_class(const real_vector_t& features_vector) override;
+    // Read the forest from one binary model container written by write_to_binary instead of one CSV file per tree
+    void fill_from_binary(const std::filesystem::path &binary_file_path);
+
+    // One TREE_NODES section per tree, all sharing the class names section
+    void write_to_binary(const std::filesystem::path &binary_file_path) const;
+
+    // Forest class names, sorted in alphabetical order and indexed like the columns of the votes array
+    const ClassDictionary &get_class_dictionary() const override;
+
+    // Features tested by the inner nodes of any tree
+    std::vector<std::size_t> get_used_features() const override;
+
+    std::size_t predict_class_id(const real_vector_t &features_vector) const override;
+
+    // Same prediction, the number of evaluated trees is added to the prediction stats
+    std::size_t predict_class_id(const real_vector_t &features_vector, RandomForestPredictionStats &prediction_stats) const;
+
+    // The confidence is the vote margin, the votes of the leader minus the votes of the runner-up over the number of trees.
+    // All the trees are evaluated, whatever the early termination
+    std::size_t predict_class_id_with_confidence(const real_vector_t &features_vector, real_t &confidence) const override;
+
+    std::vector<std::size_t> predict_class_ids(const std::vector<real_vector_t> &features_vectors) const override;
+
+    // Dense samples x classes array with votes[sample_i * number_of_classes + class_id] the number of trees voting class_id for sample_i
+    std::vector<std::size_t> compute_votes(const std::vector<real_vector_t> &features_vectors) const;
+
+    // Number of samples scored by one tree before moving on to the next tree
+    static constexpr std::size_t BATCH_BLOCK_SIZE = 64;
 
 private:
+    // Declared first so the arena outlives the trees allocating from it
+    ModelArenaReference arena;
     std::vector<DecisionTree> trees;
+    ClassDictionary class_dictionary;
+    // For each tree, the forest class id of each tree class id, rebuilt after every change of the trees
+    std::vector<std::vector<std::size_t>> trees_class_ids;
+    bool early_termination;
+    std::shared_ptr<ThreadPool> thread_pool;
 
+    void compute_classes();
 };
 
 #endif //RANDOM_FOREST_H
@@ -0,0 +1,229 @@
+#include "shared_models.h"
+#include <algorithm>
+#include <array>
+#include "../helpers/log.h"
+
+/*
+ * Shared models helpers
+ */
+// Number of features of a model of the segment, from its FEATURES_VECTOR_SIZE section
+static std::size_t get_features_vector_size(const MappedModelContainer &model_container) {
+    std::span<const std::uint32_t> features_vector_size = model_container.get_section<std::uint32_t>(ModelSectionType::FEATURES_VECTOR_SIZE);
+    if (features_vector_size.size() != 1) {
+        LOG(LOG_ERROR) << "Error : the shared model does not have a features vector size";
+        throw std::invalid_argument("Invalid shared model!");
+    }
+    return features_vector_size.front();
+}
+
+static void check_features_vector_size(const real_vector_t &features_vector, std::size_t number_of_features) {
+    if (features_vector.size() != number_of_features) {
+        LOG(LOG_ERROR) << "Error : trying to make prediction but the feature vector size (" << features_vector.size() << ") is different from the model one (" << number_of_features << ")";
+        throw std::invalid_argument("Feature vector size differ from the model one!");
+    }
+}
+
+static void fill_shared_model_from_csv(const std::filesystem::path &csv_path) {
+    LOG(LOG_ERROR) << "Error : trying to load " << csv_path << " in a shared model, the models of a shared segment are read-only and prepared by MODEL_SUPERVISOR";
+    throw std::logic_error("Shared models are read-only!");
+}
+
+/*
+ * SharedRandomForest class definition
+ */
+
+/* PUBLIC DEFINITION */
+SharedRandomForest::SharedRandomForest(std::shared_ptr<const SharedModelSegment> segment, const std::string &model_name) : segment(std::move(segment)) {
+    MappedModelContainer model_container(this->segment->get_model_container(model_name), model_name);
+    if (model_container.get_model_type() != ModelType::DECISION_TREE) {
+        model_container.expect_model_type(ModelType::RANDOM_FOREST);
+    }
+    this->nodes = model_container.get_section<FlatTreeNode>(ModelSectionType::FLAT_TREE_NODES);
+    this->roots_id = model_container.get_section<std::uint32_t>(ModelSectionType::TREE_ROOTS_ID);
+    this->number_of_features = get_features_vector_size(model_container);
+    this->class_dictionary = model_container.get_class_dictionary();
+
+    // Every id read by the inference is in range, so a corrupted segment can't make a worker read out of it
+    const bool valid_roots = std::all_of(this->roots_id.begin(), this->roots_id.end(), [this](std::uint32_t root_id) {
+        return root_id < this->nodes.size();
+    });
+    const bool valid_nodes = std::all_of(this->nodes.begin(), this->nodes.end(), [this](const FlatTreeNode &node) {
+        return node.feature_id < this->number_of_features && node.children_id[0] < this->nodes.size() && node.children_id[1] < this->nodes.size() && node.class_id < this->class_dictionary.size();
+    });
+    if (this->roots_id.empty() || !valid_roots || !valid_nodes) {
+        LOG(LOG_ERROR) << "Error : the trees of the shared model " << model_name << " have out of range ids";
+        throw std::invalid_argument("Invalid shared model!");
+    }
+}
+
+std::size_t SharedRandomForest::get_number_of_trees() const {
+    return this->roots_id.size();
+}
+
+void SharedRandomForest::fill_from_csv(const std::filesystem::path &csv_folder_path) {
+    fill_shared_model_from_csv(csv_folder_path);
+}
+
+const ClassDictionary &SharedRandomForest::get_class_dictionary() const {
+    return this->class_dictionary;
+}
+
+std::size_t SharedRandomForest::predict_class_id(const real_vector_t &features_vector) const {
+    check_features_vector_size(features_vector, this->number_of_features);
+    std::array<std::size_t, ClassDictionary::MAX_NUMBER_OF_CLASSES> votes = {};
+    // A leaf is the only node looping on itself
+    for (std::uint32_t root_id: this->roots_id) {
+        std::uint32_t current_node_id = root_id;
+        std::uint32_t next_node_id = root_id;
+        do {
+            current_node_id = next_node_id;
+            const FlatTreeNode &node = this->nodes[current_node_id];
+            next_node_id = node.children_id[!(features_vector[node.feature_id] <= node.threshold)];
+        } while (next_node_id != current_node_id);
+        votes[this->nodes[current_node_id].class_id] += 1;
+    }
+    return std::distance(votes.cbegin(), std::max_element(votes.cbegin(), votes.cbegin() + (long) this->class_dictionary.size()));
+}
+
+/*
+ * SharedOneVsOneSVM class definition
+ */
+
+/* PUBLIC DEFINITION */
+SharedOneVsOneSVM::SharedOneVsOneSVM(std::shared_ptr<const SharedModelSegment> segment, const std::string &model_name) : segment(std::move(segment)) {
+    MappedModelContainer model_container(this->segment->get_model_container(model_name), model_name);
+    model_container.expect_model_type(ModelType::ONE_VS_ONE_SVM);
+    this->coefficients = model_container.get_section<real_t>(ModelSectionType::PADDED_SVM_COEFFICIENTS);
+    this->intercepts = model_container.get_section<real_t>(ModelSectionType::SVM_INTERCEPTS);
+    this->classifiers_class_ids = model_container.get_section<std::uint32_t>(ModelSectionType::SVM_CLASS_IDS);
+    this->number_of_features = get_features_vector_size(model_container);
+    this->padded_number_of_features = simd_padded_size(this->number_of_features);
+    this->class_dictionary = model_container.get_class_dictionary();
+
+    const bool valid_class_ids = std::all_of(this->classifiers_class_ids.begin(), this->classifiers_class_ids.end(), [this](std::uint32_t class_id) {
+        return class_id < this->class_dictionary.size();
+    });
+    if (this->intercepts.empty() || this->coefficients.size() != this->intercepts.size() * this->padded_number_of_features || this->classifiers_class_ids.size() != this->intercepts.size() * 2 || !valid_class_ids) {
+        LOG(LOG_ERROR) << "Error : the shared SVM " << model_name << " has " << this->intercepts.size() << " classifiers but " << this->coefficients.size() << " coefficients and " << this->classifiers_class_ids.size() << " class ids";
+        throw std::invalid_argument("Invalid shared model!");
+    }
+}
+
+std::size_t SharedOneVsOneSVM::get_number_of_classifiers() const {
+    return this->intercepts.size();
+}
+
+void SharedOneVsOneSVM::fill_from_csv(const std::filesystem::path &csv_file_path) {
+    fill_shared_model_from_csv(csv_file_path);
+}
+
+const ClassDictionary &SharedOneVsOneSVM::get_class_dictionary() const {
+    return this->class_dictionary;
+}
+
+std::size_t SharedOneVsOneSVM::predict_class_id(const real_vector_t &features_vector) const {
+    return this->predict_class_id(features_vector, InferenceContext::get_thread_context());
+}
+
+// Ties go to the first class in alphabetical order, as OneVsOneSVM
+std::size_t SharedOneVsOneSVM::predict_class_id(const real_vector_t &features_vector, InferenceContext &context) const {
+    check_features_vector_size(features_vector, this->number_of_features);
+    real_t *features = context.get_real_buffer(0, this->padded_number_of_features);
+    std::copy(features_vector.cbegin(), features_vector.cend(), features);
+    std::fill(features + this->number_of_features, features + this->padded_number_of_features, 0);
+    real_t *decision_values = context.get_real_buffer(1, this->intercepts.size());
+    simd_gemv(this->coefficients.data(), this->intercepts.size(), this->padded_number_of_features, features, this->intercepts.data(), decision_values);
+
+    std::array<std::size_t, ClassDictionary::MAX_NUMBER_OF_CLASSES> votes = {};
+    for (std::size_t classifier_i = 0; classifier_i < this->intercepts.size(); classifier_i++) {
+        votes[this->classifiers_class_ids[classifier_i * 2 + (decision_values[classifier_i] > 0 ? 0 : 1)]] += 1;
+    }
+    return std::distance(votes.cbegin(), std::max_element(votes.cbegin(), votes.cbegin() + (long) this->class_dictionary.size()));
+}
+
+/*
+ * SharedArtificialNeuralNetwork class definition
+ */
+
+/* PUBLIC DEFINITION */
+SharedArtificialNeuralNetwork::SharedArtificialNeuralNetwork(std::shared_ptr<const SharedModelSegment> segment, const std::string &model_name) : segment(std::move(segment)), activations_buffer_size(0) {
+    MappedModelContainer model_container(this->segment->get_model_container(model_name), model_name);
+    model_container.expect_model_type(ModelType::ARTIFICIAL_NEURAL_NETWORK);
+    this->class_dictionary = model_container.get_class_dictionary();
+    for (std::size_t layer_i = 0; layer_i < model_container.get_number_of_sections(ModelSectionType::LAYER_SHAPE); layer_i++) {
+        const BinaryLayerShape layer_shape = model_container.get_section<BinaryLayerShape>(ModelSectionType::LAYER_SHAPE, layer_i).front();
+        SharedDenseLayer layer = {layer_shape.input_size, layer_shape.output_size, model_container.get_section<real_t>(ModelSectionType::PADDED_LAYER_WEIGHTS, layer_i),
+                                  model_container.get_section<real_t>(ModelSectionType::LAYER_BIASES, layer_i), (ActivationFunction) layer_shape.activation_function};
+        const bool chained_layer = this->layers.empty() || this->layers.back().output_size == layer.input_size;
+        if (!chained_layer || layer.weights.size() != layer.output_size * simd_padded_size(layer.input_size) || layer.biases.size() != layer.output_size) {
+            LOG(LOG_ERROR) << "Error : the layer " << layer_i << " of the shared model " << model_name << " is " << layer.input_size << " -> " << layer.output_size << " but holds " << layer.weights.size() << " weights and " << layer.biases.size() << " biases";
+            throw std::invalid_argument("Invalid shared model!");
+        }
+        this->activations_buffer_size = std::max({this->activations_buffer_size, simd_padded_size(layer.input_size), simd_padded_size(layer.output_size)});
+        this->layers.push_back(layer);
+    }
+    if (this->layers.empty() || this->layers.back().output_size != this->class_dictionary.size()) {
+        LOG(LOG_ERROR) << "Error : the shared neural network " << model_name << " has " << this->layers.size() << " layers for " << this->class_dictionary.size() << " classes";
+        throw std::invalid_argument("Invalid shared model!");
+    }
+}
+
+const std::vector<SharedDenseLayer> &SharedArtificialNeuralNetwork::get_layers() const {
+    return this->layers;
+}
+
+void SharedArtificialNeuralNetwork::fill_from_csv(const std::filesystem::path &csv_folder_path) {
+    fill_shared_model_from_csv(csv_folder_path);
+}
+
+const ClassDictionary &SharedArtificialNeuralNetwork::get_class_dictionary() const {
+    return this->class_dictionary;
+}
+
+std::size_t SharedArtificialNeuralNetwork::predict_class_id(const real_vector_t &features_vector) const {
+    return this->predict_class_id(features_vector, InferenceContext::get_thread_context());
+}
+
+std::size_t SharedArtificialNeuralNetwork::predict_class_id(const real_vector_t &features_vector, InferenceContext &context) const {
+    check_features_vector_size(features_vector, this->layers.front().input_size);
+    real_t *input = context.get_real_buffer(0, this->activations_buffer_size);
+    real_t *output = context.get_real_buffer(1, this->activations_buffer_size);
+    std::copy(features_vector.cbegin(), features_vector.cend(), input);
+    std::fill(input + features_vector.size(), input + this->activations_buffer_size, 0);
+    for (const SharedDenseLayer &layer: this->layers) {
+        simd_gemv(layer.weights.data(), layer.output_size, simd_padded_size(layer.input_size), input, layer.biases.data(), output);
+        ArtificialNeuralNetwork::apply_activation_function(layer.activation_function, layer.output_size, output);
+        // The padding of the next input must be zeros, the buffer may hold the output of a wider layer
+        std::fill(output + layer.output_size, output + this->activations_buffer_size, 0);
+        std::swap(input, output);
+    }
+    return std::distance(input, std::max_element(input, input + this->layers.back().output_size));
+}
+
+/*
+ * Shared models factory
+ */
+std::shared_ptr<MachineLearningModel> get_shared_model(const std::shared_ptr<const SharedModelSegment> &segment, const std::string &model_name) {
+    MappedModelContainer model_container(segment->get_model_container(model_name), model_name);
+    switch (model_container.get_model_type()) {
+        case ModelType::DECISION_TREE :
+        case ModelType::RANDOM_FOREST : {
+            return std::make_shared<SharedRandomForest>(segment, model_name);
+        }
+        case ModelType::ONE_VS_ONE_SVM : {
+            return std::make_shared<SharedOneVsOneSVM>(segment, model_name);
+        }
+        case ModelType::ARTIFICIAL_NEURAL_NETWORK : {
+            return std::make_shared<SharedArtificialNeuralNetwork>(segment, model_name);
+        }
+        default: {
+            LOG(LOG_ERROR) << "Error : the shared model " << model_name << " has the unknown model type " << (std::uint32_t) model_container.get_model_type();
+            throw std::domain_error("Unsupported model type!");
+        }
+    }
+}
+
+std::size_t get_shared_model_number_of_features(const SharedModelSegment &segment, const std::string &model_name) {
+    MappedModelContainer model_container(segment.get_model_container(model_name), model_name);
+    return get_features_vector_size(model_container);
+}
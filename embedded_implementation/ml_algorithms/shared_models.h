@@ -0,0 +1,120 @@
+#ifndef SHARED_MODELS_H
+#define SHARED_MODELS_H
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+#include "artificial_neural_network.h"
+#include "decision_tree.h"
+#include "machine_learning_model.h"
+#include "globals.h"
+#include "../helpers/shared_model_segment.h"
+
+/*
+ * SharedRandomForest class definition
+ */
+// Decision tree or random forest evaluated in place from a shared model segment written by MODEL_SUPERVISOR, the flattened
+// nodes of all the trees one after the other as EmbeddedRandomForest, a decision tree being a forest of one tree. Only the
+// class names are copied out of the segment
+class SharedRandomForest : public MachineLearningModel {
+public:
+    SharedRandomForest(std::shared_ptr<const SharedModelSegment> segment, const std::string &model_name);
+
+    std::size_t get_number_of_trees() const;
+
+    // The models of a segment are prepared by MODEL_SUPERVISOR, not loaded by the workers
+    void fill_from_csv(const std::filesystem::path &csv_folder_path) override;
+
+    const ClassDictionary &get_class_dictionary() const override;
+
+    // Ties go to the first class in alphabetical order, as RandomForest
+    std::size_t predict_class_id(const real_vector_t &features_vector) const override;
+
+private:
+    // Keeps the mapping of the tables alive
+    std::shared_ptr<const SharedModelSegment> segment;
+    std::span<const FlatTreeNode> nodes;
+    std::span<const std::uint32_t> roots_id;
+    std::size_t number_of_features;
+    ClassDictionary class_dictionary;
+};
+
+/*
+ * SharedOneVsOneSVM class definition
+ */
+// One vs one linear SVM evaluated in place from a shared model segment, the zero-padded coefficients of OneVsOneSVM and the
+// two class ids of each classifier, the first one winning the vote on a positive decision value
+class SharedOneVsOneSVM : public MachineLearningModel {
+public:
+    SharedOneVsOneSVM(std::shared_ptr<const SharedModelSegment> segment, const std::string &model_name);
+
+    std::size_t get_number_of_classifiers() const;
+
+    void fill_from_csv(const std::filesystem::path &csv_file_path) override;
+
+    const ClassDictionary &get_class_dictionary() const override;
+
+    std::size_t predict_class_id(const real_vector_t &features_vector) const override;
+
+    // Same prediction with the padded features in the buffer 0 and the decision values in the buffer 1 of the context
+    std::size_t predict_class_id(const real_vector_t &features_vector, InferenceContext &context) const;
+
+private:
+    std::shared_ptr<const SharedModelSegment> segment;
+    // Row-major classifiers x padded_number_of_features matrix
+    std::span<const real_t> coefficients;
+    std::span<const real_t> intercepts;
+    std::span<const std::uint32_t> classifiers_class_ids;
+    std::size_t number_of_features;
+    std::size_t padded_number_of_features;
+    ClassDictionary class_dictionary;
+};
+
+/*
+ * SharedDenseLayer struct definition
+ */
+// Dense layer of a SharedArtificialNeuralNetwork, the row-major output_size x simd_padded_size(input_size) zero-padded
+// weights of DenseLayer in the segment
+struct SharedDenseLayer {
+    std::size_t input_size;
+    std::size_t output_size;
+    std::span<const real_t> weights;
+    std::span<const real_t> biases;
+    ActivationFunction activation_function;
+};
+
+/*
+ * SharedArtificialNeuralNetwork class definition
+ */
+// Neural network evaluated in place from a shared model segment, only the layer shapes and the class names are copied
+class SharedArtificialNeuralNetwork : public MachineLearningModel {
+public:
+    SharedArtificialNeuralNetwork(std::shared_ptr<const SharedModelSegment> segment, const std::string &model_name);
+
+    const std::vector<SharedDenseLayer> &get_layers() const;
+
+    void fill_from_csv(const std::filesystem::path &csv_folder_path) override;
+
+    const ClassDictionary &get_class_dictionary() const override;
+
+    std::size_t predict_class_id(const real_vector_t &features_vector) const override;
+
+    // Same prediction with the activations in the ping-pong buffers 0 and 1 of the context
+    std::size_t predict_class_id(const real_vector_t &features_vector, InferenceContext &context) const;
+
+private:
+    std::shared_ptr<const SharedModelSegment> segment;
+    std::vector<SharedDenseLayer> layers;
+    ClassDictionary class_dictionary;
+    // Size of the ping-pong activation buffers, the widest padded layer
+    std::size_t activations_buffer_size;
+};
+
+// Model of the segment evaluated in place, whatever its type
+std::shared_ptr<MachineLearningModel> get_shared_model(const std::shared_ptr<const SharedModelSegment> &segment, const std::string &model_name);
+
+// Size of the features vectors of a model of the segment
+std::size_t get_shared_model_number_of_features(const SharedModelSegment &segment, const std::string &model_name);
+
+#endif //SHARED_MODELS_H
@@ -0,0 +1,164 @@
+#include "sparse_artificial_neural_network.h"
+#include <cmath>
+#include <execution>
+#include <limits>
+#include "../helpers/log.h"
+
+/*
+ * SparseArtificialNeuralNetwork class definition
+ */
+
+/* PUBLIC DEFINITION */
+SparseArtificialNeuralNetwork::SparseArtificialNeuralNetwork() {
+    this->clear();
+}
+
+const std::vector<SparseDenseLayer> &SparseArtificialNeuralNetwork::get_layers() const {
+    return layers;
+}
+
+std::size_t SparseArtificialNeuralNetwork::get_number_of_weights() const {
+    return number_of_weights;
+}
+
+std::size_t SparseArtificialNeuralNetwork::get_number_of_non_zero_weights() const {
+    std::size_t number_of_non_zero_weights = 0;
+    for (const SparseDenseLayer &layer: this->layers) {
+        number_of_non_zero_weights += layer.values.size();
+    }
+    return number_of_non_zero_weights;
+}
+
+real_t SparseArtificialNeuralNetwork::get_sparsity() const {
+    if (this->number_of_weights == 0) {
+        return 0;
+    }
+    return 1.0 - (real_t) this->get_number_of_non_zero_weights() / (real_t) this->number_of_weights;
+}
+
+std::size_t SparseArtificialNeuralNetwork::get_memory_footprint() const {
+    std::size_t footprint = sizeof(SparseArtificialNeuralNetwork);
+    for (const SparseDenseLayer &layer: this->layers) {
+        footprint += sizeof(SparseDenseLayer) + (layer.row_offsets.capacity() + layer.column_indices.capacity()) * sizeof(std::uint32_t);
+        footprint += (layer.values.capacity() + layer.biases.capacity()) * sizeof(real_t);
+    }
+    return footprint;
+}
+
+std::ostream &operator<<(std::ostream &os, const SparseArtificialNeuralNetwork &sparse_artificial_neural_network) {
+    for (std::size_t layer_i = 0; layer_i < sparse_artificial_neural_network.get_layers().size(); layer_i++) {
+        const SparseDenseLayer &layer = sparse_artificial_neural_network.get_layers()[layer_i];
+        os << "layer " << layer_i << " (" << layer.input_size << " -> " << layer.output_size << ", " << layer.values.size() << " non zero weights)\n";
+    }
+    return os << "sparsity: " << sparse_artificial_neural_network.get_sparsity() << ", footprint: " << sparse_artificial_neural_network.get_memory_footprint() << "B";
+}
+
+void SparseArtificialNeuralNetwork::compress(const ArtificialNeuralNetwork &artificial_neural_network, real_t threshold) {
+    this->clear();
+    const std::vector<DenseLayer> &dense_layers = artificial_neural_network.get_dense_layers();
+    if (dense_layers.empty()) {
+        LOG(LOG_ERROR) << "Error : trying to compress a neural network without any layer";
+        throw std::invalid_argument("Nothing to compress!");
+    }
+    this->class_dictionary = ClassDictionary(artificial_neural_network.get_classes());
+
+    std::size_t buffer_size = 0;
+    for (const DenseLayer &dense_layer: dense_layers) {
+        if (dense_layer.input_size * dense_layer.output_size > std::numeric_limits<std::uint32_t>::max()) {
+            LOG(LOG_ERROR) << "Error : the layer " << this->layers.size() << " has too many weights (" << dense_layer.input_size * dense_layer.output_size << ") for 32 bits CSR indices";
+            throw std::invalid_argument("Layer too big!");
+        }
+        SparseDenseLayer layer = {};
+        layer.input_size = dense_layer.input_size;
+        layer.output_size = dense_layer.output_size;
+        layer.activation_function = dense_layer.activation_function;
+        layer.biases.assign(dense_layer.biases.cbegin(), dense_layer.biases.cend());
+        layer.row_offsets.push_back(0);
+        for (std::size_t neuron_i = 0; neuron_i < dense_layer.output_size; neuron_i++) {
+            const real_t *neuron_weights = dense_layer.weights.data() + neuron_i * dense_layer.padded_input_size;
+            for (std::size_t input_i = 0; input_i < dense_layer.input_size; input_i++) {
+                if (std::abs(neuron_weights[input_i]) > threshold) {
+                    layer.column_indices.push_back((std::uint32_t) input_i);
+                    layer.values.push_back(neuron_weights[input_i]);
+                }
+            }
+            layer.row_offsets.push_back((std::uint32_t) layer.values.size());
+        }
+        layer.column_indices.shrink_to_fit();
+        layer.values.shrink_to_fit();
+        this->number_of_weights += dense_layer.input_size * dense_layer.output_size;
+        buffer_size = std::max({buffer_size, layer.input_size, layer.output_size});
+        this->layers.push_back(std::move(layer));
+    }
+    this->activations_buffer_size = buffer_size;
+}
+
+void SparseArtificialNeuralNetwork::clear() {
+    this->layers.clear();
+    this->class_dictionary.clear();
+    this->number_of_weights = 0;
+    this->activations_buffer_size = 0;
+}
+
+void SparseArtificialNeuralNetwork::fill_from_csv(const std::filesystem::path &csv_folder_path) {
+    ArtificialNeuralNetwork artificial_neural_network = {};
+    artificial_neural_network.fill_from_csv(csv_folder_path);
+    this->compress(artificial_neural_network);
+}
+
+const ClassDictionary &SparseArtificialNeuralNetwork::get_class_dictionary() const {
+    return class_dictionary;
+}
+
+std::size_t SparseArtificialNeuralNetwork::predict_class_id(const real_vector_t &features_vector) const {
+    return this->predict_class_id(features_vector, InferenceContext::get_thread_context());
+}
+
+std::size_t SparseArtificialNeuralNetwork::predict_class_id(const real_vector_t &features_vector, InferenceContext &context) const {
+    if (this->layers.empty()) {
+        LOG(LOG_ERROR) << "Error : trying to make prediction but the neural network does not have any layer";
+        throw std::invalid_argument("Neural network does not have any layer!");
+    }
+    const SparseDenseLayer &input_layer = this->layers.front();
+    if (features_vector.size() != input_layer.input_size) {
+        LOG(LOG_ERROR) << "Error : trying to make prediction but the feature vector size (" << features_vector.size() << ") is different from the input layer size (" << input_layer.input_size << ")";
+        throw std::invalid_argument("Feature vector size differ from input layer size!");
+    }
+
+    // The layers read and write exactly their sizes, the buffers need no clearing
+    std::array<real_t *, 2> activations_buffers = {context.get_real_buffer(0, this->activations_buffer_size), context.get_real_buffer(1, this->activations_buffer_size)};
+    std::copy(features_vector.cbegin(), features_vector.cend(), activations_buffers[0]);
+    std::size_t buffer_i = 0;
+    for (const SparseDenseLayer &layer: this->layers) {
+        compute_sparse_layer(layer, activations_buffers[buffer_i], activations_buffers[1 - buffer_i]);
+        buffer_i = 1 - buffer_i;
+    }
+
+    // Get the prediction result with the most choice
+    const real_t *output = activations_buffers[buffer_i];
+    auto pr = std::max_element(std::execution::seq, output, output + this->layers.back().output_size);
+
+    return std::distance(output, pr);
+}
+
+void SparseArtificialNeuralNetwork::compute_sparse_layer(const SparseDenseLayer &layer, const real_t *input, real_t *output) {
+    const std::uint32_t *column_indices = layer.column_indices.data();
+    const real_t *values = layer.values.data();
+    for (std::size_t neuron_i = 0; neuron_i < layer.output_size; neuron_i++) {
+        // Four independent accumulators hide the latency of the additions behind the indexed loads
+        std::uint32_t weight_i = layer.row_offsets[neuron_i];
+        const std::uint32_t row_end = layer.row_offsets[neuron_i + 1];
+        real_t sum_0 = 0, sum_1 = 0, sum_2 = 0, sum_3 = 0;
+        for (; weight_i + 4 <= row_end; weight_i += 4) {
+            sum_0 += values[weight_i] * input[column_indices[weight_i]];
+            sum_1 += values[weight_i + 1] * input[column_indices[weight_i + 1]];
+            sum_2 += values[weight_i + 2] * input[column_indices[weight_i + 2]];
+            sum_3 += values[weight_i + 3] * input[column_indices[weight_i + 3]];
+        }
+        for (; weight_i < row_end; weight_i++) {
+            sum_0 += values[weight_i] * input[column_indices[weight_i]];
+        }
+        output[neuron_i] = (sum_0 + sum_1) + (sum_2 + sum_3) + layer.biases[neuron_i];
+    }
+    ArtificialNeuralNetwork::apply_activation_function(layer.activation_function, layer.output_size, output);
+}
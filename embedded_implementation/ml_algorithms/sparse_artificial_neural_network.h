@@ -0,0 +1,72 @@
+#ifndef SPARSE_ARTIFICIAL_NEURAL_NETWORK_H
+#define SPARSE_ARTIFICIAL_NEURAL_NETWORK_H
+
+#include <cstdint>
+#include <vector>
+#include "artificial_neural_network.h"
+#include "machine_learning_model.h"
+#include "globals.h"
+
+/*
+ * SparseDenseLayer struct definition
+ */
+// Layer whose non zero weights are stored in CSR (compressed sparse row) format, the weights of the neuron o are
+// values[row_offsets[o], row_offsets[o + 1]) and multiply the inputs column_indices[row_offsets[o], row_offsets[o + 1])
+struct SparseDenseLayer {
+    std::size_t input_size = 0;
+    std::size_t output_size = 0;
+    std::vector<std::uint32_t> row_offsets;
+    std::vector<std::uint32_t> column_indices;
+    real_vector_t values;
+    real_vector_t biases;
+    ActivationFunction activation_function = ActivationFunction::RELU;
+};
+
+/*
+ * SparseArtificialNeuralNetwork class definition
+ */
+// Inference engine of a pruned ArtificialNeuralNetwork, only the non zero weights are stored and multiplied
+class SparseArtificialNeuralNetwork : public MachineLearningModel {
+public:
+    SparseArtificialNeuralNetwork();
+
+    const std::vector<SparseDenseLayer> &get_layers() const;
+
+    std::size_t get_number_of_weights() const;
+
+    std::size_t get_number_of_non_zero_weights() const;
+
+    // Fraction of the weights equal to zero
+    real_t get_sparsity() const;
+
+    std::size_t get_memory_footprint() const;
+
+    friend std::ostream &operator<<(std::ostream &os, const SparseArtificialNeuralNetwork &sparse_artificial_neural_network);
+
+    // Keep the weights of the network whose absolute value is above the threshold (the exact zeros of a pruned network by default)
+    void compress(const ArtificialNeuralNetwork &artificial_neural_network, real_t threshold = 0);
+
+    void clear();
+
+    // Load a (pruned) network and keep its non zero weights
+    void fill_from_csv(const std::filesystem::path &csv_folder_path) override;
+
+    const ClassDictionary &get_class_dictionary() const override;
+
+    std::size_t predict_class_id(const real_vector_t &features_vector) const override;
+
+    // Same prediction with the activations in the ping-pong buffers 0 and 1 of the context
+    std::size_t predict_class_id(const real_vector_t &features_vector, InferenceContext &context) const;
+
+    // output = activation(weights * input + biases) with the CSR weights of the layer
+    static void compute_sparse_layer(const SparseDenseLayer &layer, const real_t *input, real_t *output);
+
+private:
+    std::vector<SparseDenseLayer> layers;
+    ClassDictionary class_dictionary;
+    std::size_t number_of_weights;
+    // Size of the ping-pong activation buffers, a layer reads one and writes the other so a forward pass allocates nothing
+    std::size_t activations_buffer_size;
+};
+
+#endif //SPARSE_ARTIFICIAL_NEURAL_NETWORK_H
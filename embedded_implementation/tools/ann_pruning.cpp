@@ -0,0 +1,78 @@
+#include <fstream>
+#include "../helpers/file_helpers.h"
+#include "../helpers/classification_helpers.h"
+#include "../helpers/log.h"
+#include "../ml_algorithms/artificial_neural_network.h"
+#include "../ml_algorithms/sparse_artificial_neural_network.h"
+
+log_struct LOGGING_CONFIG = {};
+
+int main(int argc, char *argv[]) {
+    // Log config
+    LOGGING_CONFIG.level = LOG_INFO;
+
+    if (argc != 4 || (std::string(argv[1]) != "stft" && std::string(argv[1]) != "mfcc")) {
+        std::cout << "Usage: " << argv[0] << " <stft|mfcc> <sparsity> <output_model_dir>" << std::endl;
+        return 1;
+    }
+    const AuFileProcessingAlgorithm processing_algorithm = std::string(argv[1]) == "stft" ? AuFileProcessingAlgorithm::STFT : AuFileProcessingAlgorithm::MFCC;
+    const real_t target_sparsity = std::stod(argv[2]);
+    const std::filesystem::path output_folder_path = argv[3];
+    const std::filesystem::path model_folder_path = processing_algorithm == AuFileProcessingAlgorithm::STFT ? ARTIFICIAL_NEURAL_NETWORK_LAYERS_FOLDER_PATH_STFT : ARTIFICIAL_NEURAL_NETWORK_LAYERS_FOLDER_PATH_MFCC;
+    const std::filesystem::path test_csv_path = processing_algorithm == AuFileProcessingAlgorithm::STFT ? MUSIC_FEATURES_STFT_CSV_TEST_PATH : MUSIC_FEATURES_MFCC_CSV_TEST_PATH;
+    const std::filesystem::path train_csv_path = processing_algorithm == AuFileProcessingAlgorithm::STFT ? MUSIC_FEATURES_STFT_CSV_TRAIN_PATH : MUSIC_FEATURES_MFCC_CSV_TRAIN_PATH;
+    if (target_sparsity < 0 || target_sparsity >= 1) {
+        LOG(LOG_ERROR) << "Error : the sparsity (" << target_sparsity << ") must be in [0, 1)";
+        return 1;
+    }
+
+    // Load the network and the test features vectors
+    LOG(LOG_INFO) << "Creating an Artificial Neural Network from all csv files in the following dir " << model_folder_path << " ...";
+    ArtificialNeuralNetwork artificial_neural_network = {};
+    artificial_neural_network.fill_from_csv(model_folder_path);
+    LOG(LOG_INFO) << "Getting features vectors from the csv file " << absolute(test_csv_path) << " ...";
+    auto fvs = get_features_vectors_from_csv(test_csv_path, processing_algorithm);
+    // The weights are ranked on the train set inputs, the test set is kept for the accuracy check
+    LOG(LOG_INFO) << "Getting calibration features vectors from the csv file " << absolute(train_csv_path) << " ...";
+    std::vector<real_vector_t> calibration_fvs;
+    for (const auto &features_vector: get_features_vectors_from_csv(train_csv_path, processing_algorithm)) {
+        calibration_fvs.push_back(features_vector.second);
+    }
+    const real_t dense_accuracy = predictions_report(make_predictions(artificial_neural_network, fvs));
+    const real_t dense_time = benchmark_predictions(artificial_neural_network, fvs, 100);
+    const std::size_t dense_footprint = artificial_neural_network.get_memory_footprint();
+
+    // Prune by steps of 10% up to the target to build the sparsity versus accuracy and speed-up curve
+    std::vector<real_t> sparsities;
+    for (std::size_t step = 1; (real_t) step / 10.0 < target_sparsity; step++) {
+        sparsities.push_back((real_t) step / 10.0);
+    }
+    sparsities.push_back(target_sparsity);
+    const std::filesystem::path report_path = output_folder_path.string() + "_report.csv";
+    std::ofstream report_file(report_path);
+    report_file << "sparsity,accuracy,latency_us,speed_up,footprint_bytes\n";
+    report_file << 0 << "," << dense_accuracy << "," << dense_time << "," << 1 << "," << dense_footprint << "\n";
+    ArtificialNeuralNetwork pruned_artificial_neural_network = {};
+    SparseArtificialNeuralNetwork sparse_artificial_neural_network = {};
+    real_t sparse_accuracy = dense_accuracy;
+    real_t sparse_time = dense_time;
+    for (real_t sparsity: sparsities) {
+        pruned_artificial_neural_network = artificial_neural_network;
+        pruned_artificial_neural_network.prune_weights(sparsity, calibration_fvs);
+        sparse_artificial_neural_network.compress(pruned_artificial_neural_network);
+        sparse_accuracy = predictions_report(make_predictions(sparse_artificial_neural_network, fvs));
+        sparse_time = benchmark_predictions(sparse_artificial_neural_network, fvs, 100);
+        report_file << sparse_artificial_neural_network.get_sparsity() << "," << sparse_accuracy << "," << sparse_time << "," << dense_time / sparse_time << "," << sparse_artificial_neural_network.get_memory_footprint() << "\n";
+        LOG(LOG_INFO) << "Sparsity " << sparse_artificial_neural_network.get_sparsity() << ": accuracy " << sparse_accuracy << " (delta " << sparse_accuracy - dense_accuracy << "), " << sparse_time << "µs per sample (x" << dense_time / sparse_time << "), " << sparse_artificial_neural_network.get_memory_footprint() << "B";
+    }
+
+    // Write the pruned network, it can be loaded by ArtificialNeuralNetwork or SparseArtificialNeuralNetwork
+    std::filesystem::create_directories(output_folder_path);
+    pruned_artificial_neural_network.write_to_csv(output_folder_path);
+
+    LOG(LOG_INFO) << "Dense network: " << dense_time << "µs per sample, " << dense_footprint << "B, accuracy " << dense_accuracy;
+    LOG(LOG_INFO) << "Pruned network: " << sparse_time << "µs per sample (x" << dense_time / sparse_time << "), " << sparse_artificial_neural_network.get_memory_footprint() << "B (x" << (real_t) dense_footprint / (real_t) sparse_artificial_neural_network.get_memory_footprint() << " smaller), accuracy " << sparse_accuracy;
+    LOG(LOG_INFO) << "Pruned network written in " << absolute(output_folder_path) << ", sparsity versus accuracy curve written in " << absolute(report_path);
+
+    return 0;
+}
@@ -0,0 +1,191 @@
+#include <chrono>
+#include "../helpers/file_helpers.h"
+#include "../helpers/log.h"
+#include "../helpers/thread_pool.h"
+#include "../ml_algorithms/decision_tree.h"
+#include "../ml_algorithms/decision_tree_trainer.h"
+
+/**
+ * @brief           Train a decision tree and measure the training time.
+ * @details         The training is repeated and the fastest run is kept to filter out the scheduler noise.
+ *
+ * @param[in]       trainer the trainer holding the binned training set
+ * @param[in]       parameters the training parameters
+ * @param[out]      decision_tree the trained tree
+ * @returns         the training time in ms
+ */
+real_t measure_training_time(const DecisionTreeTrainer &trainer, const DecisionTreeTrainingParameters &parameters, DecisionTree &decision_tree) {
+    const std::size_t repetitions = 5;
+    real_t best_elapsed_time = std::numeric_limits<real_t>::max();
+    for (std::size_t repetition = 0; repetition < repetitions; repetition++) {
+        auto start_time = std::chrono::high_resolution_clock::now();
+        decision_tree = trainer.train(parameters);
+        auto stop_time = std::chrono::high_resolution_clock::now();
+        best_elapsed_time = std::min(best_elapsed_time, (real_t) std::chrono::duration_cast<std::chrono::microseconds>(stop_time - start_time).count() / 1000.0);
+    }
+    return best_elapsed_time;
+}
+
+/**
+ * @brief           Compute the accuracy of a decision tree on some of the given features vectors.
+ *
+ * @param[in]       decision_tree the decision tree to evaluate
+ * @param[in]       features_vectors the labelled features vectors
+ * @param[in]       sample_ids the ids of the features vectors to predict
+ * @returns         the accuracy
+ */
+real_t tree_accuracy(const DecisionTree &decision_tree, const std::vector<std::pair<std::string, real_vector_t>> &features_vectors, const std::vector<std::size_t> &sample_ids) {
+    std::size_t good_predictions = 0;
+    for (std::size_t sample_id: sample_ids) {
+        if (decision_tree.predict_class(features_vectors[sample_id].second) == features_vectors[sample_id].first) {
+            good_predictions += 1;
+        }
+    }
+    return (real_t) good_predictions / (real_t) sample_ids.size();
+}
+
+/**
+ * @brief           Choose the maximum depth of the tree like the grid search of the training notebooks.
+ * @details         Every depth from 1 to 19 and the unlimited one are evaluated by a stratified k-fold cross validation
+ *                  (the samples of each class are dealt to the folds in the training set order), the first depth with
+ *                  the best mean accuracy is kept.
+ *
+ * @param[in]       trainer the trainer holding the binned training set
+ * @param[in]       training_set the training features vectors, in the order given to the trainer
+ * @param[in]       parameters the training parameters, their maximum depth is ignored
+ * @param[in]       number_of_folds the number of folds of the cross validation
+ * @returns         the chosen maximum depth, 0 if unlimited
+ */
+std::size_t select_max_depth(const DecisionTreeTrainer &trainer, const std::vector<std::pair<std::string, real_vector_t>> &training_set, DecisionTreeTrainingParameters parameters, std::size_t number_of_folds) {
+    std::vector<std::vector<std::size_t>> folds(number_of_folds);
+    std::vector<std::size_t> class_samples(trainer.get_class_dictionary().size(), 0);
+    for (std::size_t sample_id = 0; sample_id < training_set.size(); sample_id++) {
+        const std::size_t class_id = trainer.get_class_dictionary().get_class_id(training_set[sample_id].first);
+        folds[class_samples[class_id] % number_of_folds].push_back(sample_id);
+        class_samples[class_id] += 1;
+    }
+
+    std::vector<std::size_t> max_depths;
+    for (std::size_t max_depth = 1; max_depth < 20; max_depth++) {
+        max_depths.push_back(max_depth);
+    }
+    max_depths.push_back(0);
+
+    std::size_t best_max_depth = 0;
+    real_t best_accuracy = -1;
+    for (std::size_t max_depth: max_depths) {
+        parameters.max_depth = max_depth;
+        real_t accuracy_sum = 0;
+        for (std::size_t fold_i = 0; fold_i < number_of_folds; fold_i++) {
+            std::vector<std::size_t> training_sample_ids;
+            for (std::size_t other_fold_i = 0; other_fold_i < number_of_folds; other_fold_i++) {
+                if (other_fold_i != fold_i) {
+                    training_sample_ids.insert(training_sample_ids.end(), folds[other_fold_i].cbegin(), folds[other_fold_i].cend());
+                }
+            }
+            std::sort(training_sample_ids.begin(), training_sample_ids.end());
+            accuracy_sum += tree_accuracy(trainer.train(parameters, training_sample_ids), training_set, folds[fold_i]);
+        }
+        const real_t accuracy = accuracy_sum / (real_t) number_of_folds;
+        LOG(LOG_INFO) << "\tmax depth " << (max_depth == 0 ? "unlimited" : std::to_string(max_depth)) << ": mean cross validation accuracy " << accuracy;
+        if (accuracy > best_accuracy) {
+            best_accuracy = accuracy;
+            best_max_depth = max_depth;
+        }
+    }
+    return best_max_depth;
+}
+
+/**
+ * @brief           Check that two decision trees have the same nodes.
+ *
+ * @param[in]       decision_tree_1 the first decision tree
+ * @param[in]       decision_tree_2 the second decision tree
+ * @returns         true if every node has the same threshold, feature, children and class
+ */
+bool same_trees(const DecisionTree &decision_tree_1, const DecisionTree &decision_tree_2) {
+    return std::equal(decision_tree_1.get_tree().cbegin(), decision_tree_1.get_tree().cend(), decision_tree_2.get_tree().cbegin(), decision_tree_2.get_tree().cend(), [](const auto &node_1, const auto &node_2) {
+        return node_1.first == node_2.first && node_1.second.get_threshold() == node_2.second.get_threshold() && node_1.second.get_feature_id() == node_2.second.get_feature_id() && node_1.second.get_left_children_id() == node_2.second.get_left_children_id() && node_1.second.get_right_children_id() == node_2.second.get_right_children_id() && node_1.second.get_class_name() == node_2.second.get_class_name();
+    });
+}
+
+log_struct LOGGING_CONFIG = {};
+
+int main(int argc, char *argv[]) {
+    // Log config
+    LOGGING_CONFIG.level = LOG_INFO;
+
+    if (argc < 5 || argc > 7 || (std::string(argv[1]) != "stft" && std::string(argv[1]) != "mfcc") || (std::string(argv[2]) != "gini" && std::string(argv[2]) != "entropy")) {
+        std::cout << "Usage: " << argv[0] << " <stft|mfcc> <gini|entropy> <max_depth|cv> <output_csv_path> [<number_of_bins>] [<number_of_threads>]" << std::endl;
+        std::cout << "Trains a CART decision tree on the training set and writes it in the format read by DecisionTree::fill_from_csv, max_depth 0 is unlimited and cv chooses it by 5-fold cross validation like the training notebooks" << std::endl;
+        return 1;
+    }
+    const AuFileProcessingAlgorithm processing_algorithm = std::string(argv[1]) == "stft" ? AuFileProcessingAlgorithm::STFT : AuFileProcessingAlgorithm::MFCC;
+    DecisionTreeTrainingParameters parameters = {};
+    parameters.criterion = std::string(argv[2]) == "gini" ? SplitCriterion::GINI : SplitCriterion::ENTROPY;
+    const bool cross_validation = std::string(argv[3]) == "cv";
+    parameters.max_depth = cross_validation ? 0 : std::stoul(argv[3]);
+    const std::filesystem::path output_csv_path = argv[4];
+    const std::size_t number_of_bins = argc > 5 ? std::stoul(argv[5]) : DecisionTreeTrainer::MAX_NUMBER_OF_BINS;
+    const std::size_t number_of_threads = argc > 6 ? std::stoul(argv[6]) : std::thread::hardware_concurrency();
+    const std::filesystem::path train_csv_path = processing_algorithm == AuFileProcessingAlgorithm::STFT ? MUSIC_FEATURES_STFT_CSV_TRAIN_PATH : MUSIC_FEATURES_MFCC_CSV_TRAIN_PATH;
+    const std::filesystem::path test_csv_path = processing_algorithm == AuFileProcessingAlgorithm::STFT ? MUSIC_FEATURES_STFT_CSV_TEST_PATH : MUSIC_FEATURES_MFCC_CSV_TEST_PATH;
+    const std::filesystem::path model_csv_path = processing_algorithm == AuFileProcessingAlgorithm::STFT ? DECISION_TREE_CSV_PATH_STFT : DECISION_TREE_CSV_PATH_MFCC;
+
+    LOG(LOG_INFO) << "Reading the features vectors of " << train_csv_path << " and " << test_csv_path << " ...";
+    const std::vector<std::pair<std::string, real_vector_t>> training_set = get_features_vectors_from_csv(train_csv_path, processing_algorithm);
+    const std::vector<std::pair<std::string, real_vector_t>> test_set = get_features_vectors_from_csv(test_csv_path, processing_algorithm);
+    std::vector<std::size_t> test_sample_ids(test_set.size());
+    for (std::size_t sample_id = 0; sample_id < test_set.size(); sample_id++) {
+        test_sample_ids[sample_id] = sample_id;
+    }
+
+    // Bin the training set once, every training reuses the bins
+    ThreadPool thread_pool(number_of_threads);
+    auto start_time = std::chrono::high_resolution_clock::now();
+    const DecisionTreeTrainer trainer(training_set, number_of_bins, &thread_pool);
+    auto stop_time = std::chrono::high_resolution_clock::now();
+    const real_t binning_time = (real_t) std::chrono::duration_cast<std::chrono::microseconds>(stop_time - start_time).count() / 1000.0;
+    LOG(LOG_INFO) << trainer.get_number_of_samples() << " training samples of " << trainer.get_number_of_features() << " features and " << trainer.get_class_dictionary().size() << " classes binned in " << binning_time << "ms on " << thread_pool.get_number_of_threads() << " threads";
+
+    if (cross_validation) {
+        LOG(LOG_INFO) << "Choosing the maximum depth by 5-fold cross validation...";
+        start_time = std::chrono::high_resolution_clock::now();
+        parameters.max_depth = select_max_depth(trainer, training_set, parameters, 5);
+        stop_time = std::chrono::high_resolution_clock::now();
+        LOG(LOG_INFO) << "Maximum depth " << (parameters.max_depth == 0 ? "unlimited" : std::to_string(parameters.max_depth)) << " chosen in " << (real_t) std::chrono::duration_cast<std::chrono::microseconds>(stop_time - start_time).count() / 1000.0 << "ms (100 trainings)";
+    }
+
+    DecisionTree decision_tree;
+    const real_t training_time = measure_training_time(trainer, parameters, decision_tree);
+    LOG(LOG_INFO) << "Tree of " << decision_tree.get_number_of_nodes() << " nodes and depth " << decision_tree.get_depth() << " trained in " << training_time << "ms (" << binning_time + training_time << "ms with the binning) on " << thread_pool.get_number_of_threads() << " threads";
+
+    // Same training on the calling thread only, the tree must not depend on the number of threads
+    start_time = std::chrono::high_resolution_clock::now();
+    const DecisionTreeTrainer sequential_trainer(training_set, number_of_bins);
+    stop_time = std::chrono::high_resolution_clock::now();
+    const real_t sequential_binning_time = (real_t) std::chrono::duration_cast<std::chrono::microseconds>(stop_time - start_time).count() / 1000.0;
+    DecisionTree sequential_decision_tree;
+    const real_t sequential_training_time = measure_training_time(sequential_trainer, parameters, sequential_decision_tree);
+    LOG(LOG_INFO) << "Sequential training in " << sequential_training_time << "ms (" << sequential_binning_time + sequential_training_time << "ms with the binning), x" << (sequential_binning_time + sequential_training_time) / (binning_time + training_time) << " with the thread pool";
+    if (!same_trees(decision_tree, sequential_decision_tree)) {
+        LOG(LOG_ERROR) << "Error : the sequential training did not give the same tree";
+        return 1;
+    }
+
+    // The written tree is read back and must make the same predictions
+    decision_tree.write_to_csv(output_csv_path);
+    DecisionTree written_decision_tree;
+    written_decision_tree.fill_from_csv(output_csv_path);
+    if (!same_trees(decision_tree, written_decision_tree)) {
+        LOG(LOG_ERROR) << "Error : the tree read back from " << output_csv_path << " is not the trained one";
+        return 1;
+    }
+    LOG(LOG_INFO) << "Tree written in " << output_csv_path;
+
+    DecisionTree model_decision_tree;
+    model_decision_tree.fill_from_csv(model_csv_path);
+    LOG(LOG_INFO) << "Test accuracy: " << tree_accuracy(written_decision_tree, test_set, test_sample_ids) << " (" << tree_accuracy(model_decision_tree, test_set, test_sample_ids) << " for the tree of " << model_csv_path << " trained by sklearn)";
+
+    return 0;
+}
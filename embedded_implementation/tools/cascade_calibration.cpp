@@ -0,0 +1,294 @@
+#include <chrono>
+#include <fstream>
+#include <numeric>
+#include "../helpers/file_helpers.h"
+#include "../helpers/classification_helpers.h"
+#include "../helpers/log.h"
+#include "../ml_algorithms/artificial_neural_network.h"
+#include "../ml_algorithms/cascade_model.h"
+#include "../ml_algorithms/decision_tree.h"
+#include "../ml_algorithms/one_vs_one_svm.h"
+#include "../ml_algorithms/random_forest.h"
+
+/*
+ * CalibrationModel struct definition
+ */
+// A candidate stage with its cost and its prediction and confidence for each sample of the calibration set
+struct CalibrationModel {
+    std::string name;
+    std::shared_ptr<const MachineLearningModel> model;
+    real_t cost;
+    real_t accuracy;
+    std::vector<bool> good_predictions;
+    std::vector<real_t> confidences;
+    // A model always fully confident can only be the last stage of a cascade
+    bool has_confidence;
+};
+
+/*
+ * CascadeCalibration struct definition
+ */
+// Simulated cascade of the calibration models, the thresholds of all the stages but the last one
+struct CascadeCalibration {
+    std::vector<std::size_t> models_id;
+    std::vector<real_t> confidence_thresholds;
+    real_t accuracy;
+    real_t cost;
+    std::vector<real_t> stage_rates;
+};
+
+/**
+ * @brief           Measure the average prediction time with confidence of a model on the given features vectors.
+ * @details         The measure is repeated and the fastest run is kept to filter out the scheduler noise.
+ *
+ * @param[in]       model the model to measure
+ * @param[in]       features_vectors the features vectors to predict
+ * @returns         the average prediction time in µs per sample
+ */
+real_t measure_model_cost(const MachineLearningModel &model, const std::vector<std::pair<std::string, real_vector_t>> &features_vectors) {
+    const std::size_t repetitions = 20;
+    real_t best_elapsed_time = std::numeric_limits<real_t>::max();
+    std::size_t class_ids_sum = 0;
+    real_t confidence = 0;
+    for (std::size_t repetition = 0; repetition < repetitions; repetition++) {
+        auto start_time = std::chrono::high_resolution_clock::now();
+        for (const auto &features_vector: features_vectors) {
+            class_ids_sum += model.predict_class_id_with_confidence(features_vector.second, confidence);
+        }
+        auto stop_time = std::chrono::high_resolution_clock::now();
+        best_elapsed_time = std::min(best_elapsed_time, (real_t) std::chrono::duration_cast<std::chrono::nanoseconds>(stop_time - start_time).count());
+    }
+    LOG(LOG_DEBUG) << "class ids checksum: " << class_ids_sum;
+    return best_elapsed_time / 1000.0 / (real_t) features_vectors.size();
+}
+
+/**
+ * @brief           Load a model, measure its cost and keep its prediction and confidence for each sample.
+ *
+ * @param[in]       name the name of the cascade stage
+ * @param[in]       model the filled model
+ * @param[in]       features_vectors the calibration features vectors
+ * @returns         the calibration model
+ */
+CalibrationModel get_calibration_model(const std::string &name, std::shared_ptr<const MachineLearningModel> model, const std::vector<std::pair<std::string, real_vector_t>> &features_vectors) {
+    CalibrationModel calibration_model = {name, std::move(model), 0, 0, {}, {}, false};
+    calibration_model.cost = measure_model_cost(*calibration_model.model, features_vectors);
+    const ClassDictionary &class_dictionary = calibration_model.model->get_class_dictionary();
+    std::size_t good_predictions = 0;
+    for (const auto &features_vector: features_vectors) {
+        real_t confidence = 0;
+        const std::size_t class_id = calibration_model.model->predict_class_id_with_confidence(features_vector.second, confidence);
+        calibration_model.good_predictions.push_back(class_dictionary.get_class_name(class_id) == features_vector.first);
+        calibration_model.confidences.push_back(confidence);
+        calibration_model.has_confidence = calibration_model.has_confidence || confidence != calibration_model.confidences.front();
+        good_predictions += calibration_model.good_predictions.back() ? 1 : 0;
+    }
+    calibration_model.accuracy = (real_t) good_predictions / (real_t) features_vectors.size();
+    return calibration_model;
+}
+
+/**
+ * @brief           Simulate a cascade on the calibration set from the predictions of its models.
+ *
+ * @param[in]       calibration_models the calibration models
+ * @param[in]       models_id the models of the stages, from the first to the last one
+ * @param[in]       confidence_thresholds the thresholds of all the stages but the last one
+ * @returns         the accuracy, the average cost and the fraction of the samples reaching each stage
+ */
+CascadeCalibration simulate_cascade(const std::vector<CalibrationModel> &calibration_models, const std::vector<std::size_t> &models_id, const std::vector<real_t> &confidence_thresholds) {
+    CascadeCalibration cascade_calibration = {models_id, confidence_thresholds, 0, 0, std::vector<real_t>(models_id.size(), 0)};
+    const std::size_t number_of_samples = calibration_models.front().good_predictions.size();
+    std::size_t good_predictions = 0;
+    for (std::size_t sample_i = 0; sample_i < number_of_samples; sample_i++) {
+        for (std::size_t stage_i = 0; stage_i < models_id.size(); stage_i++) {
+            const CalibrationModel &calibration_model = calibration_models[models_id[stage_i]];
+            cascade_calibration.cost += calibration_model.cost;
+            cascade_calibration.stage_rates[stage_i] += 1;
+            if (stage_i + 1 == models_id.size() || calibration_model.confidences[sample_i] >= confidence_thresholds[stage_i]) {
+                good_predictions += calibration_model.good_predictions[sample_i] ? 1 : 0;
+                break;
+            }
+        }
+    }
+    cascade_calibration.accuracy = (real_t) good_predictions / (real_t) number_of_samples;
+    cascade_calibration.cost /= (real_t) number_of_samples;
+    for (real_t &stage_rate: cascade_calibration.stage_rates) {
+        stage_rate /= (real_t) number_of_samples;
+    }
+    return cascade_calibration;
+}
+
+/**
+ * @brief           Name of a cascade, its stage names from the first to the last one.
+ *
+ * @param[in]       calibration_models the calibration models
+ * @param[in]       models_id the models of the stages
+ * @returns         the cascade name
+ */
+std::string get_cascade_name(const std::vector<CalibrationModel> &calibration_models, const std::vector<std::size_t> &models_id) {
+    std::string cascade_name;
+    for (std::size_t model_id: models_id) {
+        cascade_name += (cascade_name.empty() ? "" : ">") + calibration_models[model_id].name;
+    }
+    return cascade_name;
+}
+
+log_struct LOGGING_CONFIG = {};
+
+int main(int argc, char *argv[]) {
+    // Log config
+    LOGGING_CONFIG.level = LOG_INFO;
+
+    if ((argc != 3 && argc != 4) || (std::string(argv[1]) != "stft" && std::string(argv[1]) != "mfcc")) {
+        std::cout << "Usage: " << argv[0] << " <stft|mfcc> <output_prefix> [<accuracy_tolerance>]" << std::endl;
+        std::cout << "Calibrates the confidence thresholds of the cascades of the models on the test set, keeps the cheapest cascade within accuracy_tolerance (0 by default) of the most accurate model" << std::endl;
+        return 1;
+    }
+    const AuFileProcessingAlgorithm processing_algorithm = std::string(argv[1]) == "stft" ? AuFileProcessingAlgorithm::STFT : AuFileProcessingAlgorithm::MFCC;
+    const std::string output_prefix = argv[2];
+    const real_t accuracy_tolerance = argc == 4 ? std::stod(argv[3]) : 0;
+    const bool stft = processing_algorithm == AuFileProcessingAlgorithm::STFT;
+    const std::filesystem::path test_csv_path = stft ? MUSIC_FEATURES_STFT_CSV_TEST_PATH : MUSIC_FEATURES_MFCC_CSV_TEST_PATH;
+
+    // Load the models and the test features vectors
+    LOG(LOG_INFO) << "Getting features vectors from the csv file " << absolute(test_csv_path) << " ...";
+    auto fvs = get_features_vectors_from_csv(test_csv_path, processing_algorithm);
+    auto decision_tree = std::make_shared<DecisionTree>();
+    load_model_from_csv(*decision_tree, stft ? DECISION_TREE_CSV_PATH_STFT : DECISION_TREE_CSV_PATH_MFCC);
+    auto random_forest = std::make_shared<RandomForest>();
+    load_model_from_csv(*random_forest, stft ? RANDOM_FOREST_TREES_FOLDER_PATH_STFT : RANDOM_FOREST_TREES_FOLDER_PATH_MFCC);
+    auto one_vs_one_svm = std::make_shared<OneVsOneSVM>();
+    load_model_from_csv(*one_vs_one_svm, stft ? ONE_VS_ONE_SVM_CSV_PATH_STFT : ONE_VS_ONE_SVM_CSV_PATH_MFCC);
+    auto artificial_neural_network = std::make_shared<ArtificialNeuralNetwork>();
+    load_model_from_csv(*artificial_neural_network, stft ? ARTIFICIAL_NEURAL_NETWORK_LAYERS_FOLDER_PATH_STFT : ARTIFICIAL_NEURAL_NETWORK_LAYERS_FOLDER_PATH_MFCC);
+
+    // Measure the cost of each model and keep its predictions, the cascades are simulated from them
+    LOG(LOG_INFO) << "Measuring the cost and the confidence of the models on " << fvs.size() << " samples...";
+    std::vector<CalibrationModel> calibration_models;
+    calibration_models.push_back(get_calibration_model("cart", decision_tree, fvs));
+    calibration_models.push_back(get_calibration_model("random_forest", random_forest, fvs));
+    calibration_models.push_back(get_calibration_model("svm", one_vs_one_svm, fvs));
+    calibration_models.push_back(get_calibration_model("ann", artificial_neural_network, fvs));
+    std::sort(calibration_models.begin(), calibration_models.end(), [](const CalibrationModel &a, const CalibrationModel &b) {
+        return a.cost < b.cost;
+    });
+    std::size_t best_model_id = 0;
+    for (std::size_t model_id = 0; model_id < calibration_models.size(); model_id++) {
+        const CalibrationModel &calibration_model = calibration_models[model_id];
+        LOG(LOG_INFO) << calibration_model.name << ": " << calibration_model.cost << "µs per sample, accuracy " << calibration_model.accuracy << (calibration_model.has_confidence ? "" : ", no confidence measure");
+        if (calibration_model.accuracy > calibration_models[best_model_id].accuracy) {
+            best_model_id = model_id;
+        }
+    }
+
+    // Every subset of the models ordered by cost is a cascade, only its last stage may lack a confidence measure. The
+    // thresholds take the values of a 0.05 grid, 0 and above 1 are left out since they drop a stage of the cascade
+    std::vector<real_t> thresholds_grid;
+    for (std::size_t step = 1; step <= 20; step++) {
+        thresholds_grid.push_back((real_t) step / 20.0);
+    }
+    std::vector<CascadeCalibration> cascade_calibrations;
+    for (std::size_t subset = 1; subset < (std::size_t{1} << calibration_models.size()); subset++) {
+        std::vector<std::size_t> models_id;
+        for (std::size_t model_id = 0; model_id < calibration_models.size(); model_id++) {
+            if (subset & (std::size_t{1} << model_id)) {
+                models_id.push_back(model_id);
+            }
+        }
+        if (std::any_of(models_id.cbegin(), models_id.cend() - 1, [&calibration_models](std::size_t model_id) { return !calibration_models[model_id].has_confidence; })) {
+            continue;
+        }
+
+        // Odometer over the thresholds of all the stages but the last one
+        std::vector<std::size_t> thresholds_step(models_id.size() - 1, 0);
+        bool done = false;
+        while (!done) {
+            std::vector<real_t> confidence_thresholds;
+            for (std::size_t step: thresholds_step) {
+                confidence_thresholds.push_back(thresholds_grid[step]);
+            }
+            cascade_calibrations.push_back(simulate_cascade(calibration_models, models_id, confidence_thresholds));
+            done = true;
+            for (std::size_t &step: thresholds_step) {
+                if (++step < thresholds_grid.size()) {
+                    done = false;
+                    break;
+                }
+                step = 0;
+            }
+        }
+    }
+
+    // Pareto front of the cost versus accuracy trade-off, from the cheapest to the most accurate cascade
+    std::sort(cascade_calibrations.begin(), cascade_calibrations.end(), [](const CascadeCalibration &a, const CascadeCalibration &b) {
+        if (a.cost != b.cost) {
+            return a.cost < b.cost;
+        }
+        // A threshold never escalating makes a cascade as cheap as its first stage alone, the shortest one is kept
+        return a.accuracy > b.accuracy || (a.accuracy == b.accuracy && a.models_id.size() < b.models_id.size());
+    });
+    std::vector<bool> pareto(cascade_calibrations.size(), false);
+    real_t pareto_accuracy = -1;
+    for (std::size_t calibration_i = 0; calibration_i < cascade_calibrations.size(); calibration_i++) {
+        if (cascade_calibrations[calibration_i].accuracy > pareto_accuracy) {
+            pareto[calibration_i] = true;
+            pareto_accuracy = cascade_calibrations[calibration_i].accuracy;
+        }
+    }
+
+    // Write the report, one line per simulated cascade
+    const CalibrationModel &best_model = calibration_models[best_model_id];
+    const std::filesystem::path report_path = output_prefix + "_report.csv";
+    std::ofstream report_file(report_path);
+    report_file << "cascade,confidence_thresholds,accuracy,cost_us,relative_cost,stage_rates,pareto\n";
+    for (std::size_t calibration_i = 0; calibration_i < cascade_calibrations.size(); calibration_i++) {
+        const CascadeCalibration &cascade_calibration = cascade_calibrations[calibration_i];
+        report_file << get_cascade_name(calibration_models, cascade_calibration.models_id) << ",";
+        for (std::size_t stage_i = 0; stage_i < cascade_calibration.confidence_thresholds.size(); stage_i++) {
+            report_file << (stage_i == 0 ? "" : ";") << cascade_calibration.confidence_thresholds[stage_i];
+        }
+        report_file << "," << cascade_calibration.accuracy << "," << cascade_calibration.cost << "," << cascade_calibration.cost / best_model.cost << ",";
+        for (std::size_t stage_i = 0; stage_i < cascade_calibration.stage_rates.size(); stage_i++) {
+            report_file << (stage_i == 0 ? "" : ";") << cascade_calibration.stage_rates[stage_i];
+        }
+        report_file << "," << (pareto[calibration_i] ? 1 : 0) << "\n";
+        if (pareto[calibration_i]) {
+            LOG(LOG_INFO) << "Pareto cascade " << get_cascade_name(calibration_models, cascade_calibration.models_id) << ": " << cascade_calibration.cost << "µs per sample (x" << cascade_calibration.cost / best_model.cost << "), accuracy " << cascade_calibration.accuracy;
+        }
+    }
+
+    // Keep the cheapest cascade within the tolerance of the most accurate model
+    auto selected_calibration = std::find_if(cascade_calibrations.cbegin(), cascade_calibrations.cend(), [&best_model, accuracy_tolerance](const CascadeCalibration &cascade_calibration) {
+        return cascade_calibration.accuracy >= best_model.accuracy - accuracy_tolerance;
+    });
+    CascadeModel cascade_model = {};
+    for (std::size_t stage_i = 0; stage_i < selected_calibration->models_id.size(); stage_i++) {
+        const CalibrationModel &calibration_model = calibration_models[selected_calibration->models_id[stage_i]];
+        cascade_model.add_stage(calibration_model.name, calibration_model.model, stage_i < selected_calibration->confidence_thresholds.size() ? selected_calibration->confidence_thresholds[stage_i] : 0);
+    }
+    const std::filesystem::path cascade_path = output_prefix + "_cascade.csv";
+    cascade_model.write_to_csv(cascade_path);
+
+    // Check the simulation against the real cascade
+    CascadePredictionStats prediction_stats = {};
+    std::size_t good_predictions = 0;
+    for (const auto &features_vector: fvs) {
+        good_predictions += cascade_model.get_class_dictionary().get_class_name(cascade_model.predict_class_id(features_vector.second, prediction_stats)) == features_vector.first ? 1 : 0;
+    }
+    const real_t cascade_accuracy = (real_t) good_predictions / (real_t) fvs.size();
+    const real_t cascade_cost = benchmark_predictions(cascade_model, fvs, 20);
+    if (cascade_accuracy != selected_calibration->accuracy) {
+        LOG(LOG_ERROR) << "Error : the cascade accuracy (" << cascade_accuracy << ") differs from the simulated one (" << selected_calibration->accuracy << ")";
+        return 1;
+    }
+
+    LOG(LOG_INFO) << "Most accurate model " << best_model.name << ": " << best_model.cost << "µs per sample, accuracy " << best_model.accuracy;
+    for (std::size_t stage_i = 0; stage_i < cascade_model.get_stages().size(); stage_i++) {
+        const CascadeStage &stage = cascade_model.get_stages()[stage_i];
+        LOG(LOG_INFO) << "Stage " << stage_i << " " << stage.name << (stage_i + 1 < cascade_model.get_stages().size() ? ", confidence threshold " + std::to_string(stage.confidence_threshold) : "") << ", reached by " << prediction_stats.get_stage_rate(stage_i) * 100 << "% of the samples";
+    }
+    LOG(LOG_INFO) << "Selected cascade " << get_cascade_name(calibration_models, selected_calibration->models_id) << ": " << cascade_cost << "µs per sample measured, " << selected_calibration->cost << "µs simulated (x" << selected_calibration->cost / best_model.cost << "), accuracy " << cascade_accuracy;
+    LOG(LOG_INFO) << "Cascade thresholds written in " << absolute(cascade_path) << ", cost versus accuracy report written in " << absolute(report_path);
+
+    return 0;
+}
@@ -0,0 +1,267 @@
+#include <fstream>
+#include <iomanip>
+#include "../helpers/log.h"
+#include "../ml_algorithms/decision_tree.h"
+#include "../ml_algorithms/random_forest.h"
+#include "../ml_algorithms/one_vs_one_svm.h"
+#include "../ml_algorithms/artificial_neural_network.h"
+
+// Number of features of the STFT and MFCC features vectors, the same as get_features_vectors_from_csv
+constexpr std::size_t STFT_NUMBER_OF_FEATURES = FFT_SIZE * 2;
+constexpr std::size_t MFCC_NUMBER_OF_FEATURES = (MEL_APPLIED_N + 1) * 2;
+
+/**
+ * @brief           Write a constexpr array of numbers, the reals in hexadecimal so the tables hold the exact values of the model.
+ *
+ * @param[in]       output_file the generated header
+ * @param[in]       type_name the element type of the array
+ * @param[in]       array_name the name of the array
+ * @param[in]       values the elements of the array
+ */
+template<typename Values>
+void write_array(std::ofstream &output_file, const std::string &type_name, const std::string &array_name, const Values &values) {
+    output_file << "alignas(SIMD_ALIGNMENT) inline constexpr std::array<" << type_name << ", " << values.size() << "> " << array_name << " = {";
+    std::size_t value_i = 0;
+    for (const auto &value: values) {
+        output_file << (value_i % 8 == 0 ? "\n        " : " ") << value << ",";
+        value_i++;
+    }
+    output_file << "\n};\n";
+}
+
+/**
+ * @brief           Write a constexpr array of flattened tree nodes.
+ *
+ * @param[in]       output_file the generated header
+ * @param[in]       array_name the name of the array
+ * @param[in]       flat_tree the nodes
+ */
+void write_flat_tree(std::ofstream &output_file, const std::string &array_name, const std::vector<FlatTreeNode> &flat_tree) {
+    output_file << "inline constexpr std::array<FlatTreeNode, " << flat_tree.size() << "> " << array_name << " = {{";
+    for (const FlatTreeNode &node: flat_tree) {
+        output_file << "\n        {" << node.threshold << ", " << node.feature_id << ", {" << node.children_id[0] << ", " << node.children_id[1] << "}, " << node.class_id << "},";
+    }
+    output_file << "\n}};\n";
+}
+
+/**
+ * @brief           Write a constexpr array of the class names of a model, in the order of its class ids.
+ *
+ * @param[in]       output_file the generated header
+ * @param[in]       array_name the name of the array
+ * @param[in]       class_names the class names
+ */
+void write_class_names(std::ofstream &output_file, const std::string &array_name, const std::vector<std::string> &class_names) {
+    output_file << "inline constexpr std::array<std::string_view, " << class_names.size() << "> " << array_name << " = {";
+    for (const std::string &class_name: class_names) {
+        output_file << (&class_name == &class_names.front() ? "" : ", ") << std::quoted(class_name);
+    }
+    output_file << "};\n";
+}
+
+/**
+ * @brief           Write the tables and the embedded model of a decision tree.
+ *
+ * @param[in]       output_file the generated header
+ * @param[in]       model_name the name of the generated model, prefix of its tables
+ * @param[in]       csv_file_path the decision tree CSV file
+ * @param[in]       number_of_features the size of the features vectors
+ */
+void write_embedded_decision_tree(std::ofstream &output_file, const std::string &model_name, const std::filesystem::path &csv_file_path, std::size_t number_of_features) {
+    DecisionTree decision_tree = {};
+    decision_tree.fill_from_csv(csv_file_path);
+    const std::vector<FlatTreeNode> &flat_tree = decision_tree.get_flat_tree();
+    if (flat_tree.empty()) {
+        LOG(LOG_ERROR) << "Error : the decision tree of " << csv_file_path << " does not have any node";
+        throw std::invalid_argument("Tree does not have a root node!");
+    }
+    const std::size_t number_of_classes = decision_tree.get_class_dictionary().size();
+
+    output_file << "// " << csv_file_path.filename().string() << ": " << flat_tree.size() << " nodes\n";
+    write_flat_tree(output_file, model_name + "_NODES", flat_tree);
+    write_class_names(output_file, model_name + "_CLASS_NAMES", decision_tree.get_class_dictionary().get_class_names());
+    output_file << "inline constexpr EmbeddedDecisionTree<" << number_of_features << ", " << number_of_classes << "> " << model_name << "(" << model_name << "_NODES, " << model_name << "_CLASS_NAMES);\n";
+    output_file << "static_assert(" << model_name << ".is_valid(), \"Invalid " << model_name << " tables\");\n\n";
+    LOG(LOG_INFO) << model_name << " generated from " << csv_file_path;
+}
+
+/**
+ * @brief           Write the tables and the embedded model of a random forest.
+ * @details         The flattened trees are concatenated, their children ids shifted by the index of their root node and
+ *                  their leaf class ids translated to the class ids of the forest.
+ *
+ * @param[in]       output_file the generated header
+ * @param[in]       model_name the name of the generated model, prefix of its tables
+ * @param[in]       csv_folder_path the folder of the trees CSV files
+ * @param[in]       number_of_features the size of the features vectors
+ */
+void write_embedded_random_forest(std::ofstream &output_file, const std::string &model_name, const std::filesystem::path &csv_folder_path, std::size_t number_of_features) {
+    RandomForest random_forest = {};
+    random_forest.fill_from_csv(csv_folder_path);
+    if (random_forest.get_number_of_trees() == 0) {
+        LOG(LOG_ERROR) << "Error : the random forest of " << csv_folder_path << " does not have any tree";
+        throw std::invalid_argument("Forest does not have any tree!");
+    }
+    const ClassDictionary &forest_class_dictionary = random_forest.get_class_dictionary();
+
+    std::vector<FlatTreeNode> forest_nodes;
+    std::vector<std::uint32_t> roots_id;
+    for (DecisionTree decision_tree: random_forest.get_trees()) {
+        const std::uint32_t root_id = forest_nodes.size();
+        const std::vector<FlatTreeNode> &flat_tree = decision_tree.get_flat_tree();
+        for (FlatTreeNode node: flat_tree) {
+            if (node.children_id[0] == node.children_id[1]) {
+                node.class_id = forest_class_dictionary.get_class_id(decision_tree.get_class_dictionary().get_class_name(node.class_id));
+            }
+            node.children_id[0] += root_id;
+            node.children_id[1] += root_id;
+            forest_nodes.push_back(node);
+        }
+        roots_id.push_back(root_id);
+    }
+
+    output_file << "// " << csv_folder_path.filename().string() << ": " << roots_id.size() << " trees, " << forest_nodes.size() << " nodes\n";
+    write_flat_tree(output_file, model_name + "_NODES", forest_nodes);
+    write_array(output_file, "std::uint32_t", model_name + "_ROOTS_ID", roots_id);
+    write_class_names(output_file, model_name + "_CLASS_NAMES", forest_class_dictionary.get_class_names());
+    output_file << "inline constexpr EmbeddedRandomForest<" << number_of_features << ", " << forest_class_dictionary.size() << ", " << roots_id.size() << "> " << model_name << "(" << model_name << "_NODES, " << model_name << "_ROOTS_ID, " << model_name << "_CLASS_NAMES);\n";
+    output_file << "static_assert(" << model_name << ".is_valid(), \"Invalid " << model_name << " tables\");\n\n";
+    LOG(LOG_INFO) << model_name << " generated from " << csv_folder_path;
+}
+
+/**
+ * @brief           Write the tables and the embedded model of a one vs one SVM.
+ *
+ * @param[in]       output_file the generated header
+ * @param[in]       model_name the name of the generated model, prefix of its tables
+ * @param[in]       csv_file_path the SVM CSV file
+ */
+void write_embedded_one_vs_one_svm(std::ofstream &output_file, const std::string &model_name, const std::filesystem::path &csv_file_path) {
+    OneVsOneSVM one_vs_one_svm = {};
+    one_vs_one_svm.fill_from_csv(csv_file_path);
+    const std::pmr::vector<LinearClassifier> &classifiers = one_vs_one_svm.get_classifiers();
+    if (classifiers.empty()) {
+        LOG(LOG_ERROR) << "Error : the SVM of " << csv_file_path << " does not have any classifier";
+        throw std::invalid_argument("SVM does not have any classifier!");
+    }
+    const ClassDictionary &class_dictionary = one_vs_one_svm.get_class_dictionary();
+    const std::size_t number_of_features = classifiers.front().get_coef_matrix().size();
+    const std::size_t padded_number_of_features = simd_padded_size(number_of_features);
+
+    std::vector<real_t> coefficients(classifiers.size() * padded_number_of_features, 0);
+    std::vector<real_t> intercepts;
+    std::vector<std::uint32_t> classifiers_class_ids;
+    for (std::size_t classifier_i = 0; classifier_i < classifiers.size(); classifier_i++) {
+        const LinearClassifier &linear_classifier = classifiers[classifier_i];
+        if (linear_classifier.get_coef_matrix().size() != number_of_features) {
+            LOG(LOG_ERROR) << "Error : the classifier " << classifier_i << " has " << linear_classifier.get_coef_matrix().size() << " coefficients but the first one has " << number_of_features;
+            throw std::invalid_argument("SVM shape mismatch!");
+        }
+        std::copy(linear_classifier.get_coef_matrix().cbegin(), linear_classifier.get_coef_matrix().cend(), coefficients.begin() + (long) (classifier_i * padded_number_of_features));
+        intercepts.push_back(linear_classifier.get_intercept());
+        classifiers_class_ids.push_back(class_dictionary.get_class_id(linear_classifier.get_lower_class()));
+        classifiers_class_ids.push_back(class_dictionary.get_class_id(linear_classifier.get_upper_class()));
+    }
+
+    output_file << "// " << csv_file_path.filename().string() << ": " << classifiers.size() << " classifiers\n";
+    write_array(output_file, "real_t", model_name + "_COEFFICIENTS", coefficients);
+    write_array(output_file, "real_t", model_name + "_INTERCEPTS", intercepts);
+    write_array(output_file, "std::uint32_t", model_name + "_CLASSIFIERS_CLASS_IDS", classifiers_class_ids);
+    write_class_names(output_file, model_name + "_CLASS_NAMES", class_dictionary.get_class_names());
+    output_file << "inline constexpr EmbeddedOneVsOneSVM<" << number_of_features << ", " << class_dictionary.size() << "> " << model_name << "(" << model_name << "_COEFFICIENTS, " << model_name << "_INTERCEPTS, " << model_name << "_CLASSIFIERS_CLASS_IDS, " << model_name << "_CLASS_NAMES);\n";
+    output_file << "static_assert(" << model_name << ".is_valid(), \"Invalid " << model_name << " tables\");\n\n";
+    LOG(LOG_INFO) << model_name << " generated from " << csv_file_path;
+}
+
+/**
+ * @brief           Write the tables and the embedded model of a neural network.
+ *
+ * @param[in]       output_file the generated header
+ * @param[in]       model_name the name of the generated model, prefix of its tables
+ * @param[in]       csv_folder_path the folder of the layers CSV files
+ */
+void write_embedded_artificial_neural_network(std::ofstream &output_file, const std::string &model_name, const std::filesystem::path &csv_folder_path) {
+    ArtificialNeuralNetwork artificial_neural_network = {};
+    artificial_neural_network.fill_from_csv(csv_folder_path);
+    const std::vector<DenseLayer> &dense_layers = artificial_neural_network.get_dense_layers();
+    if (dense_layers.empty()) {
+        LOG(LOG_ERROR) << "Error : the neural network of " << csv_folder_path << " does not have any layer";
+        throw std::invalid_argument("Neural network does not have any layer!");
+    }
+
+    output_file << "// " << csv_folder_path.filename().string() << ": " << dense_layers.size() << " layers\n";
+    for (std::size_t layer_i = 0; layer_i < dense_layers.size(); layer_i++) {
+        // The packed weights rows are already zero-padded to simd_padded_size(input_size)
+        const DenseLayer &dense_layer = dense_layers[layer_i];
+        write_array(output_file, "real_t", model_name + "_LAYER_" + std::to_string(layer_i) + "_WEIGHTS", dense_layer.weights);
+        write_array(output_file, "real_t", model_name + "_LAYER_" + std::to_string(layer_i) + "_BIASES", dense_layer.biases);
+    }
+    write_class_names(output_file, model_name + "_CLASS_NAMES", artificial_neural_network.get_classes());
+    output_file << "inline constexpr EmbeddedArtificialNeuralNetwork<" << dense_layers.front().input_size;
+    for (const DenseLayer &dense_layer: dense_layers) {
+        output_file << ", " << dense_layer.output_size;
+    }
+    output_file << "> " << model_name << "({{";
+    for (std::size_t layer_i = 0; layer_i < dense_layers.size(); layer_i++) {
+        const DenseLayer &dense_layer = dense_layers[layer_i];
+        output_file << "\n        {" << dense_layer.input_size << ", " << dense_layer.output_size << ", " << model_name << "_LAYER_" << layer_i << "_WEIGHTS, " << model_name << "_LAYER_" << layer_i << "_BIASES, ActivationFunction(" << (int) dense_layer.activation_function << ")},";
+    }
+    output_file << "\n}}, " << model_name << "_CLASS_NAMES);\n";
+    output_file << "static_assert(" << model_name << ".is_valid(), \"Invalid " << model_name << " tables\");\n\n";
+    LOG(LOG_INFO) << model_name << " generated from " << csv_folder_path;
+}
+
+log_struct LOGGING_CONFIG = {};
+
+int main(int argc, char *argv[]) {
+    // Log config
+    LOGGING_CONFIG.level = LOG_INFO;
+
+    if (argc != 3 && argc != 4) {
+        std::cout << "Usage: " << argv[0] << " <cart|random_forest|svm|ann> <output_header> [<training_folder>]" << std::endl;
+        std::cout << "The trained models are read from training_folder when given (the build passes the absolute one of the sources), else from the paths of globals.h relative to the working directory" << std::endl;
+        return 1;
+    }
+    const std::string model = argv[1];
+    if (model != "cart" && model != "random_forest" && model != "svm" && model != "ann") {
+        LOG(LOG_ERROR) << "Error : the model " << model << " can't be embedded, expected cart, random_forest, svm or ann";
+        return 1;
+    }
+    const std::filesystem::path output_header_path = argv[2];
+    // Path of a model file or folder, moved under the given training folder if any
+    auto model_path = [argc, argv](const std::filesystem::path &default_path) {
+        return argc == 4 ? std::filesystem::path(argv[3]) / default_path.parent_path().filename() / default_path.filename() : default_path;
+    };
+    std::ofstream output_file(output_header_path);
+    if (!output_file.is_open()) {
+        LOG(LOG_ERROR) << "Error : file with path " + output_header_path.string() + "  cannot be created.";
+        return 1;
+    }
+    // Hexadecimal reals are parsed back to the exact same values by the compiler
+    output_file << std::hexfloat;
+
+    // The tables of the trained STFT and MFCC models, compiled in the read-only data of the binary including the header
+    std::string include_guard = "EMBEDDED_" + model + "_H";
+    std::transform(include_guard.begin(), include_guard.end(), include_guard.begin(), ::toupper);
+    const std::string model_prefix = include_guard.substr(0, include_guard.size() - 2);
+    output_file << "// Generated by EMBEDDED_MODEL_GENERATOR from the training CSV files, do not edit\n";
+    output_file << "#ifndef " << include_guard << "\n#define " << include_guard << "\n\n";
+    output_file << "#include <array>\n#include <cstdint>\n#include <string_view>\n#include \"embedded_models.h\"\n\n";
+    if (model == "cart") {
+        write_embedded_decision_tree(output_file, model_prefix + "_STFT", model_path(DECISION_TREE_CSV_PATH_STFT), STFT_NUMBER_OF_FEATURES);
+        write_embedded_decision_tree(output_file, model_prefix + "_MFCC", model_path(DECISION_TREE_CSV_PATH_MFCC), MFCC_NUMBER_OF_FEATURES);
+    } else if (model == "random_forest") {
+        write_embedded_random_forest(output_file, model_prefix + "_STFT", model_path(RANDOM_FOREST_TREES_FOLDER_PATH_STFT), STFT_NUMBER_OF_FEATURES);
+        write_embedded_random_forest(output_file, model_prefix + "_MFCC", model_path(RANDOM_FOREST_TREES_FOLDER_PATH_MFCC), MFCC_NUMBER_OF_FEATURES);
+    } else if (model == "svm") {
+        write_embedded_one_vs_one_svm(output_file, model_prefix + "_STFT", model_path(ONE_VS_ONE_SVM_CSV_PATH_STFT));
+        write_embedded_one_vs_one_svm(output_file, model_prefix + "_MFCC", model_path(ONE_VS_ONE_SVM_CSV_PATH_MFCC));
+    } else {
+        write_embedded_artificial_neural_network(output_file, model_prefix + "_STFT", model_path(ARTIFICIAL_NEURAL_NETWORK_LAYERS_FOLDER_PATH_STFT));
+        write_embedded_artificial_neural_network(output_file, model_prefix + "_MFCC", model_path(ARTIFICIAL_NEURAL_NETWORK_LAYERS_FOLDER_PATH_MFCC));
+    }
+    output_file << "#endif //" << include_guard << "\n";
+
+    LOG(LOG_INFO) << "Embedded " << model << " models written in " << absolute(output_header_path);
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include <fstream>
+#include "../helpers/log.h"
+#include "../ml_algorithms/artificial_neural_network.h"
+#include "../ml_algorithms/one_vs_one_svm.h"
+
+/**
+ * @brief           Write the fixed neural network type of the network loaded from the layers CSV files folder.
+ *
+ * @param[in]       output_file the generated header
+ * @param[in]       type_name the name of the generated type
+ * @param[in]       csv_folder_path the folder of the layers CSV files
+ */
+void write_fixed_artificial_neural_network(std::ofstream &output_file, const std::string &type_name, const std::filesystem::path &csv_folder_path) {
+    ArtificialNeuralNetwork artificial_neural_network = {};
+    artificial_neural_network.fill_from_csv(csv_folder_path);
+    const std::vector<DenseLayer> &dense_layers = artificial_neural_network.get_dense_layers();
+    if (dense_layers.empty()) {
+        LOG(LOG_ERROR) << "Error : the neural network of " << csv_folder_path << " does not have any layer";
+        throw std::invalid_argument("Neural network does not have any layer!");
+    }
+    output_file << "// " << csv_folder_path.filename().string() << ": " << dense_layers.size() << " layers\n";
+    output_file << "typedef FixedArtificialNeuralNetwork<" << dense_layers.front().input_size;
+    for (const DenseLayer &dense_layer: dense_layers) {
+        output_file << ", " << dense_layer.output_size;
+    }
+    output_file << "> " << type_name << ";\n\n";
+    LOG(LOG_INFO) << type_name << " generated from " << csv_folder_path;
+}
+
+/**
+ * @brief           Write the fixed one vs one SVM type of the SVM loaded from the CSV file.
+ *
+ * @param[in]       output_file the generated header
+ * @param[in]       type_name the name of the generated type
+ * @param[in]       csv_file_path the SVM CSV file
+ */
+void write_fixed_one_vs_one_svm(std::ofstream &output_file, const std::string &type_name, const std::filesystem::path &csv_file_path) {
+    OneVsOneSVM one_vs_one_svm = {};
+    one_vs_one_svm.fill_from_csv(csv_file_path);
+    if (one_vs_one_svm.get_classifiers().empty()) {
+        LOG(LOG_ERROR) << "Error : the SVM of " << csv_file_path << " does not have any classifier";
+        throw std::invalid_argument("SVM does not have any classifier!");
+    }
+    output_file << "// " << csv_file_path.filename().string() << ": " << one_vs_one_svm.get_classifiers().size() << " classifiers\n";
+    output_file << "typedef FixedOneVsOneSVM<" << one_vs_one_svm.get_classifiers().front().get_coef_matrix().size() << ", " << one_vs_one_svm.get_class_dictionary().size() << "> " << type_name << ";\n\n";
+    LOG(LOG_INFO) << type_name << " generated from " << csv_file_path;
+}
+
+log_struct LOGGING_CONFIG = {};
+
+int main(int argc, char *argv[]) {
+    // Log config
+    LOGGING_CONFIG.level = LOG_INFO;
+
+    if (argc != 2) {
+        std::cout << "Usage: " << argv[0] << " <output_header>" << std::endl;
+        return 1;
+    }
+    const std::filesystem::path output_header_path = argv[1];
+    std::ofstream output_file(output_header_path);
+    if (!output_file.is_open()) {
+        LOG(LOG_ERROR) << "Error : file with path " + output_header_path.string() + "  cannot be created.";
+        return 1;
+    }
+
+    // The fixed model types of the trained models, to be included next to the fixed model templates
+    output_file << "// Generated by FIXED_MODEL_GENERATOR from the training CSV files, do not edit\n";
+    output_file << "#ifndef FIXED_MODELS_H\n#define FIXED_MODELS_H\n\n";
+    output_file << "#include \"fixed_artificial_neural_network.h\"\n#include \"fixed_one_vs_one_svm.h\"\n\n";
+    write_fixed_artificial_neural_network(output_file, "FixedArtificialNeuralNetworkSTFT", ARTIFICIAL_NEURAL_NETWORK_LAYERS_FOLDER_PATH_STFT);
+    write_fixed_artificial_neural_network(output_file, "FixedArtificialNeuralNetworkMFCC", ARTIFICIAL_NEURAL_NETWORK_LAYERS_FOLDER_PATH_MFCC);
+    write_fixed_one_vs_one_svm(output_file, "FixedOneVsOneSVMSTFT", ONE_VS_ONE_SVM_CSV_PATH_STFT);
+    write_fixed_one_vs_one_svm(output_file, "FixedOneVsOneSVMMFCC", ONE_VS_ONE_SVM_CSV_PATH_MFCC);
+    output_file << "#endif //FIXED_MODELS_H\n";
+
+    LOG(LOG_INFO) << "Fixed model types written in " << absolute(output_header_path);
+    return 0;
+}
@@ -0,0 +1,185 @@
+#include <chrono>
+#include <fstream>
+#include <numeric>
+#include "../helpers/file_helpers.h"
+#include "../helpers/log.h"
+#include "../ml_algorithms/decision_tree.h"
+#include "../ml_algorithms/random_forest.h"
+
+/** @brief pruning budget types */
+enum class PruningBudget : std::size_t {
+    LATENCY = 0, /** Keep the most accurate subset whose prediction time fits in the budget (in µs per sample) */
+    ACCURACY = 1 /** Keep the smallest subset reaching the accuracy target */
+};
+
+/**
+ * @brief           Measure the average prediction time of a tree on the given features vectors.
+ * @details         The measure is repeated and the fastest run is kept to filter out the scheduler noise.
+ *
+ * @param[in]       tree the decision tree to measure
+ * @param[in]       features_vectors the features vectors to predict
+ * @returns         the average prediction time in µs per sample
+ */
+real_t measure_tree_cost(DecisionTree &tree, const std::vector<std::pair<std::string, real_vector_t>> &features_vectors) {
+    const std::size_t repetitions = 20;
+    real_t best_elapsed_time = std::numeric_limits<real_t>::max();
+    std::uint32_t class_ids_sum = 0;
+    for (std::size_t repetition = 0; repetition < repetitions; repetition++) {
+        auto start_time = std::chrono::high_resolution_clock::now();
+        for (const auto &features_vector: features_vectors) {
+            class_ids_sum += tree.predict_class_id(features_vector.second);
+        }
+        auto stop_time = std::chrono::high_resolution_clock::now();
+        best_elapsed_time = std::min(best_elapsed_time, (real_t) std::chrono::duration_cast<std::chrono::nanoseconds>(stop_time - start_time).count());
+    }
+    LOG(LOG_DEBUG) << "class ids checksum: " << class_ids_sum;
+    return best_elapsed_time / 1000.0 / (real_t) features_vectors.size();
+}
+
+/**
+ * @brief           Compute the accuracy of the votes, ties go to the first class like RandomForest::predict_class_id.
+ *
+ * @param[in]       votes the dense samples x classes votes array
+ * @param[in]       true_class_ids the true forest class id of each sample (-1 if the class is unknown to the forest)
+ * @param[in]       number_of_classes the number of forest classes
+ * @returns         the accuracy
+ */
+real_t votes_accuracy(const std::vector<std::size_t> &votes, const std::vector<long> &true_class_ids, std::size_t number_of_classes) {
+    std::size_t good_predictions = 0;
+    for (std::size_t sample_i = 0; sample_i < true_class_ids.size(); sample_i++) {
+        auto sample_votes = votes.cbegin() + (long) (sample_i * number_of_classes);
+        if (std::distance(sample_votes, std::max_element(sample_votes, sample_votes + (long) number_of_classes)) == true_class_ids[sample_i]) {
+            good_predictions += 1;
+        }
+    }
+    return (real_t) good_predictions / (real_t) true_class_ids.size();
+}
+
+log_struct LOGGING_CONFIG = {};
+
+int main(int argc, char *argv[]) {
+    // Log config
+    LOGGING_CONFIG.level = LOG_INFO;
+
+    if (argc != 5 || (std::string(argv[1]) != "stft" && std::string(argv[1]) != "mfcc") || (std::string(argv[2]) != "--latency" && std::string(argv[2]) != "--accuracy")) {
+        std::cout << "Usage: " << argv[0] << " <stft|mfcc> <--latency µs_per_sample|--accuracy target> <output_model_dir>" << std::endl;
+        return 1;
+    }
+    const AuFileProcessingAlgorithm processing_algorithm = std::string(argv[1]) == "stft" ? AuFileProcessingAlgorithm::STFT : AuFileProcessingAlgorithm::MFCC;
+    const PruningBudget pruning_budget = std::string(argv[2]) == "--latency" ? PruningBudget::LATENCY : PruningBudget::ACCURACY;
+    const real_t budget = std::stod(argv[3]);
+    const std::filesystem::path output_folder_path = argv[4];
+    const std::filesystem::path model_folder_path = processing_algorithm == AuFileProcessingAlgorithm::STFT ? RANDOM_FOREST_TREES_FOLDER_PATH_STFT : RANDOM_FOREST_TREES_FOLDER_PATH_MFCC;
+    const std::filesystem::path test_csv_path = processing_algorithm == AuFileProcessingAlgorithm::STFT ? MUSIC_FEATURES_STFT_CSV_TEST_PATH : MUSIC_FEATURES_MFCC_CSV_TEST_PATH;
+
+    // Load the forest and the test features vectors
+    LOG(LOG_INFO) << "Creating a Random Forest from all csv files in the following dir " << model_folder_path << " ...";
+    RandomForest random_forest = {};
+    random_forest.fill_from_csv(model_folder_path);
+    const ClassDictionary forest_class_dictionary = random_forest.get_class_dictionary();
+    const std::size_t number_of_classes = forest_class_dictionary.size();
+    std::vector<DecisionTree> trees = random_forest.get_trees();
+    LOG(LOG_INFO) << "Getting features vectors from the csv file " << absolute(test_csv_path) << " ...";
+    auto fvs = get_features_vectors_from_csv(test_csv_path, processing_algorithm);
+    std::vector<long> true_class_ids;
+    for (const auto &features_vector: fvs) {
+        true_class_ids.push_back(forest_class_dictionary.contains(features_vector.first) ? (long) forest_class_dictionary.get_class_id(features_vector.first) : -1);
+    }
+
+    // Measure the cost and the forest class id predicted by each tree for each sample
+    LOG(LOG_INFO) << "Measuring the cost of the " << trees.size() << " trees on " << fvs.size() << " samples...";
+    std::vector<real_t> trees_cost;
+    std::vector<std::vector<std::size_t>> trees_predictions;
+    for (DecisionTree &tree: trees) {
+        trees_cost.push_back(measure_tree_cost(tree, fvs));
+        std::vector<std::size_t> tree_predictions;
+        for (const auto &features_vector: fvs) {
+            const std::string &class_name = tree.get_class_dictionary().get_class_name(tree.predict_class_id(features_vector.second));
+            tree_predictions.push_back(forest_class_dictionary.get_class_id(class_name));
+        }
+        trees_predictions.push_back(tree_predictions);
+    }
+    const real_t forest_cost = std::accumulate(trees_cost.cbegin(), trees_cost.cend(), 0.0);
+
+    // Greedily add the tree giving the best accuracy (the cheapest one on ties) to build the speed-up versus accuracy curve
+    std::vector<std::size_t> votes(fvs.size() * number_of_classes, 0);
+    std::vector<bool> selected(trees.size(), false);
+    std::vector<std::size_t> selection_order;
+    std::vector<real_t> curve_cost;
+    std::vector<real_t> curve_accuracy;
+    real_t subset_cost = 0;
+    for (std::size_t step = 0; step < trees.size(); step++) {
+        std::size_t best_tree_i = trees.size();
+        real_t best_accuracy = -1;
+        for (std::size_t tree_i = 0; tree_i < trees.size(); tree_i++) {
+            if (selected[tree_i]) {
+                continue;
+            }
+            std::vector<std::size_t> candidate_votes = votes;
+            for (std::size_t sample_i = 0; sample_i < fvs.size(); sample_i++) {
+                candidate_votes[sample_i * number_of_classes + trees_predictions[tree_i][sample_i]] += 1;
+            }
+            real_t accuracy = votes_accuracy(candidate_votes, true_class_ids, number_of_classes);
+            if (accuracy > best_accuracy || (accuracy == best_accuracy && trees_cost[tree_i] < trees_cost[best_tree_i])) {
+                best_accuracy = accuracy;
+                best_tree_i = tree_i;
+            }
+        }
+        for (std::size_t sample_i = 0; sample_i < fvs.size(); sample_i++) {
+            votes[sample_i * number_of_classes + trees_predictions[best_tree_i][sample_i]] += 1;
+        }
+        selected[best_tree_i] = true;
+        selection_order.push_back(best_tree_i);
+        subset_cost += trees_cost[best_tree_i];
+        curve_cost.push_back(subset_cost);
+        curve_accuracy.push_back(best_accuracy);
+    }
+
+    // Pick the subset size meeting the budget
+    std::size_t subset_size = 0;
+    switch (pruning_budget) {
+        case PruningBudget::LATENCY: {
+            for (std::size_t k = 1; k <= trees.size(); k++) {
+                if (curve_cost[k - 1] <= budget && (subset_size == 0 || curve_accuracy[k - 1] > curve_accuracy[subset_size - 1])) {
+                    subset_size = k;
+                }
+            }
+            break;
+        }
+        case PruningBudget::ACCURACY: {
+            for (std::size_t k = 1; k <= trees.size() && subset_size == 0; k++) {
+                if (curve_accuracy[k - 1] >= budget) {
+                    subset_size = k;
+                }
+            }
+            break;
+        }
+        default: {
+            LOG(LOG_ERROR) << "Error : the pruning budget value usage is not defined in the project";
+            throw std::domain_error("Unsupported pruning budget!");
+            break;
+        }
+    }
+    if (subset_size == 0) {
+        LOG(LOG_ERROR) << "Error : no subset of trees meets the budget " << budget << " (cheapest tree: " << curve_cost.front() << "µs, best accuracy: " << *std::max_element(curve_accuracy.cbegin(), curve_accuracy.cend()) << ")";
+        return 1;
+    }
+
+    // Write the pruned forest and the curve report
+    std::filesystem::create_directories(output_folder_path);
+    for (std::size_t k = 0; k < subset_size; k++) {
+        trees[selection_order[k]].write_to_csv(output_folder_path / ("random_forest_trees_" + std::to_string(k) + ".csv"));
+    }
+    const std::filesystem::path report_path = output_folder_path.string() + "_report.csv";
+    std::ofstream report_file(report_path);
+    report_file << "number_of_trees,tree_id,latency_us,speed_up,accuracy\n";
+    for (std::size_t k = 0; k < trees.size(); k++) {
+        report_file << k + 1 << "," << selection_order[k] << "," << curve_cost[k] << "," << forest_cost / curve_cost[k] << "," << curve_accuracy[k] << "\n";
+    }
+
+    LOG(LOG_INFO) << "Full forest: " << trees.size() << " trees, " << forest_cost << "µs per sample, accuracy " << curve_accuracy.back();
+    LOG(LOG_INFO) << "Pruned forest: " << subset_size << " trees, " << curve_cost[subset_size - 1] << "µs per sample (x" << forest_cost / curve_cost[subset_size - 1] << "), accuracy " << curve_accuracy[subset_size - 1];
+    LOG(LOG_INFO) << "Pruned forest written in " << absolute(output_folder_path) << ", speed-up versus accuracy curve written in " << absolute(report_path);
+
+    return 0;
+}
@@ -0,0 +1,244 @@
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include "../helpers/inference_protocol.h"
+#include "../helpers/file_helpers.h"
+#include "../helpers/log.h"
+
+using steady_clock = std::chrono::steady_clock;
+
+// Model served by the daemon, from its MODEL_INFO response
+struct ModelInfo {
+    std::string name;
+    AuFileProcessingAlgorithm processing_algorithm;
+    std::size_t number_of_features;
+    std::vector<std::string> class_names;
+};
+
+// Requests and expected answers of the test set
+struct TestSample {
+    std::string true_label;
+    real_vector_t features_vector;
+    std::string au_file_path;
+};
+
+// Results of a connection
+struct ConnectionResults {
+    std::vector<real_t> latencies;
+    std::size_t good_predictions = 0;
+    std::size_t errors = 0;
+};
+
+/**
+ * @brief           Connect to the daemon socket.
+ *
+ * @param[in]       socket_path the path of the daemon socket
+ * @returns         the connected socket
+ */
+int connect_to_daemon(const std::string &socket_path) {
+    const sockaddr_un address = get_unix_socket_address(socket_path);
+    int file_descriptor = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (file_descriptor < 0 || connect(file_descriptor, (const sockaddr *) &address, sizeof(address)) < 0) {
+        LOG(LOG_ERROR) << "Error : can't connect to the daemon socket " << socket_path << " : " << std::strerror(errno);
+        throw std::runtime_error("Can't connect to the daemon!");
+    }
+    return file_descriptor;
+}
+
+/**
+ * @brief           Send a request.
+ *
+ * @param[in]       file_descriptor the connected socket
+ * @param[in]       request_id the id of the request, echoed by its response
+ * @param[in]       model_id the position of the model in the daemon command line
+ * @param[in]       type the request type
+ * @param[in]       payload the request payload
+ * @param[in]       payload_size the payload size in bytes
+ * @returns         false if the daemon is gone
+ */
+bool send_request(int file_descriptor, std::uint32_t request_id, std::uint8_t model_id, InferenceRequestType type, const void *payload, std::size_t payload_size) {
+    InferenceRequestHeader header = {};
+    std::copy(std::begin(INFERENCE_REQUEST_MAGIC), std::end(INFERENCE_REQUEST_MAGIC), header.magic);
+    header.request_id = request_id;
+    header.model_id = model_id;
+    header.type = (std::uint8_t) type;
+    header.payload_size = (std::uint32_t) payload_size;
+    return write_message(file_descriptor, &header, sizeof(header), payload, payload_size);
+}
+
+/**
+ * @brief           Receive a response.
+ *
+ * @param[in]       file_descriptor the connected socket
+ * @param[out]      header the response header
+ * @param[out]      payload the response payload
+ * @returns         false if the daemon is gone or breaks the protocol
+ */
+bool receive_response(int file_descriptor, InferenceResponseHeader &header, std::string &payload) {
+    if (!read_fully(file_descriptor, &header, sizeof(header)) || !std::equal(std::begin(INFERENCE_RESPONSE_MAGIC), std::end(INFERENCE_RESPONSE_MAGIC), header.magic) || header.payload_size > INFERENCE_MAX_PAYLOAD_SIZE) {
+        return false;
+    }
+    payload.resize(header.payload_size);
+    return read_fully(file_descriptor, payload.data(), payload.size());
+}
+
+/**
+ * @brief           Ask the daemon which model it serves under a model id.
+ *
+ * @param[in]       socket_path the path of the daemon socket
+ * @param[in]       model_id the position of the model in the daemon command line
+ * @returns         the model name, processing algorithm, features vector size and class names
+ */
+ModelInfo get_model_info(const std::string &socket_path, std::uint8_t model_id) {
+    int file_descriptor = connect_to_daemon(socket_path);
+    InferenceResponseHeader header;
+    std::string payload;
+    const bool answered = send_request(file_descriptor, 0, model_id, InferenceRequestType::MODEL_INFO, nullptr, 0) && receive_response(file_descriptor, header, payload);
+    close(file_descriptor);
+    if (!answered || header.status != (std::uint16_t) InferenceStatus::OK) {
+        LOG(LOG_ERROR) << "Error : the daemon does not serve any model with the id " << (int) model_id;
+        throw std::invalid_argument("Unknown model!");
+    }
+
+    ModelInfo model_info;
+    std::istringstream model_info_stream(payload);
+    std::string processing_algorithm;
+    model_info_stream >> model_info.name >> processing_algorithm >> model_info.number_of_features;
+    model_info.processing_algorithm = processing_algorithm == "STFT" ? AuFileProcessingAlgorithm::STFT : AuFileProcessingAlgorithm::MFCC;
+    std::string class_name;
+    std::getline(model_info_stream, class_name);
+    while (std::getline(model_info_stream, class_name)) {
+        model_info.class_names.push_back(class_name);
+    }
+    return model_info;
+}
+
+/**
+ * @brief           Read the test set of a processing algorithm with the .au file path of each features vector.
+ *
+ * @param[in]       processing_algorithm the processing algorithm of the model
+ * @returns         the test samples
+ */
+std::vector<TestSample> get_test_samples(AuFileProcessingAlgorithm processing_algorithm) {
+    const std::filesystem::path csv_file_path = processing_algorithm == AuFileProcessingAlgorithm::STFT ? MUSIC_FEATURES_STFT_CSV_TEST_PATH : MUSIC_FEATURES_MFCC_CSV_TEST_PATH;
+    std::vector<TestSample> test_samples;
+    for (std::pair<std::string, real_vector_t> &pair: get_features_vectors_from_csv(csv_file_path, processing_algorithm)) {
+        test_samples.push_back({std::move(pair.first), std::move(pair.second), {}});
+    }
+
+    // The file path is the last column of the CSV lines, between double quotes
+    std::ifstream input_file(csv_file_path);
+    std::string line;
+    std::getline(input_file, line);
+    for (TestSample &test_sample: test_samples) {
+        std::getline(input_file, line);
+        const std::size_t first_quote = line.rfind('"', line.size() - 2);
+        test_sample.au_file_path = line.substr(first_quote + 1, line.size() - first_quote - 2);
+    }
+    return test_samples;
+}
+
+/**
+ * @brief           Send requests on a connection keeping a fixed number of them in flight and record their latencies.
+ *
+ * @param[in]       socket_path the path of the daemon socket
+ * @param[in]       model_info the served model
+ * @param[in]       model_id the position of the model in the daemon command line
+ * @param[in]       test_samples the samples sent in turn, starting from first_sample
+ * @param[in]       first_sample the first sample sent by the connection
+ * @param[in]       number_of_requests the number of requests of the connection
+ * @param[in]       in_flight the number of requests sent without waiting for their responses
+ * @param[in]       request_type FEATURES_VECTOR or AU_FILE_PATH
+ * @param[out]      results the latencies and prediction results of the connection
+ * @returns         void
+ */
+void run_connection(const std::string &socket_path, const ModelInfo &model_info, std::uint8_t model_id, const std::vector<TestSample> &test_samples, std::size_t first_sample, std::size_t number_of_requests, std::size_t in_flight, InferenceRequestType request_type, ConnectionResults &results) {
+    int file_descriptor = connect_to_daemon(socket_path);
+    std::vector<steady_clock::time_point> send_times(number_of_requests);
+    std::vector<double> payload(model_info.number_of_features);
+    auto send_next = [&](std::uint32_t request_id) {
+        const TestSample &test_sample = test_samples[(first_sample + request_id) % test_samples.size()];
+        send_times[request_id] = steady_clock::now();
+        if (request_type == InferenceRequestType::AU_FILE_PATH) {
+            return send_request(file_descriptor, request_id, model_id, request_type, test_sample.au_file_path.data(), test_sample.au_file_path.size());
+        }
+        std::copy(test_sample.features_vector.cbegin(), test_sample.features_vector.cend(), payload.begin());
+        return send_request(file_descriptor, request_id, model_id, request_type, payload.data(), payload.size() * sizeof(double));
+    };
+
+    std::size_t sent_requests = 0;
+    while (sent_requests < std::min(in_flight, number_of_requests) && send_next((std::uint32_t) sent_requests)) {
+        sent_requests++;
+    }
+    InferenceResponseHeader header;
+    std::string response_payload;
+    for (std::size_t received_requests = 0; received_requests < sent_requests; received_requests++) {
+        if (!receive_response(file_descriptor, header, response_payload) || header.request_id >= number_of_requests) {
+            LOG(LOG_ERROR) << "Error : the daemon closed the connection";
+            break;
+        }
+        results.latencies.push_back((real_t) std::chrono::duration_cast<std::chrono::nanoseconds>(steady_clock::now() - send_times[header.request_id]).count() / 1000.0);
+        if (header.status != (std::uint16_t) InferenceStatus::OK || header.class_id >= model_info.class_names.size()) {
+            results.errors++;
+        } else if (model_info.class_names[header.class_id] == test_samples[(first_sample + header.request_id) % test_samples.size()].true_label) {
+            results.good_predictions++;
+        }
+        if (sent_requests < number_of_requests && send_next((std::uint32_t) sent_requests)) {
+            sent_requests++;
+        }
+    }
+    close(file_descriptor);
+}
+
+log_struct LOGGING_CONFIG = {};
+
+int main(int argc, char *argv[]) {
+    // Log config
+    LOGGING_CONFIG.level = LOG_INFO;
+
+    if (argc != 6 && argc != 7) {
+        std::cout << "Usage: " << argv[0] << " <socket_path> <model_id> <connections> <requests_per_connection> <in_flight_per_connection> [au]" << std::endl;
+        std::cout << "Sends the test set features vectors to the model of the daemon, or the paths of their .au files with au" << std::endl;
+        return 1;
+    }
+    const std::string socket_path = argv[1];
+    const auto model_id = (std::uint8_t) std::stoul(argv[2]);
+    const std::size_t number_of_connections = std::max(1UL, std::stoul(argv[3]));
+    const std::size_t requests_per_connection = std::stoul(argv[4]);
+    const std::size_t in_flight = std::max(1UL, std::stoul(argv[5]));
+    const InferenceRequestType request_type = argc == 7 && std::string(argv[6]) == "au" ? InferenceRequestType::AU_FILE_PATH : InferenceRequestType::FEATURES_VECTOR;
+
+    const ModelInfo model_info = get_model_info(socket_path, model_id);
+    const std::vector<TestSample> test_samples = get_test_samples(model_info.processing_algorithm);
+    LOG(LOG_INFO) << "Sending " << requests_per_connection << " " << (request_type == InferenceRequestType::AU_FILE_PATH ? ".au file paths" : "features vectors") << " on each of " << number_of_connections
+                  << " connections to the model " << model_info.name << ", " << in_flight << " requests in flight per connection ...";
+
+    // Each connection starts at another sample so the batches mix the samples
+    std::vector<ConnectionResults> connections_results(number_of_connections);
+    std::vector<std::thread> connections;
+    auto start_time = steady_clock::now();
+    for (std::size_t connection_i = 0; connection_i < number_of_connections; connection_i++) {
+        connections.emplace_back(run_connection, std::cref(socket_path), std::cref(model_info), model_id, std::cref(test_samples), connection_i * test_samples.size() / number_of_connections,
+                                 requests_per_connection, in_flight, request_type, std::ref(connections_results[connection_i]));
+    }
+    for (std::thread &connection: connections) {
+        connection.join();
+    }
+    const real_t elapsed_time = (real_t) std::chrono::duration_cast<std::chrono::microseconds>(steady_clock::now() - start_time).count() / 1e6;
+
+    LatencyRecorder latencies;
+    std::size_t good_predictions = 0;
+    std::size_t errors = 0;
+    for (const ConnectionResults &connection_results: connections_results) {
+        for (real_t latency: connection_results.latencies) {
+            latencies.record(latency);
+        }
+        good_predictions += connection_results.good_predictions;
+        errors += connection_results.errors;
+    }
+    LOG(LOG_INFO) << latencies.size() << " responses in " << elapsed_time << "s (" << (real_t) latencies.size() / elapsed_time << " req/s), " << errors << " errors, latency p50 "
+                  << latencies.get_percentile(50) << "µs, p99 " << latencies.get_percentile(99) << "µs";
+    LOG(LOG_INFO) << "Model accuracy: " << (real_t) good_predictions / (real_t) std::max((std::size_t) 1, latencies.size());
+    return latencies.size() == number_of_connections * requests_per_connection && errors == 0 ? 0 : 1;
+}
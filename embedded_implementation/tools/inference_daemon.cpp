@@ -0,0 +1,671 @@
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <fcntl.h>
+#include <poll.h>
+#include "../helpers/inference_protocol.h"
+#include "../helpers/model_container.h"
+#include "../helpers/model_holder.h"
+#include "../helpers/log.h"
+#include "../extraction/au_file_processor.h"
+#include "../ml_algorithms/decision_tree.h"
+#include "../ml_algorithms/random_forest.h"
+#include "../ml_algorithms/one_vs_one_svm.h"
+#include "../ml_algorithms/artificial_neural_network.h"
+
+using steady_clock = std::chrono::steady_clock;
+
+// Period of the throughput and latency report of each model
+constexpr std::chrono::seconds STATS_REPORT_PERIOD(10);
+// Bytes read from a connection at once
+constexpr std::size_t READ_SIZE = 1 << 16;
+// Responses a client may leave unread before it is disconnected, so a client which stops reading can't hold the daemon memory
+constexpr std::size_t MAX_OUTPUT_BACKLOG = 4 * MiB;
+// Time left to the clients to read their last responses when the daemon stops
+constexpr std::chrono::seconds STOP_FLUSH_TIMEOUT(1);
+
+volatile std::sig_atomic_t stop_requested = 0;
+
+/*
+ * Connection struct definition
+ */
+// Client connection, the socket is closed once the event loop and the pending requests of the client have all released it
+// The socket is non-blocking: a response is sent at once when possible, else it waits in the output buffer which only the
+// event loop flushes, so a client which does not read its responses never blocks a model, an extraction or the event loop
+struct Connection {
+    int file_descriptor;
+    // Received bytes not parsed yet, only used by the event loop
+    std::vector<char> input_buffer;
+    // The responses are written by the event loop, the extraction threads and the model threads
+    std::mutex output_mutex;
+    // Responses not sent yet
+    std::vector<char> output_buffer;
+    // The backlog went over MAX_OUTPUT_BACKLOG, the event loop disconnects the client
+    bool overflowed = false;
+    // Disconnected, the next responses are dropped
+    bool closed = false;
+    // Written to wake the event loop up when the output buffer needs a flush or the connection overflowed
+    int wake_file_descriptor;
+
+    Connection(int file_descriptor, int wake_file_descriptor) : file_descriptor(file_descriptor), wake_file_descriptor(wake_file_descriptor) {}
+
+    ~Connection() {
+        close(this->file_descriptor);
+    }
+
+    // A client gone before its response is not an error of the daemon, the response is dropped
+    void respond(std::uint32_t request_id, InferenceStatus status, std::size_t class_id = 0, const std::string &payload = {}) {
+        InferenceResponseHeader header = {};
+        std::copy(std::begin(INFERENCE_RESPONSE_MAGIC), std::end(INFERENCE_RESPONSE_MAGIC), header.magic);
+        header.request_id = request_id;
+        header.status = (std::uint16_t) status;
+        header.class_id = (std::uint16_t) class_id;
+        header.payload_size = (std::uint32_t) payload.size();
+        std::unique_lock<std::mutex> lock(this->output_mutex);
+        if (this->closed || this->overflowed) {
+            return;
+        }
+        const bool was_empty = this->output_buffer.empty();
+        const char *header_bytes = reinterpret_cast<const char *>(&header);
+        this->output_buffer.insert(this->output_buffer.end(), header_bytes, header_bytes + sizeof(header));
+        this->output_buffer.insert(this->output_buffer.end(), payload.cbegin(), payload.cend());
+        // The responses queued before are sent first, by the event loop
+        if (was_empty && !this->send_output()) {
+            return;
+        }
+        if (this->output_buffer.size() > MAX_OUTPUT_BACKLOG) {
+            this->overflowed = true;
+            this->output_buffer.clear();
+        }
+        if ((was_empty && !this->output_buffer.empty()) || this->overflowed) {
+            const char wake_byte = 0;
+            // A full pipe already wakes the event loop up
+            [[maybe_unused]] ssize_t written = write(this->wake_file_descriptor, &wake_byte, 1);
+        }
+    }
+
+    bool has_output() {
+        std::unique_lock<std::mutex> lock(this->output_mutex);
+        return !this->output_buffer.empty();
+    }
+
+    bool is_overflowed() {
+        std::unique_lock<std::mutex> lock(this->output_mutex);
+        return this->overflowed;
+    }
+
+    // Send what the socket accepts of the output buffer, returns false if the client is gone
+    bool flush() {
+        std::unique_lock<std::mutex> lock(this->output_mutex);
+        return this->send_output();
+    }
+
+    // Drop the next responses and wake the client up, the file descriptor is closed with the last reference
+    void disconnect() {
+        std::unique_lock<std::mutex> lock(this->output_mutex);
+        this->closed = true;
+        this->output_buffer.clear();
+        shutdown(this->file_descriptor, SHUT_RDWR);
+    }
+
+private:
+    // Called with the output mutex held
+    bool send_output() {
+        std::size_t sent_size = 0;
+        while (sent_size < this->output_buffer.size()) {
+            ssize_t written = send(this->file_descriptor, this->output_buffer.data() + sent_size, this->output_buffer.size() - sent_size, MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            }
+            if (written <= 0) {
+                this->closed = true;
+                this->output_buffer.clear();
+                return false;
+            }
+            sent_size += (std::size_t) written;
+        }
+        this->output_buffer.erase(this->output_buffer.begin(), this->output_buffer.begin() + (long) sent_size);
+        return true;
+    }
+};
+
+struct PendingRequest {
+    std::shared_ptr<Connection> connection;
+    std::uint32_t request_id;
+    real_vector_t features_vector;
+    // Time the request was parsed, the latency includes the extraction and the wait for the batch
+    steady_clock::time_point arrival_time;
+};
+
+/*
+ * ModelServer class definition
+ */
+// Loaded model and the thread predicting its pending requests, the requests are coalesced into a batch until it holds
+// max_batch_size requests or its oldest request has waited max_wait, then the whole batch goes through predict_class_ids
+// The model is reloaded in the background when its files change, each batch uses the version current when it starts
+class ModelServer {
+public:
+    ModelServer(std::string name, AuFileProcessingAlgorithm processing_algorithm, const std::filesystem::path &model_path, const ModelHolder<MachineLearningModel>::model_loader_t &model_loader, std::size_t max_batch_size, steady_clock::duration max_wait)
+            : name(std::move(name)), processing_algorithm(processing_algorithm), model(model_path, this->get_checked_model_loader(model_loader)), max_batch_size(max_batch_size), max_wait(max_wait) {
+        this->model.start_watching();
+        this->thread = std::thread([this]() { this->run(); });
+    }
+
+    ~ModelServer() {
+        this->stop();
+    }
+
+    const std::string &get_name() const {
+        return this->name;
+    }
+
+    AuFileProcessingAlgorithm get_processing_algorithm() const {
+        return this->processing_algorithm;
+    }
+
+    ModelHolder<MachineLearningModel>::ModelView get_model() const {
+        return this->model.get();
+    }
+
+    // Features vector size of the processing algorithm of the model
+    std::size_t get_number_of_features() const {
+        return this->processing_algorithm == AuFileProcessingAlgorithm::STFT ? FFT_SIZE * 2 : (MEL_APPLIED_N + 1) * 2;
+    }
+
+    void push(PendingRequest &&pending_request) {
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->queue.push_back(std::move(pending_request));
+        }
+        this->request_available.notify_one();
+    }
+
+    // Predict the pending requests then join the thread
+    void stop() {
+        this->model.stop_watching();
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->stopping = true;
+        }
+        this->request_available.notify_one();
+        if (this->thread.joinable()) {
+            this->thread.join();
+        }
+    }
+
+    // Log the throughput, the batch size and the latencies of the period and start a new period
+    void report(real_t period) {
+        std::unique_lock<std::mutex> lock(this->stats_mutex);
+        if (this->latencies.size() > 0) {
+            LOG(LOG_INFO) << this->name << ": " << this->latencies.size() << " requests (" << (real_t) this->latencies.size() / period << " req/s), mean batch size "
+                          << (real_t) this->latencies.size() / (real_t) this->number_of_batches << ", latency p50 " << this->latencies.get_percentile(50) << "µs, p99 " << this->latencies.get_percentile(99) << "µs, "
+                          << this->model.get_number_of_reloads() << " reloads";
+        }
+        this->latencies.clear();
+        this->number_of_batches = 0;
+    }
+
+private:
+    const std::string name;
+    const AuFileProcessingAlgorithm processing_algorithm;
+    ModelHolder<MachineLearningModel> model;
+    const std::size_t max_batch_size;
+    const steady_clock::duration max_wait;
+    std::mutex mutex;
+    std::condition_variable request_available;
+    std::deque<PendingRequest> queue;
+    bool stopping = false;
+    std::mutex stats_mutex;
+    LatencyRecorder latencies;
+    std::size_t number_of_batches = 0;
+    // Started last, once the members it uses are built
+    std::thread thread;
+
+    // The CSV readers skip the lines they can't parse, a model file being rewritten or broken can give a model without any
+    // class, the loader makes a prediction on a zero features vector so such a model is rejected rather than published
+    ModelHolder<MachineLearningModel>::model_loader_t get_checked_model_loader(const ModelHolder<MachineLearningModel>::model_loader_t &model_loader) const {
+        const std::size_t number_of_features = this->get_number_of_features();
+        return [model_loader, number_of_features](const std::filesystem::path &model_path) {
+            std::shared_ptr<MachineLearningModel> model = model_loader(model_path);
+            if (model->get_class_dictionary().empty()) {
+                LOG(LOG_ERROR) << "Error : the model " << model_path << " does not have any class";
+                throw std::runtime_error("Empty model!");
+            }
+            model->predict_class_id(real_vector_t(number_of_features, 0));
+            return model;
+        };
+    }
+
+    void run() {
+        std::vector<PendingRequest> batch;
+        std::vector<real_vector_t> features_vectors;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(this->mutex);
+                this->request_available.wait(lock, [this]() { return this->stopping || !this->queue.empty(); });
+                if (this->queue.empty()) {
+                    return;
+                }
+                // Wait for more requests until the batch is full or its oldest request has waited long enough
+                const steady_clock::time_point deadline = this->queue.front().arrival_time + this->max_wait;
+                this->request_available.wait_until(lock, deadline, [this]() { return this->stopping || this->queue.size() >= this->max_batch_size; });
+                const std::size_t batch_size = std::min(this->max_batch_size, this->queue.size());
+                batch.assign(std::make_move_iterator(this->queue.begin()), std::make_move_iterator(this->queue.begin() + (long) batch_size));
+                this->queue.erase(this->queue.begin(), this->queue.begin() + (long) batch_size);
+            }
+
+            features_vectors.clear();
+            for (PendingRequest &pending_request: batch) {
+                features_vectors.push_back(std::move(pending_request.features_vector));
+            }
+            try {
+                const std::vector<std::size_t> predicted_class_ids = this->get_model()->predict_class_ids(features_vectors);
+                for (std::size_t i = 0; i < batch.size(); i++) {
+                    batch[i].connection->respond(batch[i].request_id, InferenceStatus::OK, predicted_class_ids[i]);
+                }
+            } catch (const std::exception &e) {
+                LOG(LOG_WARNING) << "Batch of " << batch.size() << " requests of " << this->name << " not predicted due to the following error : " << e.what();
+                for (const PendingRequest &pending_request: batch) {
+                    pending_request.connection->respond(pending_request.request_id, InferenceStatus::BAD_REQUEST);
+                }
+            }
+
+            const steady_clock::time_point response_time = steady_clock::now();
+            std::unique_lock<std::mutex> lock(this->stats_mutex);
+            for (const PendingRequest &pending_request: batch) {
+                this->latencies.record((real_t) std::chrono::duration_cast<std::chrono::nanoseconds>(response_time - pending_request.arrival_time).count() / 1000.0);
+            }
+            this->number_of_batches++;
+        }
+    }
+};
+
+/*
+ * AuFileExtractor class definition
+ */
+// Threads extracting the features of the .au files of the AU_FILE_PATH requests, the features vectors then join the batches
+// of their model like the FEATURES_VECTOR requests
+class AuFileExtractor {
+public:
+    explicit AuFileExtractor(std::size_t number_of_threads) {
+        for (std::size_t thread_i = 0; thread_i < std::max((std::size_t) 1, number_of_threads); thread_i++) {
+            this->threads.emplace_back([this]() { this->run(); });
+        }
+    }
+
+    ~AuFileExtractor() {
+        this->stop();
+    }
+
+    void push(PendingRequest &&pending_request, std::filesystem::path &&au_file_path, ModelServer &model_server) {
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->queue.push_back({std::move(pending_request), std::move(au_file_path), &model_server});
+        }
+        this->request_available.notify_one();
+    }
+
+    // Extract the pending files then join the threads
+    void stop() {
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->stopping = true;
+        }
+        this->request_available.notify_all();
+        for (std::thread &thread: this->threads) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+    }
+
+private:
+    struct ExtractionRequest {
+        PendingRequest pending_request;
+        std::filesystem::path au_file_path;
+        ModelServer *model_server;
+    };
+
+    std::mutex mutex;
+    std::condition_variable request_available;
+    std::deque<ExtractionRequest> queue;
+    bool stopping = false;
+    std::vector<std::thread> threads;
+
+    void run() {
+        while (true) {
+            ExtractionRequest extraction_request;
+            {
+                std::unique_lock<std::mutex> lock(this->mutex);
+                this->request_available.wait(lock, [this]() { return this->stopping || !this->queue.empty(); });
+                if (this->queue.empty()) {
+                    return;
+                }
+                extraction_request = std::move(this->queue.front());
+                this->queue.pop_front();
+            }
+
+            PendingRequest &pending_request = extraction_request.pending_request;
+            try {
+                // The features vector is laid out like the CSV files the models were trained on: averages then standard deviations
+                AuFileProcessor au_file(extraction_request.au_file_path, extraction_request.model_server->get_processing_algorithm());
+                au_file.read_file();
+                au_file.apply_processing_algorithm();
+                pending_request.features_vector = au_file.get_features_average();
+                pending_request.features_vector.insert(pending_request.features_vector.end(), au_file.get_features_standard_deviation().cbegin(), au_file.get_features_standard_deviation().cend());
+            } catch (const std::exception &e) {
+                LOG(LOG_WARNING) << "File " << extraction_request.au_file_path << " not processed due to the following error : " << e.what();
+                pending_request.connection->respond(pending_request.request_id, InferenceStatus::EXTRACTION_FAILED);
+                continue;
+            }
+            extraction_request.model_server->push(std::move(pending_request));
+        }
+    }
+};
+
+/*
+ * Models of the daemon
+ */
+// A model ending with the model container extension is loaded with fill_from_binary, else with fill_from_csv
+template<typename Model>
+std::shared_ptr<MachineLearningModel> load_model(const std::filesystem::path &model_path) {
+    std::shared_ptr<Model> model = std::make_shared<Model>();
+    if (model_path.extension() == MODEL_CONTAINER_EXTENSION) {
+        model->fill_from_binary(model_path);
+    } else {
+        model->fill_from_csv(model_path);
+    }
+    return model;
+}
+
+struct ModelDefinition {
+    std::string name;
+    AuFileProcessingAlgorithm processing_algorithm;
+    std::filesystem::path csv_path;
+    std::function<std::shared_ptr<MachineLearningModel>(const std::filesystem::path &)> load;
+};
+
+const std::vector<ModelDefinition> MODEL_DEFINITIONS = {
+        {"cart_stft", AuFileProcessingAlgorithm::STFT, DECISION_TREE_CSV_PATH_STFT, load_model<DecisionTree>},
+        {"cart_mfcc", AuFileProcessingAlgorithm::MFCC, DECISION_TREE_CSV_PATH_MFCC, load_model<DecisionTree>},
+        {"random_forest_stft", AuFileProcessingAlgorithm::STFT, RANDOM_FOREST_TREES_FOLDER_PATH_STFT, load_model<RandomForest>},
+        {"random_forest_mfcc", AuFileProcessingAlgorithm::MFCC, RANDOM_FOREST_TREES_FOLDER_PATH_MFCC, load_model<RandomForest>},
+        {"svm_stft", AuFileProcessingAlgorithm::STFT, ONE_VS_ONE_SVM_CSV_PATH_STFT, load_model<OneVsOneSVM>},
+        {"svm_mfcc", AuFileProcessingAlgorithm::MFCC, ONE_VS_ONE_SVM_CSV_PATH_MFCC, load_model<OneVsOneSVM>},
+        {"ann_stft", AuFileProcessingAlgorithm::STFT, ARTIFICIAL_NEURAL_NETWORK_LAYERS_FOLDER_PATH_STFT, load_model<ArtificialNeuralNetwork>},
+        {"ann_mfcc", AuFileProcessingAlgorithm::MFCC, ARTIFICIAL_NEURAL_NETWORK_LAYERS_FOLDER_PATH_MFCC, load_model<ArtificialNeuralNetwork>}
+};
+
+/**
+ * @brief           Load a model of the command line.
+ *
+ * @param[in]       model_argument "<model name>" to load the training CSV files of the model or "<model name>=<model file>"
+ *                  to load a CSV file or folder or a model container written by MODEL_CONVERTER
+ * @param[in]       max_batch_size the maximum number of requests predicted together
+ * @param[in]       max_wait the maximum time a request waits for the batch to fill
+ * @returns         the server of the model
+ */
+std::unique_ptr<ModelServer> load_model_server(const std::string &model_argument, std::size_t max_batch_size, steady_clock::duration max_wait) {
+    const std::size_t separator = model_argument.find('=');
+    const std::string model_name = model_argument.substr(0, separator);
+    auto model_definition = std::find_if(MODEL_DEFINITIONS.cbegin(), MODEL_DEFINITIONS.cend(), [&model_name](const ModelDefinition &definition) {
+        return definition.name == model_name;
+    });
+    if (model_definition == MODEL_DEFINITIONS.cend()) {
+        LOG(LOG_ERROR) << "Error : unknown model " << model_name << ", the models are cart, random_forest, svm and ann followed by _stft or _mfcc";
+        throw std::invalid_argument("Unknown model!");
+    }
+    const std::filesystem::path model_path = separator == std::string::npos ? model_definition->csv_path : std::filesystem::path(model_argument.substr(separator + 1));
+
+    auto start_time = steady_clock::now();
+    std::unique_ptr<ModelServer> model_server = std::make_unique<ModelServer>(model_name, model_definition->processing_algorithm, model_path, model_definition->load, max_batch_size, max_wait);
+    auto elapsed_time = std::chrono::duration_cast<std::chrono::milliseconds>(steady_clock::now() - start_time).count();
+    LOG(LOG_INFO) << "Model " << model_name << " loaded from " << model_path << " in " << elapsed_time << "ms, reloaded when its files change";
+    return model_server;
+}
+
+/**
+ * @brief           Handle a complete request of a connection.
+ *
+ * @param[in]       connection the connection of the request
+ * @param[in]       header the request header
+ * @param[in]       payload the request payload
+ * @param[in]       model_servers the models of the daemon, indexed by the model ids
+ * @param[in]       au_file_extractor the threads extracting the .au files
+ * @returns         void
+ */
+void handle_request(const std::shared_ptr<Connection> &connection, const InferenceRequestHeader &header, const char *payload, std::vector<std::unique_ptr<ModelServer>> &model_servers, AuFileExtractor &au_file_extractor) {
+    const steady_clock::time_point arrival_time = steady_clock::now();
+    if (header.model_id >= model_servers.size()) {
+        connection->respond(header.request_id, InferenceStatus::UNKNOWN_MODEL);
+        return;
+    }
+    ModelServer &model_server = *model_servers[header.model_id];
+
+    switch ((InferenceRequestType) header.type) {
+        case InferenceRequestType::FEATURES_VECTOR : {
+            if (header.payload_size != model_server.get_number_of_features() * sizeof(double)) {
+                connection->respond(header.request_id, InferenceStatus::BAD_REQUEST);
+                break;
+            }
+            real_vector_t features_vector(model_server.get_number_of_features());
+            for (std::size_t i = 0; i < features_vector.size(); i++) {
+                double feature;
+                std::memcpy(&feature, payload + i * sizeof(double), sizeof(double));
+                features_vector[i] = (real_t) feature;
+            }
+            model_server.push({connection, header.request_id, std::move(features_vector), arrival_time});
+            break;
+        }
+        case InferenceRequestType::AU_FILE_PATH : {
+            au_file_extractor.push({connection, header.request_id, {}, arrival_time}, std::filesystem::path(std::string(payload, header.payload_size)), model_server);
+            break;
+        }
+        case InferenceRequestType::MODEL_INFO : {
+            std::string model_info = model_server.get_name() + (model_server.get_processing_algorithm() == AuFileProcessingAlgorithm::STFT ? " STFT " : " MFCC ") + std::to_string(model_server.get_number_of_features()) + "\n";
+            // The view is named so its read section lasts for the whole loop, a temporary one would end before the loop body
+            const ModelHolder<MachineLearningModel>::ModelView model = model_server.get_model();
+            for (const std::string &class_name: model->get_class_dictionary().get_class_names()) {
+                model_info += class_name + "\n";
+            }
+            connection->respond(header.request_id, InferenceStatus::OK, 0, model_info);
+            break;
+        }
+        default: {
+            connection->respond(header.request_id, InferenceStatus::BAD_REQUEST);
+            break;
+        }
+    }
+}
+
+/**
+ * @brief           Read the available bytes of a connection and handle its complete requests.
+ *
+ * @param[in]       connection the readable connection
+ * @param[in]       model_servers the models of the daemon, indexed by the model ids
+ * @param[in]       au_file_extractor the threads extracting the .au files
+ * @returns         false if the connection is closed or breaks the protocol
+ */
+bool read_requests(const std::shared_ptr<Connection> &connection, std::vector<std::unique_ptr<ModelServer>> &model_servers, AuFileExtractor &au_file_extractor) {
+    std::vector<char> &input_buffer = connection->input_buffer;
+    const std::size_t buffered_size = input_buffer.size();
+    input_buffer.resize(buffered_size + READ_SIZE);
+    ssize_t read_size = read(connection->file_descriptor, input_buffer.data() + buffered_size, READ_SIZE);
+    if (read_size < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+        input_buffer.resize(buffered_size);
+        return true;
+    }
+    if (read_size <= 0) {
+        return false;
+    }
+    input_buffer.resize(buffered_size + (std::size_t) read_size);
+
+    std::size_t offset = 0;
+    while (input_buffer.size() - offset >= sizeof(InferenceRequestHeader)) {
+        InferenceRequestHeader header;
+        std::memcpy(&header, input_buffer.data() + offset, sizeof(header));
+        if (!std::equal(std::begin(INFERENCE_REQUEST_MAGIC), std::end(INFERENCE_REQUEST_MAGIC), header.magic) || header.payload_size > INFERENCE_MAX_PAYLOAD_SIZE) {
+            LOG(LOG_WARNING) << "Closing a connection breaking the protocol (bad magic number or payload of " << header.payload_size << "B)";
+            return false;
+        }
+        if (input_buffer.size() - offset < sizeof(header) + header.payload_size) {
+            break;
+        }
+        handle_request(connection, header, input_buffer.data() + offset + sizeof(header), model_servers, au_file_extractor);
+        offset += sizeof(header) + header.payload_size;
+    }
+    input_buffer.erase(input_buffer.begin(), input_buffer.begin() + (long) offset);
+    return true;
+}
+
+/**
+ * @brief           Send the responses left in the output buffers of the connections.
+ *
+ * @param[in]       connections the client connections
+ * @param[in]       timeout the time left to the clients to read their responses
+ * @returns         void
+ */
+void flush_connections(const std::vector<std::shared_ptr<Connection>> &connections, steady_clock::duration timeout) {
+    const steady_clock::time_point deadline = steady_clock::now() + timeout;
+    std::vector<std::shared_ptr<Connection>> flushed_connections = connections;
+    std::vector<pollfd> poll_file_descriptors;
+    while (steady_clock::now() < deadline) {
+        std::erase_if(flushed_connections, [](const std::shared_ptr<Connection> &connection) {
+            return !connection->flush() || !connection->has_output();
+        });
+        if (flushed_connections.empty()) {
+            return;
+        }
+        poll_file_descriptors.clear();
+        for (const std::shared_ptr<Connection> &connection: flushed_connections) {
+            poll_file_descriptors.push_back({connection->file_descriptor, POLLOUT, 0});
+        }
+        poll(poll_file_descriptors.data(), poll_file_descriptors.size(), (int) std::chrono::duration_cast<std::chrono::milliseconds>(deadline - steady_clock::now()).count() + 1);
+    }
+    LOG(LOG_WARNING) << flushed_connections.size() << " clients did not read all their responses before the daemon stopped";
+}
+
+void request_stop(int) {
+    stop_requested = 1;
+}
+
+log_struct LOGGING_CONFIG = {};
+
+int main(int argc, char *argv[]) {
+    // Log config
+    LOGGING_CONFIG.level = LOG_INFO;
+
+    if (argc < 5) {
+        std::cout << "Usage: " << argv[0] << " <socket_path> <max_batch_size> <max_wait_us> <model>[=<model_file>] [<model>[=<model_file>] ...]" << std::endl;
+        std::cout << "The model ids of the requests are the positions of the models, the models are cart, random_forest, svm and ann followed by _stft or _mfcc" << std::endl;
+        return 1;
+    }
+    const std::string socket_path = argv[1];
+    const std::size_t max_batch_size = std::max(1UL, std::stoul(argv[2]));
+    const std::chrono::microseconds max_wait(std::stoul(argv[3]));
+    if (argc - 4 > 256) {
+        LOG(LOG_ERROR) << "Error : the model ids of the protocol are limited to 256 models";
+        return 1;
+    }
+
+    std::vector<std::unique_ptr<ModelServer>> model_servers;
+    for (int arg_i = 4; arg_i < argc; arg_i++) {
+        model_servers.push_back(load_model_server(argv[arg_i], max_batch_size, max_wait));
+    }
+    AuFileExtractor au_file_extractor(std::thread::hardware_concurrency());
+
+    int listen_file_descriptor = socket(AF_UNIX, SOCK_STREAM, 0);
+    const sockaddr_un address = get_unix_socket_address(socket_path);
+    unlink(socket_path.c_str());
+    if (listen_file_descriptor < 0 || bind(listen_file_descriptor, (const sockaddr *) &address, sizeof(address)) < 0 || listen(listen_file_descriptor, SOMAXCONN) < 0) {
+        LOG(LOG_ERROR) << "Error : can't listen on the socket " << socket_path << " : " << std::strerror(errno);
+        return 1;
+    }
+    std::signal(SIGINT, request_stop);
+    std::signal(SIGTERM, request_stop);
+    LOG(LOG_INFO) << "Listening on " << socket_path << " with " << model_servers.size() << " models, batches of up to " << max_batch_size << " requests waiting up to " << max_wait.count() << "µs";
+
+    // Written by the threads responding to a connection whose responses wait for the event loop
+    int wake_file_descriptors[2];
+    if (pipe2(wake_file_descriptors, O_NONBLOCK | O_CLOEXEC) < 0) {
+        LOG(LOG_ERROR) << "Error : can't create the wake up pipe of the event loop : " << std::strerror(errno);
+        return 1;
+    }
+
+    // Single threaded event loop, it only parses the requests and flushes the responses the clients could not take at once,
+    // the predictions run on the model threads
+    std::vector<std::shared_ptr<Connection>> connections;
+    std::vector<pollfd> poll_file_descriptors;
+    steady_clock::time_point last_report_time = steady_clock::now();
+    while (!stop_requested) {
+        poll_file_descriptors.assign({{listen_file_descriptor, POLLIN, 0}, {wake_file_descriptors[0], POLLIN, 0}});
+        for (const std::shared_ptr<Connection> &connection: connections) {
+            poll_file_descriptors.push_back({connection->file_descriptor, (short) (POLLIN | (connection->has_output() ? POLLOUT : 0)), 0});
+        }
+        // The timeout bounds the delay to notice a stop request and to report the stats
+        if (poll(poll_file_descriptors.data(), poll_file_descriptors.size(), 100) > 0) {
+            if (poll_file_descriptors[1].revents & POLLIN) {
+                char wake_bytes[256];
+                while (read(wake_file_descriptors[0], wake_bytes, sizeof(wake_bytes)) > 0) {
+                }
+            }
+            std::vector<std::shared_ptr<Connection>> open_connections;
+            for (std::size_t connection_i = 0; connection_i < connections.size(); connection_i++) {
+                const std::shared_ptr<Connection> &connection = connections[connection_i];
+                const short revents = poll_file_descriptors[connection_i + 2].revents;
+                bool open = !(revents & POLLOUT) || connection->flush();
+                if (open && (revents & (POLLIN | POLLHUP | POLLERR))) {
+                    open = read_requests(connection, model_servers, au_file_extractor);
+                }
+                if (open && connection->is_overflowed()) {
+                    LOG(LOG_WARNING) << "Disconnecting a client leaving more than " << MAX_OUTPUT_BACKLOG << "B of responses unread";
+                    open = false;
+                }
+                if (open) {
+                    open_connections.push_back(connection);
+                } else {
+                    connection->disconnect();
+                }
+            }
+            connections = std::move(open_connections);
+            if (poll_file_descriptors[0].revents & POLLIN) {
+                int connection_file_descriptor = accept4(listen_file_descriptor, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                if (connection_file_descriptor >= 0) {
+                    connections.push_back(std::make_shared<Connection>(connection_file_descriptor, wake_file_descriptors[1]));
+                }
+            }
+        }
+
+        const steady_clock::time_point now = steady_clock::now();
+        if (now - last_report_time >= STATS_REPORT_PERIOD) {
+            const real_t period = (real_t) std::chrono::duration_cast<std::chrono::milliseconds>(now - last_report_time).count() / 1000.0;
+            for (const std::unique_ptr<ModelServer> &model_server: model_servers) {
+                model_server->report(period);
+            }
+            last_report_time = now;
+        }
+    }
+
+    // Answer the requests already received before leaving
+    LOG(LOG_INFO) << "Stopping, answering the pending requests ...";
+    close(listen_file_descriptor);
+    unlink(socket_path.c_str());
+    au_file_extractor.stop();
+    const real_t period = (real_t) std::chrono::duration_cast<std::chrono::milliseconds>(steady_clock::now() - last_report_time).count() / 1000.0;
+    for (const std::unique_ptr<ModelServer> &model_server: model_servers) {
+        model_server->stop();
+        model_server->report(period);
+    }
+    flush_connections(connections, STOP_FLUSH_TIMEOUT);
+    close(wake_file_descriptors[0]);
+    close(wake_file_descriptors[1]);
+    return 0;
+}
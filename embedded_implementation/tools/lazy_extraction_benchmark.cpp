@@ -0,0 +1,109 @@
+#include <chrono>
+#include <set>
+#include "../helpers/file_helpers.h"
+#include "../helpers/log.h"
+#include "../extraction/au_file_processor.h"
+#include "../ml_algorithms/decision_tree.h"
+#include "../ml_algorithms/random_forest.h"
+
+/**
+ * @brief           Extract the STFT features vector of a read .au file and measure the extraction time.
+ *
+ * @param[in]       au_file the read .au file, restricted or not to the features of a model
+ * @param[out]      features_vector the normalized features vector
+ * @returns         the extraction time in ms
+ */
+real_t extract_features_vector(AuFileProcessor &au_file, real_vector_t &features_vector) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    au_file.apply_processing_algorithm();
+    auto stop_time = std::chrono::high_resolution_clock::now();
+    features_vector = au_file.get_features_average();
+    features_vector.insert(features_vector.end(), au_file.get_features_standard_deviation().cbegin(), au_file.get_features_standard_deviation().cend());
+    return (real_t) std::chrono::duration_cast<std::chrono::microseconds>(stop_time - start_time).count() / 1000.0;
+}
+
+log_struct LOGGING_CONFIG = {};
+
+int main(int argc, char *argv[]) {
+    // Log config
+    LOGGING_CONFIG.level = LOG_INFO;
+
+    const std::string model_argument = argc > 1 ? argv[1] : "";
+    const std::string model_name = model_argument.substr(0, model_argument.find('='));
+    if ((argc != 3 && argc != 4) || (model_name != "cart" && model_name != "random_forest")) {
+        std::cout << "Usage: " << argv[0] << " <cart|random_forest>[=<model_csv_path>] <normalization_frame_stride> [<au_folder>]" << std::endl;
+        std::cout << "Compares the full STFT extraction of the .au files of au_folder (../../../datasets/music by default) with the one restricted to the features used by the STFT model (the trained one by default)" << std::endl;
+        return 1;
+    }
+    const std::size_t normalization_frame_stride = std::stoul(argv[2]);
+    const std::filesystem::path au_folder_path = argc == 4 ? argv[3] : "../../../datasets/music";
+
+    // Load the model and the features it tests
+    std::unique_ptr<MachineLearningModel> model;
+    if (model_name == "cart") {
+        model = std::make_unique<DecisionTree>();
+        model->fill_from_csv(model_argument.find('=') != std::string::npos ? std::filesystem::path(model_argument.substr(model_argument.find('=') + 1)) : DECISION_TREE_CSV_PATH_STFT);
+    } else {
+        model = std::make_unique<RandomForest>();
+        model->fill_from_csv(model_argument.find('=') != std::string::npos ? std::filesystem::path(model_argument.substr(model_argument.find('=') + 1)) : RANDOM_FOREST_TREES_FOLDER_PATH_STFT);
+    }
+    const std::vector<std::size_t> used_features = model->get_used_features();
+    std::set<std::size_t> used_bins;
+    for (std::size_t feature_id: used_features) {
+        used_bins.insert(feature_id % FFT_SIZE);
+    }
+    LOG(LOG_INFO) << "The " << model_name << " model uses " << used_features.size() << " of the " << FFT_SIZE * 2 << " STFT features, " << used_bins.size() << " of the " << FFT_SIZE << " bins";
+
+    std::vector<std::filesystem::path> au_files;
+    for (const auto &entry: std::filesystem::recursive_directory_iterator(au_folder_path)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".au") {
+            au_files.push_back(entry.path());
+        }
+    }
+    std::sort(au_files.begin(), au_files.end());
+    if (au_files.empty()) {
+        LOG(LOG_ERROR) << "Error : no .au file found in " << absolute(au_folder_path);
+        return 1;
+    }
+
+    // Extract each track in full then restricted to the used features, from the same raw data
+    real_t read_time = 0;
+    real_t full_time = 0;
+    real_t lazy_time = 0;
+    real_t max_deviation = 0;
+    std::size_t same_predictions = 0;
+    std::size_t full_good_predictions = 0;
+    std::size_t lazy_good_predictions = 0;
+    for (const std::filesystem::path &au_file_path: au_files) {
+        AuFileProcessor au_file(au_file_path, AuFileProcessingAlgorithm::STFT);
+        auto start_time = std::chrono::high_resolution_clock::now();
+        au_file.read_file();
+        auto stop_time = std::chrono::high_resolution_clock::now();
+        read_time += (real_t) std::chrono::duration_cast<std::chrono::microseconds>(stop_time - start_time).count() / 1000.0;
+
+        real_vector_t full_features_vector;
+        real_vector_t lazy_features_vector;
+        full_time += extract_features_vector(au_file, full_features_vector);
+        au_file.set_required_features(used_features, normalization_frame_stride);
+        lazy_time += extract_features_vector(au_file, lazy_features_vector);
+
+        // The used features only differ by the estimation of the normalization statistics
+        for (std::size_t feature_id: used_features) {
+            max_deviation = std::max(max_deviation, std::abs(full_features_vector[feature_id] - lazy_features_vector[feature_id]));
+        }
+        const std::string &full_prediction = model->predict_class(full_features_vector);
+        const std::string &lazy_prediction = model->predict_class(lazy_features_vector);
+        same_predictions += full_prediction == lazy_prediction ? 1 : 0;
+        full_good_predictions += full_prediction == au_file.get_music_style() ? 1 : 0;
+        lazy_good_predictions += lazy_prediction == au_file.get_music_style() ? 1 : 0;
+        LOG(LOG_DEBUG) << au_file_path.filename().string() << ": full prediction " << full_prediction << ", lazy prediction " << lazy_prediction;
+    }
+
+    const auto number_of_tracks = (real_t) au_files.size();
+    LOG(LOG_INFO) << au_files.size() << " tracks, read in " << read_time / number_of_tracks << "ms per track";
+    LOG(LOG_INFO) << "Full extraction: " << full_time / number_of_tracks << "ms per track, accuracy " << (real_t) full_good_predictions / number_of_tracks;
+    LOG(LOG_INFO) << "Lazy extraction (normalization frame stride " << normalization_frame_stride << "): " << lazy_time / number_of_tracks << "ms per track (x" << full_time / lazy_time << ", x" << (read_time + full_time) / (read_time + lazy_time) << " with the read), accuracy " << (real_t) lazy_good_predictions / number_of_tracks;
+    LOG(LOG_INFO) << "Same prediction for " << (real_t) same_predictions / number_of_tracks * 100 << "% of the tracks, largest deviation of a used normalized feature " << max_deviation;
+
+    return 0;
+}
@@ -0,0 +1,135 @@
+#include <chrono>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include "../helpers/file_helpers.h"
+#include "../helpers/classification_helpers.h"
+#include "../helpers/log.h"
+#include "../ml_algorithms/decision_tree.h"
+#include "../ml_algorithms/random_forest.h"
+#include "../ml_algorithms/one_vs_one_svm.h"
+#include "../ml_algorithms/artificial_neural_network.h"
+
+/**
+ * @brief           Evict a model file, or all the files of a model folder, from the page cache.
+ * @details         The dirty pages are written back first, only the clean pages can be dropped. Approximates a cold
+ *                  start without the root privileges needed to drop the whole page cache.
+ *
+ * @param[in]       model_path the model file or folder
+ * @returns         the number of bytes of the model files
+ */
+std::size_t drop_page_cache(const std::filesystem::path &model_path) {
+    std::vector<std::filesystem::path> file_paths = {model_path};
+    if (std::filesystem::is_directory(model_path)) {
+        file_paths = alpha_files_listing(model_path.string());
+    }
+    std::size_t model_size = 0;
+    for (const std::filesystem::path &file_path: file_paths) {
+        int file_descriptor = open(file_path.c_str(), O_RDONLY);
+        if (file_descriptor < 0) {
+            LOG(LOG_ERROR) << "Error : file with path " + file_path.string() + "  not found.";
+            throw std::filesystem::filesystem_error("Can't open file!", std::make_error_code(std::errc::no_such_file_or_directory));
+        }
+        fdatasync(file_descriptor);
+        posix_fadvise(file_descriptor, 0, 0, POSIX_FADV_DONTNEED);
+        close(file_descriptor);
+        model_size += std::filesystem::file_size(file_path);
+    }
+    return model_size;
+}
+
+/**
+ * @brief           Measure the cold start load time of a model.
+ * @details         The model files are evicted from the page cache before each load and the fastest load is kept.
+ *
+ * @param[in]       model_path the model file or folder
+ * @param[in]       load the function creating a model and loading it from model_path
+ * @returns         the load time in µs
+ */
+real_t measure_cold_load_time(const std::filesystem::path &model_path, const std::function<void(const std::filesystem::path &)> &load) {
+    const std::size_t repetitions = 5;
+    real_t best_elapsed_time = std::numeric_limits<real_t>::max();
+    for (std::size_t repetition = 0; repetition < repetitions; repetition++) {
+        drop_page_cache(model_path);
+        auto start_time = std::chrono::high_resolution_clock::now();
+        load(model_path);
+        auto stop_time = std::chrono::high_resolution_clock::now();
+        best_elapsed_time = std::min(best_elapsed_time, (real_t) std::chrono::duration_cast<std::chrono::nanoseconds>(stop_time - start_time).count());
+    }
+    return best_elapsed_time / 1000.0;
+}
+
+/**
+ * @brief           Convert a model from its training CSV files to a binary model container, check that both make the
+ *                  same predictions on the test set and compare their cold start load times.
+ *
+ * @param[in]       model_name the name of the model in the logs and the report
+ * @param[in]       csv_path the CSV file or folder of the model
+ * @param[in]       binary_file_path the binary model container to write
+ * @param[in]       features_vectors the test features vectors
+ * @param[in]       report_file the report, one line per model
+ * @returns         true if the binary model makes the same predictions as the CSV one
+ */
+template<typename Model>
+bool convert_model(const std::string &model_name, const std::filesystem::path &csv_path, const std::filesystem::path &binary_file_path, const std::vector<std::pair<std::string, real_vector_t>> &features_vectors, std::ofstream &report_file) {
+    LOG(LOG_INFO) << "Converting the " << model_name << " model " << csv_path << " ...";
+    Model csv_model = {};
+    csv_model.fill_from_csv(csv_path);
+    csv_model.write_to_binary(binary_file_path);
+    Model binary_model = {};
+    binary_model.fill_from_binary(binary_file_path);
+    const bool identical_predictions = make_predictions(csv_model, features_vectors) == make_predictions(binary_model, features_vectors);
+
+    const real_t csv_load_time = measure_cold_load_time(csv_path, [](const std::filesystem::path &model_path) {
+        Model model = {};
+        model.fill_from_csv(model_path);
+    });
+    const real_t binary_load_time = measure_cold_load_time(binary_file_path, [](const std::filesystem::path &model_path) {
+        Model model = {};
+        model.fill_from_binary(model_path);
+    });
+    const std::size_t csv_size = drop_page_cache(csv_path);
+    const std::size_t binary_size = drop_page_cache(binary_file_path);
+
+    report_file << model_name << "," << csv_size << "," << binary_size << "," << csv_load_time << "," << binary_load_time << "," << csv_load_time / binary_load_time << "," << identical_predictions << "\n";
+    LOG(LOG_INFO) << model_name << ": CSV " << csv_size << "B loaded in " << csv_load_time << "µs, binary " << binary_size << "B loaded in " << binary_load_time << "µs (x" << csv_load_time / binary_load_time << "), " << (identical_predictions ? "identical predictions" : "PREDICTIONS DIFFER");
+    return identical_predictions;
+}
+
+log_struct LOGGING_CONFIG = {};
+
+int main(int argc, char *argv[]) {
+    // Log config
+    LOGGING_CONFIG.level = LOG_INFO;
+
+    if (argc != 2) {
+        std::cout << "Usage: " << argv[0] << " <output_model_dir>" << std::endl;
+        return 1;
+    }
+    const std::filesystem::path output_folder_path = argv[1];
+    std::filesystem::create_directories(output_folder_path);
+
+    LOG(LOG_INFO) << "Getting features vectors from the csv files " << absolute(MUSIC_FEATURES_STFT_CSV_TEST_PATH) << " and " << absolute(MUSIC_FEATURES_MFCC_CSV_TEST_PATH) << " ...";
+    const auto stft_fvs = get_features_vectors_from_csv(MUSIC_FEATURES_STFT_CSV_TEST_PATH, AuFileProcessingAlgorithm::STFT);
+    const auto mfcc_fvs = get_features_vectors_from_csv(MUSIC_FEATURES_MFCC_CSV_TEST_PATH, AuFileProcessingAlgorithm::MFCC);
+
+    const std::filesystem::path report_path = output_folder_path.string() + "_report.csv";
+    std::ofstream report_file(report_path);
+    report_file << "model,csv_bytes,binary_bytes,csv_load_us,binary_load_us,speed_up,identical_predictions\n";
+    bool identical_predictions = true;
+    identical_predictions &= convert_model<DecisionTree>("cart_stft", DECISION_TREE_CSV_PATH_STFT, output_folder_path / ("cart_stft" + MODEL_CONTAINER_EXTENSION), stft_fvs, report_file);
+    identical_predictions &= convert_model<DecisionTree>("cart_mfcc", DECISION_TREE_CSV_PATH_MFCC, output_folder_path / ("cart_mfcc" + MODEL_CONTAINER_EXTENSION), mfcc_fvs, report_file);
+    identical_predictions &= convert_model<RandomForest>("random_forest_stft", RANDOM_FOREST_TREES_FOLDER_PATH_STFT, output_folder_path / ("random_forest_stft" + MODEL_CONTAINER_EXTENSION), stft_fvs, report_file);
+    identical_predictions &= convert_model<RandomForest>("random_forest_mfcc", RANDOM_FOREST_TREES_FOLDER_PATH_MFCC, output_folder_path / ("random_forest_mfcc" + MODEL_CONTAINER_EXTENSION), mfcc_fvs, report_file);
+    identical_predictions &= convert_model<OneVsOneSVM>("svm_stft", ONE_VS_ONE_SVM_CSV_PATH_STFT, output_folder_path / ("svm_stft" + MODEL_CONTAINER_EXTENSION), stft_fvs, report_file);
+    identical_predictions &= convert_model<OneVsOneSVM>("svm_mfcc", ONE_VS_ONE_SVM_CSV_PATH_MFCC, output_folder_path / ("svm_mfcc" + MODEL_CONTAINER_EXTENSION), mfcc_fvs, report_file);
+    identical_predictions &= convert_model<ArtificialNeuralNetwork>("ann_stft", ARTIFICIAL_NEURAL_NETWORK_LAYERS_FOLDER_PATH_STFT, output_folder_path / ("ann_stft" + MODEL_CONTAINER_EXTENSION), stft_fvs, report_file);
+    identical_predictions &= convert_model<ArtificialNeuralNetwork>("ann_mfcc", ARTIFICIAL_NEURAL_NETWORK_LAYERS_FOLDER_PATH_MFCC, output_folder_path / ("ann_mfcc" + MODEL_CONTAINER_EXTENSION), mfcc_fvs, report_file);
+
+    LOG(LOG_INFO) << "Binary models written in " << absolute(output_folder_path) << ", load times written in " << absolute(report_path);
+    if (!identical_predictions) {
+        LOG(LOG_ERROR) << "Error : at least one binary model does not make the same predictions as its CSV model";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,354 @@
+#include <chrono>
+#include <csignal>
+#include <functional>
+#include <thread>
+#include <sys/wait.h>
+#include "../helpers/classification_helpers.h"
+#include "../helpers/file_helpers.h"
+#include "../helpers/shared_model_segment.h"
+#include "../helpers/log.h"
+#include "../ml_algorithms/decision_tree.h"
+#include "../ml_algorithms/random_forest.h"
+#include "../ml_algorithms/one_vs_one_svm.h"
+#include "../ml_algorithms/artificial_neural_network.h"
+#include "../ml_algorithms/shared_models.h"
+
+using steady_clock = std::chrono::steady_clock;
+
+// Period of the memory report of the workers
+constexpr auto MEMORY_REPORT_PERIOD = std::chrono::seconds(5);
+
+volatile std::sig_atomic_t stop_requested = 0;
+
+void request_stop(int) {
+    stop_requested = 1;
+}
+
+/**
+ * @brief           Add the features vector size of a model to its container.
+ *
+ * @param[in,out]   model_container the container of the model
+ * @param[in]       number_of_features the size of the features vectors of the model
+ */
+void add_features_vector_size(ModelContainerWriter &model_container, std::size_t number_of_features) {
+    const auto features_vector_size = (std::uint32_t) number_of_features;
+    model_container.add_section(ModelSectionType::FEATURES_VECTOR_SIZE, &features_vector_size, 1);
+}
+
+/**
+ * @brief           Container of a decision tree for the segment, its flattened nodes as a forest of one tree.
+ *
+ * @param[in]       decision_tree the decision tree
+ * @param[in]       number_of_features the size of the features vectors of the model
+ * @returns         the model container
+ */
+ModelContainerWriter get_shared_container(const DecisionTree &decision_tree, std::size_t number_of_features) {
+    const std::vector<FlatTreeNode> &flat_tree = decision_tree.get_flat_tree();
+    if (flat_tree.empty()) {
+        LOG(LOG_ERROR) << "Error : the decision tree does not have any node";
+        throw std::invalid_argument("Tree does not have a root node!");
+    }
+    const std::uint32_t root_id = 0;
+    ModelContainerWriter model_container(ModelType::DECISION_TREE);
+    model_container.add_class_dictionary(decision_tree.get_class_dictionary());
+    add_features_vector_size(model_container, number_of_features);
+    model_container.add_section(ModelSectionType::FLAT_TREE_NODES, flat_tree.data(), flat_tree.size());
+    model_container.add_section(ModelSectionType::TREE_ROOTS_ID, &root_id, 1);
+    return model_container;
+}
+
+/**
+ * @brief           Container of a random forest for the segment.
+ * @details         The flattened trees are concatenated, their children ids shifted by the index of their root node and
+ *                  their leaf class ids translated to the class ids of the forest, as EMBEDDED_MODEL_GENERATOR.
+ *
+ * @param[in]       random_forest the random forest
+ * @param[in]       number_of_features the size of the features vectors of the model
+ * @returns         the model container
+ */
+ModelContainerWriter get_shared_container(const RandomForest &random_forest, std::size_t number_of_features) {
+    if (random_forest.get_number_of_trees() == 0) {
+        LOG(LOG_ERROR) << "Error : the random forest does not have any tree";
+        throw std::invalid_argument("Forest does not have any tree!");
+    }
+    const ClassDictionary &forest_class_dictionary = random_forest.get_class_dictionary();
+    std::vector<FlatTreeNode> forest_nodes;
+    std::vector<std::uint32_t> roots_id;
+    for (const DecisionTree &decision_tree: random_forest.get_trees()) {
+        const std::uint32_t root_id = forest_nodes.size();
+        for (FlatTreeNode node: decision_tree.get_flat_tree()) {
+            if (node.children_id[0] == node.children_id[1]) {
+                node.class_id = forest_class_dictionary.get_class_id(decision_tree.get_class_dictionary().get_class_name(node.class_id));
+            }
+            node.children_id[0] += root_id;
+            node.children_id[1] += root_id;
+            forest_nodes.push_back(node);
+        }
+        roots_id.push_back(root_id);
+    }
+    ModelContainerWriter model_container(ModelType::RANDOM_FOREST);
+    model_container.add_class_dictionary(forest_class_dictionary);
+    add_features_vector_size(model_container, number_of_features);
+    model_container.add_section(ModelSectionType::FLAT_TREE_NODES, forest_nodes.data(), forest_nodes.size());
+    model_container.add_section(ModelSectionType::TREE_ROOTS_ID, roots_id.data(), roots_id.size());
+    return model_container;
+}
+
+/**
+ * @brief           Container of a one vs one SVM for the segment, its coefficients zero-padded as in OneVsOneSVM.
+ *
+ * @param[in]       one_vs_one_svm the SVM
+ * @param[in]       number_of_features the size of the features vectors of the model
+ * @returns         the model container
+ */
+ModelContainerWriter get_shared_container(const OneVsOneSVM &one_vs_one_svm, std::size_t number_of_features) {
+    const std::pmr::vector<LinearClassifier> &classifiers = one_vs_one_svm.get_classifiers();
+    if (classifiers.empty()) {
+        LOG(LOG_ERROR) << "Error : the SVM does not have any classifier";
+        throw std::invalid_argument("SVM does not have any classifier!");
+    }
+    const ClassDictionary &class_dictionary = one_vs_one_svm.get_class_dictionary();
+    const std::size_t padded_number_of_features = simd_padded_size(number_of_features);
+    aligned_real_vector_t coefficients(classifiers.size() * padded_number_of_features, 0);
+    std::vector<real_t> intercepts;
+    std::vector<std::uint32_t> classifiers_class_ids;
+    for (std::size_t classifier_i = 0; classifier_i < classifiers.size(); classifier_i++) {
+        const LinearClassifier &linear_classifier = classifiers[classifier_i];
+        if (linear_classifier.get_coef_matrix().size() != number_of_features) {
+            LOG(LOG_ERROR) << "Error : the classifier " << classifier_i << " has " << linear_classifier.get_coef_matrix().size() << " coefficients but the model takes " << number_of_features << " features";
+            throw std::invalid_argument("SVM shape mismatch!");
+        }
+        std::copy(linear_classifier.get_coef_matrix().cbegin(), linear_classifier.get_coef_matrix().cend(), coefficients.begin() + (long) (classifier_i * padded_number_of_features));
+        intercepts.push_back(linear_classifier.get_intercept());
+        classifiers_class_ids.push_back(class_dictionary.get_class_id(linear_classifier.get_lower_class()));
+        classifiers_class_ids.push_back(class_dictionary.get_class_id(linear_classifier.get_upper_class()));
+    }
+    ModelContainerWriter model_container(ModelType::ONE_VS_ONE_SVM);
+    model_container.add_class_dictionary(class_dictionary);
+    add_features_vector_size(model_container, number_of_features);
+    model_container.add_section(ModelSectionType::PADDED_SVM_COEFFICIENTS, coefficients.data(), coefficients.size());
+    model_container.add_section(ModelSectionType::SVM_INTERCEPTS, intercepts.data(), intercepts.size());
+    model_container.add_section(ModelSectionType::SVM_CLASS_IDS, classifiers_class_ids.data(), classifiers_class_ids.size());
+    return model_container;
+}
+
+/**
+ * @brief           Container of a neural network for the segment, its packed weights already zero-padded.
+ *
+ * @param[in]       artificial_neural_network the neural network
+ * @param[in]       number_of_features the size of the features vectors of the model
+ * @returns         the model container
+ */
+ModelContainerWriter get_shared_container(const ArtificialNeuralNetwork &artificial_neural_network, std::size_t number_of_features) {
+    const std::vector<DenseLayer> &dense_layers = artificial_neural_network.get_dense_layers();
+    if (dense_layers.empty() || dense_layers.front().input_size != number_of_features) {
+        LOG(LOG_ERROR) << "Error : the neural network does not have any layer taking " << number_of_features << " features";
+        throw std::invalid_argument("Neural network shape mismatch!");
+    }
+    ModelContainerWriter model_container(ModelType::ARTIFICIAL_NEURAL_NETWORK);
+    model_container.add_class_dictionary(artificial_neural_network.get_class_dictionary());
+    add_features_vector_size(model_container, number_of_features);
+    for (const DenseLayer &dense_layer: dense_layers) {
+        const BinaryLayerShape layer_shape = {(std::uint32_t) dense_layer.input_size, (std::uint32_t) dense_layer.output_size, (std::uint32_t) dense_layer.activation_function};
+        model_container.add_section(ModelSectionType::LAYER_SHAPE, &layer_shape, 1);
+        model_container.add_section(ModelSectionType::PADDED_LAYER_WEIGHTS, dense_layer.weights.data(), dense_layer.weights.size());
+        model_container.add_section(ModelSectionType::LAYER_BIASES, dense_layer.biases.data(), dense_layer.biases.size());
+    }
+    return model_container;
+}
+
+/**
+ * @brief           Load a model from its CSV files or from a model container written by MODEL_CONVERTER.
+ *
+ * @param[out]      model the model to fill
+ * @param[in]       model_path the CSV file or folder, or the .eml file of the model
+ */
+template<typename Model>
+void load_model(Model &model, const std::filesystem::path &model_path) {
+    if (model_path.extension() == MODEL_CONTAINER_EXTENSION) {
+        model.fill_from_binary(model_path);
+    } else {
+        model.fill_from_csv(model_path);
+    }
+}
+
+/**
+ * @brief           Load a model and check that its container makes the same predictions once shared.
+ *
+ * @param[in,out]   segment_writer the segment to add the model to
+ * @param[in]       model_name the name of the model in the segment
+ * @param[in]       model_path the CSV file or folder, or the .eml file of the model
+ * @param[in]       processing_algorithm the processing algorithm of the features of the model
+ * @returns         the model predictions on the test set, compared to the shared model ones once the segment is built
+ */
+template<typename Model>
+std::vector<std::pair<std::string, std::string>> add_shared_model(SharedModelSegmentWriter &segment_writer, const std::string &model_name, const std::filesystem::path &model_path, AuFileProcessingAlgorithm processing_algorithm) {
+    const std::size_t number_of_features = processing_algorithm == AuFileProcessingAlgorithm::STFT ? FFT_SIZE * 2 : (MEL_APPLIED_N + 1) * 2;
+    Model model = {};
+    load_model(model, model_path);
+    ModelContainerWriter model_container = get_shared_container(model, number_of_features);
+    segment_writer.add_model(model_name, model_container);
+    return make_predictions(model, get_features_vectors_from_csv(processing_algorithm == AuFileProcessingAlgorithm::STFT ? MUSIC_FEATURES_STFT_CSV_TEST_PATH : MUSIC_FEATURES_MFCC_CSV_TEST_PATH, processing_algorithm));
+}
+
+struct ModelDefinition {
+    std::string name;
+    AuFileProcessingAlgorithm processing_algorithm;
+    std::filesystem::path csv_path;
+    std::function<std::vector<std::pair<std::string, std::string>>(SharedModelSegmentWriter &, const std::string &, const std::filesystem::path &, AuFileProcessingAlgorithm)> add;
+};
+
+const std::vector<ModelDefinition> MODEL_DEFINITIONS = {
+        {"cart_stft", AuFileProcessingAlgorithm::STFT, DECISION_TREE_CSV_PATH_STFT, add_shared_model<DecisionTree>},
+        {"cart_mfcc", AuFileProcessingAlgorithm::MFCC, DECISION_TREE_CSV_PATH_MFCC, add_shared_model<DecisionTree>},
+        {"random_forest_stft", AuFileProcessingAlgorithm::STFT, RANDOM_FOREST_TREES_FOLDER_PATH_STFT, add_shared_model<RandomForest>},
+        {"random_forest_mfcc", AuFileProcessingAlgorithm::MFCC, RANDOM_FOREST_TREES_FOLDER_PATH_MFCC, add_shared_model<RandomForest>},
+        {"svm_stft", AuFileProcessingAlgorithm::STFT, ONE_VS_ONE_SVM_CSV_PATH_STFT, add_shared_model<OneVsOneSVM>},
+        {"svm_mfcc", AuFileProcessingAlgorithm::MFCC, ONE_VS_ONE_SVM_CSV_PATH_MFCC, add_shared_model<OneVsOneSVM>},
+        {"ann_stft", AuFileProcessingAlgorithm::STFT, ARTIFICIAL_NEURAL_NETWORK_LAYERS_FOLDER_PATH_STFT, add_shared_model<ArtificialNeuralNetwork>},
+        {"ann_mfcc", AuFileProcessingAlgorithm::MFCC, ARTIFICIAL_NEURAL_NETWORK_LAYERS_FOLDER_PATH_MFCC, add_shared_model<ArtificialNeuralNetwork>}
+};
+
+/**
+ * @brief           Start a worker process, it inherits the segment file descriptor and finds it in its environment.
+ *
+ * @param[in]       worker_arguments the worker command and its arguments
+ * @returns         the pid of the worker
+ */
+pid_t start_worker(const std::vector<char *> &worker_arguments) {
+    pid_t pid = fork();
+    if (pid < 0) {
+        LOG(LOG_ERROR) << "Error : can't start the worker " << worker_arguments.front() << " : " << std::strerror(errno);
+        throw std::runtime_error("Can't start the worker!");
+    }
+    if (pid == 0) {
+        execvp(worker_arguments.front(), worker_arguments.data());
+        LOG(LOG_ERROR) << "Error : can't execute the worker " << worker_arguments.front() << " : " << std::strerror(errno);
+        _exit(127);
+    }
+    return pid;
+}
+
+/**
+ * @brief           Log the memory used by each worker and by all of them, the models segment apart.
+ *
+ * @param[in]       workers the pids of the running workers
+ * @param[in]       segment_mapping_name the name of the segment mappings in /proc/<pid>/smaps
+ * @param[in]       segment_size the size of the segment
+ */
+void report_memory_usage(const std::vector<pid_t> &workers, const std::string &segment_mapping_name, std::size_t segment_size) {
+    const real_t mb = 1024.0 * 1024.0;
+    MappingsMemoryUsage total_usage;
+    MappingsMemoryUsage total_segment_usage;
+    for (pid_t worker: workers) {
+        const MappingsMemoryUsage usage = get_mappings_memory_usage(worker);
+        const MappingsMemoryUsage segment_usage = get_mappings_memory_usage(worker, segment_mapping_name);
+        LOG(LOG_INFO) << "Worker " << worker << ": RSS " << (real_t) usage.rss / mb << "MB, PSS " << (real_t) usage.pss / mb << "MB, private " << (real_t) usage.private_memory / mb << "MB, models segment RSS "
+                      << (real_t) segment_usage.rss / mb << "MB, PSS " << (real_t) segment_usage.pss / mb << "MB";
+        total_usage.rss += usage.rss;
+        total_usage.pss += usage.pss;
+        total_segment_usage.rss += segment_usage.rss;
+        total_segment_usage.pss += segment_usage.pss;
+    }
+    LOG(LOG_INFO) << workers.size() << " workers: PSS " << (real_t) total_usage.pss / mb << "MB (RSS " << (real_t) total_usage.rss / mb << "MB), models segment PSS " << (real_t) total_segment_usage.pss / mb
+                  << "MB (RSS " << (real_t) total_segment_usage.rss / mb << "MB) for a segment of " << (real_t) segment_size / mb << "MB, private copies of the models would take at least "
+                  << (real_t) (workers.size() * segment_size) / mb << "MB";
+}
+
+log_struct LOGGING_CONFIG = {};
+
+int main(int argc, char *argv[]) {
+    // Log config
+    LOGGING_CONFIG.level = LOG_INFO;
+
+    const auto separator = std::find(argv, argv + argc, std::string("--"));
+    if (separator - argv < 4 || separator + 1 >= argv + argc) {
+        std::cout << "Usage: " << argv[0] << " <segment_name> <number_of_workers> <model>[=<model_file>]... -- <worker_command> [<worker_argument>...]" << std::endl;
+        std::cout << "Loads the models once in a read-only shared memory segment, then starts the workers with its path in " << SHARED_SEGMENT_ENVIRONMENT_VARIABLE << std::endl;
+        std::cout << "The models are cart, random_forest, svm and ann followed by _stft or _mfcc, loaded from their training CSV files or from <model_file>" << std::endl;
+        return 1;
+    }
+    const std::string segment_name = argv[1];
+    const std::size_t number_of_workers = std::max(1UL, std::stoul(argv[2]));
+    std::vector<char *> worker_arguments(separator + 1, argv + argc);
+    worker_arguments.push_back(nullptr);
+
+    // Build the segment and check that each shared model makes the same predictions as the model it comes from
+    SharedModelSegmentWriter segment_writer;
+    std::vector<std::pair<std::string, std::vector<std::pair<std::string, std::string>>>> models_predictions;
+    for (char **model_argument = argv + 3; model_argument < separator; model_argument++) {
+        const std::string argument = *model_argument;
+        const std::size_t model_separator = argument.find('=');
+        const std::string model_name = argument.substr(0, model_separator);
+        auto model_definition = std::find_if(MODEL_DEFINITIONS.cbegin(), MODEL_DEFINITIONS.cend(), [&model_name](const ModelDefinition &definition) {
+            return definition.name == model_name;
+        });
+        if (model_definition == MODEL_DEFINITIONS.cend()) {
+            LOG(LOG_ERROR) << "Error : unknown model " << model_name << ", the models are cart, random_forest, svm and ann followed by _stft or _mfcc";
+            return 1;
+        }
+        const std::filesystem::path model_path = model_separator == std::string::npos ? model_definition->csv_path : std::filesystem::path(argument.substr(model_separator + 1));
+        models_predictions.emplace_back(model_name, model_definition->add(segment_writer, model_name, model_path, model_definition->processing_algorithm));
+    }
+    const int segment_file_descriptor = segment_writer.create_memfd(segment_name);
+    const std::string segment_path = "/proc/self/fd/" + std::to_string(segment_file_descriptor);
+    const auto segment = std::make_shared<const SharedModelSegment>(segment_path);
+    for (const auto &[model_name, predictions]: models_predictions) {
+        const AuFileProcessingAlgorithm processing_algorithm = get_shared_model_number_of_features(*segment, model_name) == FFT_SIZE * 2 ? AuFileProcessingAlgorithm::STFT : AuFileProcessingAlgorithm::MFCC;
+        const auto features_vectors = get_features_vectors_from_csv(processing_algorithm == AuFileProcessingAlgorithm::STFT ? MUSIC_FEATURES_STFT_CSV_TEST_PATH : MUSIC_FEATURES_MFCC_CSV_TEST_PATH, processing_algorithm);
+        if (make_predictions(*get_shared_model(segment, model_name), features_vectors) != predictions) {
+            LOG(LOG_ERROR) << "Error : the shared model " << model_name << " does not make the same predictions as the model it comes from";
+            return 1;
+        }
+    }
+    LOG(LOG_INFO) << "Segment " << segment_name << " of " << segment->get_size() << "B holding " << models_predictions.size() << " models sealed, identical predictions, attach to it with /proc/" << getpid() << "/fd/" << segment_file_descriptor;
+
+    // The workers find the segment through the inherited file descriptor
+    setenv(SHARED_SEGMENT_ENVIRONMENT_VARIABLE.c_str(), segment_path.c_str(), 1);
+    std::signal(SIGINT, request_stop);
+    std::signal(SIGTERM, request_stop);
+    std::vector<pid_t> workers;
+    for (std::size_t worker_i = 0; worker_i < number_of_workers; worker_i++) {
+        workers.push_back(start_worker(worker_arguments));
+    }
+    LOG(LOG_INFO) << number_of_workers << " workers " << worker_arguments.front() << " started";
+
+    // Restart the crashed workers until they all exit or a stop is requested
+    bool stopping = false;
+    auto last_report_time = steady_clock::now();
+    int exit_code = 0;
+    while (!workers.empty()) {
+        if (stop_requested && !stopping) {
+            stopping = true;
+            LOG(LOG_INFO) << "Stopping the workers ...";
+            for (pid_t worker: workers) {
+                kill(worker, SIGTERM);
+            }
+        }
+        int status = 0;
+        const pid_t worker = waitpid(-1, &status, WNOHANG);
+        if (worker > 0) {
+            auto worker_it = std::find(workers.begin(), workers.end(), worker);
+            if (worker_it != workers.end()) {
+                if (WIFSIGNALED(status) && !stopping) {
+                    LOG(LOG_WARNING) << "Worker " << worker << " killed by the signal " << WTERMSIG(status) << ", restarting it";
+                    *worker_it = start_worker(worker_arguments);
+                } else {
+                    if (WIFEXITED(status) && WEXITSTATUS(status) != 0) {
+                        LOG(LOG_WARNING) << "Worker " << worker << " exited with the code " << WEXITSTATUS(status);
+                        exit_code = 1;
+                    }
+                    workers.erase(worker_it);
+                }
+            }
+            continue;
+        }
+        if (steady_clock::now() - last_report_time >= MEMORY_REPORT_PERIOD && !workers.empty()) {
+            report_memory_usage(workers, "memfd:" + segment_name, segment->get_size());
+            last_report_time = steady_clock::now();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    LOG(LOG_INFO) << "All the workers exited";
+    return exit_code;
+}
@@ -0,0 +1,47 @@
+#include <chrono>
+#include <csignal>
+#include <thread>
+#include "../helpers/classification_helpers.h"
+#include "../helpers/file_helpers.h"
+#include "../helpers/shared_model_segment.h"
+#include "../helpers/log.h"
+#include "../ml_algorithms/shared_models.h"
+
+volatile std::sig_atomic_t stop_requested = 0;
+
+void request_stop(int) {
+    stop_requested = 1;
+}
+
+log_struct LOGGING_CONFIG = {};
+
+int main(int argc, char *argv[]) {
+    // Log config
+    LOGGING_CONFIG.level = LOG_INFO;
+
+    if (argc > 2) {
+        std::cout << "Usage: " << argv[0] << " [<lifetime_s>]" << std::endl;
+        std::cout << "Started by MODEL_SUPERVISOR, evaluates the models of its shared segment on the test set then stays alive for lifetime_s seconds (10 by default)" << std::endl;
+        return 1;
+    }
+    const auto lifetime = std::chrono::seconds(argc == 2 ? std::stoul(argv[1]) : 10);
+    std::signal(SIGINT, request_stop);
+    std::signal(SIGTERM, request_stop);
+
+    // The models are evaluated in place, the worker holds no copy of their weights
+    const auto segment = std::make_shared<const SharedModelSegment>(SharedModelSegment::get_environment_segment_path());
+    const auto stft_fvs = get_features_vectors_from_csv(MUSIC_FEATURES_STFT_CSV_TEST_PATH, AuFileProcessingAlgorithm::STFT);
+    const auto mfcc_fvs = get_features_vectors_from_csv(MUSIC_FEATURES_MFCC_CSV_TEST_PATH, AuFileProcessingAlgorithm::MFCC);
+    for (const std::string &model_name: segment->get_model_names()) {
+        const std::shared_ptr<MachineLearningModel> model = get_shared_model(segment, model_name);
+        const auto &features_vectors = get_shared_model_number_of_features(*segment, model_name) == stft_fvs.front().second.size() ? stft_fvs : mfcc_fvs;
+        const real_t accuracy = predictions_report(make_predictions(*model, features_vectors));
+        LOG(LOG_INFO) << "Worker " << getpid() << ", " << model_name << " accuracy: " << accuracy;
+    }
+
+    auto start_time = std::chrono::steady_clock::now();
+    while (!stop_requested && std::chrono::steady_clock::now() - start_time < lifetime) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    return 0;
+}
@@ -1,3 +1,4 @@
+import os
 import pandas as pd
 import numpy as np
 import csv
@@ -25,4 +26,43 @@ def svm_to_csv(svm, class_names, csv_file):
     pd.DataFrame([CSV_HEADER]).to_csv(csv_file, mode='w', index=False, header=False, quoting=csv.QUOTE_NONE)
     svm_df.to_csv(csv_file, mode='a', index=False, header=False, quoting=csv.QUOTE_NONNUMERIC)
 
-    return CSV_HEADER
\ No newline at end of file
+    return CSV_HEADER
+
+def kernel_svm_to_csv(svm, folder):
+    # Export a sklearn SVC (one vs one, any kernel) in the folder format read by KernelOneVsOneSVM
+    os.makedirs(folder, exist_ok=True)
+    n_classes = len(svm.classes_)
+    n_support_vectors = len(svm.support_vectors_)
+    # Index of the first support vector of each class, support vectors are grouped by class in svm.classes_ order
+    sv_start = np.concatenate([[0], np.cumsum(svm.n_support_)])
+
+    gamma = svm._gamma
+    pd.DataFrame([[svm.kernel, gamma, svm.coef0, svm.degree]], columns=["kernel", "gamma", "coef0", "degree"]).to_csv(
+        os.path.join(folder, "kernel.csv"), index=False, quoting=csv.QUOTE_NONNUMERIC)
+
+    pd.DataFrame(svm.support_vectors_, columns=list("feature{}".format(i) for i in range(svm.support_vectors_.shape[1]))).to_csv(
+        os.path.join(folder, "support_vectors.csv"), index=False)
+
+    # Dense coefficients of each pair (i, j), the dual coefficients of the support vectors of class i are in row j - 1
+    # and the ones of class j in row i, the decision value is positive when class i wins
+    dual_coef = svm.dual_coef_
+    intercept = svm.intercept_
+    if n_classes == 2:
+        # sklearn flips the sign of a 2 classes SVC so its decision value is positive when classes_[1] wins
+        dual_coef = -dual_coef
+        intercept = -intercept
+    CSV_HEADER = ["positive_class", "negative_class", "intercept"] + list("coeff{}".format(i) for i in range(n_support_vectors))
+    value_list = []
+    pair_i = 0
+    for i in range(n_classes):
+        for j in range(i + 1, n_classes):
+            coefficients = np.zeros(n_support_vectors)
+            coefficients[sv_start[i]:sv_start[i + 1]] = dual_coef[j - 1, sv_start[i]:sv_start[i + 1]]
+            coefficients[sv_start[j]:sv_start[j + 1]] = dual_coef[i, sv_start[j]:sv_start[j + 1]]
+            value_list.append([str(svm.classes_[i]), str(svm.classes_[j]), intercept[pair_i]] + list(coefficients))
+            pair_i += 1
+
+    pd.DataFrame([CSV_HEADER]).to_csv(os.path.join(folder, "dual_coefficients.csv"), mode='w', index=False, header=False, quoting=csv.QUOTE_NONE)
+    pd.DataFrame(value_list).to_csv(os.path.join(folder, "dual_coefficients.csv"), mode='a', index=False, header=False, quoting=csv.QUOTE_NONNUMERIC)
+
+    return CSV_HEADER